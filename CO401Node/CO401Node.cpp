@@ -78,13 +78,12 @@ CO401Node::CO401Node(uint8_t thisId)
  * no need to be regsitered as we don't receive messages
  *
  * 25-03-09 AW 
+ * 2026-10-16 AW mappings preset from the COPDOMaps
  *
  *-------------------------------------------------------------------*/
 
 void CO401Node::init(COMsgHandler *ThisHandler)
 {
-	uint8_t NodeHandle;
-	
 	MsgHandler = ThisHandler;
 
 	NodeHandle = MsgHandler->RegisterNode(nodeId);
@@ -97,8 +96,8 @@ void CO401Node::init(COMsgHandler *ThisHandler)
 	PDOHandler.PresetRxPDOTransmission(0, 255);  //parameters are the PDO# and the transmission type
 	PDOHandler.PresetTxPDOTransmission(0, 255, 0, 0);  //parameters are the PDO#, the transmission type, the inhibit time and the EvtTimer
 	
-	PDOHandler.PresetRxPDOMapping(0, MapRxPDO1.NrEntries, MapRxPDO1.Entries);  //parameters are the PDO#, the number of actually mapped entries and the pointer to the entries
-  PDOHandler.PresetTxPDOMapping(0, MapTxPDO1.NrEntries, MapTxPDO1.Entries);  //parameters are the PDO#, the number of actually mapped entries and the pointer to the entries
+	PDOHandler.PresetRxPDOMapping<CO401RxPDO1Map>(0, MapRxPDO1.Entries);  //parameters are the PDO# and the pointer to the entries in the order of the map
+  PDOHandler.PresetTxPDOMapping<CO401TxPDO1Map>(0, MapTxPDO1.Entries);  //parameters are the PDO# and the pointer to the entries in the order of the map
 
   PDOHandler.PresetRxPDOisValid(0,true);
   PDOHandler.PresetTxPDOisValid(0,true);
@@ -106,8 +105,8 @@ void CO401Node::init(COMsgHandler *ThisHandler)
 	PDOHandler.PresetRxPDOTransmission(1, 255);  //parameters are the PDO# and the transmission type
 	PDOHandler.PresetTxPDOTransmission(1, 255, 0, 0);  //parameters are the PDO#, the transmission type, the inhibit time and the EvtTimer
 
-	PDOHandler.PresetRxPDOMapping(1, MapRxPDO2.NrEntries, MapRxPDO2.Entries);  //parameters are the PDO#, the number of actually mapped entries and the pointer to the entries
-  PDOHandler.PresetTxPDOMapping(1, MapTxPDO2.NrEntries, MapTxPDO2.Entries);  //parameters are the PDO#, the number of actually mapped entries and the pointer to the entries
+	PDOHandler.PresetRxPDOMapping<CO401RxPDO2Map>(1, MapRxPDO2.Entries);  //parameters are the PDO# and the pointer to the entries in the order of the map
+  PDOHandler.PresetTxPDOMapping<CO401TxPDO2Map>(1, MapTxPDO2.Entries);  //parameters are the PDO# and the pointer to the entries in the order of the map
 
   PDOHandler.PresetRxPDOisValid(1,false);
   PDOHandler.PresetTxPDOisValid(1,false);
@@ -210,6 +209,125 @@ NMTNodeState CO401Node::Update(uint32_t actTime, COSyncState syncState)
   return NodeState;	
 }
 
+/*-------------------------------------------------------------------
+ * void CO401Node::Schedule(pfunction_holder *OnUpdate)
+ * 
+ * run the node by the scheduler of the COMsgHandler instead of calling
+ * Update() in the loop: Update() is called whenever the node is due -
+ * a frame of the node received, a SYNC sent if there are synchronous
+ * RxPDOs or one of the deadlines of GetDueInUs() - and then
+ * OnUpdate->callback with OnUpdate->op and the node, if not NULL.
+ * The callback is where the application steps the node on.
+ * To be called after init().
+ *
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void CO401Node::Schedule(pfunction_holder *OnUpdate)
+{
+	pfunction_holder Cb;
+	
+	OnUpdateCb.callback = (OnUpdate != NULL) ? OnUpdate->callback : NULL;
+	OnUpdateCb.op = (OnUpdate != NULL) ? OnUpdate->op : NULL;
+	SeenSyncNr = MsgHandler->GetSyncNr();
+	
+	Cb.callback = (pfunction_pointer_t)CO401Node::OnDueCb;
+	Cb.op = (void *)this;
+	MsgHandler->Register_OnDueCb(NodeHandle, &Cb);
+}
+
+/*-------------------------------------------------------------------
+ * void CO401Node::Unschedule()
+ * 
+ * back to Update() being called by the loop
+ *
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void CO401Node::Unschedule()
+{
+	MsgHandler->Register_OnDueCb(NodeHandle, NULL);
+}
+
+/*-------------------------------------------------------------------
+ * void CO401Node::Wake()
+ * 
+ * the node is due right away - the application changed something
+ * outside of the callback, e.g. autoEnable
+ *
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void CO401Node::Wake()
+{
+	MsgHandler->PostNode(NodeHandle);
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t CO401Node::GetDueInUs()
+ * 
+ * the time in us until Update() has something to do - the one of the
+ * node, the one of the PDO config in pre-op and the one of the PDOs
+ * when operational. SchedNotDue if there is nothing but waiting for
+ * a frame.
+ *
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+uint32_t CO401Node::GetDueInUs()
+{
+	uint32_t DueInUs = Node.GetDueInUs();
+	
+	switch(Node.GetNodeState())
+	{
+		case eNMTStatePreOp:
+			if(!isPDOsConfigured)
+			{
+				if(reConfigPDOs)
+					DueInUs = COSchedMin(DueInUs, PDOHandler.GetConfigDueInUs());
+			}
+			else if(autoEnable)
+				DueInUs = 0;
+			break;
+		case eNMTStateOperational:
+			DueInUs = COSchedMin(DueInUs, PDOHandler.GetDueInUs());
+			break;
+		default:
+			break;
+	}
+	
+	return DueInUs;
+}
+
+/*-------------------------------------------------------------------
+ * void CO401Node::OnDue()
+ * 
+ * the node is due: the SYNC is reported to the first Update() after
+ * it, then the node is scheduled again by it's next deadline
+ *
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void CO401Node::OnDue()
+{
+	uint32_t syncNr = MsgHandler->GetSyncNr();
+	COSyncState syncState = (syncNr != SeenSyncNr) ? eSyncSyncSent : eSyncIdle;
+	
+	SeenSyncNr = syncNr;
+	Update(millis(), syncState);
+	
+	if(OnUpdateCb.callback != NULL)
+		OnUpdateCb.callback(OnUpdateCb.op, (void *)this);
+	
+	MsgHandler->SetNodeSyncDue(NodeHandle, PDOHandler.HasSyncRxPDOs());
+	MsgHandler->ScheduleNode(NodeHandle, GetDueInUs());
+}
+
 /*-------------------------------------------------------------------
  * COIONodeCommStates CO401Node::InitNode(uint32_t actTime)
  * 
@@ -24,6 +24,8 @@
  * a class covering the CiA401 I/O Nodes
  *
  * 2025-10-28 AW Frame
+ * 2026-10-16 AW PDO mappings as COPDOMap
+ * 2026-10-16 AW run by the scheduler of the COMsgHandler
  *
  *-------------------------------------------------------------------*/
  
@@ -48,6 +50,18 @@ const uint8_t NumAnOut16Objects = 1;
 const uint8_t NumNodeIdentityObjects = 3;
 const uint8_t NodeOdStringLen = 32;
 
+//--- the objects mapped to the PDOs and the default mappings ---
+
+typedef COPDOObject<0x6000, 0x01, uint8_t> CO401DigIn;
+typedef COPDOObject<0x6200, 0x01, uint8_t> CO401DigOut;
+typedef COPDOObject<0x6401, 0x01, int16_t> CO401AnIn;
+typedef COPDOObject<0x6411, 0x01, int16_t> CO401AnOut;
+
+typedef COPDOMap<CO401DigIn> CO401TxPDO1Map;
+typedef COPDOMap<CO401DigOut> CO401RxPDO1Map;
+typedef COPDOMap<CO401AnIn> CO401TxPDO2Map;
+typedef COPDOMap<CO401AnOut> CO401RxPDO2Map;
+
 typedef enum COIONodeCommStates {
 	eCO_IOIdle,
 	eCO_IOWaiting,
@@ -73,6 +87,17 @@ class CO401Node {
 		COIONodeCommStates InitPDOs(uint32_t);
 		
 	  NMTNodeState Update(uint32_t, COSyncState); //parameters are actTime and SyncState
+	
+	  //instead of calling Update() in the loop: run by the COMsgHandler
+	  //when due, the callback is called with the node after each Update()
+	  void Schedule(pfunction_holder *);
+	  void Unschedule();
+	  void Wake();
+	  uint32_t GetDueInUs();
+	
+	  static void OnDueCb(void *op,void *p) {
+		  ((CO401Node *)op)->OnDue();
+	  };
 		
 		COIONodeCommStates IdentifyIONode();
 		ODEntry **GetIdentityEntries();
@@ -105,15 +130,20 @@ class CO401Node {
 		                               (ODEntry *)&OdHwVersion, 
 		                               (ODEntry *)&OdSwVersion};
 
-		ODEntry08 OdDigInStatus = {0x6000, 0x01, &(DigInStatus[0]), 1};
-		ODEntry08 OdDigOutStatus = {0x6200, 0x01, &(DigOutStatus[0]), 1};
+		ODEntry08 OdDigInStatus = {CO401DigIn::Idx, CO401DigIn::SubIdx, &(DigInStatus[0]), CO401DigIn::Len};
+		ODEntry08 OdDigOutStatus = {CO401DigOut::Idx, CO401DigOut::SubIdx, &(DigOutStatus[0]), CO401DigOut::Len};
 
-		ODEntry16 OdAnInStatus = {0x6401, 0x01, (uint16_t *)&(AnInStatus16[0]), 2};
-		ODEntry16 OdAnOutStatus = {0x6411, 0x01, (uint16_t *)&(AnOutStatus16[0]), 2};
+		ODEntry16 OdAnInStatus = {CO401AnIn::Idx, CO401AnIn::SubIdx, (uint16_t *)&(AnInStatus16[0]), CO401AnIn::Len};
+		ODEntry16 OdAnOutStatus = {CO401AnOut::Idx, CO401AnOut::SubIdx, (uint16_t *)&(AnOutStatus16[0]), CO401AnOut::Len};
 		
 	private:
 		uint8_t nodeId;
 		COMsgHandler *MsgHandler;
+		uint8_t NodeHandle = InvalidSlot;
+	
+	  void OnDue();
+	  pfunction_holder OnUpdateCb = {NULL, NULL};
+	  uint32_t SeenSyncNr = 0;
 
 	  uint8_t AccessStep = 0;
 	
@@ -26,6 +26,8 @@
  * produce a global HB message if configured
  *
  * 2025-03-09 AW Frame
+ * 2026-10-16 AW PDO mappings as COPDOMap
+ * 2026-10-16 AW run by the scheduler of the COMsgHandler
  *
  *-------------------------------------------------------------------*/
  
@@ -47,6 +49,25 @@ const int8_t OpModeHoming = 6;
 const uint8_t NumDriveIdentityObjects = 4;
 const uint8_t DriveOdStringLen = 32;
 
+//--- the objects mapped to the PDOs and the default mappings ---
+//the lengths, offsets and mapping words are constants, an oversized
+//mapping fails to compile
+
+typedef COPDOObject<0x6040, 0x00, uint16_t> CO402ControlWord;
+typedef COPDOObject<0x6041, 0x00, uint16_t> CO402StatusWord;
+typedef COPDOObject<0x6060, 0x00, uint8_t> CO402ModesOfOp;
+typedef COPDOObject<0x6061, 0x00, uint8_t> CO402ModesOfOpDisp;
+typedef COPDOObject<0x607A, 0x00, int32_t> CO402TargetPos;
+typedef COPDOObject<0x6064, 0x00, int32_t> CO402ActPos;
+typedef COPDOObject<0x60FF, 0x00, int32_t> CO402TargetSpeed;
+typedef COPDOObject<0x606C, 0x00, int32_t> CO402ActSpeed;
+typedef COPDOObject<0x6077, 0x00, int16_t> CO402ActTorque;
+
+typedef COPDOMap<CO402ActPos, CO402StatusWord, CO402ModesOfOpDisp> CO402TxPDO1Map;
+typedef COPDOMap<CO402TargetPos, CO402ControlWord, CO402ModesOfOp> CO402RxPDO1Map;
+typedef COPDOMap<CO402ActSpeed, CO402ActTorque> CO402TxPDO2Map;
+typedef COPDOMap<CO402TargetSpeed> CO402RxPDO2Map;
+
 typedef enum CODriveCommStates {
 	eCO_DriveIdle,
 	eCO_DriveWaiting,
@@ -114,6 +135,17 @@ class CO402Drive {
 		CODriveCommStates InitPDOs(uint32_t);
 		
 	  NMTNodeState Update(uint32_t, COSyncState); //parameters are actTime and SyncState
+	
+	  //instead of calling Update() in the loop: run by the COMsgHandler
+	  //when due, the callback is called with the drive after each Update()
+	  void Schedule(pfunction_holder *);
+	  void Unschedule();
+	  void Wake();
+	  uint32_t GetDueInUs();
+	
+	  static void OnDueCb(void *op,void *p) {
+		  ((CO402Drive *)op)->OnDue();
+	  };
 		
 		CODriveCommStates IdentifyDrive();
 		ODEntry **GetIdentityEntries();
@@ -143,22 +175,22 @@ class CO402Drive {
 		                               (ODEntry *)&OdSwVersion, 
 		                               (ODEntry *)&OdMotor};
 
-    ODEntry08 OdModesOfOpDisp = {0x6061,0x00, &ModesOfOpDispValue, 1};
-    ODEntry08 OdModesOfOp = {0x6060,0x00,&ModesOfOpTarget,1};
+    ODEntry08 OdModesOfOpDisp = {CO402ModesOfOpDisp::Idx,CO402ModesOfOpDisp::SubIdx, &ModesOfOpDispValue, CO402ModesOfOpDisp::Len};
+    ODEntry08 OdModesOfOp = {CO402ModesOfOp::Idx,CO402ModesOfOp::SubIdx,&ModesOfOpTarget,CO402ModesOfOp::Len};
 
-    ODEntry16 OdCW = {0x6040,0x00,&CWValue,2};
-    ODEntry16 OdSW = {0x6041,0x00,&SWValue,2};
+    ODEntry16 OdCW = {CO402ControlWord::Idx,CO402ControlWord::SubIdx,&CWValue,CO402ControlWord::Len};
+    ODEntry16 OdSW = {CO402StatusWord::Idx,CO402StatusWord::SubIdx,&SWValue,CO402StatusWord::Len};
 
     ODEntry16 OdErrorWord = {0x6041,0x00,&ErrorWord,2};
 
-    ODEntry32 OdTargetPos = {0x607A,0x00,(uint32_t *)&TargetPos,4};
-    ODEntry32 OdActPos = {0x6064,0x00,(uint32_t *)&ActPos,4};
+    ODEntry32 OdTargetPos = {CO402TargetPos::Idx,CO402TargetPos::SubIdx,(uint32_t *)&TargetPos,CO402TargetPos::Len};
+    ODEntry32 OdActPos = {CO402ActPos::Idx,CO402ActPos::SubIdx,(uint32_t *)&ActPos,CO402ActPos::Len};
 
-    ODEntry32 OdTargetSpeed = {0x60FF,0x00,(uint32_t *)&TargetSpeed,4};
-    ODEntry32 OdActSpeed = {0x606C,0x00,(uint32_t *)&ActSpeed,4};
+    ODEntry32 OdTargetSpeed = {CO402TargetSpeed::Idx,CO402TargetSpeed::SubIdx,(uint32_t *)&TargetSpeed,CO402TargetSpeed::Len};
+    ODEntry32 OdActSpeed = {CO402ActSpeed::Idx,CO402ActSpeed::SubIdx,(uint32_t *)&ActSpeed,CO402ActSpeed::Len};
 
     ODEntry16 OdTargetTorque = {0x6071,0x00,(uint16_t *)&TargetTorque,2};
-    ODEntry16 OdActTorque = {0x6077,0x00,(uint16_t *)&ActTorque,2};
+    ODEntry16 OdActTorque = {CO402ActTorque::Idx,CO402ActTorque::SubIdx,(uint16_t *)&ActTorque,CO402ActTorque::Len};
 		
 		ODEntry08 OdHomingMethod = {0x6098,0x00,(uint8_t *)&DriveHomingMethod,1};
 
@@ -173,6 +205,11 @@ class CO402Drive {
 	private:
 		uint8_t nodeId;
 		COMsgHandler *MsgHandler;
+		uint8_t NodeHandle = InvalidSlot;
+	
+	  void OnDue();
+	  pfunction_holder OnUpdateCb = {NULL, NULL};
+	  uint32_t SeenSyncNr = 0;
 
 	  CODriveCommStates MovePP(bool, bool);
 	  uint8_t AccessStep = 0;
@@ -26,6 +26,8 @@
  * 2025-08-23 AW
  * 2025-09-03 AW reset the cyle if a node fails
  *               test cycle moved into a class
+ * 2026-10-16 AW node flags as 32 bit masks
+ * 2026-10-16 AW configure all nodes at the same time
  *
  *------------------------------------------------------------------------*/
 
@@ -58,16 +60,16 @@ COMsgHandler MsgHandler(R4WiFiTx, R4WiFiRx, CanBitRate::BR_250k);
 
 const uint8_t MasterNodeId = 0x7F;
 const uint8_t NumNodes = 1;
+//one bit per node in the flags below
+static_assert(NumNodes <= 32, "node flags hold 32 nodes max");
 
 uint8_t NodeUpdated = 0;
 uint8_t SteppedNode = 0;
 
-uint8_t NodeUnderConfig = NumNodes;
+uint32_t AllNodesFinished = 0;
 
-uint8_t AllNodesFinished = 0;
-
-uint8_t NodeConfigFlags = 0;
-uint8_t StepDoneFlags = 0;
+uint32_t NodeConfigFlags = 0;
+uint32_t StepDoneFlags = 0;
 
 uint8_t ConfigStep = 0;
 uint8_t CycleStep = 0;
@@ -145,7 +147,7 @@ void setup() {
   for(uint8_t iter = 0; iter < NumNodes; iter++)
   {
     Drives[iter]->init(&MsgHandler);
-    AllNodesFinished |= (0x01 << iter);
+    AllNodesFinished |= (0x01UL << iter);
 
     #ifdef UseNodeGuarding
     Drives[iter]->Node.ConfigureGuarding(GuardTime,LiveTimeFactor);
@@ -200,12 +202,9 @@ void loop()
 
           if(Drives[NodeUpdated]->isPDOsConfigured)
           {
-            NodeConfigFlags |= (0x01 << NodeUpdated);
-            Drives[NodeUpdated]->reConfigPDOs = false;
-
-            if(NodeUpdated == NodeUnderConfig)
+            if(Drives[NodeUpdated]->reConfigPDOs)
             {
-              NodeUnderConfig = NumNodes;
+              Drives[NodeUpdated]->reConfigPDOs = false;
 
               #if(DEBUG_Master & DEBUG_Master_Init)
               Serial.print("PDOs @ Node ");
@@ -213,11 +212,12 @@ void loop()
               Serial.println(" configured");
               #endif
             }
+            NodeConfigFlags |= (0x01UL << NodeUpdated);
           }
-          else if(NodeUpdated == NumNodes)
-          {          
-            //if so, there is no code under configration right now
-            NodeUnderConfig = NodeUpdated;
+          else
+          {
+            //all nodes are configured at the same time - the SDO requests
+            //are interleaved by the COMsgHandler
             Drives[NodeUpdated]->reConfigPDOs = true;
           }
         }
@@ -243,7 +243,7 @@ void loop()
         if(Drives[NodeUpdated]->autoEnable == false)
         {
           Drives[NodeUpdated]->autoEnable = true;
-          NodeConfigFlags |= (0x01 << NodeUpdated);
+          NodeConfigFlags |= (0x01UL << NodeUpdated);
 
           #if(DEBUG_Master & DEBUG_Master_Init)
           Serial.print("Main: Node ");
@@ -261,7 +261,7 @@ void loop()
       case 2:
         if (DriveNodeStates[NodeUpdated] == eNMTStateOperational)
         {
-          NodeConfigFlags |= (0x01 << NodeUpdated);
+          NodeConfigFlags |= (0x01UL << NodeUpdated);
         }
         if(NodeConfigFlags == AllNodesFinished)
         {
@@ -322,7 +322,7 @@ void loop()
         case 1:
           if(Cycle[SteppedNode]->FirstMove(Drives[SteppedNode]))
           {
-            StepDoneFlags |= (0x01 << SteppedNode);
+            StepDoneFlags |= (0x01UL << SteppedNode);
 
             Serial.print("Main: node ");
             Serial.print(SteppedNode);
@@ -345,7 +345,7 @@ void loop()
           break;
         case 2:
           if(Cycle[SteppedNode]->DoCycle(Drives[SteppedNode], targetStep) == targetStep)
-            StepDoneFlags |= (0x01 << SteppedNode);
+            StepDoneFlags |= (0x01UL << SteppedNode);
 
           if(StepDoneFlags == AllNodesFinished)
           {
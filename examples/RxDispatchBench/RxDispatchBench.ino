@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * RxDispatchBench
+ *
+ * floods the Rx buffer of the COMsgHandler with TPDO frames of 4 nodes
+ * the way the CAN interrupt would and measures how many frames a single
+ * call of MsgHandler.Update() dispatches for different frame budgets.
+ * No CAN transceiver is needed - the bus is never opened.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <COMsgHandler.h>
+
+//---- local definitions -----------------------------------------------
+
+const uint8_t NumNodes = 4;
+const uint16_t NumRounds = 1000;
+const uint8_t Budgets[] = {1, 4, DefaultRxFrameBudget};
+
+COMsgHandler MsgHandler(R4WiFiTx, R4WiFiRx, CanBitRate::BR_250k);
+
+uint32_t FramesReceived = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//the PDO callback of all nodes - only counts
+void OnPDOCb(void *op, void *p)
+{
+  FramesReceived++;
+}
+
+//inject a TPDO1 frame of the given node just as the CAN interrupt would do
+void InjectFrame(uint8_t NodeId)
+{
+  can_callback_args_t args;
+
+  args.event = CAN_EVENT_RX_COMPLETE;
+  args.frame.id = eCANTPDO1 + NodeId;
+  args.frame.type = CAN_FRAME_TYPE_DATA;
+  args.frame.data_length_code = 8;
+  memset(args.frame.data, NodeId, 8);
+
+  COMsgHandler::OnMsgRxCb(&MsgHandler, &args);
+}
+
+void RunBench(uint8_t budget)
+{
+  uint32_t updates = 0;
+  uint32_t dispatched = 0;
+  uint32_t maxLeft = 0;
+  uint32_t usedTime = 0;
+
+  MsgHandler.SetRxFrameBudget(budget);
+
+  for(uint16_t round = 0; round < NumRounds; round++)
+  {
+    //a burst as seen after a SYNC: 2 TPDOs of each node
+    for(uint8_t iter = 0; iter < (2 * NumNodes); iter++)
+      InjectFrame((iter % NumNodes) + 1);
+
+    //a single loop() worth of dispatching
+    uint32_t before = FramesReceived;
+    uint32_t stime = micros();
+    uint8_t left = MsgHandler.Update(millis());
+    usedTime += micros() - stime;
+
+    updates++;
+    dispatched += FramesReceived - before;
+    if(left > maxLeft)
+      maxLeft = left;
+
+    //empty the buffer before the next burst
+    while(MsgHandler.Update(millis()) > 0)
+      ;
+  }
+
+  Serial.print("budget ");
+  Serial.print(budget);
+  Serial.print(": frames/Update ");
+  Serial.print((float)dispatched / updates);
+  Serial.print(", max left behind ");
+  Serial.print(maxLeft);
+  Serial.print(", us/frame ");
+  Serial.println((float)usedTime / dispatched);
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  uint32_t stime = millis();
+  pfunction_holder Cb;
+
+  Serial.begin(115200);
+  while (!Serial && ((millis() - stime) < 5000)) {};
+
+  Serial.println();
+  Serial.println("> Rx dispatch benchmark");
+
+  Cb.callback = (pfunction_pointer_t)OnPDOCb;
+  Cb.op = NULL;
+
+  for(uint8_t iter = 1; iter <= NumNodes; iter++)
+  {
+    uint8_t NodeHandle = MsgHandler.RegisterNode(iter);
+    MsgHandler.Register_OnRxPDOCb(NodeHandle, &Cb);
+  }
+
+  for(uint8_t iter = 0; iter < sizeof(Budgets); iter++)
+    RunBench(Budgets[iter]);
+
+  CORxStats Stats;
+  MsgHandler.GetRxStats(&Stats);
+
+  Serial.print("sizeof(COMsgHandler) ");
+  Serial.print(sizeof(COMsgHandler));
+  Serial.print(" for ");
+  Serial.print(MsgHandler_MaxNodes);
+  Serial.print(" nodes, per node ");
+  Serial.println(COMsgHandlerBytesPerNode);
+
+  Serial.print("received ");
+  Serial.print(Stats.NumRxMessages);
+  Serial.print(", dropped ");
+  Serial.print(Stats.NumDroppedMessages);
+  Serial.print(", high water mark ");
+  Serial.println(Stats.HighWaterMark);
+}
+
+void loop()
+{
+  delay(1000);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_HOST_ARDUINO_H
+#define CO_HOST_ARDUINO_H
+
+/*--------------------------------------------------------------------
+ * Arduino.h of the host build
+ * the small part of the Arduino API used by the library and the
+ * example sketches: Serial, millis()/micros()/delay(), interrupt
+ * locks and pin stubs.
+ *
+ * The time is either the wall clock or a simulated clock which only
+ * advances by delay() or COHostAdvance() - see COHostClock.
+ * Everything runs in a single thread, the "interrupts" of the
+ * virtual CAN bus are called from delay()/COHostAdvance(), so the
+ * interrupt locks are empty.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW COHostProbeTicks
+ *
+ *-------------------------------------------------------------------*/
+
+#if !defined(CO_HOST_BUILD)
+#error "the host shim needs CO_HOST_BUILD to be defined"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+#define HEX 16
+#define DEC 10
+#define BIN 2
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+//--- time ---
+
+typedef enum COHostClock {
+	eHostWallClock,     //millis()/micros() follow the time of the host
+	eHostSimClock       //time advances by delay()/COHostAdvance() only
+} COHostClock;
+
+void COHostSetClock(COHostClock);
+COHostClock COHostGetClock();
+uint64_t COHostMicros64();
+//the ns of the wall clock for the latency probes (COProbe.h)
+uint32_t COHostProbeTicks();
+//advance the simulated time and run the virtual CAN bus up to it
+void COHostAdvance(uint32_t us);
+
+inline uint32_t micros() { return (uint32_t)COHostMicros64(); }
+inline uint32_t millis() { return (uint32_t)(COHostMicros64() / 1000); }
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+//--- interrupts - all in one thread ---
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline uint32_t __get_PRIMASK() { return 0; }
+inline void __set_PRIMASK(uint32_t) {}
+inline void __disable_irq() {}
+
+//--- pins - no hardware ---
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return LOW; }
+inline int analogRead(int) { return 0; }
+inline void analogWrite(int, int) {}
+
+//--- Serial writing to stdout ---
+
+class HostSerial {
+	public:
+	  void begin(unsigned long) {}
+	  void end() {}
+	  operator bool() { return true; }
+	  int available() { return 0; }
+	  int read() { return -1; }
+	  void flush() { fflush(stdout); }
+
+	  size_t write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+	  size_t write(const uint8_t *buf, size_t len) { return fwrite(buf, 1, len, stdout); }
+
+	  size_t print(const char *s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+	  size_t print(char c) { return write((uint8_t)c); }
+	  size_t print(double d, int digits = 2) { return printf("%.*f", digits, d); }
+
+	  template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+	  size_t print(T n, int base = DEC)
+	  {
+		  if(base == DEC)
+		  {
+			  if(std::is_signed<T>::value)
+				  return printf("%lld", (long long)n);
+			  return printf("%llu", (unsigned long long)n);
+		  }
+		  //negative numbers are printed as their two's complement of the type's size
+		  unsigned long long mask = (sizeof(T) >= sizeof(unsigned long long)) ? ~0ULL : ((1ULL << (8 * sizeof(T))) - 1);
+		  return printUnsigned((unsigned long long)n & mask, base);
+	  }
+
+	  template<typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+	  size_t print(T n, int base = DEC) { return print((long long)n, base); }
+
+	  size_t println() { return print("\n"); }
+	  template<typename T>
+	  size_t println(T v) { size_t n = print(v); return n + println(); }
+	  template<typename T>
+	  size_t println(T v, int base) { size_t n = print(v, base); return n + println(); }
+
+	private:
+	  size_t printUnsigned(unsigned long long n, int base)
+	  {
+		  char buf[65];
+		  char *p = &buf[64];
+		  *p = 0;
+		  do {
+			  uint8_t digit = n % base;
+			  *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+			  n /= base;
+		  } while(n);
+		  return print(p);
+	  }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+ 
+/*-------------------------------------------------------------------
+ * COHostMain.cpp
+ * main() to run an Arduino sketch in the host build
+ *
+ *   --sim        use the simulated clock instead of the wall clock
+ *   --loops n    stop after n calls of loop(), default: run forever
+ *   --loop-us u  time passing per loop() on top of the sketch's delays
+ *                default 100us
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+ 
+//--- includes ---
+ 
+#include <Arduino.h>
+#include <stdlib.h>
+
+void setup();
+void loop();
+
+int main(int argc, char **argv)
+{
+	uint32_t numLoops = 0;
+	uint32_t loopUs = 100;
+
+	for(int iter = 1; iter < argc; iter++)
+	{
+		if(strcmp(argv[iter], "--sim") == 0)
+			COHostSetClock(eHostSimClock);
+		else if((strcmp(argv[iter], "--loops") == 0) && (iter + 1 < argc))
+			numLoops = strtoul(argv[++iter], NULL, 0);
+		else if((strcmp(argv[iter], "--loop-us") == 0) && (iter + 1 < argc))
+			loopUs = strtoul(argv[++iter], NULL, 0);
+		else
+		{
+			fprintf(stderr, "usage: %s [--sim] [--loops n] [--loop-us u]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	setup();
+
+	for(uint32_t iter = 0; (numLoops == 0) || (iter < numLoops); iter++)
+	{
+		loop();
+		COHostAdvance(loopUs);
+	}
+
+	fflush(stdout);
+	return 0;
+}
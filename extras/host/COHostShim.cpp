@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+ 
+/*-------------------------------------------------------------------
+ * COHostShim.cpp
+ * Serial, time and the default CAN transport of the host build
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW FspTimer
+ * 2026-10-16 AW COHostProbeTicks
+ *
+ *-------------------------------------------------------------------*/
+ 
+//--- includes ---
+ 
+#include <Arduino.h>
+#include <COVirtualBus.h>
+#include <FspTimer.h>
+
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+
+static COHostClock HostClock = eHostWallClock;
+static uint64_t SimMicros = 0;
+static std::chrono::steady_clock::time_point WallStart = std::chrono::steady_clock::now();
+
+//--- implementation ---
+
+void COHostSetClock(COHostClock clock)
+{
+	HostClock = clock;
+}
+
+COHostClock COHostGetClock()
+{
+	return HostClock;
+}
+
+uint64_t COHostMicros64()
+{
+	if(HostClock == eHostSimClock)
+		return SimMicros;
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - WallStart).count();
+}
+
+//the ticks of the latency probes, always the wall clock in ns
+uint32_t COHostProbeTicks()
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - WallStart).count();
+}
+
+/*------------------------------------------------------
+ * void COHostAdvance(uint32_t us)
+ * let the time pass and run the timers and the virtual CAN buses.
+ * In simulated time the clock steps frame by frame, so
+ * the events are called with the time of the frame end.
+ * A timer due in between is called at exactly it's time.
+ * With the wall clock it's a sleep.
+ * 
+ * 2026-10-16 AW
+ * 2026-10-16 AW FspTimer
+ * ----------------------------------------------------*/
+
+void COHostAdvance(uint32_t us)
+{
+	if(HostClock == eHostSimClock)
+	{
+		uint64_t endAt = SimMicros + us;
+
+		//step in units of 10us so frame events see a close enough time
+		while(SimMicros < endAt)
+		{
+			uint64_t step = endAt - SimMicros;
+			if(step > 10)
+				step = 10;
+			uint64_t timerAt = FspTimer::NextDueAt();
+			if((timerAt > SimMicros) && (timerAt - SimMicros < step))
+				step = timerAt - SimMicros;
+			SimMicros += step;
+			FspTimer::RunAllUntil(SimMicros);
+			COVirtualBus::RunAllUntil(SimMicros * 1000);
+		}
+	}
+	else
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(us));
+		FspTimer::RunAllUntil(COHostMicros64());
+		COVirtualBus::RunAllUntil(COHostMicros64() * 1000);
+	}
+}
+
+void delay(uint32_t ms)
+{
+	COHostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+	COHostAdvance(us);
+}
+
+/*------------------------------------------------------
+ * default transport
+ * a COMsgHandler created by the pin constructor - as all
+ * the sketches do - is attached to the default bus
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+COVirtualBus *COHostDefaultBus()
+{
+	static COVirtualBus DefaultBus(CanBitRate::BR_250k);
+	return &DefaultBus;
+}
+
+COTransport *COHostDefaultTransport()
+{
+	static COVirtualCAN DefaultController(COHostDefaultBus());
+	return &DefaultController;
+}
+
+/*------------------------------------------------------
+ * FspTimer
+ * periodic timers only, the channel is an index into
+ * the timers of the host
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+static FspTimer *HostTimers[MaxHostTimers];
+static uint8_t NumHostTimers = 0;
+
+int8_t FspTimer::get_available_timer(uint8_t &type, bool force)
+{
+	type = GPT_TIMER;
+	if(NumHostTimers >= MaxHostTimers)
+		return -1;
+	return (int8_t)NumHostTimers;
+}
+
+bool FspTimer::begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc, GPTimerCbk_f cbk, void *ctx)
+{
+	if((mode != TIMER_MODE_PERIODIC) || (freq_hz <= 0) || (channel >= MaxHostTimers))
+		return false;
+
+	PeriodUs = (uint32_t)(1000000.0 / freq_hz + 0.5);
+	if(PeriodUs == 0)
+		PeriodUs = 1;
+	Channel = (int8_t)channel;
+	Callback = cbk;
+	Args.p_context = ctx;
+	return true;
+}
+
+bool FspTimer::open()
+{
+	if((Channel < 0) || ((HostTimers[Channel] != NULL) && (HostTimers[Channel] != this)))
+		return false;
+
+	HostTimers[Channel] = this;
+	if(Channel >= NumHostTimers)
+		NumHostTimers = Channel + 1;
+	return true;
+}
+
+bool FspTimer::start()
+{
+	if((Channel < 0) || (HostTimers[Channel] != this))
+		return false;
+
+	DueAt = COHostMicros64() + PeriodUs;
+	isRunning = true;
+	return true;
+}
+
+bool FspTimer::stop()
+{
+	isRunning = false;
+	return true;
+}
+
+void FspTimer::end()
+{
+	isRunning = false;
+	if((Channel >= 0) && (HostTimers[Channel] == this))
+		HostTimers[Channel] = NULL;
+}
+
+void FspTimer::RunAllUntil(uint64_t nowUs)
+{
+	for(uint8_t iter = 0; iter < NumHostTimers; iter++)
+	{
+		FspTimer *Timer = HostTimers[iter];
+
+		while((Timer != NULL) && Timer->isRunning && (Timer->DueAt <= nowUs))
+		{
+			Timer->DueAt += Timer->PeriodUs;
+			if(Timer->Callback != nullptr)
+				Timer->Callback(&Timer->Args);
+		}
+	}
+}
+
+uint64_t FspTimer::NextDueAt()
+{
+	uint64_t nextAt = ~0ULL;
+
+	for(uint8_t iter = 0; iter < NumHostTimers; iter++)
+	{
+		FspTimer *Timer = HostTimers[iter];
+
+		if((Timer != NULL) && Timer->isRunning && (Timer->DueAt < nextAt))
+			nextAt = Timer->DueAt;
+	}
+	return nextAt;
+}
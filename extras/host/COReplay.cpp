@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COReplay.cpp
+ * Implementation of the COReplay Class of the host build
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COReplay.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//--- local definitions ---
+
+const uint16_t ReplayMaxLineLen = 256;
+
+static const char *SkipSpaces(const char *Pos)
+{
+	while((*Pos == ' ') || (*Pos == '\t'))
+		Pos++;
+	return Pos;
+}
+
+static uint8_t HexValue(char c)
+{
+	return isdigit((unsigned char)c) ? c - '0' : toupper((unsigned char)c) - 'A' + 10;
+}
+
+/*-------------------------------------------------------------------
+ * const char *ParseTime(const char *Pos, uint64_t *AtUs)
+ * seconds with up to 6 decimals (more are cut), NULL if there is
+ * no time.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+static const char *ParseTime(const char *Pos, uint64_t *AtUs)
+{
+	char *End;
+	uint64_t sec = strtoull(Pos, &End, 10);
+	uint32_t usec = 0;
+	uint32_t scale = 100000;
+
+	if(End == Pos)
+		return NULL;
+	Pos = End;
+
+	if(*Pos == '.')
+	{
+		Pos++;
+		while(isdigit((unsigned char)*Pos))
+		{
+			usec += (*Pos - '0') * scale;
+			scale /= 10;
+			Pos++;
+		}
+	}
+	*AtUs = sec * 1000000 + usec;
+	return Pos;
+}
+
+//--- public functions ---
+
+/*-------------------------------------------------------------------
+ * COReplay(COVirtualBus *Bus)
+ * attach the player to the bus, it's task sends the frames
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+COReplay::COReplay(COVirtualBus *Bus):
+	CAN(Bus)
+{
+	pfunction_holder Cb;
+
+	CAN.begin();
+
+	Cb.callback = (pfunction_pointer_t)OnTaskCb;
+	Cb.op = (void *)this;
+	Bus->AttachTask(&Cb);
+}
+
+/*-------------------------------------------------------------------
+ * bool Load(const char *FileName)
+ * read a capture, lines which are no frame (headers, comments,
+ * events, CAN FD and extended frames) are skipped.
+ * The time of the frames starts with the first one.
+ * false if the file can't be read or has no frames.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COReplay::Load(const char *FileName)
+{
+	FILE *File = fopen(FileName, "r");
+	char Line[ReplayMaxLineLen];
+	COReplayFrame Frame;
+
+	if(File == NULL)
+		return false;
+
+	Frames.clear();
+	NumTxFrames = 0;
+	while(fgets(Line, sizeof(Line), File) != NULL)
+	{
+		if(ParseLine(Line, &Frame))
+		{
+			if(!Frames.empty())
+				Frame.AtUs = (Frame.AtUs > Frames[0].AtUs) ? Frame.AtUs - Frames[0].AtUs : 0;
+			Frames.push_back(Frame);
+			if(Frame.isTx)
+				NumTxFrames++;
+		}
+	}
+	fclose(File);
+
+	if(!Frames.empty())
+		Frames[0].AtUs = 0;
+	Rewind();
+
+	return !Frames.empty();
+}
+
+/*-------------------------------------------------------------------
+ * static bool ParseLine(const char *Line, COReplayFrame *Frame)
+ * a frame of a line of a capture, the time as written:
+ *   candump -L: (12.345678) can0 181#0102030405060708
+ *               (12.345678) can0 701#R
+ *   ASC:        12.345678 1  181             Rx   d 8 01 02 03 04 05 06 07 08
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COReplay::ParseLine(const char *Line, COReplayFrame *Frame)
+{
+	const char *Pos = SkipSpaces(Line);
+	char *End;
+	uint32_t Id;
+
+	memset(Frame, 0, sizeof(COReplayFrame));
+	Frame->frame.id_mode = CAN_ID_MODE_STANDARD;
+	Frame->frame.type = CAN_FRAME_TYPE_DATA;
+
+	if(*Pos == '(')
+	{
+		char Interface[16];
+		int len;
+
+		if(((Pos = ParseTime(Pos + 1, &Frame->AtUs)) == NULL) || (*Pos != ')'))
+			return false;
+		if(sscanf(Pos + 1, " %15s %n", Interface, &len) != 1)
+			return false;
+		Frame->isTx = (strcmp(Interface, "tx") == 0);
+		Pos = Pos + 1 + len;
+
+		Id = strtoul(Pos, &End, 16);
+		if((End == Pos) || (*End != '#') || (End - Pos > 3) || (End[1] == '#'))
+			return false;
+		Pos = End + 1;
+
+		if(*Pos == 'R')
+		{
+			Frame->frame.type = CAN_FRAME_TYPE_REMOTE;
+			if(isxdigit((unsigned char)Pos[1]))
+				Frame->frame.data_length_code = HexValue(Pos[1]);
+		}
+		else
+		{
+			while(isxdigit((unsigned char)Pos[0]) && isxdigit((unsigned char)Pos[1]) && (Frame->frame.data_length_code < 8))
+			{
+				Frame->frame.data[Frame->frame.data_length_code++] = (HexValue(Pos[0]) << 4) | HexValue(Pos[1]);
+				Pos += 2;
+			}
+		}
+	}
+	else
+	{
+		char Direction[4];
+		char Type;
+		int len;
+
+		if((Pos = ParseTime(Pos, &Frame->AtUs)) == NULL)
+			return false;
+		//the channel
+		strtoul(Pos, &End, 10);
+		if(End == Pos)
+			return false;
+		Pos = SkipSpaces(End);
+
+		Id = strtoul(Pos, &End, 16);
+		if((End == Pos) || ((*End != ' ') && (*End != '\t')))
+			return false;
+		if(sscanf(End, " %3s %c%n", Direction, &Type, &len) != 2)
+			return false;
+		if((strcmp(Direction, "Rx") != 0) && (strcmp(Direction, "Tx") != 0))
+			return false;
+		Frame->isTx = (Direction[0] == 'T');
+		Pos = End + len;
+
+		if(Type == 'r')
+			Frame->frame.type = CAN_FRAME_TYPE_REMOTE;
+		else if(Type == 'd')
+		{
+			unsigned long dlc = strtoul(Pos, &End, 16);
+
+			if((End == Pos) || (dlc > 8))
+				return false;
+			Pos = End;
+			for(uint8_t iter = 0; iter < dlc; iter++)
+			{
+				unsigned long value = strtoul(Pos, &End, 16);
+
+				if(End == Pos)
+					return false;
+				Frame->frame.data[iter] = (uint8_t)value;
+				Pos = End;
+			}
+			Frame->frame.data_length_code = (uint8_t)dlc;
+		}
+		else
+			return false;
+	}
+
+	if(Id > 0x7FF)
+		return false;
+	Frame->frame.id = Id;
+
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void Start()
+ * replay from the first frame with the original timing, the first
+ * one is sent right now
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COReplay::Start()
+{
+	Rewind();
+	StartNs = COHostMicros64() * 1000;
+	isRunning = true;
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t Pump(COMsgHandler *Handler, uint32_t maxFrames)
+ * hand up to maxFrames of the following frames to the Rx handler of
+ * the COMsgHandler, just as it's Rx interrupt does, and return their
+ * number. The Update() of the COMsgHandler has to dispatch them
+ * before the next call - the Rx buffer takes NumRxBuffers frames.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint32_t COReplay::Pump(COMsgHandler *Handler, uint32_t maxFrames)
+{
+	can_callback_args_t args;
+	uint32_t numPumped = 0;
+
+	memset(&args, 0, sizeof(args));
+	args.event = CAN_EVENT_RX_COMPLETE;
+
+	while((numPumped < maxFrames) && SkipTx())
+	{
+		args.frame = Frames[NextFrame].frame;
+		COMsgHandler::OnMsgRxCb((void *)Handler, (void *)&args);
+		NextFrame++;
+		NumReplayed++;
+		numPumped++;
+	}
+	return numPumped;
+}
+
+/*-------------------------------------------------------------------
+ * void Rewind()
+ * stop and start over with the first frame
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COReplay::Rewind()
+{
+	isRunning = false;
+	NextFrame = 0;
+	NumReplayed = 0;
+}
+
+//--- private functions ---
+
+/*-------------------------------------------------------------------
+ * bool SkipTx()
+ * move on to the next frame to be replayed, false if there is none
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COReplay::SkipTx()
+{
+	while((NextFrame < Frames.size()) && Frames[NextFrame].isTx && !isReplayTx)
+		NextFrame++;
+
+	return NextFrame < Frames.size();
+}
+
+/*-------------------------------------------------------------------
+ * void OnTask(uint64_t nowNs)
+ * the task on the bus: send the frames which are due. A frame
+ * waiting for the bus keeps the following ones waiting.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COReplay::OnTask(uint64_t nowNs)
+{
+	if(!isRunning)
+		return;
+
+	while(SkipTx() && ((StartNs + Frames[NextFrame].AtUs * 1000) <= nowNs))
+	{
+		if(CAN.send(&Frames[NextFrame].frame, NextMailbox) <= 0)
+			break;
+
+		NextMailbox = (NextMailbox + 1) % NumVirtualMailboxes;
+		NextFrame++;
+		NumReplayed++;
+	}
+
+	if(IsDone())
+		isRunning = false;
+}
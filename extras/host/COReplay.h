@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_REPLAY_H
+#define CO_REPLAY_H
+
+/*--------------------------------------------------------------------
+ * class COReplay of the host build
+ * plays a capture back to a central device: a candump -L log or a
+ * Vector ASC file, as written by the COCapture or any other tool.
+ *
+ * - Start() replays with the original timing: the player is a
+ *   controller on a COVirtualBus and sends each frame at it's time
+ *   relative to the start, the central device receives them by it's
+ *   Rx interrupt as any other frame. The player acknowledges the
+ *   frames of the central device.
+ * - Pump() replays as fast as possible: the frames are handed right
+ *   to the Rx handler of a COMsgHandler, without the bus.
+ *
+ * Only the received frames of a capture are replayed by default - the
+ * ones sent by the central device are sent by the device under test.
+ * Frames of a candump log on the interface "tx" and those of an ASC
+ * file marked Tx are taken as sent by the central device.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COVirtualBus.h>
+#include <COMsgHandler.h>
+#include <stdint.h>
+#include <vector>
+
+typedef struct COReplayFrame {
+	uint64_t AtUs;          //since the first frame of the capture
+	bool isTx;
+	can_frame_t frame;
+} COReplayFrame;
+
+class COReplay {
+	public:
+	  COReplay(COVirtualBus *);
+
+	  bool Load(const char *FileName);
+	  static bool ParseLine(const char *Line, COReplayFrame *);
+	  void SetReplayTx(bool isEnabled) { isReplayTx = isEnabled; };
+
+	  void Start();
+	  uint32_t Pump(COMsgHandler *, uint32_t maxFrames);
+	  void Rewind();
+	  bool IsDone() { return NextFrame >= Frames.size(); };
+
+	  uint32_t GetNumFrames() { return Frames.size(); };
+	  uint32_t GetNumTxFrames() { return NumTxFrames; };
+	  uint32_t GetNumReplayed() { return NumReplayed; };
+	  uint64_t GetDurationUs() { return Frames.empty() ? 0 : Frames.back().AtUs; };
+
+	  static void OnTaskCb(void *op, void *p) {
+		  ((COReplay *)op)->OnTask(*(uint64_t *)p);
+	  };
+
+	private:
+	  void OnTask(uint64_t nowNs);
+	  bool SkipTx();
+
+	  COVirtualCAN CAN;
+	  std::vector<COReplayFrame> Frames;
+	  size_t NextFrame = 0;
+	  uint32_t NumReplayed = 0;
+	  uint32_t NumTxFrames = 0;
+	  uint8_t NextMailbox = 0;
+	  bool isReplayTx = false;
+
+	  bool isRunning = false;
+	  uint64_t StartNs = 0;
+};
+
+#endif
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COSim402Drive.cpp
+ * Implementation of the simulated CiA 402 drive of the host build
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COSim402Drive.h>
+
+//--- local definitions ---
+
+const uint32_t Sim402DeviceType = 0x00020192;   //CiA 402, servo drive
+
+const int8_t SimOpModePP = 1;
+const int8_t SimOpModePV = 3;
+const int8_t SimOpModeHoming = 6;
+
+const uint16_t SimCWStartBit = 0x0010;
+const uint16_t SimCWRelativeBit = 0x0040;
+const uint16_t SimCWFaultReset = 0x0080;
+
+const uint16_t SimSWRemote = 0x0200;
+const uint16_t SimSWTargetReached = 0x0400;
+const uint16_t SimSWBit12 = 0x1000;   //set-point ack / speed 0 / homing attained
+
+//the default mapping: CW / SW and the mode
+static const uint32_t SimDefaultRxPDO1[] = {0x60400010};
+static const uint32_t SimDefaultRxPDO2[] = {0x60400010, 0x60600008};
+static const uint32_t SimDefaultTxPDO1[] = {0x60410010};
+static const uint32_t SimDefaultTxPDO2[] = {0x60410010, 0x60610008};
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * COSim402Drive::COSim402Drive(COVirtualBus *Bus, uint8_t thisId)
+ * create the objects and attach the cycle to the bus
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+COSim402Drive::COSim402Drive(COVirtualBus *Bus, uint8_t thisId):
+	Node(Bus, thisId, Sim402DeviceType)
+{
+	pfunction_holder Cb;
+
+	Node.AddObject(0x1008, 0x00, SimMaxStringLen, eSimString, DeviceName);
+	Node.AddObject(0x1009, 0x00, SimMaxStringLen, eSimString, HwVersion);
+	Node.AddObject(0x100A, 0x00, SimMaxStringLen, eSimString, SwVersion);
+
+	Node.AddObject(0x2311, 0x01, 1, eSimRO, &DigInStatus);
+	Node.AddObject(0x2320, 0x00, 2, eSimRO, &ErrorWord);
+
+	Node.AddObject(0x603F, 0x00, 2, eSimRO, &ErrorCode);
+	Node.AddObject(0x6040, 0x00, 2, eSimRW, &CW);
+	Node.AddObject(0x6041, 0x00, 2, eSimRO, &SW);
+	Node.AddObject(0x6060, 0x00, 1, eSimRW, &ModesOfOp);
+	Node.AddObject(0x6061, 0x00, 1, eSimRO, &ModesOfOpDisp);
+	Node.AddObject(0x6064, 0x00, 4, eSimRO, &ActPos);
+	Node.AddObject(0x606C, 0x00, 4, eSimRO, &ActSpeed);
+	Node.AddObject(0x6071, 0x00, 2, eSimRW, &TargetTorque);
+	Node.AddObject(0x6077, 0x00, 2, eSimRO, &ActTorque);
+	Node.AddObject(0x607A, 0x00, 4, eSimRW, &TargetPos);
+	Node.AddObject(0x6081, 0x00, 4, eSimRW, &ProfileSpeed);
+	Node.AddObject(0x6083, 0x00, 4, eSimRW, &ProfileAcc);
+	Node.AddObject(0x6084, 0x00, 4, eSimRW, &ProfileDec);
+	Node.AddObject(0x6098, 0x00, 1, eSimRW, &HomingMethod);
+	Node.AddObject(0x60FF, 0x00, 4, eSimRW, &TargetSpeed);
+	Node.AddObject(0x6403, 0x00, SimMaxStringLen, eSimString, MotorName);
+
+	Node.PresetRxPDOMapping(0, 1, SimDefaultRxPDO1);
+	Node.PresetRxPDOMapping(1, 2, SimDefaultRxPDO2);
+	Node.PresetTxPDOMapping(0, 1, SimDefaultTxPDO1);
+	Node.PresetTxPDOMapping(1, 2, SimDefaultTxPDO2);
+
+	Cb.callback = (pfunction_pointer_t)OnResetAppCb;
+	Cb.op = (void *)this;
+	Node.Register_OnResetAppCb(&Cb);
+
+	Cb.callback = (pfunction_pointer_t)OnTaskCb;
+	Bus->AttachTask(&Cb);
+}
+
+/*---------------------------------------------------------------------
+ * void COSim402Drive::PowerOn()
+ * boot the node - the drive starts in not ready to switch on
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSim402Drive::PowerOn()
+{
+	ResetApp();
+	lastCycleUs = COHostMicros64();
+	isPoweredOn = true;
+	Node.PowerOn();
+}
+
+/*---------------------------------------------------------------------
+ * void COSim402Drive::InjectFault(uint16_t Code)
+ * a drive error: EMCY and fault state, the drive stops
+ * a fault reset in the CW is required to leave it
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSim402Drive::InjectFault(uint16_t Code)
+{
+	ErrorCode = Code;
+	ErrorWord = 0x0001;
+
+	if(State == eSim402OperationEnabled)
+		State = eSim402FaultReactionActive;
+	else
+		State = eSim402Fault;
+
+	SW = ComposeSW();
+	Node.SendEmcy(Code, 0x01);
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * void COSim402Drive::Update(uint64_t nowUs)
+ * called by the bus after each run - does the cycle of the drive
+ * each CycleTimeUs
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSim402Drive::Update(uint64_t nowUs)
+{
+	if(!isPoweredOn || ((nowUs - lastCycleUs) < CycleTimeUs))
+		return;
+
+	double dt = (nowUs - lastCycleUs) / 1e6;
+	lastCycleUs = nowUs;
+
+	UpdateStateMachine();
+	UpdateMotion(dt);
+
+	ActPos = (int32_t)lround(Pos);
+	ActSpeed = (int32_t)lround(Speed);
+	SW = ComposeSW();
+
+	Node.Update(nowUs);
+}
+
+void COSim402Drive::ResetApp()
+{
+	State = eSim402NotReadyToSwitchOn;
+	CW = 0;
+	lastCW = 0;
+	ModesOfOp = 0;
+	ModesOfOpDisp = 0;
+	TargetPos = 0;
+	TargetSpeed = 0;
+	TargetTorque = 0;
+	ErrorCode = 0;
+	ErrorWord = 0;
+
+	Speed = 0;
+	PPTarget = Pos;
+	isPPActive = false;
+	isSetPointAck = false;
+	isHomingActive = false;
+	isHomed = false;
+
+	ActPos = (int32_t)lround(Pos);
+	ActSpeed = 0;
+	ActTorque = 0;
+	SW = ComposeSW();
+}
+
+/*---------------------------------------------------------------------
+ * void COSim402Drive::UpdateStateMachine()
+ * the CiA 402 state machine driven by the CW
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSim402Drive::UpdateStateMachine()
+{
+	bool isDisableVoltage = ((CW & 0x0082) == 0x0000);
+	bool isQuickStop = ((CW & 0x0086) == 0x0002);
+	bool isShutdown = ((CW & 0x0087) == 0x0006);
+	bool isSwitchOn = ((CW & 0x008F) == 0x0007);
+	bool isEnableOp = ((CW & 0x008F) == 0x000F);
+	bool isFaultReset = (CW & SimCWFaultReset) && !(lastCW & SimCWFaultReset);
+
+	switch(State)
+	{
+		case eSim402NotReadyToSwitchOn:
+			State = eSim402SwitchOnDisabled;
+			break;
+		case eSim402SwitchOnDisabled:
+			if(isShutdown)
+				State = eSim402ReadyToSwitchOn;
+			break;
+		case eSim402ReadyToSwitchOn:
+			if(isDisableVoltage || isQuickStop)
+				State = eSim402SwitchOnDisabled;
+			else if(isSwitchOn)
+				State = eSim402SwitchedOn;
+			else if(isEnableOp)
+				State = eSim402OperationEnabled;
+			break;
+		case eSim402SwitchedOn:
+			if(isDisableVoltage || isQuickStop)
+				State = eSim402SwitchOnDisabled;
+			else if(isShutdown)
+				State = eSim402ReadyToSwitchOn;
+			else if(isEnableOp)
+				State = eSim402OperationEnabled;
+			break;
+		case eSim402OperationEnabled:
+			if(isDisableVoltage)
+				State = eSim402SwitchOnDisabled;
+			else if(isQuickStop)
+				State = eSim402QuickStopActive;
+			else if(isShutdown)
+				State = eSim402ReadyToSwitchOn;
+			else if(isSwitchOn)
+				State = eSim402SwitchedOn;
+			break;
+		case eSim402QuickStopActive:
+			if(isDisableVoltage)
+				State = eSim402SwitchOnDisabled;
+			else if(isEnableOp)
+				State = eSim402OperationEnabled;
+			break;
+		case eSim402FaultReactionActive:
+			if(Speed == 0)
+				State = eSim402Fault;
+			break;
+		case eSim402Fault:
+			if(isFaultReset)
+			{
+				State = eSim402SwitchOnDisabled;
+				ErrorCode = 0;
+				ErrorWord = 0;
+			}
+			break;
+		default:
+			break;
+	}
+
+	//the set-point handshake and homing start with the rising edge of bit 4
+	if(State == eSim402OperationEnabled)
+	{
+		bool isStart = (CW & SimCWStartBit) && !(lastCW & SimCWStartBit);
+
+		if((ModesOfOp == SimOpModePP) && isStart)
+		{
+			if(CW & SimCWRelativeBit)
+				PPTarget += TargetPos;
+			else
+				PPTarget = TargetPos;
+			isPPActive = true;
+			isSetPointAck = true;
+		}
+		else if((ModesOfOp == SimOpModeHoming) && isStart)
+		{
+			isHomingActive = true;
+			isHomed = false;
+			HomingStartUs = lastCycleUs;
+		}
+	}
+	if(!(CW & SimCWStartBit))
+		isSetPointAck = false;
+
+	lastCW = CW;
+}
+
+/*---------------------------------------------------------------------
+ * void COSim402Drive::UpdateMotion(double dt)
+ * the trapezoidal profiles of PP and PV, homing
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSim402Drive::UpdateMotion(double dt)
+{
+	double lastSpeed = Speed;
+
+	if(State == eSim402OperationEnabled)
+	{
+		ModesOfOpDisp = ModesOfOp;
+
+		switch(ModesOfOp)
+		{
+			case SimOpModePV:
+				Speed = Ramp(Speed, TargetSpeed, dt);
+				break;
+			case SimOpModePP:
+				if(isPPActive)
+				{
+					double dist = PPTarget - Pos;
+					//the speed which still allows to stop at the target
+					double brakeSpeed = 60.0 * sqrt(2.0 * ProfileDec * fabs(dist) / IncrementsPerRev);
+					double cmdSpeed = (brakeSpeed < ProfileSpeed) ? brakeSpeed : ProfileSpeed;
+
+					Speed = Ramp(Speed, (dist < 0) ? -cmdSpeed : cmdSpeed, dt);
+				}
+				else
+					Speed = Ramp(Speed, 0, dt);
+				break;
+			case SimOpModeHoming:
+				Speed = 0;
+				if(isHomingActive && ((lastCycleUs - HomingStartUs) >= ((uint64_t)HomingTimeMs * 1000)))
+				{
+					Pos = 0;
+					PPTarget = 0;
+					isHomingActive = false;
+					isHomed = true;
+				}
+				break;
+			default:
+				Speed = Ramp(Speed, 0, dt);
+				break;
+		}
+	}
+	else if((State == eSim402QuickStopActive) || (State == eSim402FaultReactionActive))
+		Speed = Ramp(Speed, 0, dt);
+	else
+		Speed = 0;
+
+	double lastPos = Pos;
+	Pos += Speed / 60.0 * IncrementsPerRev * dt;
+
+	if(isPPActive)
+	{
+		//target reached or passed within this cycle
+		if((((lastPos - PPTarget) * (Pos - PPTarget)) <= 0) && (fabs(Speed) <= (ProfileDec * 60.0 * dt) + 1))
+		{
+			Pos = PPTarget;
+			Speed = 0;
+			isPPActive = false;
+		}
+	}
+
+	if(Speed > lastSpeed)
+		ActTorque = (Speed > 0) ? ProfileTorque : -ProfileTorque;
+	else if(Speed < lastSpeed)
+		ActTorque = (Speed < 0) ? ProfileTorque : -ProfileTorque;
+	else
+		ActTorque = 0;
+}
+
+/*---------------------------------------------------------------------
+ * double COSim402Drive::Ramp(double act, double target, double dt)
+ * approach the target speed with the profile acceleration when
+ * speeding up and the deceleration when slowing down
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+double COSim402Drive::Ramp(double act, double target, double dt)
+{
+	bool isSpeedingUp = (fabs(target) > fabs(act)) && ((target * act) >= 0);
+	double step = 60.0 * dt * (isSpeedingUp ? ProfileAcc : ProfileDec);
+
+	if(target > act + step)
+		return act + step;
+	if(target < act - step)
+		return act - step;
+	return target;
+}
+
+uint16_t COSim402Drive::ComposeSW()
+{
+	uint16_t Value = 0;
+
+	switch(State)
+	{
+		case eSim402SwitchOnDisabled:
+			Value = 0x0040;
+			break;
+		case eSim402ReadyToSwitchOn:
+			Value = 0x0021;
+			break;
+		case eSim402SwitchedOn:
+			Value = 0x0023;
+			break;
+		case eSim402OperationEnabled:
+			Value = 0x0027;
+			break;
+		case eSim402QuickStopActive:
+			Value = 0x0007;
+			break;
+		case eSim402FaultReactionActive:
+			Value = 0x000F;
+			break;
+		case eSim402Fault:
+			Value = 0x0008;
+			break;
+		default:
+			break;
+	}
+	Value |= SimSWRemote;
+
+	switch(ModesOfOpDisp)
+	{
+		case SimOpModePV:
+			if(Speed == TargetSpeed)
+				Value |= SimSWTargetReached;
+			if(Speed == 0)
+				Value |= SimSWBit12;
+			break;
+		case SimOpModeHoming:
+			if(!isHomingActive)
+				Value |= SimSWTargetReached;
+			if(isHomed)
+				Value |= SimSWBit12;
+			break;
+		default:
+			if(!isPPActive)
+				Value |= SimSWTargetReached;
+			if(isSetPointAck)
+				Value |= SimSWBit12;
+			break;
+	}
+	return Value;
+}
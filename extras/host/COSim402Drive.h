@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_SIM_402DRIVE_H
+#define CO_SIM_402DRIVE_H
+
+/*--------------------------------------------------------------------
+ * class COSim402Drive of the host build
+ * a simulated CiA 402 drive - the counterpart of the CO402Drive.
+ * A COSimNode with the drive objects, the CiA 402 state machine and
+ * a simple motion model for the modes PP, PV and homing:
+ *
+ * - speeds in 1/min, acceleration and deceleration in 1/s²
+ * - positions in increments, IncrementsPerRev per revolution
+ * - trapezoidal profiles, the actual torque is +-ProfileTorque
+ *   while accelerating / decelerating, 0 else
+ * - homing sets the position to 0 after HomingTimeMs
+ *
+ * The drive runs it's cycle every CycleTimeUs as a task of the
+ * virtual bus, so any number of drives can run next to the central
+ * device in a single host process.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COSimNode.h>
+#include <stdint.h>
+
+//--- definitions ---
+
+typedef enum COSim402State {
+	eSim402NotReadyToSwitchOn,
+	eSim402SwitchOnDisabled,
+	eSim402ReadyToSwitchOn,
+	eSim402SwitchedOn,
+	eSim402OperationEnabled,
+	eSim402QuickStopActive,
+	eSim402FaultReactionActive,
+	eSim402Fault
+} COSim402State;
+
+class COSim402Drive {
+	public:
+	  COSim402Drive(COVirtualBus *, uint8_t);   //the bus and the NodeId
+
+	  void PowerOn();
+	  void InjectFault(uint16_t);              //EMCY with this code and fault state
+
+	  COSimNode Node;
+
+	  COSim402State GetState() { return State; };
+	  int32_t GetActPos() { return ActPos; };
+	  int32_t GetActSpeed() { return ActSpeed; };
+
+	  uint32_t CycleTimeUs = 1000;
+	  uint32_t IncrementsPerRev = 3000;
+	  uint32_t HomingTimeMs = 50;
+	  int16_t ProfileTorque = 100;
+
+	  static void OnTaskCb(void *op, void *p) {
+		  ((COSim402Drive *)op)->Update(*(uint64_t *)p / 1000);
+	  };
+
+	  static void OnResetAppCb(void *op, void *p) {
+		  ((COSim402Drive *)op)->ResetApp();
+	  };
+
+	private:
+	  void Update(uint64_t);
+	  void ResetApp();
+	  void UpdateStateMachine();
+	  void UpdateMotion(double);
+	  double Ramp(double, double, double);
+	  uint16_t ComposeSW();
+
+	  COSim402State State = eSim402NotReadyToSwitchOn;
+	  uint64_t lastCycleUs = 0;
+	  bool isPoweredOn = false;
+
+	  //--- motion ---
+	  double Pos = 0;         //increments
+	  double Speed = 0;       //1/min
+	  double PPTarget = 0;
+	  bool isPPActive = false;
+	  bool isSetPointAck = false;
+	  bool isHomingActive = false;
+	  bool isHomed = false;
+	  uint64_t HomingStartUs = 0;
+	  uint16_t lastCW = 0;
+
+	  //--- the objects ---
+	  char DeviceName[SimMaxStringLen] = "SimDrive 402";
+	  char HwVersion[SimMaxStringLen] = "host";
+	  char SwVersion[SimMaxStringLen] = "COSim402Drive 1.0";
+	  char MotorName[SimMaxStringLen] = "SimMotor";
+
+	  uint16_t CW = 0;
+	  uint16_t SW = 0;
+	  int8_t ModesOfOp = 0;
+	  int8_t ModesOfOpDisp = 0;
+	  int32_t TargetPos = 0;
+	  int32_t ActPos = 0;
+	  int32_t TargetSpeed = 0;
+	  int32_t ActSpeed = 0;
+	  int16_t TargetTorque = 0;
+	  int16_t ActTorque = 0;
+	  uint32_t ProfileSpeed = 1000;
+	  uint32_t ProfileAcc = 1000;
+	  uint32_t ProfileDec = 1000;
+	  int8_t HomingMethod = 0;
+	  uint16_t ErrorWord = 0;
+	  uint8_t DigInStatus = 0;
+	  uint16_t ErrorCode = 0;
+};
+
+#endif
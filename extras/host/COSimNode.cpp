@@ -0,0 +1,1329 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COSimNode.cpp
+ * Implementation of the simulated CANopen slave of the host build
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW SDO responses delayed as by a gateway
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COSimNode.h>
+
+//--- local definitions ---
+
+#define DEBUG_SIM_NMT     0x0001
+#define DEBUG_SIM_SDO     0x0002
+#define DEBUG_SIM_ERROR   0x0004
+
+#define DEBUG_SIM (DEBUG_SIM_ERROR)
+
+const uint16_t SimCANNmt = 0x000;
+const uint16_t SimCANSync = 0x080;
+const uint16_t SimCANEmcy = 0x080;
+const uint16_t SimCANSDOResp = 0x580;
+const uint16_t SimCANSDOReq = 0x600;
+const uint16_t SimCANGuarding = 0x700;
+
+const uint32_t SimPDOInvalid = 0x80000000;
+
+//SDO command specifiers - client side in bit 5..7 of byte 0
+const uint8_t SimSDODownloadSeg = 0;
+const uint8_t SimSDOInitDownload = 1;
+const uint8_t SimSDOInitUpload = 2;
+const uint8_t SimSDOUploadSeg = 3;
+const uint8_t SimSDOAbort = 4;
+const uint8_t SimSDOBlockUpload = 5;
+const uint8_t SimSDOBlockDownload = 6;
+
+//SDO abort codes
+const uint32_t SimAbortToggle = 0x05030000;
+const uint32_t SimAbortCommand = 0x05040001;
+const uint32_t SimAbortBlockSize = 0x05040002;
+const uint32_t SimAbortCRC = 0x05040004;
+const uint32_t SimAbortReadOnly = 0x06010002;
+const uint32_t SimAbortNoObject = 0x06020000;
+const uint32_t SimAbortNotMappable = 0x06040041;
+const uint32_t SimAbortPDOLength = 0x06040042;
+const uint32_t SimAbortLength = 0x06070010;
+const uint32_t SimAbortNoSubIdx = 0x06090011;
+const uint32_t SimAbortDeviceState = 0x08000022;
+
+//number of entries of the PDO communication objects
+static uint8_t SimRxPDOCommEntries = 2;
+static uint8_t SimTxPDOCommEntries = 5;
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * COSimNode::COSimNode(COVirtualBus *Bus, uint8_t thisId, uint32_t thisType)
+ * attach to the bus and create the communication objects.
+ * Node stays silent until PowerOn()
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+COSimNode::COSimNode(COVirtualBus *Bus, uint8_t thisId, uint32_t thisType):
+	CAN(Bus)
+{
+	pfunction_holder Cb;
+
+	NodeId = thisId;
+	DeviceType = thisType;
+
+	memset(&Stats, 0, sizeof(Stats));
+	memset(RxPDO, 0, sizeof(RxPDO));
+	memset(TxPDO, 0, sizeof(TxPDO));
+	memset(DefaultRxMapping, 0, sizeof(DefaultRxMapping));
+	memset(DefaultRxNrMapped, 0, sizeof(DefaultRxNrMapped));
+	memset(DefaultTxMapping, 0, sizeof(DefaultTxMapping));
+	memset(DefaultTxNrMapped, 0, sizeof(DefaultTxNrMapped));
+
+	AddCommObjects();
+
+	Cb.callback = (pfunction_pointer_t)OnCANEventCb;
+	Cb.op = (void *)this;
+	CAN.set_callback(&Cb);
+}
+
+/*---------------------------------------------------------------------
+ * bool COSimNode::AddObject(uint16_t Idx, uint8_t SubIdx, uint16_t len, COSimAccess Access, void *Value)
+ * add an object of the application to the OD
+ * len is the size of the value in bytes, for strings and buffers it's
+ * the size of the buffer
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+bool COSimNode::AddObject(uint16_t Idx, uint8_t SubIdx, uint16_t len, COSimAccess Access, void *Value)
+{
+	if((NumObjects >= SimMaxObjects) || (len == 0) || (len > SimMaxSDOLen))
+		return false;
+
+	OD[NumObjects].Idx = Idx;
+	OD[NumObjects].SubIdx = SubIdx;
+	OD[NumObjects].len = len;
+	OD[NumObjects].Access = Access;
+	OD[NumObjects].Value = Value;
+	NumObjects++;
+
+	return true;
+}
+
+COSimObject *COSimNode::FindObject(uint16_t Idx, uint8_t SubIdx)
+{
+	for(uint8_t iter = 0; iter < NumObjects; iter++)
+	{
+		if((OD[iter].Idx == Idx) && (OD[iter].SubIdx == SubIdx))
+			return &OD[iter];
+	}
+	return NULL;
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::PresetRxPDOMapping(uint8_t PdoNr, uint8_t NrEntries, const uint32_t *Mapping)
+ * void COSimNode::PresetTxPDOMapping(uint8_t PdoNr, uint8_t NrEntries, const uint32_t *Mapping)
+ * the default mapping restored by each reset communication
+ * entries are coded as in 0x1600 / 0x1A00: Idx << 16 | SubIdx << 8 | bits
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::PresetRxPDOMapping(uint8_t PdoNr, uint8_t NrEntries, const uint32_t *Mapping)
+{
+	if((PdoNr >= SimNrPDOs) || (NrEntries > SimMaxMappedObjects))
+		return;
+
+	DefaultRxNrMapped[PdoNr] = NrEntries;
+	for(uint8_t iter = 0; iter < NrEntries; iter++)
+		DefaultRxMapping[PdoNr][iter] = Mapping[iter];
+}
+
+void COSimNode::PresetTxPDOMapping(uint8_t PdoNr, uint8_t NrEntries, const uint32_t *Mapping)
+{
+	if((PdoNr >= SimNrPDOs) || (NrEntries > SimMaxMappedObjects))
+		return;
+
+	DefaultTxNrMapped[PdoNr] = NrEntries;
+	for(uint8_t iter = 0; iter < NrEntries; iter++)
+		DefaultTxMapping[PdoNr][iter] = Mapping[iter];
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::PowerOn()
+ * open the controller and boot - ends in pre-op after the
+ * boot-up message
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::PowerOn()
+{
+	CAN.begin();
+	actTimeUs = COHostMicros64();
+	ResetComm();
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::Update(uint64_t nowUs)
+ * the cycle of the device:
+ * life guarding, heartbeat and the event driven TxPDOs
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW delayed SDO requests
+ * 2026-10-16 AW a request received after nowUs was taken is no life guarding event
+ * ------------------------------------------------------------------*/
+
+void COSimNode::Update(uint64_t nowUs)
+{
+	actTimeUs = nowUs;
+
+	if(NMTState == eSimNMTInit)
+		return;
+
+	if(isSDORequestDelayed && ((actTimeUs - DelayedSDORequestAtUs) >= SDORespDelayUs))
+	{
+		isSDORequestDelayed = false;
+		OnSDORequest(DelayedSDORequest);
+	}
+
+	if(isLifeGuarding)
+	{
+		//with the wall clock the Rx callback may have stamped the request after nowUs
+		if((int64_t)(actTimeUs - GuardRequestAtUs) > ((int64_t)GuardTime * LifeTimeFactor * 1000))
+		{
+			//life guarding event - fall back to pre-op
+			isLifeGuarding = false;
+			SendEmcy(0x8130, 0x11);
+			if(NMTState == eSimNMTOperational)
+				NMTState = eSimNMTPreOp;
+
+			#if(DEBUG_SIM & DEBUG_SIM_ERROR)
+			Serial.print("SimNode ");
+			Serial.print(NodeId);
+			Serial.println(": life guarding event");
+			#endif
+		}
+	}
+
+	if(ProducerHBTime > 0)
+	{
+		if((actTimeUs - HBSentAtUs) >= ((uint64_t)ProducerHBTime * 1000))
+		{
+			uint8_t state = (uint8_t)NMTState;
+			if(Send(SimCANGuarding + NodeId, &state, 1))
+				HBSentAtUs = actTimeUs;
+		}
+	}
+
+	if(NMTState != eSimNMTOperational)
+		return;
+
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		COSimPDO *Pdo = &TxPDO[iter];
+
+		if((Pdo->COBId & SimPDOInvalid) || (Pdo->NrMapped == 0) || (Pdo->TransmType < 254))
+			continue;
+
+		uint8_t Data[8];
+		uint8_t len = PackTxPDO(Pdo, Data);
+		uint64_t sinceSent = actTimeUs - Pdo->sentAtUs;
+		bool isChanged = (!Pdo->hasData) || (memcmp(Data, Pdo->Data, len) != 0);
+
+		if((isChanged && (sinceSent >= ((uint64_t)Pdo->InhibitTime * 100))) ||
+		   ((Pdo->EventTimer > 0) && (sinceSent >= ((uint64_t)Pdo->EventTimer * 1000))))
+		{
+			SendTxPDO(iter, actTimeUs);
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+ * bool COSimNode::SendEmcy(uint16_t ErrorCode, uint8_t ErrorReg)
+ * send an EMCY - not while stopped
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+bool COSimNode::SendEmcy(uint16_t ErrorCode, uint8_t ErrorReg)
+{
+	uint8_t Data[8] = {(uint8_t)ErrorCode, (uint8_t)(ErrorCode >> 8), ErrorReg, 0, 0, 0, 0, 0};
+
+	ErrorRegister = ErrorReg;
+
+	if((NMTState == eSimNMTInit) || (NMTState == eSimNMTStopped))
+		return false;
+
+	return Send(SimCANEmcy + NodeId, Data, 8);
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::Register_OnResetAppCb(pfunction_holder *Cb)
+ * called by an NMT reset node before the communication is reset
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::Register_OnResetAppCb(pfunction_holder *Cb)
+{
+	OnResetAppCb.callback = Cb->callback;
+	OnResetAppCb.op = Cb->op;
+}
+
+void COSimNode::SetSDOBlockTransfer(bool isEnabled)
+{
+	isBlockEnabled = isEnabled;
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::SetSDORespDelay(uint32_t DelayUs)
+ * answer the SDO requests DelayUs later, by Update() - a gateway to
+ * another bus or a slow device. A request received while the one
+ * before is still delayed replaces it - for expedited and segmented
+ * transfers only.
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::SetSDORespDelay(uint32_t DelayUs)
+{
+	SDORespDelayUs = DelayUs;
+}
+
+void COSimNode::GetStats(COSimNodeStats *thisStats)
+{
+	*thisStats = Stats;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * void COSimNode::AddCommObjects()
+ * the CiA 301 objects of the node
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::AddCommObjects()
+{
+	AddObject(0x1000, 0x00, 4, eSimRO, &DeviceType);
+	AddObject(0x1001, 0x00, 1, eSimRO, &ErrorRegister);
+	AddObject(0x100C, 0x00, 2, eSimRW, &GuardTime);
+	AddObject(0x100D, 0x00, 1, eSimRW, &LifeTimeFactor);
+	AddObject(0x1016, 0x00, 1, eSimRO, &NumConsumerHB);
+	AddObject(0x1016, 0x01, 4, eSimRW, &ConsumerHBTime);
+	AddObject(0x1017, 0x00, 2, eSimRW, &ProducerHBTime);
+
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		AddPDOObjects(0x1400 + iter, 0x1600 + iter, &RxPDO[iter], false);
+		AddPDOObjects(0x1800 + iter, 0x1A00 + iter, &TxPDO[iter], true);
+	}
+}
+
+void COSimNode::AddPDOObjects(uint16_t CommIdx, uint16_t MapIdx, COSimPDO *Pdo, bool isTx)
+{
+	AddObject(CommIdx, 0x00, 1, eSimRO, isTx ? &SimTxPDOCommEntries : &SimRxPDOCommEntries);
+	AddObject(CommIdx, 0x01, 4, eSimRW, &(Pdo->COBId));
+	AddObject(CommIdx, 0x02, 1, eSimRW, &(Pdo->TransmType));
+	if(isTx)
+	{
+		AddObject(CommIdx, 0x03, 2, eSimRW, &(Pdo->InhibitTime));
+		AddObject(CommIdx, 0x05, 2, eSimRW, &(Pdo->EventTimer));
+	}
+
+	AddObject(MapIdx, 0x00, 1, eSimRW, &(Pdo->NrMapped));
+	for(uint8_t iter = 0; iter < SimMaxMappedObjects; iter++)
+		AddObject(MapIdx, iter + 1, 4, eSimRW, &(Pdo->Mapping[iter]));
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::ResetComm()
+ * restore the communication objects and the default PDO config,
+ * send the boot-up message and enter pre-op
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::ResetComm()
+{
+	uint8_t BootMsg = 0;
+
+	GuardTime = 0;
+	LifeTimeFactor = 0;
+	ConsumerHBTime = 0;
+	ProducerHBTime = 0;
+	ErrorRegister = 0;
+
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		//only PDO1 and PDO2 are valid by default
+		uint32_t invalid = (iter < 2) ? 0 : SimPDOInvalid;
+
+		memset(&RxPDO[iter], 0, sizeof(COSimPDO));
+		RxPDO[iter].COBId = (0x200 + (iter * 0x100) + NodeId) | invalid;
+		RxPDO[iter].TransmType = 255;
+		RxPDO[iter].NrMapped = DefaultRxNrMapped[iter];
+		memcpy(RxPDO[iter].Mapping, DefaultRxMapping[iter], sizeof(RxPDO[iter].Mapping));
+		if(CheckMapping(&RxPDO[iter], false) != 0)
+			RxPDO[iter].NrMapped = 0;
+
+		memset(&TxPDO[iter], 0, sizeof(COSimPDO));
+		TxPDO[iter].COBId = (0x180 + (iter * 0x100) + NodeId) | invalid;
+		TxPDO[iter].TransmType = 255;
+		TxPDO[iter].NrMapped = DefaultTxNrMapped[iter];
+		memcpy(TxPDO[iter].Mapping, DefaultTxMapping[iter], sizeof(TxPDO[iter].Mapping));
+		if(CheckMapping(&TxPDO[iter], true) != 0)
+			TxPDO[iter].NrMapped = 0;
+	}
+
+	isSegUpload = false;
+	isSegDownload = false;
+	isBlockUpload = false;
+	isBlockDownload = false;
+
+	GuardToggle = 0;
+	isLifeGuarding = false;
+	HBSentAtUs = actTimeUs;
+
+	NMTState = eSimNMTPreOp;
+	Send(SimCANGuarding + NodeId, &BootMsg, 1);
+
+	#if(DEBUG_SIM & DEBUG_SIM_NMT)
+	Serial.print("SimNode ");
+	Serial.print(NodeId);
+	Serial.println(": boot-up");
+	#endif
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnCANEvent(can_callback_args_t *p_args)
+ * dispatch a received frame - called in "interrupt" context
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnCANEvent(can_callback_args_t *p_args)
+{
+	if(NMTState == eSimNMTInit)
+		return;
+
+	if(p_args->event == CAN_EVENT_TX_COMPLETE)
+	{
+		//the next segment of a block upload
+		if(p_args->frame.id == (uint32_t)(SimCANSDOResp + NodeId))
+			SendBlockSegment();
+		return;
+	}
+	if(p_args->event != CAN_EVENT_RX_COMPLETE)
+		return;
+
+	can_frame_t *frame = &(p_args->frame);
+	uint32_t Id = frame->id;
+
+	actTimeUs = COHostMicros64();
+
+	if(Id == SimCANNmt)
+	{
+		if(frame->data_length_code == 2)
+		{
+			Stats.NumRxFrames++;
+			OnNMT(frame->data[0], frame->data[1]);
+		}
+	}
+	else if(Id == (uint32_t)(SimCANGuarding + NodeId))
+	{
+		if(frame->type == CAN_FRAME_TYPE_REMOTE)
+		{
+			Stats.NumRxFrames++;
+			OnGuarding();
+		}
+	}
+	else if(NMTState == eSimNMTStopped)
+	{
+		//nothing but NMT and guarding
+		;
+	}
+	else if(Id == (uint32_t)(SimCANSDOReq + NodeId))
+	{
+		if(frame->data_length_code == 8)
+		{
+			Stats.NumRxFrames++;
+			if(SDORespDelayUs > 0)
+			{
+				memcpy(DelayedSDORequest, frame->data, 8);
+				DelayedSDORequestAtUs = actTimeUs;
+				isSDORequestDelayed = true;
+			}
+			else
+				OnSDORequest(frame->data);
+		}
+	}
+	else if(NMTState == eSimNMTOperational)
+	{
+		if(Id == SimCANSync)
+		{
+			Stats.NumRxFrames++;
+			OnSync();
+		}
+		else
+		{
+			for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+			{
+				if(((RxPDO[iter].COBId & SimPDOInvalid) == 0) && ((RxPDO[iter].COBId & 0x7FF) == Id))
+				{
+					Stats.NumRxFrames++;
+					OnRxPDO(iter, frame->data, frame->data_length_code);
+					break;
+				}
+			}
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnNMT(uint8_t Command, uint8_t TargetId)
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnNMT(uint8_t Command, uint8_t TargetId)
+{
+	if((TargetId != 0) && (TargetId != NodeId))
+		return;
+
+	#if(DEBUG_SIM & DEBUG_SIM_NMT)
+	Serial.print("SimNode ");
+	Serial.print(NodeId);
+	Serial.print(": NMT ");
+	Serial.println(Command, HEX);
+	#endif
+
+	switch(Command)
+	{
+		case 0x01:
+			NMTState = eSimNMTOperational;
+			break;
+		case 0x02:
+			NMTState = eSimNMTStopped;
+			break;
+		case 0x80:
+			NMTState = eSimNMTPreOp;
+			break;
+		case 0x81:
+			if(OnResetAppCb.callback != NULL)
+				OnResetAppCb.callback(OnResetAppCb.op, NULL);
+			ResetComm();
+			break;
+		case 0x82:
+			ResetComm();
+			break;
+		default:
+			break;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnGuarding()
+ * answer the guarding request with the toggled state and
+ * start life guarding with the first request
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnGuarding()
+{
+	uint8_t Response = GuardToggle | (uint8_t)NMTState;
+
+	if(Send(SimCANGuarding + NodeId, &Response, 1))
+		GuardToggle ^= 0x80;
+
+	GuardRequestAtUs = actTimeUs;
+	isLifeGuarding = (GuardTime > 0) && (LifeTimeFactor > 0);
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnSDORequest(const uint8_t *Request)
+ * the SDO server - expedited and segmented transfers
+ * block transfers are handled by OnSDOBlockRequest()
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnSDORequest(const uint8_t *Request)
+{
+	uint8_t ccs = Request[0] >> 5;
+	uint16_t Idx = Request[1] | (Request[2] << 8);
+	uint8_t SubIdx = Request[3];
+	uint8_t Response[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+	Stats.NumSDORequests++;
+
+	//as a real server: once the end of a block upload is sent, nothing
+	//but it's confirmation or an abort is accepted
+	if(isBlockUpload && isBlockEnd && (ccs != SimSDOAbort) &&
+	   !((ccs == SimSDOBlockUpload) && ((Request[0] & 0x03) == 1)))
+	{
+		isBlockUpload = false;
+		SendSDOAbort(Idx, SubIdx, SimAbortCommand);
+		return;
+	}
+
+	//the segments of a block download have no command specifier
+	if(isBlockEnabled && ((ccs == SimSDOBlockUpload) || (ccs == SimSDOBlockDownload) ||
+	   (isBlockDownload && (Request[0] != (SimSDOAbort << 5)))))
+	{
+		OnSDOBlockRequest(Request);
+		return;
+	}
+
+	switch(ccs)
+	{
+		case SimSDOInitUpload:
+		{
+			COSimObject *Object = FindObject(Idx, SubIdx);
+			isSegUpload = false;
+			isSegDownload = false;
+			isBlockUpload = false;
+
+			if(Object == NULL)
+			{
+				SendSDOAbort(Idx, SubIdx, FindObject(Idx, 0) ? SimAbortNoSubIdx : SimAbortNoObject);
+				return;
+			}
+
+			uint32_t len = Object->len;
+			if(Object->Access == eSimString)
+				len = strnlen((char *)Object->Value, Object->len);
+
+			Response[1] = Request[1];
+			Response[2] = Request[2];
+			Response[3] = Request[3];
+
+			StartUpload(Object, len, Response);
+			break;
+		}
+		case SimSDOUploadSeg:
+		{
+			uint8_t toggle = (Request[0] >> 4) & 0x01;
+
+			if(!isSegUpload)
+			{
+				SendSDOAbort(0, 0, SimAbortCommand);
+				return;
+			}
+			if(toggle != SegToggle)
+			{
+				isSegUpload = false;
+				SendSDOAbort(SegObject->Idx, SegObject->SubIdx, SimAbortToggle);
+				return;
+			}
+
+			uint32_t len = SegLen - SegOffset;
+			uint8_t isLast = 0;
+			if(len <= 7)
+				isLast = 1;
+			else
+				len = 7;
+
+			Response[0] = (toggle << 4) | ((7 - len) << 1) | isLast;
+			memcpy(&Response[1], &SegBuffer[SegOffset], len);
+			SegOffset += len;
+			SegToggle ^= 0x01;
+
+			if(isLast)
+				isSegUpload = false;
+			break;
+		}
+		case SimSDOInitDownload:
+		{
+			COSimObject *Object = FindObject(Idx, SubIdx);
+			uint8_t isExpedited = (Request[0] >> 1) & 0x01;
+			uint8_t isSizeSet = Request[0] & 0x01;
+			isSegUpload = false;
+			isSegDownload = false;
+			isBlockUpload = false;
+
+			if(Object == NULL)
+			{
+				SendSDOAbort(Idx, SubIdx, FindObject(Idx, 0) ? SimAbortNoSubIdx : SimAbortNoObject);
+				return;
+			}
+			if(Object->Access != eSimRW)
+			{
+				SendSDOAbort(Idx, SubIdx, SimAbortReadOnly);
+				return;
+			}
+
+			if(isExpedited)
+			{
+				uint32_t len = isSizeSet ? (4 - ((Request[0] >> 2) & 0x03)) : Object->len;
+				uint32_t result = SDOWrite(Object, &Request[4], len);
+				if(result != 0)
+				{
+					SendSDOAbort(Idx, SubIdx, result);
+					return;
+				}
+			}
+			else
+			{
+				uint32_t len = Object->len;
+				if(isSizeSet)
+					len = Request[4] | (Request[5] << 8) | (Request[6] << 16) | ((uint32_t)Request[7] << 24);
+				if(len > Object->len)
+				{
+					SendSDOAbort(Idx, SubIdx, SimAbortLength);
+					return;
+				}
+				SegObject = Object;
+				SegOffset = 0;
+				SegLen = len;
+				SegToggle = 0;
+				isSegDownload = true;
+			}
+
+			Response[0] = 0x60;
+			Response[1] = Request[1];
+			Response[2] = Request[2];
+			Response[3] = Request[3];
+			break;
+		}
+		case SimSDODownloadSeg:
+		{
+			uint8_t toggle = (Request[0] >> 4) & 0x01;
+			uint8_t isLast = Request[0] & 0x01;
+			uint32_t len = 7 - ((Request[0] >> 1) & 0x07);
+
+			if(!isSegDownload)
+			{
+				SendSDOAbort(0, 0, SimAbortCommand);
+				return;
+			}
+			if(toggle != SegToggle)
+			{
+				isSegDownload = false;
+				SendSDOAbort(SegObject->Idx, SegObject->SubIdx, SimAbortToggle);
+				return;
+			}
+
+			//never beyond the size given by the init request
+			if(len > (SegLen - SegOffset))
+				len = SegLen - SegOffset;
+			memcpy(&SegBuffer[SegOffset], &Request[1], len);
+			SegOffset += len;
+			SegToggle ^= 0x01;
+
+			if(isLast)
+			{
+				isSegDownload = false;
+				uint32_t result = SDOWrite(SegObject, SegBuffer, SegOffset);
+				if(result != 0)
+				{
+					SendSDOAbort(SegObject->Idx, SegObject->SubIdx, result);
+					return;
+				}
+			}
+
+			Response[0] = 0x20 | (toggle << 4);
+			break;
+		}
+		case SimSDOAbort:
+			isSegUpload = false;
+			isSegDownload = false;
+			isBlockUpload = false;
+			isBlockDownload = false;
+			return;
+		default:
+			SendSDOAbort(Idx, SubIdx, SimAbortCommand);
+			return;
+	}
+
+	Send(SimCANSDOResp + NodeId, Response, 8);
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::StartUpload(COSimObject *Object, uint32_t len, uint8_t *Response)
+ * the response to an init upload - expedited or segmented
+ *
+ * 2026-10-16 AW extracted from OnSDORequest
+ * ------------------------------------------------------------------*/
+
+void COSimNode::StartUpload(COSimObject *Object, uint32_t len, uint8_t *Response)
+{
+	if((len <= 4) && (len > 0))
+	{
+		//expedited, size indicated
+		Response[0] = 0x43 | ((4 - len) << 2);
+		memcpy(&Response[4], Object->Value, len);
+	}
+	else
+	{
+		//segmented, the size is given in the data
+		Response[0] = 0x41;
+		Response[4] = (uint8_t)len;
+		Response[5] = (uint8_t)(len >> 8);
+		memcpy(SegBuffer, Object->Value, len);
+		SegObject = Object;
+		SegOffset = 0;
+		SegLen = len;
+		SegToggle = 0;
+		isSegUpload = true;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnSDOBlockRequest(const uint8_t *Request)
+ * the SDO server - block up- and download with CRC.
+ * An upload of up to pst bytes is switched to expedited / segmented.
+ * The segments of an upload are sent one by one - each one as soon as
+ * the one before has been sent, so they can't overtake each other.
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnSDOBlockRequest(const uint8_t *Request)
+{
+	uint8_t ccs = Request[0] >> 5;
+	uint16_t Idx = Request[1] | (Request[2] << 8);
+	uint8_t SubIdx = Request[3];
+	uint8_t Response[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+	if(isBlockDownload && !isBlockEnd)
+	{
+		//a segment
+		uint8_t seqNr = Request[0] & 0x7F;
+
+		if(seqNr == (BlockSeqNr + 1))
+		{
+			for(uint8_t iter = 0; iter < 7; iter++)
+			{
+				if((SegOffset + iter) < SimMaxSDOLen)
+					SegBuffer[SegOffset + iter] = Request[iter + 1];
+			}
+			SegOffset += 7;
+			BlockSeqNr = seqNr;
+			isBlockLastSeg = (Request[0] & 0x80);
+		}
+
+		if((seqNr == BlockSize) || (Request[0] & 0x80))
+		{
+			//confirm the segments received in sequence
+			Response[0] = 0xA2;
+			Response[1] = BlockSeqNr;
+			Response[2] = BlockSize;
+			isBlockEnd = isBlockLastSeg;
+			BlockSeqNr = 0;
+			Send(SimCANSDOResp + NodeId, Response, 8);
+		}
+		return;
+	}
+
+	if(ccs == SimSDOBlockDownload)
+	{
+		if((Request[0] & 0x01) == 0)
+		{
+			//init
+			COSimObject *Object = FindObject(Idx, SubIdx);
+			isSegUpload = false;
+			isSegDownload = false;
+			isBlockUpload = false;
+
+			if(Object == NULL)
+			{
+				SendSDOAbort(Idx, SubIdx, FindObject(Idx, 0) ? SimAbortNoSubIdx : SimAbortNoObject);
+				return;
+			}
+			if(Object->Access != eSimRW)
+			{
+				SendSDOAbort(Idx, SubIdx, SimAbortReadOnly);
+				return;
+			}
+
+			uint32_t len = Object->len;
+			if(Request[0] & 0x02)
+				len = Request[4] | (Request[5] << 8) | (Request[6] << 16) | ((uint32_t)Request[7] << 24);
+			if(len > Object->len)
+			{
+				SendSDOAbort(Idx, SubIdx, SimAbortLength);
+				return;
+			}
+
+			SegObject = Object;
+			SegOffset = 0;
+			SegLen = len;
+			BlockSize = SimBlockSize;
+			BlockSeqNr = 0;
+			isBlockCRC = (Request[0] & 0x04);
+			isBlockLastSeg = false;
+			isBlockEnd = false;
+			isBlockDownload = true;
+
+			Response[0] = 0xA4;
+			Response[1] = Request[1];
+			Response[2] = Request[2];
+			Response[3] = Request[3];
+			Response[4] = BlockSize;
+		}
+		else
+		{
+			//end - the unused bytes of the last segment and the CRC
+			uint32_t len = SegOffset - ((Request[0] >> 2) & 0x07);
+			uint16_t crc = Request[1] | (Request[2] << 8);
+
+			if(!isBlockDownload)
+			{
+				SendSDOAbort(0, 0, SimAbortCommand);
+				return;
+			}
+			isBlockDownload = false;
+
+			if(len != SegLen)
+			{
+				SendSDOAbort(SegObject->Idx, SegObject->SubIdx, SimAbortLength);
+				return;
+			}
+			if(isBlockCRC && (BlockCRC(SegBuffer, len) != crc))
+			{
+				SendSDOAbort(SegObject->Idx, SegObject->SubIdx, SimAbortCRC);
+				return;
+			}
+
+			uint32_t result = SDOWrite(SegObject, SegBuffer, len);
+			if(result != 0)
+			{
+				SendSDOAbort(SegObject->Idx, SegObject->SubIdx, result);
+				return;
+			}
+
+			Response[0] = 0xA1;
+		}
+	}
+	else
+	{
+		//upload
+		switch(Request[0] & 0x03)
+		{
+			case 0:
+			{
+				//init
+				COSimObject *Object = FindObject(Idx, SubIdx);
+				uint8_t pst = Request[5];
+				isSegUpload = false;
+				isSegDownload = false;
+				isBlockDownload = false;
+				isBlockUpload = false;
+
+				if(Object == NULL)
+				{
+					SendSDOAbort(Idx, SubIdx, FindObject(Idx, 0) ? SimAbortNoSubIdx : SimAbortNoObject);
+					return;
+				}
+				if((Request[4] == 0) || (Request[4] > 127))
+				{
+					SendSDOAbort(Idx, SubIdx, SimAbortBlockSize);
+					return;
+				}
+
+				uint32_t len = Object->len;
+				if(Object->Access == eSimString)
+					len = strnlen((char *)Object->Value, Object->len);
+
+				Response[1] = Request[1];
+				Response[2] = Request[2];
+				Response[3] = Request[3];
+
+				if((pst > 0) && (len <= pst))
+				{
+					//protocol switch
+					StartUpload(Object, len, Response);
+					break;
+				}
+
+				memcpy(SegBuffer, Object->Value, len);
+				SegObject = Object;
+				SegOffset = 0;
+				SegLen = len;
+				BlockSize = Request[4];
+				isBlockCRC = (Request[0] & 0x04);
+				isBlockEnd = false;
+				isBlockUpload = true;
+
+				//CRC supported, size indicated
+				Response[0] = 0xC6;
+				Response[4] = (uint8_t)len;
+				Response[5] = (uint8_t)(len >> 8);
+				break;
+			}
+			case 3:
+			case 2:
+				if(!isBlockUpload || isBlockEnd)
+				{
+					SendSDOAbort(0, 0, SimAbortCommand);
+					return;
+				}
+
+				if((Request[0] & 0x03) == 2)
+				{
+					//ack of the client - sent again from the first segment missed
+					SegOffset += Request[1] * 7;
+					if(SegOffset > SegLen)
+						SegOffset = SegLen;
+					if((Request[2] == 0) || (Request[2] > 127))
+					{
+						isBlockUpload = false;
+						SendSDOAbort(SegObject->Idx, SegObject->SubIdx, SimAbortBlockSize);
+						return;
+					}
+					BlockSize = Request[2];
+
+					if(SegOffset >= SegLen)
+					{
+						uint16_t crc = BlockCRC(SegBuffer, SegLen);
+
+						Response[0] = 0xC1 | (((7 - (SegLen % 7)) % 7) << 2);
+						Response[1] = (uint8_t)crc;
+						Response[2] = (uint8_t)(crc >> 8);
+						isBlockEnd = true;
+						break;
+					}
+				}
+
+				//start or continue with the next block
+				BlockSeqNr = 0;
+				BlockTxOffset = SegOffset;
+				SendBlockSegment();
+				return;
+			case 1:
+				//the client confirmed the end
+				isBlockUpload = false;
+				return;
+		}
+	}
+
+	Send(SimCANSDOResp + NodeId, Response, 8);
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::SendBlockSegment()
+ * send the next segment of the block being uploaded
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::SendBlockSegment()
+{
+	if(isBlockUpload && (!isBlockEnd) && (BlockSeqNr < BlockSize) && (BlockTxOffset < SegLen))
+	{
+		uint8_t Segment[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		uint32_t len = SegLen - BlockTxOffset;
+
+		Segment[0] = BlockSeqNr + 1;
+		if(len > 7)
+			len = 7;
+		else
+			Segment[0] |= 0x80;
+		memcpy(&Segment[1], &SegBuffer[BlockTxOffset], len);
+
+		if(Send(SimCANSDOResp + NodeId, Segment, 8))
+		{
+			BlockSeqNr++;
+			BlockTxOffset += len;
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t COSimNode::BlockCRC(const uint8_t *Data, uint32_t len)
+ * CRC-16-CCITT of the block transfer, bit by bit
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+uint16_t COSimNode::BlockCRC(const uint8_t *Data, uint32_t len)
+{
+	uint16_t crc = 0;
+
+	for(uint32_t iter = 0; iter < len; iter++)
+	{
+		crc ^= (uint16_t)Data[iter] << 8;
+		for(uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+	}
+	return crc;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t COSimNode::SDOWrite(COSimObject *Object, const uint8_t *Data, uint32_t len)
+ * write the value of an object, check the PDO mapping when
+ * written. Returns 0 or the abort code
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+uint32_t COSimNode::SDOWrite(COSimObject *Object, const uint8_t *Data, uint32_t len)
+{
+	//strings and buffers can be shorter, numbers have to match
+	if(((Object->len <= 4) && (len != Object->len)) || (len > Object->len))
+		return SimAbortLength;
+
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		for(uint8_t dir = 0; dir < 2; dir++)
+		{
+			COSimPDO *Pdo = (dir == 0) ? &RxPDO[iter] : &TxPDO[iter];
+
+			if(Object->Value == &(Pdo->NrMapped))
+			{
+				uint8_t oldNr = Pdo->NrMapped;
+				if(Data[0] > SimMaxMappedObjects)
+					return SimAbortPDOLength;
+
+				Pdo->NrMapped = Data[0];
+				uint32_t result = CheckMapping(Pdo, dir == 1);
+				if(result != 0)
+				{
+					Pdo->NrMapped = oldNr;
+					CheckMapping(Pdo, dir == 1);
+				}
+				Pdo->hasData = false;
+				return result;
+			}
+			else if((Object->Value >= (void *)&(Pdo->Mapping[0])) && (Object->Value <= (void *)&(Pdo->Mapping[SimMaxMappedObjects - 1])))
+			{
+				//the mapping is changed with the number of entries set to 0 only
+				if(Pdo->NrMapped != 0)
+					return SimAbortDeviceState;
+			}
+		}
+	}
+
+	memcpy(Object->Value, Data, len);
+	if(len < Object->len)
+		((uint8_t *)Object->Value)[len] = 0;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t COSimNode::CheckMapping(COSimPDO *Pdo, bool isTx)
+ * resolve the mapping entries to objects. Returns 0 or the abort code
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+uint32_t COSimNode::CheckMapping(COSimPDO *Pdo, bool isTx)
+{
+	uint8_t len = 0;
+
+	for(uint8_t iter = 0; iter < Pdo->NrMapped; iter++)
+	{
+		uint32_t Entry = Pdo->Mapping[iter];
+		COSimObject *Object = FindObject((uint16_t)(Entry >> 16), (uint8_t)(Entry >> 8));
+
+		if(Object == NULL)
+			return SimAbortNoObject;
+		if(((Entry & 0xFF) != (uint32_t)(Object->len * 8)) || (Object->len > 4))
+			return SimAbortNotMappable;
+		if(!isTx && (Object->Access != eSimRW))
+			return SimAbortNotMappable;
+
+		len += Object->len;
+		if(len > 8)
+			return SimAbortPDOLength;
+
+		Pdo->Mapped[iter] = Object;
+	}
+	Pdo->len = len;
+
+	return 0;
+}
+
+void COSimNode::SendSDOAbort(uint16_t Idx, uint8_t SubIdx, uint32_t Code)
+{
+	uint8_t Response[8] = {0x80, (uint8_t)Idx, (uint8_t)(Idx >> 8), SubIdx,
+	                       (uint8_t)Code, (uint8_t)(Code >> 8), (uint8_t)(Code >> 16), (uint8_t)(Code >> 24)};
+
+	Stats.NumSDOAborts++;
+
+	#if(DEBUG_SIM & DEBUG_SIM_SDO)
+	Serial.print("SimNode ");
+	Serial.print(NodeId);
+	Serial.print(": SDO abort ");
+	Serial.print(Idx, HEX);
+	Serial.print(".");
+	Serial.print(SubIdx);
+	Serial.print(" ");
+	Serial.println(Code, HEX);
+	#endif
+
+	Send(SimCANSDOResp + NodeId, Response, 8);
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnSync()
+ * take over the synchronous RxPDOs and send the synchronous TxPDOs
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnSync()
+{
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		COSimPDO *Pdo = &RxPDO[iter];
+
+		if(Pdo->hasData && (Pdo->TransmType <= 240))
+		{
+			uint8_t offset = 0;
+			for(uint8_t entry = 0; entry < Pdo->NrMapped; entry++)
+			{
+				memcpy(Pdo->Mapped[entry]->Value, &(Pdo->Data[offset]), Pdo->Mapped[entry]->len);
+				offset += Pdo->Mapped[entry]->len;
+			}
+			Pdo->hasData = false;
+		}
+	}
+
+	for(uint8_t iter = 0; iter < SimNrPDOs; iter++)
+	{
+		COSimPDO *Pdo = &TxPDO[iter];
+
+		if((Pdo->COBId & SimPDOInvalid) || (Pdo->NrMapped == 0) || (Pdo->TransmType > 240))
+			continue;
+
+		if(Pdo->TransmType == 0)
+		{
+			//acyclic: on the SYNC after a change
+			uint8_t Data[8];
+			uint8_t len = PackTxPDO(Pdo, Data);
+			if(!Pdo->hasData || (memcmp(Data, Pdo->Data, len) != 0))
+				SendTxPDO(iter, actTimeUs);
+		}
+		else if(++(Pdo->SyncCount) >= Pdo->TransmType)
+		{
+			Pdo->SyncCount = 0;
+			SendTxPDO(iter, actTimeUs);
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void COSimNode::OnRxPDO(uint8_t PdoNr, const uint8_t *Data, uint8_t len)
+ * asynchronous RxPDOs are written to the objects directly, the
+ * synchronous ones with the next SYNC
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COSimNode::OnRxPDO(uint8_t PdoNr, const uint8_t *Data, uint8_t len)
+{
+	COSimPDO *Pdo = &RxPDO[PdoNr];
+
+	if(Pdo->NrMapped == 0)
+		return;
+
+	if(len < Pdo->len)
+	{
+		//PDO not processed due to length error
+		SendEmcy(0x8210, 0x11);
+		return;
+	}
+
+	Stats.NumRxPDOs++;
+
+	if(Pdo->TransmType <= 240)
+	{
+		memcpy(Pdo->Data, Data, Pdo->len);
+		Pdo->hasData = true;
+	}
+	else
+	{
+		uint8_t offset = 0;
+		for(uint8_t entry = 0; entry < Pdo->NrMapped; entry++)
+		{
+			memcpy(Pdo->Mapped[entry]->Value, &Data[offset], Pdo->Mapped[entry]->len);
+			offset += Pdo->Mapped[entry]->len;
+		}
+	}
+}
+
+uint8_t COSimNode::PackTxPDO(COSimPDO *Pdo, uint8_t *Data)
+{
+	uint8_t offset = 0;
+
+	for(uint8_t entry = 0; entry < Pdo->NrMapped; entry++)
+	{
+		memcpy(&Data[offset], Pdo->Mapped[entry]->Value, Pdo->Mapped[entry]->len);
+		offset += Pdo->Mapped[entry]->len;
+	}
+	return offset;
+}
+
+bool COSimNode::SendTxPDO(uint8_t PdoNr, uint64_t nowUs)
+{
+	COSimPDO *Pdo = &TxPDO[PdoNr];
+	uint8_t Data[8];
+	uint8_t len = PackTxPDO(Pdo, Data);
+
+	if(!Send(Pdo->COBId & 0x7FF, Data, len))
+		return false;
+
+	memcpy(Pdo->Data, Data, len);
+	Pdo->hasData = true;
+	Pdo->sentAtUs = nowUs;
+	Stats.NumTxPDOs++;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * bool COSimNode::Send(uint32_t Id, const uint8_t *Data, uint8_t len)
+ * place the frame in the first free mailbox
+ *
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+bool COSimNode::Send(uint32_t Id, const uint8_t *Data, uint8_t len)
+{
+	can_frame_t frame;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.id = Id;
+	frame.id_mode = CAN_ID_MODE_STANDARD;
+	frame.type = CAN_FRAME_TYPE_DATA;
+	frame.data_length_code = len;
+	memcpy(frame.data, Data, len);
+
+	for(uint8_t mailbox = 0; mailbox < NumVirtualMailboxes; mailbox++)
+	{
+		if(CAN.send(&frame, mailbox) > 0)
+		{
+			Stats.NumTxFrames++;
+			return true;
+		}
+	}
+
+	Stats.NumTxOverruns++;
+	return false;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_SIM_NODE_H
+#define CO_SIM_NODE_H
+
+/*--------------------------------------------------------------------
+ * class COSimNode of the host build
+ * a simulated CANopen slave (CiA 301) on a COVirtualBus - the
+ * counterpart of the CONode / COSDOHandler / COPDOHandler of the
+ * central device:
+ *
+ * - an object dictionary of COSimObjects pointing to the values
+ *   of the device; the communication objects are added by the node,
+ *   the application adds it's own ones with AddObject()
+ * - SDO server with expedited, segmented and block up- and download
+ * - NMT slave with boot-up message, node guarding / life guarding
+ *   and heartbeat producer
+ * - 4 RxPDOs and 4 TxPDOs, mapping configured via 0x1600 / 0x1A00,
+ *   transmission types 0..240 (SYNC) and 254/255 (on change with
+ *   inhibit time and event timer)
+ *
+ * Received frames are handled in the event callback of the virtual
+ * CAN controller - that's the interrupt context of the host build.
+ * RxPDOs are only copied into the objects there. Update() runs the
+ * cycle of the device: TxPDOs, heartbeat and life guarding.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW SDO responses delayed as by a gateway
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COVirtualBus.h>
+#include <stdint.h>
+
+//--- definitions ---
+
+const uint8_t SimMaxObjects = 160;
+const uint8_t SimNrPDOs = 4;
+const uint8_t SimMaxMappedObjects = 8;
+const uint8_t SimMaxStringLen = 32;
+//objects such as recorder buffers up to this size
+const uint16_t SimMaxSDOLen = 1024;
+//segments of a block download
+const uint8_t SimBlockSize = 127;
+
+typedef enum COSimNMTState {
+	eSimNMTInit = 0,
+	eSimNMTStopped = 4,
+	eSimNMTOperational = 5,
+	eSimNMTPreOp = 127
+} COSimNMTState;
+
+typedef enum COSimAccess {
+	eSimRO,
+	eSimRW,
+	eSimString       //read only, uploaded with it's actual string length
+} COSimAccess;
+
+typedef struct COSimObject {
+	uint16_t Idx;
+	uint8_t SubIdx;
+	uint16_t len;
+	COSimAccess Access;
+	void *Value;
+} COSimObject;
+
+typedef struct COSimPDO {
+	uint32_t COBId;            //subIdx 01
+	uint8_t TransmType;        //subIdx 02
+	uint16_t InhibitTime;      //subIdx 03 in 100us, TxPDO only
+	uint16_t EventTimer;       //subIdx 05 in ms, TxPDO only
+	uint8_t NrMapped;          //mapping subIdx 00
+	uint32_t Mapping[SimMaxMappedObjects];
+	COSimObject *Mapped[SimMaxMappedObjects];
+	uint8_t len;               //bytes of the mapped objects
+
+	uint8_t Data[8];           //last sent TxPDO / RxPDO waiting for SYNC
+	bool hasData;
+	uint64_t sentAtUs;
+	uint8_t SyncCount;
+} COSimPDO;
+
+typedef struct COSimNodeStats {
+	uint32_t NumRxFrames;      //frames handled by this node
+	uint32_t NumTxFrames;      //frames placed in a mailbox
+	uint32_t NumTxOverruns;    //frames lost as all mailboxes were busy
+	uint32_t NumSDORequests;
+	uint32_t NumSDOAborts;
+	uint32_t NumRxPDOs;
+	uint32_t NumTxPDOs;
+} COSimNodeStats;
+
+class COSimNode {
+	public:
+	  COSimNode(COVirtualBus *, uint8_t, uint32_t);  //the bus, the NodeId and the device type 0x1000
+
+	  bool AddObject(uint16_t, uint8_t, uint16_t, COSimAccess, void *);
+	  COSimObject *FindObject(uint16_t, uint8_t);
+
+	  void PresetRxPDOMapping(uint8_t, uint8_t, const uint32_t *);
+	  void PresetTxPDOMapping(uint8_t, uint8_t, const uint32_t *);
+
+	  void PowerOn();                  //boot and send the boot-up message
+	  void Update(uint64_t);           //the cycle of the device, time in us
+
+	  bool SendEmcy(uint16_t, uint8_t);
+	  void Register_OnResetAppCb(pfunction_holder *);
+	  void SetSDOBlockTransfer(bool);  //a server without it aborts the request
+	  void SetSDORespDelay(uint32_t);  //a slow server, e.g. a gateway, in us
+
+	  COSimNMTState GetState() { return NMTState; };
+	  uint8_t GetNodeId() { return NodeId; };
+
+	  void GetStats(COSimNodeStats *);
+
+	  static void OnCANEventCb(void *op, void *p) {
+		  ((COSimNode *)op)->OnCANEvent((can_callback_args_t *)p);
+	  };
+
+	private:
+	  void OnCANEvent(can_callback_args_t *);
+	  void OnNMT(uint8_t, uint8_t);
+	  void OnGuarding();
+	  void OnSDORequest(const uint8_t *);
+	  void OnSDOBlockRequest(const uint8_t *);
+	  void StartUpload(COSimObject *, uint32_t, uint8_t *);
+	  void SendBlockSegment();
+	  uint16_t BlockCRC(const uint8_t *, uint32_t);
+	  void OnSync();
+	  void OnRxPDO(uint8_t, const uint8_t *, uint8_t);
+
+	  uint32_t SDOWrite(COSimObject *, const uint8_t *, uint32_t);
+	  uint32_t CheckMapping(COSimPDO *, bool);
+	  void SendSDOAbort(uint16_t, uint8_t, uint32_t);
+	  bool Send(uint32_t, const uint8_t *, uint8_t);
+
+	  void ResetComm();
+	  void AddCommObjects();
+	  void AddPDOObjects(uint16_t, uint16_t, COSimPDO *, bool);
+	  uint8_t PackTxPDO(COSimPDO *, uint8_t *);
+	  bool SendTxPDO(uint8_t, uint64_t);
+
+	  COVirtualCAN CAN;
+	  uint8_t NodeId;
+
+	  COSimObject OD[SimMaxObjects];
+	  uint8_t NumObjects = 0;
+
+	  COSimNMTState NMTState = eSimNMTInit;
+	  uint64_t actTimeUs = 0;
+
+	  //--- communication objects ---
+	  uint32_t DeviceType;
+	  uint8_t ErrorRegister = 0;
+	  uint16_t GuardTime = 0;
+	  uint8_t LifeTimeFactor = 0;
+	  uint8_t NumConsumerHB = 1;
+	  uint32_t ConsumerHBTime = 0;   //stored only
+	  uint16_t ProducerHBTime = 0;
+
+	  COSimPDO RxPDO[SimNrPDOs];
+	  COSimPDO TxPDO[SimNrPDOs];
+	  uint32_t DefaultRxMapping[SimNrPDOs][SimMaxMappedObjects];
+	  uint8_t DefaultRxNrMapped[SimNrPDOs];
+	  uint32_t DefaultTxMapping[SimNrPDOs][SimMaxMappedObjects];
+	  uint8_t DefaultTxNrMapped[SimNrPDOs];
+
+	  //--- NMT ---
+	  uint8_t GuardToggle = 0;
+	  bool isLifeGuarding = false;
+	  uint64_t GuardRequestAtUs = 0;
+	  uint64_t HBSentAtUs = 0;
+	  pfunction_holder OnResetAppCb = {NULL, NULL};
+
+	  //--- SDO server ---
+	  COSimObject *SegObject = NULL;
+	  uint32_t SegOffset = 0;
+	  uint32_t SegLen = 0;
+	  uint8_t SegToggle = 0;
+	  bool isSegUpload = false;
+	  bool isSegDownload = false;
+	  uint8_t SegBuffer[SimMaxSDOLen];
+
+	  bool isBlockEnabled = true;
+	  bool isBlockUpload = false;
+	  bool isBlockDownload = false;
+	  bool isBlockEnd = false;         //last segment done, waiting for the end
+	  bool isBlockCRC = false;
+	  bool isBlockLastSeg = false;
+	  uint8_t BlockSize = 0;
+	  uint8_t BlockSeqNr = 0;
+	  uint32_t BlockTxOffset = 0;
+
+	  //a request handled later by Update()
+	  uint32_t SDORespDelayUs = 0;
+	  uint8_t DelayedSDORequest[8];
+	  uint64_t DelayedSDORequestAtUs = 0;
+	  bool isSDORequestDelayed = false;
+
+	  COSimNodeStats Stats;
+};
+
+#endif
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+ 
+/*-------------------------------------------------------------------
+ * COVirtualBus.cpp
+ * Implementation of the in-memory CAN bus of the host build
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+ 
+//--- includes ---
+ 
+#include <COVirtualBus.h>
+
+COVirtualBus *COVirtualBus::Buses[MaxVirtualBuses] = {NULL};
+
+//--- implementation COVirtualCAN ---
+
+/*------------------------------------------------------
+ * COVirtualCAN(COVirtualBus *)
+ * constructor - attach the controller to the bus
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+COVirtualCAN::COVirtualCAN(COVirtualBus *thisBus):
+	Bus(thisBus)
+{
+	for(uint8_t iter = 0; iter < NumVirtualMailboxes; iter++)
+		Mailbox[iter].isPending = false;
+
+	if(Bus != NULL)
+		Bus->Attach(this);
+}
+
+bool COVirtualCAN::begin(void)
+{
+	isOpen = (Bus != NULL);
+	return isOpen;
+}
+
+void COVirtualCAN::end(void)
+{
+	isOpen = false;
+	for(uint8_t iter = 0; iter < NumVirtualMailboxes; iter++)
+		Mailbox[iter].isPending = false;
+	NumPending = 0;
+}
+
+/*------------------------------------------------------
+ * void set_can_bitrate(CanBitRate)
+ * the bit rate is a property of the bus - a controller
+ * using a different one would only produce error frames
+ * so it's ignored here
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+void COVirtualCAN::set_can_bitrate(CanBitRate bitrate)
+{
+	(void)bitrate;
+}
+
+void COVirtualCAN::set_callback(pfunction_holder *Cb)
+{
+	OnEventCb.callback = Cb->callback;
+	OnEventCb.op = Cb->op;
+}
+
+/*------------------------------------------------------
+ * int send(can_frame_t *, uint32_t mailbox)
+ * place the frame in the mailbox. Fails if the mailbox
+ * is still pending, just as R_CAN_Write does
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+int COVirtualCAN::send(can_frame_t *msg, uint32_t const mailbox)
+{
+	if(!isOpen || (mailbox >= NumVirtualMailboxes))
+		return -1;
+	if(Mailbox[mailbox].isPending)
+		return -2;
+
+	Mailbox[mailbox].frame = *msg;
+	if(Mailbox[mailbox].frame.data_length_code > 8)
+		Mailbox[mailbox].frame.data_length_code = 8;
+	Mailbox[mailbox].pendingSince = COHostMicros64() * 1000;
+	Mailbox[mailbox].isPending = true;
+	NumPending++;
+
+	return 1;
+}
+
+void COVirtualCAN::OnEvent(can_callback_args_t *p_args)
+{
+	if(OnEventCb.callback != NULL)
+		OnEventCb.callback(OnEventCb.op, (void *)p_args);
+}
+
+//--- implementation COVirtualBus ---
+
+/*------------------------------------------------------
+ * COVirtualBus(CanBitRate)
+ * constructor - the bus registers itself to be run
+ * by the host clock
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+COVirtualBus::COVirtualBus(CanBitRate bitrate)
+{
+	SetBitrate(bitrate);
+	ResetStats();
+
+	for(uint8_t iter = 0; iter < MaxVirtualBuses; iter++)
+	{
+		if(Buses[iter] == NULL)
+		{
+			Buses[iter] = this;
+			break;
+		}
+	}
+}
+
+COVirtualBus::~COVirtualBus()
+{
+	for(uint8_t iter = 0; iter < MaxVirtualBuses; iter++)
+	{
+		if(Buses[iter] == this)
+			Buses[iter] = NULL;
+	}
+}
+
+void COVirtualBus::SetBitrate(CanBitRate bitrate)
+{
+	BitTimeNs = 1000000000UL / (uint32_t)bitrate;
+}
+
+bool COVirtualBus::Attach(COVirtualCAN *Controller)
+{
+	if(NumControllers >= MaxVirtualControllers)
+		return false;
+
+	Controllers[NumControllers++] = Controller;
+	return true;
+}
+
+/*------------------------------------------------------
+ * bool AttachTask(pfunction_holder *)
+ * a simulated device runs it's cycle in a task called
+ * whenever the bus has been run
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+bool COVirtualBus::AttachTask(pfunction_holder *Cb)
+{
+	if(NumTasks >= MaxVirtualTasks)
+		return false;
+
+	Tasks[NumTasks].callback = Cb->callback;
+	Tasks[NumTasks].op = Cb->op;
+	NumTasks++;
+	return true;
+}
+
+/*------------------------------------------------------
+ * bool Arbitrate(uint64_t nowNs)
+ * find the frame to be sent next. The bus becomes free at
+ * BusFreeAt - or later when the first frame gets pending.
+ * All frames pending at that moment take part in the
+ * arbitration: lowest Id first, data before remote.
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+bool COVirtualBus::Arbitrate(uint64_t nowNs)
+{
+	uint64_t firstPending = UINT64_MAX;
+
+	for(uint8_t ctrl = 0; ctrl < NumControllers; ctrl++)
+	{
+		if(Controllers[ctrl]->NumPending == 0)
+			continue;
+
+		for(uint8_t mb = 0; mb < NumVirtualMailboxes; mb++)
+		{
+			COVirtualCAN::VirtualMailbox *Mb = &(Controllers[ctrl]->Mailbox[mb]);
+			if(Mb->isPending && (Mb->pendingSince < firstPending))
+				firstPending = Mb->pendingSince;
+		}
+	}
+
+	if(firstPending == UINT64_MAX)
+		return false;
+
+	uint64_t startAt = (firstPending > BusFreeAt) ? firstPending : BusFreeAt;
+	if(startAt > nowNs)
+		return false;
+
+	uint32_t bestPrio = UINT32_MAX;
+
+	for(uint8_t ctrl = 0; ctrl < NumControllers; ctrl++)
+	{
+		if(Controllers[ctrl]->NumPending == 0)
+			continue;
+
+		for(uint8_t mb = 0; mb < NumVirtualMailboxes; mb++)
+		{
+			COVirtualCAN::VirtualMailbox *Mb = &(Controllers[ctrl]->Mailbox[mb]);
+			if(Mb->isPending && (Mb->pendingSince <= startAt))
+			{
+				uint32_t prio = ((Mb->frame.id & 0x7FF) << 1) | (Mb->frame.type == CAN_FRAME_TYPE_REMOTE ? 1 : 0);
+				if(prio < bestPrio)
+				{
+					bestPrio = prio;
+					TxController = Controllers[ctrl];
+					TxMailbox = mb;
+				}
+			}
+		}
+	}
+
+	can_frame_t *frame = &(TxController->Mailbox[TxMailbox].frame);
+	uint8_t bits = COFrameBits(frame->id, frame->type == CAN_FRAME_TYPE_REMOTE, frame->data_length_code, frame->data);
+
+	TxEndAt = startAt + (uint64_t)bits * BitTimeNs;
+	isBusy = true;
+
+	Stats.NumBits += bits;
+	Stats.BusyNs += (uint64_t)bits * BitTimeNs;
+
+	return true;
+}
+
+/*------------------------------------------------------
+ * void RunUntil(uint64_t nowNs)
+ * complete all transmissions which end until now and
+ * report them to the controllers, then run the tasks
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+void COVirtualBus::RunUntil(uint64_t nowNs)
+{
+	while(isBusy || Arbitrate(nowNs))
+	{
+		if(TxEndAt > nowNs)
+			break;
+
+		COVirtualCAN *Sender = TxController;
+		uint8_t mailbox = TxMailbox;
+		can_callback_args_t args;
+		bool isAcked = false;
+
+		isBusy = false;
+		BusFreeAt = TxEndAt;
+
+		args.channel = 0;
+		args.error = 0;
+		args.mailbox = 0;
+		args.frame = Sender->Mailbox[mailbox].frame;
+
+		for(uint8_t ctrl = 0; ctrl < NumControllers; ctrl++)
+		{
+			if((Controllers[ctrl] != Sender) && Controllers[ctrl]->isOpen)
+			{
+				isAcked = true;
+				args.event = CAN_EVENT_RX_COMPLETE;
+				args.p_context = Controllers[ctrl];
+				Controllers[ctrl]->OnEvent(&args);
+			}
+		}
+
+		if(isAcked)
+		{
+			Stats.NumFrames++;
+			Sender->Mailbox[mailbox].isPending = false;
+			Sender->NumPending--;
+			args.event = CAN_EVENT_TX_COMPLETE;
+			args.mailbox = mailbox;
+			args.p_context = Sender;
+			Sender->OnEvent(&args);
+		}
+		else
+		{
+			//nobody there - the frame is repeated
+			Stats.NumAckErrors++;
+		}
+	}
+
+	for(uint8_t iter = 0; iter < NumTasks; iter++)
+		Tasks[iter].callback(Tasks[iter].op, (void *)&nowNs);
+}
+
+/*------------------------------------------------------
+ * static void RunAllUntil(uint64_t nowNs)
+ * run all buses of the host build
+ * 
+ * 2026-10-16 AW
+ * ----------------------------------------------------*/
+
+void COVirtualBus::RunAllUntil(uint64_t nowNs)
+{
+	for(uint8_t iter = 0; iter < MaxVirtualBuses; iter++)
+	{
+		if(Buses[iter] != NULL)
+			Buses[iter]->RunUntil(nowNs);
+	}
+}
+
+void COVirtualBus::GetStats(COVirtualBusStats *thisStats)
+{
+	*thisStats = Stats;
+}
+
+void COVirtualBus::ResetStats()
+{
+	Stats.NumFrames = 0;
+	Stats.NumAckErrors = 0;
+	Stats.BusyNs = 0;
+	Stats.NumBits = 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_VIRTUAL_BUS_H
+#define CO_VIRTUAL_BUS_H
+
+/*--------------------------------------------------------------------
+ * classes COVirtualBus and COVirtualCAN of the host build
+ *
+ * COVirtualBus is an in-memory CAN bus. Every attached COVirtualCAN
+ * is a CAN controller with 32 Tx mailboxes. Frames are sent one after
+ * the other, each occupying the bus for it's exact length in bits
+ * (COFrameBits) at the bit rate of the bus. If several mailboxes are
+ * pending when the bus becomes free, the lowest CAN-Id wins the
+ * arbitration and a data frame wins against a remote frame of the
+ * same Id.
+ * A sent frame is reported as CAN_EVENT_RX_COMPLETE to all other open
+ * controllers and as CAN_EVENT_TX_COMPLETE to the sender. A frame
+ * nobody acknowledges is repeated just like on a real bus.
+ *
+ * The bus runs when the host clock advances (COHostAdvance() or
+ * delay()), the events are called from there - that's the interrupt
+ * context of the host build.
+ * Simulated devices attach a task which is called each time the bus
+ * has been run, with a pointer to the uint64_t bus time in ns.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW tasks of simulated devices
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COTransport.h>
+#include <COFrameTiming.h>
+#include <stdint.h>
+
+const uint8_t NumVirtualMailboxes = 32;
+const uint8_t MaxVirtualControllers = 132;  //127 nodes, the central device and some tools
+const uint8_t MaxVirtualBuses = 4;
+const uint8_t MaxVirtualTasks = MaxVirtualControllers;
+
+class COVirtualBus;
+
+class COVirtualCAN : public COTransport {
+	public:
+	  COVirtualCAN(COVirtualBus *);
+
+	  bool begin(void) override;
+	  void end(void) override;
+
+	  void set_can_bitrate(CanBitRate bitrate) override;
+	  void set_callback(pfunction_holder *) override;
+
+	  int send(can_frame_t *msg, uint32_t const mailbox) override;
+
+	  bool IsOpen() { return isOpen; };
+
+	private:
+	  friend class COVirtualBus;
+
+	  void OnEvent(can_callback_args_t *);
+
+	  COVirtualBus *Bus;
+	  bool isOpen = false;
+	  pfunction_holder OnEventCb = {NULL, NULL};
+
+	  typedef struct VirtualMailbox {
+		  bool isPending;
+		  uint64_t pendingSince;
+		  can_frame_t frame;
+	  } VirtualMailbox;
+
+	  VirtualMailbox Mailbox[NumVirtualMailboxes];
+	  uint8_t NumPending = 0;
+};
+
+typedef struct COVirtualBusStats {
+	uint32_t NumFrames;       //frames sent successfully
+	uint32_t NumAckErrors;    //frames not acknowledged and repeated
+	uint64_t BusyNs;          //time the bus was occupied
+	uint64_t NumBits;         //bits sent including stuff bits
+} COVirtualBusStats;
+
+class COVirtualBus {
+	public:
+	  COVirtualBus(CanBitRate bitrate = CanBitRate::BR_250k);
+	  ~COVirtualBus();
+
+	  void SetBitrate(CanBitRate);
+	  uint32_t GetBitTimeNs() { return BitTimeNs; };
+
+	  bool Attach(COVirtualCAN *);
+	  bool AttachTask(pfunction_holder *);
+
+	  //run all transmissions finished until the given time
+	  void RunUntil(uint64_t nowNs);
+	  static void RunAllUntil(uint64_t nowNs);
+
+	  void GetStats(COVirtualBusStats *);
+	  void ResetStats();
+
+	private:
+	  friend class COVirtualCAN;
+
+	  bool Arbitrate(uint64_t);
+
+	  uint32_t BitTimeNs;
+	  uint64_t BusFreeAt = 0;
+
+	  //the frame on the bus
+	  bool isBusy = false;
+	  COVirtualCAN *TxController = NULL;
+	  uint8_t TxMailbox = 0;
+	  uint64_t TxEndAt = 0;
+
+	  COVirtualCAN *Controllers[MaxVirtualControllers];
+	  uint8_t NumControllers = 0;
+
+	  pfunction_holder Tasks[MaxVirtualTasks];
+	  uint8_t NumTasks = 0;
+
+	  COVirtualBusStats Stats;
+
+	  static COVirtualBus *Buses[MaxVirtualBuses];
+};
+
+//the bus the COHostDefaultTransport() is attached to
+COVirtualBus *COHostDefaultBus();
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_HOST_FSPTIMER_H
+#define CO_HOST_FSPTIMER_H
+
+/*--------------------------------------------------------------------
+ * FspTimer.h of the host build
+ * the part of the FspTimer of the Arduino UNO R4 core used by the
+ * library: a periodic timer calling it's callback in the "interrupt"
+ * context of the host build.
+ *
+ * The timers run when the host clock advances (COHostAdvance()).
+ * In simulated time the clock steps to the exact time a timer is
+ * due, with the wall clock a timer is called for each period passed.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+#if !defined(CO_HOST_BUILD)
+#error "the host shim needs CO_HOST_BUILD to be defined"
+#endif
+
+#include <stdint.h>
+
+typedef enum timer_mode_t {
+	TIMER_MODE_PERIODIC
+} timer_mode_t;
+
+typedef struct timer_callback_args_t {
+	void const *p_context;
+} timer_callback_args_t;
+
+typedef void (*GPTimerCbk_f)(timer_callback_args_t *);
+
+const uint8_t GPT_TIMER = 0;
+const uint8_t AGT_TIMER = 1;
+
+const uint8_t MaxHostTimers = 8;
+
+class FspTimer {
+	public:
+	  static int8_t get_available_timer(uint8_t &type, bool force = false);
+
+	  bool begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc, GPTimerCbk_f cbk = nullptr, void *ctx = nullptr);
+	  bool setup_overflow_irq(uint8_t priority = 12) { return true; }
+	  bool open();
+	  bool start();
+	  bool stop();
+	  void end();
+
+	  //the host clock calls the timers due up to nowUs
+	  static void RunAllUntil(uint64_t nowUs);
+	  //the time the next timer is due, ~0 if none
+	  static uint64_t NextDueAt();
+
+	private:
+	  uint32_t PeriodUs = 0;
+	  uint64_t DueAt = 0;
+	  bool isRunning = false;
+	  int8_t Channel = -1;
+
+	  GPTimerCbk_f Callback = nullptr;
+	  timer_callback_args_t Args = {nullptr};
+};
+
+#endif
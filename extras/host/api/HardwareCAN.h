@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_HOST_HARDWARECAN_H
+#define CO_HOST_HARDWARECAN_H
+
+/*--------------------------------------------------------------------
+ * api/HardwareCAN.h of the host build
+ * the bit rates of the ArduinoCore-API
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+enum class CanBitRate : int
+{
+	BR_125k  = 125000,
+	BR_250k  = 250000,
+	BR_500k  = 500000,
+	BR_1000k = 1000000,
+};
+
+#endif
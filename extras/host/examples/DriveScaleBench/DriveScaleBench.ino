@@ -0,0 +1,585 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * DriveScaleBench - host build only
+ *
+ * the central device against BENCH_NUM_DRIVES simulated CiA 402 drives
+ * on a 1 MBit/s virtual bus. All drives are booted, their PDOs are
+ * configured, they are started and enabled in PV mode. Then all of them
+ * get new target speeds every 500ms for BENCH_RUN_MS.
+ * TxPDOs are sent on each SYNC (transmission type 1), RxPDOs on change.
+ *
+ * All drives are configured at the same time, their SDO requests are
+ * interleaved by the SDO client scheduler of the COMsgHandler.
+ *
+ * Prints the simulated time to get the first and all drives running,
+ * the host CPU time of the loop() of the central device and the bus load.
+ * The latencies are taken from the time stamps of the received frames:
+ * Rx interrupt to dispatch and the round trip of the node guarding.
+ * The SDO round trip smoothed per drive gives their response time-out.
+ * Built with -DBENCH_GATEWAY_DELAY_US=u every second drive answers it's
+ * SDO requests u later, as if behind a gateway - those adapt their
+ * time-out, the others are not slowed down.
+ * Built with -DBENCH_SYNC_WINDOW_US=u the RxPDOs are synchronous (type 1)
+ * and have to make a synchronous window of u, the SYNC carries a counter.
+ * Prints the RxPDOs late and the ones of them dropped by the Tx queue.
+ * The bus load of the virtual bus is compared to the one estimated by
+ * the bus statistics of the COMsgHandler, which prints it's top talkers.
+ * Built with -DCO_PROBES=1 the histograms of the latency probes are
+ * printed as well, timed by the steady clock of the host.
+ * Built with -DCO_TRACE=1 the event trace is dumped at the end, to be
+ * piped into extras/host/tools/COTraceDecode.
+ * Built with -DBENCH_SCHEDULED=1 the drives and the SYNC are run by the
+ * scheduler of the COMsgHandler when they are due, the loop() only calls
+ * it's Update() - compare the cost of the loop() of both for 4, 32 and
+ * 127 drives.
+ *
+ * Built as any sketch of the host build (see README) together with the
+ * sources of CO402Drive and -DCO_MAX_NODES=127 -DBENCH_NUM_DRIVES=n,
+ * run with --sim.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW drives run by the scheduler
+ * 2026-10-16 AW SDO round trip and time-out
+ * 2026-10-16 AW synchronous RxPDOs within a window
+ * 2026-10-16 AW guarding queue wait, startup and run separately
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <CO402Drive.h>
+#include <COSyncHandler.h>
+#include <COVirtualBus.h>
+#include <COSim402Drive.h>
+
+#include <chrono>
+#include <stdlib.h>
+
+//---- local definitions -----------------------------------------------
+
+#ifndef BENCH_NUM_DRIVES
+#define BENCH_NUM_DRIVES 4
+#endif
+
+//the TxPDOs of 127 drives take more than 20ms on the bus
+#ifndef BENCH_SYNC_MS
+#define BENCH_SYNC_MS ((BENCH_NUM_DRIVES > 32) ? 50 : 10)
+#endif
+
+#ifndef BENCH_RUN_MS
+#define BENCH_RUN_MS 5000
+#endif
+
+#ifndef BENCH_SCHEDULED
+#define BENCH_SCHEDULED 0
+#endif
+
+//every second drive answers it's SDO requests this much later
+#ifndef BENCH_GATEWAY_DELAY_US
+#define BENCH_GATEWAY_DELAY_US 0
+#endif
+
+//0: RxPDOs on change, else synchronous ones within this window
+#ifndef BENCH_SYNC_WINDOW_US
+#define BENCH_SYNC_WINDOW_US 0
+#endif
+
+const uint8_t NumDrives = BENCH_NUM_DRIVES;
+static_assert((NumDrives > 0) && (NumDrives <= MsgHandler_MaxNodes), "build with -DCO_MAX_NODES >= BENCH_NUM_DRIVES");
+
+const uint8_t MasterNodeId = 0x7F;
+const uint16_t GuardTime = 500;
+const uint8_t LiveTimeFactor = 3;
+const uint32_t StartupTimeoutMs = 60000;
+const uint32_t PDOConfigTimeout = 200;
+const uint8_t SyncCounterOverflow = 16;
+const uint8_t NumSyncRxPDOs = 2;
+
+typedef enum BenchPhase {
+  eBenchStartup,
+  eBenchRun,
+  eBenchDone
+} BenchPhase;
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+
+COSyncHandler SyncHandler(MasterNodeId);
+
+CO402Drive *Drives[NumDrives];
+COSim402Drive *SimDrives[NumDrives];
+bool isEnabled[NumDrives];
+
+BenchPhase Phase = eBenchStartup;
+uint32_t PhaseStartedAt = 0;
+int32_t TargetSpeed = 1000;
+uint32_t TargetSpeedSetAt = 0;
+uint32_t FirstEnabledAt = 0;
+bool isAnyEnabled = false;
+
+COTxStats TxStatsAtStart;
+uint32_t LateRxPDOsAtStart = 0;
+uint32_t StartupGuardRoundTrip = 0;
+uint32_t StartupGuardQueueWait = 0;
+
+uint32_t NumDriveResets = 0;
+
+#if BENCH_SCHEDULED
+uint8_t NumEnabled = 0;
+int32_t AppliedSpeed = 1000;
+#endif
+
+uint32_t NumLoops = 0;
+uint64_t LoopNs = 0;
+uint64_t MaxLoopNs = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//the application's part of a drive after it's Update(): enable it
+//once it's operational, then keep it's target speed
+//returns true if it's running
+bool StepDrive(uint8_t iter, NMTNodeState state, uint32_t actTime)
+{
+  if(state == eNMTStatePreOp)
+  {
+    isEnabled[iter] = false;
+    if(Drives[iter]->isPDOsConfigured)
+      Drives[iter]->autoEnable = true;
+    else
+    {
+      //a PDO config stopped by a failed SDO is not retried
+      //so the drive is reset and configured again
+      COSDOCommStates SDOState = Drives[iter]->Node.GetSDOState();
+      if((SDOState == eCO_SDOError) || (SDOState == eCO_SDOTimeout))
+      {
+        Drives[iter]->Node.ResetComState();
+        if(Drives[iter]->Node.SendResetNode() == eCO_NodeDone)
+          NumDriveResets++;
+      }
+    }
+  }
+  else if(state == eNMTStateOperational)
+  {
+    if(!isEnabled[iter])
+    {
+      if((Drives[iter]->SetOpMode(OpModePV) == eCO_DriveDone) && (Drives[iter]->Enable() == eCO_DriveDone))
+      {
+        isEnabled[iter] = true;
+        if(!isAnyEnabled)
+          FirstEnabledAt = actTime;
+        isAnyEnabled = true;
+      }
+    }
+    else
+    {
+      Drives[iter]->SetTargetSpeed(TargetSpeed);
+      return true;
+    }
+  }
+  return false;
+}
+
+#if BENCH_SCHEDULED
+//called by the drive after each Update() it was run for
+void OnDriveUpdate(void *op, void *p)
+{
+  uint8_t iter = (uint8_t)(uintptr_t)op;
+  bool wasEnabled = isEnabled[iter];
+
+  StepDrive(iter, ((CO402Drive *)p)->Node.GetNodeState(), millis());
+  if(isEnabled[iter] && !wasEnabled)
+    NumEnabled++;
+  else if(!isEnabled[iter] && wasEnabled)
+    NumEnabled--;
+}
+#else
+uint8_t UpdateDrives(uint32_t actTime, COSyncState syncState)
+{
+  uint8_t numRunning = 0;
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    if(StepDrive(iter, Drives[iter]->Update(actTime, syncState), actTime))
+      numRunning++;
+  }
+  return numRunning;
+}
+#endif
+
+void PrintResults(uint32_t actTime)
+{
+  COVirtualBusStats BusStats;
+  CORxStats RxStats;
+  COTxStats TxStats;
+  COBusStats CentralBusStats;
+  COTopTalker TopTalkers[3];
+  uint8_t numTopTalkers;
+  uint32_t SDORequests = 0;
+  uint32_t SimOverruns = 0;
+  uint32_t runTime = actTime - PhaseStartedAt;
+
+  Bus.GetStats(&BusStats);
+  MsgHandler.GetRxStats(&RxStats);
+  MsgHandler.GetTxStats(&TxStats);
+  MsgHandler.GetBusStats(&CentralBusStats);
+  numTopTalkers = MsgHandler.GetTopTalkers(TopTalkers, 3);
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    COSimNodeStats Stats;
+    SimDrives[iter]->Node.GetStats(&Stats);
+    SDORequests += Stats.NumSDORequests;
+    SimOverruns += Stats.NumTxOverruns;
+  }
+
+  Serial.print("run ");
+  Serial.print(runTime);
+  Serial.print(" ms, SYNC ");
+  Serial.print(BENCH_SYNC_MS);
+  Serial.print(" ms, loops ");
+  Serial.println(NumLoops);
+
+  Serial.print("central loop(): avg ");
+  Serial.print((double)LoopNs / NumLoops / 1000.0);
+  Serial.print(" us, max ");
+  Serial.print((double)MaxLoopNs / 1000.0);
+  Serial.print(" us, per drive ");
+  Serial.print((double)LoopNs / NumLoops / NumDrives / 1000.0, 3);
+  Serial.println(" us");
+
+  Serial.print("bus: frames ");
+  Serial.print(BusStats.NumFrames);
+  Serial.print(", load ");
+  Serial.print(100.0 * (double)BusStats.BusyNs / ((double)runTime * 1e6), 1);
+  Serial.println(" %");
+
+  Serial.print("central bus stats: load ");
+  Serial.print(CentralBusStats.MeanLoadPercent, 1);
+  Serial.print(" % (last ");
+  Serial.print(CentralBusStats.NumPeriods);
+  Serial.print(" x ");
+  Serial.print(CentralBusStats.PeriodMs);
+  Serial.print(" ms, peak ");
+  Serial.print(CentralBusStats.PeakLoadPercent, 1);
+  Serial.print(" %), Tx latency mean ");
+  Serial.print(CentralBusStats.MeanTxLatencyUs);
+  Serial.print(" us, max ");
+  Serial.print(CentralBusStats.MaxTxLatencyUs);
+  Serial.println(" us");
+  Serial.print("top talkers:");
+  for(uint8_t iter = 0; iter < numTopTalkers; iter++)
+  {
+    Serial.print(" ");
+    Serial.print(TopTalkers[iter].Dir == eCOTrafficRx ? "Rx " : "Tx ");
+    Serial.print(TopTalkers[iter].COBId, HEX);
+    Serial.print(": ");
+    Serial.print(TopTalkers[iter].Count.NumFrames);
+    Serial.print(" frames, ");
+    Serial.print(TopTalkers[iter].Count.NumBits);
+    Serial.print(" bits");
+  }
+  Serial.println();
+
+  Serial.print("central Rx: received ");
+  Serial.print(RxStats.NumRxMessages);
+  Serial.print(", dropped ");
+  Serial.print(RxStats.NumDroppedMessages);
+  Serial.print(", high water mark ");
+  Serial.print(RxStats.HighWaterMark);
+  Serial.print(", latency mean ");
+  Serial.print(RxStats.MeanLatencyUs);
+  Serial.print(" us, max ");
+  Serial.print(RxStats.MaxLatencyUs);
+  Serial.println(" us");
+
+  uint32_t maxGuardRoundTrip = 0;
+  uint32_t maxGuardQueueWait = 0;
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    if(Drives[iter]->Node.GetMaxGuardRoundTripUs() > maxGuardRoundTrip)
+      maxGuardRoundTrip = Drives[iter]->Node.GetMaxGuardRoundTripUs();
+    if(Drives[iter]->Node.GetMaxGuardQueueWaitUs() > maxGuardQueueWait)
+      maxGuardQueueWait = Drives[iter]->Node.GetMaxGuardQueueWaitUs();
+  }
+  Serial.print("guarding: round trip max ");
+  Serial.print(maxGuardRoundTrip);
+  Serial.print(" us, queue wait max ");
+  Serial.print(maxGuardQueueWait);
+  Serial.print(" us (startup ");
+  Serial.print(StartupGuardRoundTrip);
+  Serial.print(" us, ");
+  Serial.print(StartupGuardQueueWait);
+  Serial.println(" us)");
+
+  uint32_t SDORoundTrip[2] = {0xFFFFFFFF, 0};
+  uint32_t SDOTimeOut[2] = {0xFFFFFFFF, 0};
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    uint32_t roundTrip = Drives[iter]->Node.RWSDO.GetRoundTripUs();
+    uint32_t timeOut = Drives[iter]->Node.RWSDO.GetRespTimeOutUs();
+
+    if(roundTrip < SDORoundTrip[0])
+      SDORoundTrip[0] = roundTrip;
+    if(roundTrip > SDORoundTrip[1])
+      SDORoundTrip[1] = roundTrip;
+    if(timeOut < SDOTimeOut[0])
+      SDOTimeOut[0] = timeOut;
+    if(timeOut > SDOTimeOut[1])
+      SDOTimeOut[1] = timeOut;
+  }
+  Serial.print("SDO: round trip smoothed ");
+  Serial.print(SDORoundTrip[0]);
+  Serial.print(" ... ");
+  Serial.print(SDORoundTrip[1]);
+  Serial.print(" us, response time-out ");
+  Serial.print(SDOTimeOut[0]);
+  Serial.print(" ... ");
+  Serial.print(SDOTimeOut[1]);
+  Serial.println(" us");
+
+  Serial.print("central Tx: queued ");
+  Serial.print(TxStats.NumTxQueued - TxStatsAtStart.NumTxQueued);
+  Serial.print(", rejected ");
+  Serial.print(TxStats.NumTxRejected - TxStatsAtStart.NumTxRejected);
+  Serial.print(", high water mark ");
+  Serial.print(TxStats.HighWaterMark);
+  Serial.print(", SDO requests waiting max ");
+  Serial.println(TxStats.SDOHighWaterMark);
+
+  #if BENCH_SYNC_WINDOW_US
+  COSyncStats SyncStats;
+  uint32_t LateRxPDOs = 0;
+
+  SyncHandler.GetSyncStats(&SyncStats);
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+    LateRxPDOs += Drives[iter]->PDOHandler.GetLateRxPDOs();
+  Serial.print("sync RxPDOs: window ");
+  Serial.print(BENCH_SYNC_WINDOW_US);
+  Serial.print(" us, SYNCs ");
+  Serial.print(SyncStats.NumSyncs);
+  Serial.print(", RxPDOs due ");
+  Serial.print(SyncStats.NumSyncs * NumDrives * NumSyncRxPDOs);
+  Serial.print(", late ");
+  Serial.print(LateRxPDOs - LateRxPDOsAtStart);
+  Serial.print(", of them dropped by the Tx queue ");
+  Serial.println(TxStats.NumTxSyncDropped - TxStatsAtStart.NumTxSyncDropped);
+  #endif
+
+  Serial.print("drives: SDO requests ");
+  Serial.print(SDORequests);
+  Serial.print(", drives reset ");
+  Serial.print(NumDriveResets);
+  Serial.print(", Tx overruns ");
+  Serial.println(SimOverruns);
+
+  #if BENCH_SCHEDULED
+  COSchedStats SchedStats;
+
+  MsgHandler.GetScheduler()->GetStats(&SchedStats);
+  Serial.print("scheduler: runs ");
+  Serial.print(SchedStats.NumRuns);
+  Serial.print(", items run ");
+  Serial.print(SchedStats.NumItemsRun);
+  Serial.print(" (");
+  Serial.print(SchedStats.NumRuns ? (double)SchedStats.NumItemsRun / SchedStats.NumRuns : 0.0, 2);
+  Serial.print(" per run), max per run ");
+  Serial.print(SchedStats.MaxItemsPerRun);
+  Serial.print(", armed ");
+  Serial.println(SchedStats.NumArmed);
+  #endif
+
+  #if CO_PROBES
+  COProbeDump();
+  #endif
+  #if CO_TRACE
+  COTraceDump();
+  #endif
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.print("> Drive scale benchmark, drives: ");
+  Serial.println(NumDrives);
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    SimDrives[iter] = new COSim402Drive(&Bus, iter + 1);
+    if(iter & 0x01)
+      SimDrives[iter]->Node.SetSDORespDelay(BENCH_GATEWAY_DELAY_US);
+
+    Drives[iter] = new CO402Drive(iter + 1);
+    Drives[iter]->init(&MsgHandler);
+    Drives[iter]->Node.ConfigureGuarding(GuardTime, LiveTimeFactor);
+    //the actual values with each SYNC
+    Drives[iter]->PDOHandler.PresetTxPDOTransmission(0, 1);
+    Drives[iter]->PDOHandler.PresetTxPDOTransmission(1, 1);
+    #if BENCH_SYNC_WINDOW_US
+    for(uint8_t pdo = 0; pdo < NumSyncRxPDOs; pdo++)
+      Drives[iter]->PDOHandler.PresetRxPDOTransmission(pdo, 1);
+    #endif
+    //SDO responses queue up behind the SYNC traffic of the running drives
+    Drives[iter]->PDOHandler.SetPDOConfigTimeout(PDOConfigTimeout);
+    isEnabled[iter] = false;
+  }
+
+  MsgHandler.Open();
+
+  SyncHandler.init(&MsgHandler);
+  SyncHandler.SyncInterval = BENCH_SYNC_MS;
+  #if BENCH_SYNC_WINDOW_US
+  SyncHandler.SetSyncWindowUs(BENCH_SYNC_WINDOW_US);
+  SyncHandler.SetSyncCounterOverflow(SyncCounterOverflow);
+  #endif
+  SyncHandler.SetState(eSyncStateOperational);
+
+  #if BENCH_SCHEDULED
+  SyncHandler.Schedule();
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    pfunction_holder Cb;
+
+    Cb.callback = (pfunction_pointer_t)OnDriveUpdate;
+    Cb.op = (void *)(uintptr_t)iter;
+    Drives[iter]->Schedule(&Cb);
+  }
+  #endif
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+    SimDrives[iter]->PowerOn();
+
+  PhaseStartedAt = millis();
+}
+
+void loop()
+{
+  uint32_t actTime = millis();
+  auto startedAt = std::chrono::steady_clock::now();
+
+  #if BENCH_SCHEDULED
+  MsgHandler.Update(actTime);
+  //the new target speed is handed to the drives right away
+  if(AppliedSpeed != TargetSpeed)
+  {
+    AppliedSpeed = TargetSpeed;
+    for(uint8_t iter = 0; iter < NumDrives; iter++)
+    {
+      if(isEnabled[iter])
+        Drives[iter]->SetTargetSpeed(TargetSpeed);
+    }
+  }
+  uint8_t numRunning = NumEnabled;
+  #else
+  MsgHandler.Update(actTime);
+  COSyncState syncState = SyncHandler.Update(actTime);
+  uint8_t numRunning = UpdateDrives(actTime, syncState);
+  #endif
+
+  uint64_t usedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startedAt).count();
+
+  switch(Phase)
+  {
+    case eBenchStartup:
+      if(numRunning == NumDrives)
+      {
+        Serial.print("first drive enabled after ");
+        Serial.print(FirstEnabledAt - PhaseStartedAt);
+        Serial.print(" ms, all drives enabled after ");
+        Serial.print(actTime - PhaseStartedAt);
+        Serial.println(" ms");
+
+        Phase = eBenchRun;
+        PhaseStartedAt = actTime;
+        TargetSpeedSetAt = actTime;
+        Bus.ResetStats();
+        MsgHandler.ResetRxStats();
+        MsgHandler.ResetBusStats();
+        MsgHandler.GetTxStats(&TxStatsAtStart);
+        SyncHandler.ResetSyncStats();
+        for(uint8_t iter = 0; iter < NumDrives; iter++)
+        {
+          LateRxPDOsAtStart += Drives[iter]->PDOHandler.GetLateRxPDOs();
+          if(Drives[iter]->Node.GetMaxGuardRoundTripUs() > StartupGuardRoundTrip)
+            StartupGuardRoundTrip = Drives[iter]->Node.GetMaxGuardRoundTripUs();
+          if(Drives[iter]->Node.GetMaxGuardQueueWaitUs() > StartupGuardQueueWait)
+            StartupGuardQueueWait = Drives[iter]->Node.GetMaxGuardQueueWaitUs();
+          Drives[iter]->Node.ResetGuardStats();
+        }
+        #if BENCH_SCHEDULED
+        MsgHandler.GetScheduler()->ResetStats();
+        #endif
+      }
+      else if((actTime - PhaseStartedAt) > StartupTimeoutMs)
+      {
+        Serial.print("startup failed, running: ");
+        Serial.println(numRunning);
+        for(uint8_t iter = 0; iter < NumDrives; iter++)
+        {
+          if(!isEnabled[iter])
+          {
+            Serial.print("drive ");
+            Serial.print(iter + 1);
+            Serial.print(": node state ");
+            Serial.print(Drives[iter]->Node.GetSDOState());
+            Serial.print(", PDOs configured ");
+            Serial.print(Drives[iter]->isPDOsConfigured);
+            Serial.print(", SW ");
+            Serial.print(Drives[iter]->GetStatusWord(), HEX);
+            Serial.print(", simulated NMT ");
+            Serial.print(SimDrives[iter]->Node.GetState());
+            Serial.print(", 402 ");
+            Serial.println(SimDrives[iter]->GetState());
+          }
+        }
+        PrintResults(actTime);
+        exit(1);
+      }
+      break;
+    case eBenchRun:
+      NumLoops++;
+      LoopNs += usedNs;
+      if(usedNs > MaxLoopNs)
+        MaxLoopNs = usedNs;
+
+      if((actTime - TargetSpeedSetAt) >= 500)
+      {
+        TargetSpeed = -TargetSpeed;
+        TargetSpeedSetAt = actTime;
+      }
+
+      if((actTime - PhaseStartedAt) >= BENCH_RUN_MS)
+      {
+        PrintResults(actTime);
+        Phase = eBenchDone;
+      }
+      break;
+    default:
+      fflush(stdout);
+      exit(0);
+      break;
+  }
+}
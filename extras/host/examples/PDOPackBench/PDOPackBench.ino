@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * PDOPackBench - host build only
+ *
+ * packs and unpacks the payload of some typical PDO mappings
+ * - using the former loop over the mapped entries with a switch on
+ *   the length of each one, byte by byte
+ * - using the copy plans of the COPDOHandler
+ * - using the pack / unpack of a COPDOMap, as preset by the CO402Drive
+ *   and the CO401Node
+ * checks all give the same result and prints the host CPU cycles
+ * (x86: TSC) and the time per PDO, for each mapping on it's own and
+ * for all of them in turn as with a number of different nodes.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW COPDOMap added
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <COPDOHandler.h>
+
+#include <chrono>
+#include <stdlib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//---- local definitions -----------------------------------------------
+
+const uint32_t NumRepeats = 2000000;
+
+//the objects of a CiA 402 drive and a 401 node
+int32_t ActPos;
+uint16_t SW;
+int8_t ModesOfOpDisp;
+int32_t ActSpeed;
+int16_t ActTorque;
+int32_t TargetPos;
+uint16_t CW;
+int8_t ModesOfOp;
+uint8_t DigIn[8];
+
+ODEntry32 OdActPos = {0x6064, 0x00, (uint32_t *)&ActPos, 4};
+ODEntry16 OdSW = {0x6041, 0x00, &SW, 2};
+ODEntry08 OdModesOfOpDisp = {0x6061, 0x00, (uint8_t *)&ModesOfOpDisp, 1};
+ODEntry32 OdActSpeed = {0x606C, 0x00, (uint32_t *)&ActSpeed, 4};
+ODEntry16 OdActTorque = {0x6077, 0x00, (uint16_t *)&ActTorque, 2};
+ODEntry32 OdTargetPos = {0x607A, 0x00, (uint32_t *)&TargetPos, 4};
+ODEntry16 OdCW = {0x6040, 0x00, &CW, 2};
+ODEntry08 OdModesOfOp = {0x6060, 0x00, (uint8_t *)&ModesOfOp, 1};
+ODEntry08 OdDigIn[8] = {
+  {0x6000, 0x01, &DigIn[0], 1}, {0x6000, 0x02, &DigIn[1], 1},
+  {0x6000, 0x03, &DigIn[2], 1}, {0x6000, 0x04, &DigIn[3], 1},
+  {0x6000, 0x05, &DigIn[4], 1}, {0x6000, 0x06, &DigIn[5], 1},
+  {0x6000, 0x07, &DigIn[6], 1}, {0x6000, 0x08, &DigIn[7], 1}
+};
+
+//the same mappings as COPDOMap
+typedef COPDOMap<COPDOObject<0x6064, 0x00, int32_t>, COPDOObject<0x6041, 0x00, uint16_t>,
+                 COPDOObject<0x6061, 0x00, int8_t> > TxPDO1Map;
+typedef COPDOMap<COPDOObject<0x606C, 0x00, int32_t>, COPDOObject<0x6077, 0x00, int16_t> > TxPDO2Map;
+typedef COPDOMap<COPDOObject<0x607A, 0x00, int32_t>, COPDOObject<0x6040, 0x00, uint16_t>,
+                 COPDOObject<0x6060, 0x00, int8_t> > RxPDO1Map;
+typedef COPDOMap<COPDOObject<0x6000, 0x01, uint8_t>, COPDOObject<0x6000, 0x02, uint8_t>,
+                 COPDOObject<0x6000, 0x03, uint8_t>, COPDOObject<0x6000, 0x04, uint8_t>,
+                 COPDOObject<0x6000, 0x05, uint8_t>, COPDOObject<0x6000, 0x06, uint8_t>,
+                 COPDOObject<0x6000, 0x07, uint8_t>, COPDOObject<0x6000, 0x08, uint8_t> > DigInMap;
+
+typedef enum BenchMode {
+  eBenchSwitch,
+  eBenchPlan,
+  eBenchMap
+} BenchMode;
+
+const char *ModeNames[] = {"  switch:    pack ", "  copy plan: pack ", "  COPDOMap:  pack "};
+
+typedef struct BenchMapping {
+  const char *Name;
+  PDOMapping Mapping;
+  PDOCopyPlan Plan;
+  //the COPDOMap
+  uint8_t NrEntries;
+  const uint32_t *MappingWords;
+  PDOPackFunction Pack;
+  PDOUnpackFunction Unpack;
+  PDOCopyPlan MapPlan;
+} BenchMapping;
+
+#define BENCH_MAP(Map) {}, Map::NrEntries, Map::MappingWords, &Map::Pack, &Map::Unpack, {}
+
+BenchMapping Mappings[] = {
+  {"402 TxPDO1 pos+SW+mode", {3, {(ODEntry *)&OdActPos, (ODEntry *)&OdSW, (ODEntry *)&OdModesOfOpDisp}}, BENCH_MAP(TxPDO1Map)},
+  {"402 TxPDO2 speed+torque", {2, {(ODEntry *)&OdActSpeed, (ODEntry *)&OdActTorque}}, BENCH_MAP(TxPDO2Map)},
+  {"402 RxPDO1 pos+CW+mode", {3, {(ODEntry *)&OdTargetPos, (ODEntry *)&OdCW, (ODEntry *)&OdModesOfOp}}, BENCH_MAP(RxPDO1Map)},
+  {"401 8 digital inputs", {8, {(ODEntry *)&OdDigIn[0], (ODEntry *)&OdDigIn[1], (ODEntry *)&OdDigIn[2], (ODEntry *)&OdDigIn[3],
+                               (ODEntry *)&OdDigIn[4], (ODEntry *)&OdDigIn[5], (ODEntry *)&OdDigIn[6], (ODEntry *)&OdDigIn[7]}}, BENCH_MAP(DigInMap)}
+};
+const uint8_t NumMappings = sizeof(Mappings) / sizeof(BenchMapping);
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//the former TransmitPdo(): a switch on the length of each entry
+__attribute__((noinline)) uint8_t SwitchPack(PDOMapping *Mapping, uint8_t *Payload)
+{
+  uint8_t writeIdx = 0;
+
+  for(uint8_t iter = 0; iter < Mapping->NrEntries; iter++)
+  {
+    switch((Mapping->Entries[iter])->len)
+    {
+      case 1:
+        Payload[writeIdx++] = *(((ODEntry08 *)(Mapping->Entries[iter]))->Value);
+        break;
+      case 2:
+      {
+        uint16_t tempValue = *(((ODEntry16 *)(Mapping->Entries[iter]))->Value);
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        tempValue = tempValue >> 8;
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        break;
+      }
+      case 4:
+      {
+        uint32_t tempValue = *(((ODEntry32 *)(Mapping->Entries[iter]))->Value);
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        tempValue = tempValue >> 8;
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        tempValue = tempValue >> 8;
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        tempValue = tempValue >> 8;
+        Payload[writeIdx++] = (uint8_t)tempValue;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return writeIdx;
+}
+
+//the former OnRxHandler()
+__attribute__((noinline)) void SwitchUnpack(PDOMapping *Mapping, const uint8_t *Payload)
+{
+  uint8_t readIdx = 0;
+
+  for(uint8_t iter = 0; iter < Mapping->NrEntries; iter++)
+  {
+    switch((Mapping->Entries[iter])->len)
+    {
+      case 1:
+        *(((ODEntry08 *)(Mapping->Entries[iter]))->Value) = Payload[readIdx++];
+        break;
+      case 2:
+      {
+        uint16_t tempValue = (uint16_t)Payload[readIdx++];
+        tempValue |= (uint16_t)((Payload[readIdx++]) * 256);
+        *(((ODEntry16 *)(Mapping->Entries[iter]))->Value) = tempValue;
+        break;
+      }
+      case 4:
+      {
+        uint32_t tempValue = (uint32_t)Payload[readIdx++];
+        tempValue |= (uint32_t)((Payload[readIdx++]) * 256);
+        tempValue |= (uint32_t)((Payload[readIdx++]) * 256 * 256);
+        tempValue |= (uint32_t)((Payload[readIdx++]) * 256 * 256 * 256);
+        *(((ODEntry32 *)(Mapping->Entries[iter]))->Value) = tempValue;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+uint64_t ReadCycles()
+{
+  #if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+  #else
+  return 0;
+  #endif
+}
+
+void SetValues(uint32_t seed)
+{
+  ActPos = (int32_t)(seed * 2654435761u);
+  SW = (uint16_t)(seed * 7);
+  ModesOfOpDisp = (int8_t)seed;
+  ActSpeed = -(int32_t)seed * 3;
+  ActTorque = (int16_t)(seed * 5);
+  TargetPos = (int32_t)seed * 11;
+  CW = (uint16_t)(seed + 0x0F);
+  ModesOfOp = (int8_t)(seed >> 3);
+  for(uint8_t iter = 0; iter < 8; iter++)
+    DigIn[iter] = (uint8_t)(seed + iter);
+}
+
+//pack and unpack NumRepeats times taking the mappings in turn,
+//print cycles and ns per PDO
+void Measure(BenchMapping **Benches, uint8_t NumBenches, BenchMode Mode)
+{
+  uint8_t Payloads[16][8];
+  uint8_t Sink = 0;
+  uint8_t next = 0;
+
+  for(uint8_t iter = 0; iter < 16; iter++)
+  {
+    for(uint8_t byteIdx = 0; byteIdx < 8; byteIdx++)
+      Payloads[iter][byteIdx] = (uint8_t)(iter * 8 + byteIdx);
+  }
+
+  auto startedAt = std::chrono::steady_clock::now();
+  uint64_t startCycles = ReadCycles();
+
+  for(uint32_t iter = 0; iter < NumRepeats; iter++)
+  {
+    uint8_t *Payload = Payloads[iter & 0x0F];
+
+    //as in COPDOHandler::TransmitPdo()
+    if(Mode == eBenchMap)
+      Benches[next]->MapPlan.Pack(Benches[next]->Mapping.Entries, Payload);
+    else if(Mode == eBenchPlan)
+      COPDOHandler::PackPayload(&Benches[next]->Plan, Payload);
+    else
+      SwitchPack(&Benches[next]->Mapping, Payload);
+    if(++next == NumBenches)
+      next = 0;
+  }
+  uint64_t packCycles = ReadCycles() - startCycles;
+  auto packedAt = std::chrono::steady_clock::now();
+  startCycles = ReadCycles();
+
+  for(uint32_t iter = 0; iter < NumRepeats; iter++)
+  {
+    const uint8_t *Payload = Payloads[iter & 0x0F];
+
+    if(Mode == eBenchMap)
+      Benches[next]->MapPlan.Unpack(Benches[next]->Mapping.Entries, Payload);
+    else if(Mode == eBenchPlan)
+      COPDOHandler::UnpackPayload(&Benches[next]->Plan, Payload);
+    else
+      SwitchUnpack(&Benches[next]->Mapping, Payload);
+    if(++next == NumBenches)
+      next = 0;
+  }
+  uint64_t unpackCycles = ReadCycles() - startCycles;
+  auto unpackedAt = std::chrono::steady_clock::now();
+
+  for(uint8_t iter = 0; iter < 16; iter++)
+    Sink += Payloads[iter][iter & 0x07];
+  if(Sink == 0x5A)
+    Serial.print("");
+
+  double packNs = std::chrono::duration<double, std::nano>(packedAt - startedAt).count();
+  double unpackNs = std::chrono::duration<double, std::nano>(unpackedAt - packedAt).count();
+
+  Serial.print(ModeNames[Mode]);
+  Serial.print((double)packCycles / NumRepeats, 1);
+  Serial.print(" cycles ");
+  Serial.print(packNs / NumRepeats, 2);
+  Serial.print(" ns, unpack ");
+  Serial.print((double)unpackCycles / NumRepeats, 1);
+  Serial.print(" cycles ");
+  Serial.print(unpackNs / NumRepeats, 2);
+  Serial.println(" ns");
+}
+
+//all ways have to give the same payload and the same values
+bool Check(BenchMapping *Bench)
+{
+  uint8_t SwitchPayload[8];
+  uint8_t PlanPayload[8];
+  uint8_t MapPayload[8];
+
+  for(uint32_t seed = 1; seed < 100; seed++)
+  {
+    SetValues(seed);
+    uint8_t len = SwitchPack(&Bench->Mapping, SwitchPayload);
+    COPDOHandler::PackPayload(&Bench->Plan, PlanPayload);
+    Bench->MapPlan.Pack(Bench->Mapping.Entries, MapPayload);
+    if((len != Bench->Plan.Length) || (memcmp(SwitchPayload, PlanPayload, len) != 0)
+       || (memcmp(SwitchPayload, MapPayload, len) != 0))
+      return false;
+
+    SetValues(seed + 1000);
+    Bench->MapPlan.Unpack(Bench->Mapping.Entries, SwitchPayload);
+    uint8_t MapUnpacked[8];
+    COPDOHandler::PackPayload(&Bench->Plan, MapUnpacked);
+
+    SetValues(seed + 1000);
+    COPDOHandler::UnpackPayload(&Bench->Plan, SwitchPayload);
+    uint8_t PlanUnpacked[8];
+    COPDOHandler::PackPayload(&Bench->Plan, PlanUnpacked);
+
+    SetValues(seed + 1000);
+    SwitchUnpack(&Bench->Mapping, SwitchPayload);
+    uint8_t SwitchUnpacked[8];
+    SwitchPack(&Bench->Mapping, SwitchUnpacked);
+    if((memcmp(PlanUnpacked, SwitchUnpacked, len) != 0) || (memcmp(MapUnpacked, SwitchUnpacked, len) != 0))
+      return false;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("> PDO pack benchmark");
+
+  BenchMapping *All[NumMappings];
+
+  for(uint8_t iter = 0; iter < NumMappings; iter++)
+  {
+    BenchMapping *Bench = &Mappings[iter];
+
+    COPDOHandler::CompileCopyPlan(&Bench->Mapping, &Bench->Plan);
+    COPDOHandler::CompileCopyPlan(&Bench->Mapping, &Bench->MapPlan);
+    if(!COPDOHandler::UseMap(&Bench->Mapping, &Bench->MapPlan, Bench->NrEntries, Bench->MappingWords,
+                             Bench->Pack, Bench->Unpack))
+    {
+      Serial.println("  entries don't match the COPDOMap");
+      exit(1);
+    }
+
+    Serial.print(Bench->Name);
+    Serial.print(": ");
+    Serial.print(Bench->Plan.Length);
+    Serial.print(" bytes, ");
+    Serial.print(Bench->Mapping.NrEntries);
+    Serial.print(" entries, ");
+    Serial.print(Bench->Plan.NrRuns);
+    Serial.println(" runs");
+
+    if(!Check(Bench))
+    {
+      Serial.println("  payloads differ");
+      exit(1);
+    }
+    Measure(&Bench, 1, eBenchSwitch);
+    Measure(&Bench, 1, eBenchPlan);
+    Measure(&Bench, 1, eBenchMap);
+    All[iter] = Bench;
+  }
+
+  //all mappings in turn as with a number of different nodes
+  Serial.println("all mappings in turn:");
+  Measure(All, NumMappings, eBenchSwitch);
+  Measure(All, NumMappings, eBenchPlan);
+  Measure(All, NumMappings, eBenchMap);
+  fflush(stdout);
+  exit(0);
+}
+
+void loop()
+{
+}
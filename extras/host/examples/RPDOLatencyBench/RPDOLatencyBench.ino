@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * RPDOLatencyBench - host build only
+ *
+ * the central device sends a RPDO to each of 8 simulated drives
+ * every 2 ms, first without SDO traffic, then while it reads objects
+ * of all drives by SDO as fast as they answer.
+ * A listener on the bus takes the time each RPDO was received -
+ * the time it was handed to SendMsg() is in it's payload - and
+ * prints the RPDO latency, the number of SDO frames and the bus
+ * load of both phases. The Tx queue sends RPDOs before SDOs, so
+ * the latency should not depend on the SDO load.
+ * Run with --sim, e.g. --loop-us 100.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <COSDOHandler.h>
+#include <COVirtualBus.h>
+#include <COSim402Drive.h>
+
+//---- local definitions -----------------------------------------------
+
+const uint8_t NumDrives = 8;
+const uint8_t NumObjects = 4;
+const uint32_t RPDOPeriodUs = 2000;
+const uint32_t PhaseUs = 2000000;
+
+typedef enum BenchPhase {
+  eBenchIdle,
+  eBenchSDOLoad,
+  eBenchDone
+} BenchPhase;
+
+typedef struct PhaseStats {
+  uint32_t NumRPDOs;
+  uint32_t NumRefused;
+  uint64_t SumLatencyUs;
+  uint32_t MaxLatencyUs;
+  uint32_t NumSDOFrames;
+} PhaseStats;
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COVirtualCAN ListenerCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+
+COSim402Drive *SimDrives[NumDrives];
+COSDOHandler SDO[NumDrives];
+
+char Strings[NumDrives][32];
+uint32_t Values[NumDrives][NumObjects];
+ODEntry Objects[NumDrives][NumObjects];
+ODEntry *ObjectList[NumDrives][NumObjects];
+
+const uint16_t ObjectIdx[NumObjects] = {0x1000, 0x1008, 0x6041, 0x6064};
+const uint32_t ObjectLen[NumObjects] = {4, 32, 2, 4};
+
+BenchPhase Phase = eBenchIdle;
+PhaseStats Stats[eBenchDone];
+uint32_t PhaseStartedAt = 0;
+uint32_t LastRPDOAt = 0;
+uint32_t NumReads = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//every frame on the bus - "interrupt" context
+void OnListenerEvent(void *op, void *p)
+{
+  can_callback_args_t *args = (can_callback_args_t *)p;
+  (void)op;
+
+  if((args->event != CAN_EVENT_RX_COMPLETE) || (Phase == eBenchDone))
+    return;
+
+  uint32_t Id = args->frame.id;
+
+  if((Id & 0x780) == eCANRPDO1)
+  {
+    uint32_t sentAt;
+    memcpy(&sentAt, args->frame.data, sizeof(sentAt));
+    uint32_t latency = micros() - sentAt;
+
+    Stats[Phase].NumRPDOs++;
+    Stats[Phase].SumLatencyUs += latency;
+    if(latency > Stats[Phase].MaxLatencyUs)
+      Stats[Phase].MaxLatencyUs = latency;
+  }
+  else if(((Id & 0x780) == eCANSdoReq) || ((Id & 0x780) == eCANSdoResp))
+    Stats[Phase].NumSDOFrames++;
+}
+
+void SendRPDOs()
+{
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    CANMsg msg;
+    uint32_t now = micros();
+
+    msg.Id = eCANRPDO1 + iter + 1;
+    msg.len = 8;
+    msg.isRTR = false;
+    msg.serviceType = eCANRPDO1;
+    memset(msg.payload, 0, sizeof(msg.payload));
+    memcpy(msg.payload, &now, sizeof(now));
+    if(!MsgHandler.SendMsg(&msg))
+      Stats[Phase].NumRefused++;
+  }
+}
+
+//the len of an entry is updated to the length read
+void RestoreLengths(uint8_t drive)
+{
+  for(uint8_t iter = 0; iter < NumObjects; iter++)
+    Objects[drive][iter].len = ObjectLen[iter];
+}
+
+void PrintPhase(const char *name, BenchPhase thisPhase, COVirtualBusStats *BusStats)
+{
+  PhaseStats *PS = &Stats[thisPhase];
+
+  Serial.print(name);
+  Serial.print(": RPDOs ");
+  Serial.print(PS->NumRPDOs);
+  Serial.print(", refused ");
+  Serial.print(PS->NumRefused);
+  Serial.print(", latency mean ");
+  Serial.print(PS->NumRPDOs ? (uint32_t)(PS->SumLatencyUs / PS->NumRPDOs) : 0);
+  Serial.print(" us, max ");
+  Serial.print(PS->MaxLatencyUs);
+  Serial.print(" us, SDO frames ");
+  Serial.print(PS->NumSDOFrames);
+  Serial.print(", bus load ");
+  Serial.print((double)BusStats->BusyNs / (PhaseUs * 10.0), 1);
+  Serial.println(" %");
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("> RPDO latency under SDO load benchmark");
+
+  pfunction_holder Cb;
+  Cb.callback = (pfunction_pointer_t)OnListenerEvent;
+  Cb.op = NULL;
+  ListenerCAN.set_callback(&Cb);
+  ListenerCAN.begin();
+
+  MsgHandler.Open();
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    uint8_t nodeId = iter + 1;
+
+    for(uint8_t obj = 0; obj < NumObjects; obj++)
+    {
+      Objects[iter][obj].Idx = ObjectIdx[obj];
+      Objects[iter][obj].SubIdx = 0x00;
+      Objects[iter][obj].Value = (ObjectIdx[obj] == 0x1008) ? (void *)Strings[iter] : (void *)&Values[iter][obj];
+      ObjectList[iter][obj] = &Objects[iter][obj];
+    }
+    RestoreLengths(iter);
+
+    SDO[iter].init(&MsgHandler, nodeId, MsgHandler.RegisterNode(nodeId));
+    SimDrives[iter] = new COSim402Drive(&Bus, nodeId);
+    SimDrives[iter]->PowerOn();
+  }
+  //the boot-up messages
+  delay(2);
+
+  memset(Stats, 0, sizeof(Stats));
+  Bus.ResetStats();
+  PhaseStartedAt = micros();
+  LastRPDOAt = PhaseStartedAt;
+}
+
+void loop()
+{
+  uint32_t now = micros();
+
+  MsgHandler.Update(millis());
+
+  if((now - LastRPDOAt) >= RPDOPeriodUs)
+  {
+    LastRPDOAt += RPDOPeriodUs;
+    SendRPDOs();
+  }
+
+  if(Phase == eBenchSDOLoad)
+  {
+    for(uint8_t iter = 0; iter < NumDrives; iter++)
+    {
+      SDO[iter].SetActTime(millis());
+      COSDOCommStates state = SDO[iter].ReadObjects(ObjectList[iter], NumObjects);
+      if(state == eCO_SDODone)
+      {
+        NumReads++;
+        RestoreLengths(iter);
+      }
+      else if((state == eCO_SDOError) || (state == eCO_SDOTimeout))
+      {
+        Serial.println("SDO failed");
+        exit(1);
+      }
+    }
+  }
+
+  if((now - PhaseStartedAt) >= PhaseUs)
+  {
+    COVirtualBusStats BusStats;
+
+    Bus.GetStats(&BusStats);
+    if(Phase == eBenchIdle)
+      PrintPhase("no SDO load", Phase, &BusStats);
+    else
+    {
+      PrintPhase("SDO load", Phase, &BusStats);
+      Serial.print("objects read by SDO: ");
+      Serial.println(NumReads * NumObjects);
+    }
+    Phase = (BenchPhase)(Phase + 1);
+    if(Phase == eBenchDone)
+    {
+      fflush(stdout);
+      exit(0);
+    }
+    Bus.ResetStats();
+    PhaseStartedAt = now;
+  }
+}
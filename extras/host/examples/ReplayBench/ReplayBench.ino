@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * ReplayBench - host build only
+ *
+ * the central device with BENCH_NUM_DRIVES CiA 402 drives, which are
+ * booted, configured, enabled in PV mode and run for BENCH_RUN_MS.
+ *
+ * Built as is, the drives are simulated (COSim402Drive) and all
+ * frames are captured by a COCapture into BENCH_CAPTURE_FILE in the
+ * candump -L format (-DBENCH_CAPTURE_ASC for the ASC format).
+ *
+ * Built with -DBENCH_REPLAY_FILE=\"file\" there are no simulated
+ * drives: the received frames of the capture are replayed by a
+ * COReplay with their original timing, the same central device runs
+ * against them. Prints the frames sent by the central device, which
+ * match the capture as long as the central device behaves the same.
+ * Then all frames are pumped through the Rx handler of the
+ * COMsgHandler as fast as possible and dispatched by it's Update() -
+ * prints the host CPU time per frame.
+ *
+ *   g++ ... ReplayBench.ino ... -o capture && ./capture --sim --loop-us 1000
+ *   g++ ... -DBENCH_REPLAY_FILE=\"ReplayBench.log\" ReplayBench.ino ... -o replay
+ *   ./replay --sim --loop-us 1000
+ *
+ * Built as any sketch of the host build (see README) together with the
+ * sources of CO402Drive.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <CO402Drive.h>
+#include <COSyncHandler.h>
+#include <COVirtualBus.h>
+#include <COSim402Drive.h>
+#include <COCapture.h>
+#include <COReplay.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+//---- local definitions -----------------------------------------------
+
+#ifndef BENCH_NUM_DRIVES
+#define BENCH_NUM_DRIVES 2
+#endif
+
+#ifndef BENCH_RUN_MS
+#define BENCH_RUN_MS 1000
+#endif
+
+#ifndef BENCH_CAPTURE_FILE
+#define BENCH_CAPTURE_FILE "ReplayBench.log"
+#endif
+
+#ifdef BENCH_CAPTURE_ASC
+const COCaptureFormat CaptureFormat = eCOCaptureASC;
+#else
+const COCaptureFormat CaptureFormat = eCOCaptureCandump;
+#endif
+
+const uint8_t NumDrives = BENCH_NUM_DRIVES;
+static_assert((NumDrives > 0) && (NumDrives <= MsgHandler_MaxNodes), "build with -DCO_MAX_NODES >= BENCH_NUM_DRIVES");
+
+const uint8_t MasterNodeId = 0x7F;
+const uint16_t GuardTime = 100;
+const uint8_t LiveTimeFactor = 3;
+const uint32_t StartupTimeoutMs = 10000;
+const uint8_t SyncIntervalMs = 10;
+//the frames pumped per Update() - the Rx buffer takes NumRxBuffers
+const uint8_t PumpFrames = 16;
+
+typedef enum BenchPhase {
+  eBenchStartup,
+  eBenchRun,
+  eBenchDone
+} BenchPhase;
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+
+COSyncHandler SyncHandler(MasterNodeId);
+
+CO402Drive *Drives[NumDrives];
+bool isEnabled[NumDrives];
+
+#ifdef BENCH_REPLAY_FILE
+COReplay Player(&Bus);
+#else
+COSim402Drive *SimDrives[NumDrives];
+COCapture Capture;
+FILE *CaptureFile = NULL;
+#endif
+
+BenchPhase Phase = eBenchStartup;
+uint32_t PhaseStartedAt = 0;
+int32_t TargetSpeed = 1000;
+uint32_t TargetSpeedSetAt = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+uint8_t UpdateDrives(uint32_t actTime, COSyncState syncState)
+{
+  uint8_t numRunning = 0;
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    NMTNodeState state = Drives[iter]->Update(actTime, syncState);
+
+    if(state == eNMTStatePreOp)
+    {
+      isEnabled[iter] = false;
+      if(Drives[iter]->isPDOsConfigured)
+        Drives[iter]->autoEnable = true;
+    }
+    else if(state == eNMTStateOperational)
+    {
+      if(!isEnabled[iter])
+      {
+        if((Drives[iter]->SetOpMode(OpModePV) == eCO_DriveDone) && (Drives[iter]->Enable() == eCO_DriveDone))
+          isEnabled[iter] = true;
+      }
+      else
+      {
+        Drives[iter]->SetTargetSpeed(TargetSpeed);
+        numRunning++;
+      }
+    }
+  }
+  return numRunning;
+}
+
+#ifndef BENCH_REPLAY_FILE
+void WriteCapture()
+{
+  char Line[CaptureLineLen];
+
+  while(Capture.ReadLine(CaptureFormat, Line, sizeof(Line)))
+    fprintf(CaptureFile, "%s\n", Line);
+}
+#endif
+
+void PrintResults(uint32_t actTime)
+{
+  COTxStats TxStats;
+  CORxStats RxStats;
+
+  MsgHandler.GetTxStats(&TxStats);
+  MsgHandler.GetRxStats(&RxStats);
+
+  Serial.print("central Rx: received ");
+  Serial.print(RxStats.NumRxMessages);
+  Serial.print(", dropped ");
+  Serial.println(RxStats.NumDroppedMessages);
+  Serial.print("central Tx: queued ");
+  Serial.print(TxStats.NumTxQueued);
+  Serial.print(", rejected ");
+  Serial.println(TxStats.NumTxRejected);
+
+  #ifdef BENCH_REPLAY_FILE
+  COBusStats BusStats;
+
+  MsgHandler.GetBusStats(&BusStats);
+  uint32_t numSent = 0;
+  for(uint8_t iter = 0; iter < NumCOServices; iter++)
+    numSent += BusStats.Service[eCOTrafficTx][iter].NumFrames;
+
+  Serial.print("replay: frames replayed ");
+  Serial.print(Player.GetNumReplayed());
+  Serial.print(", sent by the central device ");
+  Serial.print(numSent);
+  Serial.print(" (capture: ");
+  Serial.print(Player.GetNumTxFrames());
+  Serial.println(")");
+  #else
+  WriteCapture();
+  Serial.print("capture: frames ");
+  Serial.print(Capture.GetNumCaptured());
+  Serial.print(", dropped ");
+  Serial.print(Capture.GetNumDropped());
+  Serial.print(" -> ");
+  Serial.println(BENCH_CAPTURE_FILE);
+  #endif
+}
+
+#ifdef BENCH_REPLAY_FILE
+void RunFastReplay()
+{
+  CORxStats RxStats;
+  uint32_t numPumped = 0;
+
+  MsgHandler.ResetRxStats();
+  Player.Rewind();
+  auto startedAt = std::chrono::steady_clock::now();
+
+  while(!Player.IsDone())
+  {
+    numPumped += Player.Pump(&MsgHandler, PumpFrames);
+    MsgHandler.Update(millis());
+  }
+
+  uint64_t usedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startedAt).count();
+
+  MsgHandler.GetRxStats(&RxStats);
+  Serial.print("fast replay: frames ");
+  Serial.print(numPumped);
+  Serial.print(", dispatched ");
+  Serial.print(RxStats.NumProcessedMessages);
+  Serial.print(", dropped ");
+  Serial.print(RxStats.NumDroppedMessages);
+  Serial.print(", ");
+  Serial.print(numPumped ? (double)usedNs / numPumped : 0.0, 1);
+  Serial.println(" ns per frame");
+}
+#endif
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.print("> Replay benchmark, drives: ");
+  Serial.println(NumDrives);
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    #ifndef BENCH_REPLAY_FILE
+    SimDrives[iter] = new COSim402Drive(&Bus, iter + 1);
+    #endif
+
+    Drives[iter] = new CO402Drive(iter + 1);
+    Drives[iter]->init(&MsgHandler);
+    Drives[iter]->Node.ConfigureGuarding(GuardTime, LiveTimeFactor);
+    Drives[iter]->PDOHandler.PresetTxPDOTransmission(0, 1);
+    Drives[iter]->PDOHandler.PresetTxPDOTransmission(1, 1);
+    isEnabled[iter] = false;
+  }
+
+  MsgHandler.Open();
+
+  SyncHandler.init(&MsgHandler);
+  SyncHandler.SyncInterval = SyncIntervalMs;
+  SyncHandler.SetState(eSyncStateOperational);
+
+  #ifdef BENCH_REPLAY_FILE
+  if(!Player.Load(BENCH_REPLAY_FILE))
+  {
+    Serial.print("can't load ");
+    Serial.println(BENCH_REPLAY_FILE);
+    exit(1);
+  }
+  Player.Start();
+  Serial.print("replay: ");
+  Serial.print(Player.GetNumFrames());
+  Serial.print(" frames, sent by the central device ");
+  Serial.print(Player.GetNumTxFrames());
+  Serial.print(", ");
+  Serial.print((uint32_t)(Player.GetDurationUs() / 1000));
+  Serial.println(" ms");
+  #else
+  CaptureFile = fopen(BENCH_CAPTURE_FILE, "w");
+  if(CaptureFile == NULL)
+  {
+    Serial.print("can't write ");
+    Serial.println(BENCH_CAPTURE_FILE);
+    exit(1);
+  }
+  char Header[CaptureLineLen];
+  if(COCapture::FormatHeader(CaptureFormat, Header, sizeof(Header)) > 0)
+    fprintf(CaptureFile, "%s\n", Header);
+  MsgHandler.SetCapture(&Capture);
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+    SimDrives[iter]->PowerOn();
+  #endif
+
+  PhaseStartedAt = millis();
+}
+
+void loop()
+{
+  uint32_t actTime = millis();
+
+  MsgHandler.Update(actTime);
+  COSyncState syncState = SyncHandler.Update(actTime);
+  uint8_t numRunning = UpdateDrives(actTime, syncState);
+
+  #ifndef BENCH_REPLAY_FILE
+  WriteCapture();
+  #endif
+
+  switch(Phase)
+  {
+    case eBenchStartup:
+      if(numRunning == NumDrives)
+      {
+        Serial.print("all drives enabled after ");
+        Serial.print(actTime - PhaseStartedAt);
+        Serial.println(" ms");
+
+        Phase = eBenchRun;
+        PhaseStartedAt = actTime;
+        TargetSpeedSetAt = actTime;
+      }
+      else if((actTime - PhaseStartedAt) > StartupTimeoutMs)
+      {
+        Serial.print("startup failed, running: ");
+        Serial.println(numRunning);
+        PrintResults(actTime);
+        Phase = eBenchDone;
+      }
+      break;
+    case eBenchRun:
+      if((actTime - TargetSpeedSetAt) >= 500)
+      {
+        TargetSpeed = -TargetSpeed;
+        TargetSpeedSetAt = actTime;
+      }
+
+      if((actTime - PhaseStartedAt) >= BENCH_RUN_MS)
+      {
+        PrintResults(actTime);
+        Phase = eBenchDone;
+      }
+      break;
+    default:
+      #ifdef BENCH_REPLAY_FILE
+      RunFastReplay();
+      #else
+      fclose(CaptureFile);
+      #endif
+      fflush(stdout);
+      exit(0);
+      break;
+  }
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * SDOBatchBench - host build only
+ *
+ * reads 20 objects of a simulated drive - 3 of them strings, so
+ * segmented - first object by object with ReadSDO(), one object
+ * per call, then as a batch with ReadObjects(), finally as a batch
+ * with the SDO responses handled in the Rx interrupt.
+ * Prints the simulated time each takes and the number of loop() calls.
+ * Run with --sim and a --loop-us of a busy sketch, e.g. --loop-us 1000.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <COSDOHandler.h>
+#include <COVirtualBus.h>
+#include <COSim402Drive.h>
+
+//---- local definitions -----------------------------------------------
+
+const uint8_t DriveNodeId = 1;
+const uint8_t NumObjects = 20;
+const uint8_t NumRounds = 5;
+
+typedef enum BenchPhase {
+  eBenchSingle,
+  eBenchBatch,
+  eBenchBatchInRx,
+  eBenchDone
+} BenchPhase;
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+
+COSim402Drive SimDrive(&Bus, DriveNodeId);
+COSDOHandler SDO;
+
+char Strings[3][32];
+uint32_t Values[NumObjects];
+
+ODEntry Objects[NumObjects] = {
+  {0x1000, 0x00, NULL, 4},
+  {0x1008, 0x00, Strings[0], 32},
+  {0x1009, 0x00, Strings[1], 32},
+  {0x100A, 0x00, Strings[2], 32},
+  {0x1017, 0x00, NULL, 2},
+  {0x603F, 0x00, NULL, 2},
+  {0x6040, 0x00, NULL, 2},
+  {0x6041, 0x00, NULL, 2},
+  {0x6060, 0x00, NULL, 1},
+  {0x6061, 0x00, NULL, 1},
+  {0x6064, 0x00, NULL, 4},
+  {0x606C, 0x00, NULL, 4},
+  {0x6071, 0x00, NULL, 2},
+  {0x6077, 0x00, NULL, 2},
+  {0x607A, 0x00, NULL, 4},
+  {0x6081, 0x00, NULL, 4},
+  {0x6083, 0x00, NULL, 4},
+  {0x6084, 0x00, NULL, 4},
+  {0x6098, 0x00, NULL, 1},
+  {0x60FF, 0x00, NULL, 4}
+};
+ODEntry *ObjectList[NumObjects];
+uint32_t MaxLen[NumObjects];
+
+BenchPhase Phase = eBenchSingle;
+uint8_t Round = 0;
+uint8_t ActObject = 0;
+uint32_t Loops = 0;
+uint32_t StartedAt = 0;
+uint32_t PhaseUs = 0;
+uint32_t PhaseLoops = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//the len of an entry is updated to the length read
+void RestoreLengths()
+{
+  for(uint8_t iter = 0; iter < NumObjects; iter++)
+    Objects[iter].len = MaxLen[iter];
+}
+
+void PrintPhase(const char *name)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((double)PhaseUs / NumRounds / 1000.0, 2);
+  Serial.print(" ms, ");
+  Serial.print((double)PhaseLoops / NumRounds, 1);
+  Serial.println(" loop() calls per 20 objects");
+}
+
+//a round is done: sum up, start the next or switch the phase
+void EndRound(const char *name)
+{
+  PhaseUs += micros() - StartedAt;
+  PhaseLoops += Loops;
+  Loops = 0;
+  RestoreLengths();
+  Round++;
+
+  if(Round == NumRounds)
+  {
+    PrintPhase(name);
+    Phase = (BenchPhase)(Phase + 1);
+    Round = 0;
+    PhaseUs = 0;
+    PhaseLoops = 0;
+  }
+  StartedAt = micros();
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("> SDO batch benchmark");
+
+  for(uint8_t iter = 0; iter < NumObjects; iter++)
+  {
+    if(Objects[iter].Value == NULL)
+      Objects[iter].Value = &Values[iter];
+    MaxLen[iter] = Objects[iter].len;
+    ObjectList[iter] = &Objects[iter];
+  }
+
+  SDO.init(&MsgHandler, DriveNodeId, MsgHandler.RegisterNode(DriveNodeId));
+  MsgHandler.Open();
+
+  SimDrive.PowerOn();
+  //the boot-up message
+  delay(1);
+
+  StartedAt = micros();
+}
+
+void loop()
+{
+  MsgHandler.Update(millis());
+  SDO.SetActTime(millis());
+  Loops++;
+
+  switch(Phase)
+  {
+    case eBenchSingle:
+      if(SDO.ReadSDO(ObjectList[ActObject]) == eCO_SDODone)
+      {
+        ActObject++;
+        if(ActObject == NumObjects)
+        {
+          ActObject = 0;
+          EndRound("object by object");
+        }
+      }
+      break;
+    case eBenchBatch:
+      if(SDO.ReadObjects(ObjectList, NumObjects) == eCO_SDODone)
+      {
+        EndRound("batch");
+        if(Phase == eBenchBatchInRx)
+          MsgHandler.SetSDORxInInterrupt(true);
+      }
+      break;
+    case eBenchBatchInRx:
+      if(SDO.ReadObjects(ObjectList, NumObjects) == eCO_SDODone)
+        EndRound("batch, SDO in Rx interrupt");
+      break;
+    default:
+      Serial.print("device name: ");
+      Serial.println(Strings[0]);
+      fflush(stdout);
+      exit(0);
+      break;
+  }
+
+  if((SDO.GetComState() == eCO_SDOError) || (SDO.GetComState() == eCO_SDOTimeout))
+  {
+    Serial.println("SDO failed");
+    exit(1);
+  }
+}
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * SDOBlockBench - host build only
+ *
+ * transfers the identity strings, a 1 KiB recorder buffer (upload) and
+ * a 1 KiB parameter set (download) of a simulated drive
+ * - segmented
+ * - using the block transfer
+ * - using the block transfer with the SDO responses handled in the
+ *   Rx interrupt
+ * - with the block transfer enabled against a drive without it,
+ *   so falling back to segmented
+ * Checks the data and prints the simulated time each takes and the
+ * number of loop() calls.
+ * Run with --sim and a --loop-us of a busy sketch, e.g. --loop-us 1000.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <COSDOHandler.h>
+#include <COVirtualBus.h>
+#include <COSim402Drive.h>
+
+//---- local definitions -----------------------------------------------
+
+const uint8_t NumDrives = 2;
+const uint8_t BlockDriveId = 1;
+const uint8_t SegmentedDriveId = 2;
+const uint16_t BufferLen = 1024;
+const uint8_t NumRounds = 3;
+const uint8_t NumIdentityObjects = 4;
+
+typedef enum BenchMode {
+  eBenchSegmented,
+  eBenchBlock,
+  eBenchBlockInRx,
+  eBenchFallback,
+  eBenchDone
+} BenchMode;
+
+typedef enum BenchOp {
+  eOpIdentity,
+  eOpUpload,
+  eOpDownload,
+  eOpDone
+} BenchOp;
+
+const char *ModeNames[] = {"segmented", "block", "block, SDO in Rx interrupt", "block -> segmented"};
+const char *OpNames[] = {"identity strings", "1 KiB upload", "1 KiB download"};
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+
+COSim402Drive *SimDrives[NumDrives];
+COSDOHandler SDO[NumDrives];
+
+//the buffers of the simulated drives
+uint8_t Recorder[NumDrives][BufferLen];
+uint8_t ParameterSet[NumDrives][BufferLen];
+
+//the buffers of the central device
+uint8_t UploadBuffer[BufferLen];
+uint8_t DownloadBuffer[BufferLen];
+char Strings[NumIdentityObjects][32];
+
+ODEntry RecorderEntry = {0x2500, 0x00, UploadBuffer, BufferLen};
+ODEntry ParameterEntry = {0x2501, 0x00, DownloadBuffer, BufferLen};
+ODEntry IdentityEntries[NumIdentityObjects] = {
+  {0x1008, 0x00, Strings[0], 32},
+  {0x1009, 0x00, Strings[1], 32},
+  {0x100A, 0x00, Strings[2], 32},
+  {0x6403, 0x00, Strings[3], 32}
+};
+ODEntry *IdentityList[NumIdentityObjects];
+
+BenchMode Mode = eBenchSegmented;
+BenchOp Op = eOpIdentity;
+uint8_t Round = 0;
+uint32_t Loops = 0;
+uint32_t StartedAt = 0;
+uint32_t OpUs = 0;
+uint32_t OpLoops = 0;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+uint8_t ActDrive()
+{
+  return (Mode == eBenchFallback) ? 1 : 0;
+}
+
+//prepare the buffers for the next round
+void StartRound()
+{
+  for(uint8_t iter = 0; iter < NumIdentityObjects; iter++)
+    IdentityEntries[iter].len = 32;
+  RecorderEntry.len = BufferLen;
+  memset(UploadBuffer, 0, BufferLen);
+  memset(ParameterSet[ActDrive()], 0, BufferLen);
+  for(uint16_t iter = 0; iter < BufferLen; iter++)
+    DownloadBuffer[iter] = (uint8_t)(iter * 13 + Round);
+
+  StartedAt = micros();
+  Loops = 0;
+}
+
+bool CheckData()
+{
+  switch(Op)
+  {
+    case eOpUpload:
+      return (RecorderEntry.len == BufferLen) && (memcmp(UploadBuffer, Recorder[ActDrive()], BufferLen) == 0);
+    case eOpDownload:
+      return (memcmp(DownloadBuffer, ParameterSet[ActDrive()], BufferLen) == 0);
+    default:
+      return (strcmp(Strings[0], "SimDrive 402") == 0);
+  }
+}
+
+//an operation is done: check, sum up and switch to the next
+void EndRound()
+{
+  OpUs += micros() - StartedAt;
+  OpLoops += Loops;
+
+  if(!CheckData())
+  {
+    Serial.print(ModeNames[Mode]);
+    Serial.print(" ");
+    Serial.print(OpNames[Op]);
+    Serial.println(": data wrong");
+    exit(1);
+  }
+
+  Round++;
+  if(Round == NumRounds)
+  {
+    Serial.print(ModeNames[Mode]);
+    Serial.print(", ");
+    Serial.print(OpNames[Op]);
+    Serial.print(": ");
+    Serial.print((double)OpUs / NumRounds / 1000.0, 2);
+    Serial.print(" ms, ");
+    Serial.print((double)OpLoops / NumRounds, 1);
+    Serial.println(" loop() calls");
+
+    Round = 0;
+    OpUs = 0;
+    OpLoops = 0;
+    Op = (BenchOp)(Op + 1);
+    if(Op == eOpDone)
+    {
+      Op = eOpIdentity;
+      Mode = (BenchMode)(Mode + 1);
+
+      if(Mode == eBenchBlock)
+        SDO[0].SetBlockTransfer(true);
+      else if(Mode == eBenchBlockInRx)
+        MsgHandler.SetSDORxInInterrupt(true);
+      else if(Mode == eBenchFallback)
+      {
+        MsgHandler.SetSDORxInInterrupt(false);
+        SDO[1].SetBlockTransfer(true);
+      }
+    }
+  }
+  StartRound();
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("> SDO block transfer benchmark");
+
+  for(uint8_t iter = 0; iter < NumIdentityObjects; iter++)
+    IdentityList[iter] = &IdentityEntries[iter];
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+  {
+    uint8_t nodeId = (iter == 0) ? BlockDriveId : SegmentedDriveId;
+
+    SimDrives[iter] = new COSim402Drive(&Bus, nodeId);
+    for(uint16_t byteIdx = 0; byteIdx < BufferLen; byteIdx++)
+      Recorder[iter][byteIdx] = (uint8_t)(byteIdx * 7 + iter);
+    SimDrives[iter]->Node.AddObject(0x2500, 0x00, BufferLen, eSimRO, Recorder[iter]);
+    SimDrives[iter]->Node.AddObject(0x2501, 0x00, BufferLen, eSimRW, ParameterSet[iter]);
+
+    SDO[iter].init(&MsgHandler, nodeId, MsgHandler.RegisterNode(nodeId));
+  }
+  SimDrives[1]->Node.SetSDOBlockTransfer(false);
+
+  MsgHandler.Open();
+
+  for(uint8_t iter = 0; iter < NumDrives; iter++)
+    SimDrives[iter]->PowerOn();
+  //the boot-up messages
+  delay(1);
+
+  StartRound();
+}
+
+void loop()
+{
+  COSDOHandler *ActSDO = &SDO[ActDrive()];
+  COSDOCommStates State = eCO_SDOBusy;
+
+  MsgHandler.Update(millis());
+  ActSDO->SetActTime(millis());
+  Loops++;
+
+  if(Mode == eBenchDone)
+  {
+    fflush(stdout);
+    exit(0);
+  }
+
+  switch(Op)
+  {
+    case eOpIdentity:
+      State = ActSDO->ReadObjects(IdentityList, NumIdentityObjects);
+      break;
+    case eOpUpload:
+      State = ActSDO->ReadSDO(&RecorderEntry);
+      break;
+    case eOpDownload:
+      State = ActSDO->WriteSDO(&ParameterEntry);
+      break;
+    default:
+      break;
+  }
+
+  if(State == eCO_SDODone)
+    EndRound();
+  else if((State == eCO_SDOError) || (State == eCO_SDOTimeout))
+  {
+    Serial.print(ModeNames[Mode]);
+    Serial.print(" ");
+    Serial.print(OpNames[Op]);
+    Serial.println(": SDO failed");
+    exit(1);
+  }
+}
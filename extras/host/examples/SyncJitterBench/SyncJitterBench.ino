@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*----------------------------------------------------------------------
+ *
+ * SyncJitterBench - host build only
+ *
+ * sends the SYNC with a period of BENCH_SYNC_US (default 500us) while
+ * the loop() takes a varying time of up to BENCH_LOOP_WORK_US (default
+ * 400us) on top of the --loop-us. The SYNC is sent
+ * - by the Update(), catching up the ones missed
+ * - by the Update(), skipping the ones missed
+ * - by the SYNC timer
+ * for 2s each. Prints the statistics of the intervals between the SYNCs.
+ * Run with --sim, e.g. --sim --loop-us 100.
+ *
+ * 2026-10-16 AW
+ *
+ *------------------------------------------------------------------------*/
+
+//---- includes -------------------------------------------------------------
+#include <CONode.h>
+#include <COSyncHandler.h>
+#include <COVirtualBus.h>
+#include <COSimNode.h>
+
+//---- local definitions -----------------------------------------------
+
+#ifndef BENCH_SYNC_US
+#define BENCH_SYNC_US 500
+#endif
+
+#ifndef BENCH_LOOP_WORK_US
+#define BENCH_LOOP_WORK_US 400
+#endif
+
+const uint32_t PhaseMs = 2000;
+
+typedef enum BenchPhase {
+  eBenchCatchUp,
+  eBenchSkip,
+  eBenchTimer,
+  eBenchDone
+} BenchPhase;
+
+const char *PhaseNames[eBenchDone] = {"Update(), catch up", "Update(), skip", "SYNC timer"};
+
+COVirtualBus Bus(CanBitRate::BR_1000k);
+COVirtualCAN MasterCAN(&Bus);
+COMsgHandler MsgHandler(&MasterCAN, CanBitRate::BR_1000k);
+COSyncHandler SyncHandler(127);
+
+//a node to acknowledge the SYNCs
+COSimNode SimNode(&Bus, 1, 0x00000191);
+
+BenchPhase Phase = eBenchCatchUp;
+uint32_t PhaseStartedAt = 0;
+uint32_t Seed = 12345;
+
+//--------------------------------------------------------------------------------------------
+//--- local methods -------------------------------------
+
+//a simple LCG, so each run is the same
+uint32_t NextWorkUs()
+{
+  Seed = Seed * 1103515245 + 12345;
+  return (Seed >> 16) % (BENCH_LOOP_WORK_US + 1);
+}
+
+void StartPhase(uint32_t actTime)
+{
+  switch(Phase)
+  {
+    case eBenchCatchUp:
+      SyncHandler.SetSyncLatePolicy(eSyncCatchUp);
+      break;
+    case eBenchSkip:
+      SyncHandler.SetSyncLatePolicy(eSyncSkip);
+      break;
+    case eBenchTimer:
+      SyncHandler.SetSyncLatePolicy(eSyncCatchUp);
+      if(!SyncHandler.StartSyncTimer())
+        Serial.println("no timer");
+      break;
+    default:
+      break;
+  }
+  SyncHandler.ResetSyncStats();
+  PhaseStartedAt = actTime;
+}
+
+void PrintPhase()
+{
+  COSyncStats Stats;
+
+  SyncHandler.GetSyncStats(&Stats);
+
+  Serial.print(PhaseNames[Phase]);
+  Serial.print(": SYNCs ");
+  Serial.print(Stats.NumSyncs);
+  Serial.print(", interval min ");
+  Serial.print(Stats.MinIntervalUs);
+  Serial.print(" max ");
+  Serial.print(Stats.MaxIntervalUs);
+  Serial.print(" mean ");
+  Serial.print(Stats.MeanIntervalUs, 1);
+  Serial.print(" stddev ");
+  Serial.print(Stats.StdDevUs, 1);
+  Serial.print(" us, late ");
+  Serial.print(Stats.NumLate);
+  Serial.print(", skipped ");
+  Serial.println(Stats.NumSkipped);
+}
+
+//--------------------------------------------------------------------------------------------
+//--- setup ---------------------------------------------
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.print("> SYNC jitter benchmark, period ");
+  Serial.print(BENCH_SYNC_US);
+  Serial.print(" us, loop() work up to ");
+  Serial.print(BENCH_LOOP_WORK_US);
+  Serial.println(" us");
+
+  MsgHandler.Open();
+  SimNode.PowerOn();
+
+  SyncHandler.init(&MsgHandler);
+  SyncHandler.SetSyncPeriodUs(BENCH_SYNC_US);
+  SyncHandler.SetState(eSyncStateOperational);
+
+  StartPhase(millis());
+}
+
+//--------------------------------------------------------------------------------------------
+//--- loop ---------------------------------------------
+
+void loop()
+{
+  uint32_t actTime = millis();
+
+  if(Phase == eBenchDone)
+    return;
+
+  MsgHandler.Update(actTime);
+  SyncHandler.Update(actTime);
+
+  if((actTime - PhaseStartedAt) >= PhaseMs)
+  {
+    PrintPhase();
+    Phase = (BenchPhase)(Phase + 1);
+    if(Phase == eBenchDone)
+    {
+      SyncHandler.StopSyncTimer();
+      fflush(stdout);
+      exit(0);
+    }
+    StartPhase(actTime);
+  }
+
+  //the rest of a busy sketch
+  delayMicroseconds(NextWorkUs());
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_HOST_R_CAN_H
+#define CO_HOST_R_CAN_H
+
+/*--------------------------------------------------------------------
+ * r_can.h of the host build
+ * the frame and event types of the Renesas FSP CAN driver as far
+ * as they are used by the library
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+typedef enum e_can_event {
+	CAN_EVENT_ERR_WARNING          = 0x0002,
+	CAN_EVENT_ERR_PASSIVE          = 0x0004,
+	CAN_EVENT_ERR_BUS_OFF          = 0x0008,
+	CAN_EVENT_BUS_RECOVERY         = 0x0010,
+	CAN_EVENT_MAILBOX_MESSAGE_LOST = 0x0020,
+	CAN_EVENT_ERR_BUS_LOCK         = 0x0080,
+	CAN_EVENT_ERR_CHANNEL          = 0x0100,
+	CAN_EVENT_TX_ABORTED           = 0x0200,
+	CAN_EVENT_RX_COMPLETE          = 0x0400,
+	CAN_EVENT_TX_COMPLETE          = 0x0800,
+	CAN_EVENT_ERR_GLOBAL           = 0x1000,
+	CAN_EVENT_TX_FIFO_EMPTY        = 0x2000
+} can_event_t;
+
+typedef enum e_can_id_mode {
+	CAN_ID_MODE_STANDARD,
+	CAN_ID_MODE_EXTENDED
+} can_id_mode_t;
+
+typedef enum e_can_frame_type {
+	CAN_FRAME_TYPE_DATA,
+	CAN_FRAME_TYPE_REMOTE
+} can_frame_type_t;
+
+typedef struct st_can_frame {
+	uint32_t id;
+	can_id_mode_t id_mode;
+	can_frame_type_t type;
+	uint8_t data_length_code;
+	uint32_t options;
+	uint8_t data[64];
+} can_frame_t;
+
+typedef struct st_can_callback_args {
+	uint32_t channel;
+	can_event_t event;
+	uint32_t error;
+	uint32_t mailbox;
+	void const *p_context;
+	can_frame_t frame;
+} can_callback_args_t;
+
+#endif
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COTraceDecode.cpp
+ * host tool rendering a dump of the event trace (COTraceDump()) to
+ * text or the Chrome trace JSON.
+ *
+ *   COTraceDecode [--json] [file]
+ *
+ * Reads the file or stdin - the output captured from the Serial of
+ * the board or a sketch of the host build. The dump is found by it's
+ * magic within the other output, the last one is decoded.
+ * In the JSON each node has it's own track, SDO requests are shown
+ * as durations up to their response, all other events as instants.
+ *
+ * Built on it's own, it needs COTrace.h only:
+ *   g++ -std=gnu++17 -O2 -DCO_HOST_BUILD -Iextras/host -Isrc \
+ *       extras/host/tools/COTraceDecode.cpp -o COTraceDecode
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW SDO retries and errors
+ * 2026-10-16 AW rejected frames, short PDOs and EMCYs
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COTrace.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//--- local definitions ---
+
+static const char *EventNames[] = {
+	"None",
+	"Rx",
+	"Tx",
+	"RxDropped",
+	"CANError",
+	"NMTState",
+	"GuardingError",
+	"HBTimeout",
+	"SDORequest",
+	"SDODone",
+	"SDOAbort",
+	"SDOTimeout",
+	"Sync",
+	"RxPDOLate",
+	"TxPDOTimeout",
+	"User",
+	"SDORetry",
+	"SDOError",
+	"TxRejected",
+	"RxPDOShort",
+	"EMCY"
+};
+static_assert(sizeof(EventNames) / sizeof(EventNames[0]) == eCONumTraceEvents, "a name for each COTraceEvent");
+
+//the NMTNodeState of CONode.h
+static const char *NodeStateName(uint8_t state)
+{
+	switch((int8_t)state)
+	{
+		case -128: return "Offline";
+		case -3:   return "WaitForBoot";
+		case -2:   return "BootMsgReceived";
+		case -1:   return "Booting";
+		case 0:    return "Reset";
+		case 127:  return "PreOp";
+		case 5:    return "Operational";
+		case 4:    return "Stopped";
+		default:   return "?";
+	}
+}
+
+typedef struct TraceEntry {
+	uint64_t AtUs;          //unwrapped, since the first record
+	COTraceRecord Record;
+} TraceEntry;
+
+static uint16_t Get16(const uint8_t *data)
+{
+	return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t Get32(const uint8_t *data)
+{
+	return (uint32_t)Get16(data) | ((uint32_t)Get16(data + 2) << 16);
+}
+
+/*-------------------------------------------------------------------
+ * bool ParseDump(const std::vector<uint8_t> &Input, std::vector<TraceEntry> &Entries, uint32_t *numLost)
+ *
+ * find the last dump in the input and unwrap the time stamps.
+ * micros() wraps after 71 minutes, a record may also be written a
+ * little before the one in front of it by an interrupt - so the
+ * time difference to the previous one is taken as signed.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+static bool ParseDump(const std::vector<uint8_t> &Input, std::vector<TraceEntry> &Entries, uint32_t *numLost)
+{
+	const size_t headerSize = sizeof(COTraceMagic) + 2 + 2 + 4;
+	size_t start = Input.size();
+
+	for(size_t pos = 0; pos + headerSize <= Input.size(); pos++)
+	{
+		if(memcmp(&Input[pos], COTraceMagic, sizeof(COTraceMagic)) == 0)
+			start = pos;
+	}
+	if(start == Input.size())
+		return false;
+
+	const uint8_t *Header = &Input[start + sizeof(COTraceMagic)];
+	uint16_t recordSize = Get16(Header);
+	uint16_t numRecords = Get16(Header + 2);
+
+	*numLost = Get32(Header + 4);
+	if((recordSize < sizeof(COTraceRecord)) || (start + headerSize + (size_t)recordSize * numRecords > Input.size()))
+		return false;
+
+	uint64_t atUs = 0;
+	uint32_t lastAt = 0;
+
+	for(uint16_t iter = 0; iter < numRecords; iter++)
+	{
+		const uint8_t *Data = &Input[start + headerSize + (size_t)recordSize * iter];
+		TraceEntry Entry;
+
+		Entry.Record.At = Get32(Data);
+		Entry.Record.Event = Data[4];
+		Entry.Record.Node = Data[5];
+		Entry.Record.Arg0 = Get16(Data + 6);
+		Entry.Record.Arg1 = Get32(Data + 8);
+
+		if(iter > 0)
+		{
+			int32_t delta = (int32_t)(Entry.Record.At - lastAt);
+
+			atUs = ((delta < 0) && ((uint64_t)-delta > atUs)) ? 0 : atUs + delta;
+		}
+		lastAt = Entry.Record.At;
+		Entry.AtUs = atUs;
+		Entries.push_back(Entry);
+	}
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void Describe(const COTraceRecord *Record, char *Text, size_t len)
+ *
+ * the arguments of a record in words
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+static void Describe(const COTraceRecord *Record, char *Text, size_t len)
+{
+	switch(Record->Event)
+	{
+		case eCOTraceRx:
+		case eCOTraceTx:
+			snprintf(Text, len, "COB-Id 0x%03X data %02X %02X %02X %02X", Record->Arg0,
+			         Record->Arg1 & 0xFF, (Record->Arg1 >> 8) & 0xFF, (Record->Arg1 >> 16) & 0xFF, Record->Arg1 >> 24);
+			break;
+		case eCOTraceRxDropped:
+		case eCOTraceTxRejected:
+		case eCOTraceRxPDOLate:
+		case eCOTraceTxPDOTimeout:
+			snprintf(Text, len, "COB-Id 0x%03X", Record->Arg0);
+			break;
+		case eCOTraceCANError:
+			snprintf(Text, len, "event %u", Record->Arg0);
+			break;
+		case eCOTraceNMTState:
+			snprintf(Text, len, "%s -> %s", NodeStateName(Record->Arg1), NodeStateName(Record->Arg0));
+			break;
+		case eCOTraceGuardingError:
+			snprintf(Text, len, "%u requests open", Record->Arg0);
+			break;
+		case eCOTraceHBTimeout:
+			snprintf(Text, len, "%u us since the last heartbeat", Record->Arg1);
+			break;
+		case eCOTraceSDORequest:
+			snprintf(Text, len, "0x%04X.%u request %u", Record->Arg0, Record->Arg1 & 0xFF, Record->Arg1 >> 8);
+			break;
+		case eCOTraceSDODone:
+			snprintf(Text, len, "0x%04X %u bytes", Record->Arg0, Record->Arg1);
+			break;
+		case eCOTraceSDOAbort:
+			snprintf(Text, len, "0x%04X abort code 0x%08X", Record->Arg0, Record->Arg1);
+			break;
+		case eCOTraceSDOTimeout:
+			snprintf(Text, len, "0x%04X %s", Record->Arg0, Record->Arg1 ? "final" : "retried");
+			break;
+		case eCOTraceSDORetry:
+		case eCOTraceSDOError:
+			snprintf(Text, len, "0x%04X request %u", Record->Arg0, Record->Arg1);
+			break;
+		case eCOTraceRxPDOShort:
+			snprintf(Text, len, "COB-Id 0x%03X %u bytes", Record->Arg0, Record->Arg1);
+			break;
+		case eCOTraceEMCY:
+			snprintf(Text, len, "code 0x%04X error register 0x%02X CiA error 0x%04X", Record->Arg0, Record->Arg1 & 0xFF, Record->Arg1 >> 8);
+			break;
+		case eCOTraceSync:
+			snprintf(Text, len, "counter %u, %u us since the last", Record->Arg0, Record->Arg1);
+			break;
+		default:
+			snprintf(Text, len, "%u 0x%08X", Record->Arg0, Record->Arg1);
+			break;
+	}
+}
+
+static const char *EventName(uint8_t Event)
+{
+	return (Event < eCONumTraceEvents) ? EventNames[Event] : "?";
+}
+
+static void PrintText(const std::vector<TraceEntry> &Entries, uint32_t numLost)
+{
+	char Text[80];
+
+	printf("# %zu records, %u lost before\n", Entries.size(), numLost);
+	for(const TraceEntry &Entry : Entries)
+	{
+		Describe(&Entry.Record, Text, sizeof(Text));
+		printf("%12.3f ms  node %3u  %-14s %s\n", Entry.AtUs / 1000.0, Entry.Record.Node, EventName(Entry.Record.Event), Text);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void PrintJson(const std::vector<TraceEntry> &Entries)
+ *
+ * the Chrome trace event format: one thread per node, ts in us.
+ * An SDO request begins a duration, it's response, abort, timeout
+ * or error ends it.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+static void PrintJson(const std::vector<TraceEntry> &Entries)
+{
+	char Text[80];
+	bool isFirst = true;
+
+	printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for(const TraceEntry &Entry : Entries)
+	{
+		const COTraceRecord *Record = &Entry.Record;
+		const char *Phase = "i";
+
+		if(Record->Event == eCOTraceSDORequest)
+			Phase = "B";
+		else if((Record->Event == eCOTraceSDODone) || (Record->Event == eCOTraceSDOAbort) || (Record->Event == eCOTraceSDOTimeout) ||
+		        (Record->Event == eCOTraceSDOError))
+			Phase = "E";
+
+		Describe(Record, Text, sizeof(Text));
+		printf("%s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%llu,\"pid\":1,\"tid\":%u,%s\"args\":{\"info\":\"%s\"}}",
+		       isFirst ? "" : ",\n", EventName(Record->Event), Phase, (unsigned long long)Entry.AtUs, Record->Node,
+		       (Phase[0] == 'i') ? "\"s\":\"t\"," : "", Text);
+		isFirst = false;
+	}
+	printf("\n]}\n");
+}
+
+int main(int argc, char **argv)
+{
+	bool isJson = false;
+	FILE *In = stdin;
+
+	for(int iter = 1; iter < argc; iter++)
+	{
+		if(strcmp(argv[iter], "--json") == 0)
+			isJson = true;
+		else if((argv[iter][0] != '-') && (In == stdin))
+		{
+			In = fopen(argv[iter], "rb");
+			if(In == NULL)
+			{
+				perror(argv[iter]);
+				return 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--json] [file]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<uint8_t> Input;
+	uint8_t Buffer[4096];
+	size_t len;
+
+	while((len = fread(Buffer, 1, sizeof(Buffer), In)) > 0)
+		Input.insert(Input.end(), Buffer, Buffer + len);
+
+	std::vector<TraceEntry> Entries;
+	uint32_t numLost = 0;
+
+	if(!ParseDump(Input, Entries, &numLost))
+	{
+		fprintf(stderr, "no complete trace dump found\n");
+		return 1;
+	}
+
+	if(isJson)
+		PrintJson(Entries);
+	else
+		PrintText(Entries, numLost);
+
+	return 0;
+}
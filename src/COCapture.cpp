@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COCapture.cpp
+ * Implementation of the COCapture Class
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COCapture.h>
+#include <stdio.h>
+#include <string.h>
+
+//--- local definitions ---
+
+const uint16_t CaptureMask = CO_CAPTURE_FRAMES - 1;
+static_assert((CO_CAPTURE_FRAMES & CaptureMask) == 0, "CO_CAPTURE_FRAMES has to be a power of 2");
+
+//--- public functions ---
+
+/*-------------------------------------------------------------------
+ * void Record(bool isTx, uint32_t At, uint32_t Id, bool isRTR, uint8_t len, const uint8_t *payload)
+ *
+ * keep a frame in the ring, drop it if the ring is full.
+ * Called by the COMsgHandler from the Rx interrupt and when a
+ * frame is handed to the CAN controller - both with the interrupts
+ * disabled, so there is one writer at a time.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COCapture::Record(bool isTx, uint32_t At, uint32_t Id, bool isRTR, uint8_t len, const uint8_t *payload)
+{
+	//acquire: the loop must be done with a slot before we overwrite it
+	if((uint16_t)(NextWrite - __atomic_load_n(&NextRead, __ATOMIC_ACQUIRE)) >= CO_CAPTURE_FRAMES)
+	{
+		NumDropped++;
+		return;
+	}
+
+	COCaptureFrame *Frame = &Ring[NextWrite & CaptureMask];
+
+	if(len > 8)
+		len = 8;
+
+	Frame->At = At;
+	Frame->Id = (uint16_t)Id;
+	Frame->Flags = (isTx ? CaptureFlagTx : 0) | (isRTR ? CaptureFlagRTR : 0);
+	Frame->len = len;
+	if(!isRTR)
+		memcpy(Frame->payload, payload, len);
+
+	NumCaptured++;
+	//release: publish the frame only after it is completely written
+	__atomic_store_n(&NextWrite, (uint16_t)(NextWrite + 1), __ATOMIC_RELEASE);
+}
+
+/*-------------------------------------------------------------------
+ * bool Read(COCaptureFrame *Frame)
+ *
+ * take the oldest frame out of the ring - false if there is none
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COCapture::Read(COCaptureFrame *Frame)
+{
+	if(__atomic_load_n(&NextWrite, __ATOMIC_ACQUIRE) == NextRead)
+		return false;
+
+	*Frame = Ring[NextRead & CaptureMask];
+	__atomic_store_n(&NextRead, (uint16_t)(NextRead + 1), __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * bool ReadLine(COCaptureFormat Format, char *Line, uint8_t maxLen)
+ *
+ * take the oldest frame out of the ring as a line of text without
+ * the line end - false if there is none.
+ * The time of the lines runs on when micros() wraps. A frame
+ * recorded by the interrupt right before the one in front of it
+ * keeps the time of that one.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COCapture::ReadLine(COCaptureFormat Format, char *Line, uint8_t maxLen)
+{
+	COCaptureFrame Frame;
+
+	if(!Read(&Frame))
+		return false;
+
+	if(!hasLastAt)
+	{
+		LastAtUs = Frame.At;
+		hasLastAt = true;
+	}
+	else if((int32_t)(Frame.At - LastAt) > 0)
+		LastAtUs += Frame.At - LastAt;
+	LastAt = Frame.At;
+
+	FormatFrame(Format, LastAtUs, &Frame, Line, maxLen);
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t Print(COCaptureFormat Format, uint16_t maxFrames)
+ *
+ * stream up to maxFrames lines to Serial and return their number.
+ * A line takes ~4ms at 115200 Baud - keep maxFrames small in a
+ * loop which has to keep it's pace.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COCapture::Print(COCaptureFormat Format, uint16_t maxFrames)
+{
+	char Line[CaptureLineLen];
+	uint16_t numPrinted = 0;
+
+	while((numPrinted < maxFrames) && ReadLine(Format, Line, sizeof(Line)))
+	{
+		Serial.println(Line);
+		numPrinted++;
+	}
+	return numPrinted;
+}
+
+/*-------------------------------------------------------------------
+ * static uint8_t FormatHeader(COCaptureFormat Format, char *Line, uint8_t maxLen)
+ *
+ * the lines in front of the first frame, none for candump.
+ * Returns the length.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint8_t COCapture::FormatHeader(COCaptureFormat Format, char *Line, uint8_t maxLen)
+{
+	if(Format == eCOCaptureASC)
+		return snprintf(Line, maxLen, "base hex  timestamps absolute\nno internal events logged");
+
+	Line[0] = '\0';
+	return 0;
+}
+
+/*-------------------------------------------------------------------
+ * static uint8_t FormatFrame(COCaptureFormat Format, uint64_t AtUs, const COCaptureFrame *Frame, char *Line, uint8_t maxLen)
+ *
+ * a frame as a line of text:
+ *   candump -L: (12.345678) rx 181#0102030405060708
+ *   ASC:        12.345678 1  181             Rx   d 8 01 02 03 04 05 06 07 08
+ * Returns the length.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint8_t COCapture::FormatFrame(COCaptureFormat Format, uint64_t AtUs, const COCaptureFrame *Frame, char *Line, uint8_t maxLen)
+{
+	bool isTx = (Frame->Flags & CaptureFlagTx) != 0;
+	bool isRTR = (Frame->Flags & CaptureFlagRTR) != 0;
+	unsigned long sec = (unsigned long)(AtUs / 1000000);
+	unsigned long usec = (unsigned long)(AtUs % 1000000);
+	int pos;
+
+	if(Format == eCOCaptureASC)
+	{
+		pos = snprintf(Line, maxLen, "%lu.%06lu 1  %-15X %s   %c", sec, usec, Frame->Id, isTx ? "Tx" : "Rx", isRTR ? 'r' : 'd');
+		if(!isRTR)
+		{
+			pos += snprintf(Line + pos, maxLen - pos, " %u", Frame->len);
+			for(uint8_t iter = 0; iter < Frame->len; iter++)
+				pos += snprintf(Line + pos, maxLen - pos, " %02X", Frame->payload[iter]);
+		}
+	}
+	else
+	{
+		pos = snprintf(Line, maxLen, "(%lu.%06lu) %s %03X#", sec, usec, isTx ? "tx" : "rx", Frame->Id);
+		if(isRTR)
+			pos += (Frame->len > 0) ? snprintf(Line + pos, maxLen - pos, "R%u", Frame->len) : snprintf(Line + pos, maxLen - pos, "R");
+		else
+		{
+			for(uint8_t iter = 0; iter < Frame->len; iter++)
+				pos += snprintf(Line + pos, maxLen - pos, "%02X", Frame->payload[iter]);
+		}
+	}
+	return (uint8_t)pos;
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t GetFramesPending()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COCapture::GetFramesPending()
+{
+	return (uint16_t)(__atomic_load_n(&NextWrite, __ATOMIC_ACQUIRE) - NextRead);
+}
+
+/*-------------------------------------------------------------------
+ * void Clear()
+ *
+ * drop the frames not read yet and reset the counters
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COCapture::Clear()
+{
+	noInterrupts();
+	NextRead = NextWrite;
+	NumCaptured = 0;
+	NumDropped = 0;
+	interrupts();
+}
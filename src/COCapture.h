@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_CAPTURE_H
+#define CO_CAPTURE_H
+
+/*--------------------------------------------------------------------
+ * class COCapture
+ * a capture of all frames received and sent by a COMsgHandler
+ * (COMsgHandler::SetCapture()).
+ * The frames are recorded in binary with their micros() into a ring
+ * by the Rx interrupt and when they are handed to the CAN controller.
+ * The loop takes them out as lines of text - in the log format of
+ * candump -L or the Vector ASC format - and streams them to Serial or
+ * wherever the sketch wants to keep them.
+ *
+ * In the candump format the interface is "rx" for frames received and
+ * "tx" for frames sent: canplayer maps them to a real one, e.g.
+ * canplayer can0=rx. The ASC format has it's own Rx/Tx column.
+ * The time is the micros() since the start of the board.
+ *
+ * If the loop doesn't keep up the new frames are dropped and counted.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <stdint.h>
+
+//the size of the ring, has to be a power of 2
+#ifndef CO_CAPTURE_FRAMES
+#define CO_CAPTURE_FRAMES 256
+#endif
+
+//the longest line of both formats including the '\0'
+const uint8_t CaptureLineLen = 80;
+
+typedef enum COCaptureFormat {
+	eCOCaptureCandump,      //candump -L
+	eCOCaptureASC           //Vector ASC
+} COCaptureFormat;
+
+//flags of a captured frame
+const uint8_t CaptureFlagTx = 0x01;
+const uint8_t CaptureFlagRTR = 0x02;
+
+typedef struct COCaptureFrame {
+	uint32_t At;            //micros()
+	uint16_t Id;
+	uint8_t Flags;
+	uint8_t len;
+	uint8_t payload[8];
+} COCaptureFrame;
+
+class COCapture {
+	public:
+	  void Record(bool isTx, uint32_t At, uint32_t Id, bool isRTR, uint8_t len, const uint8_t *payload);
+
+	  bool Read(COCaptureFrame *);
+	  bool ReadLine(COCaptureFormat, char *Line, uint8_t maxLen);
+	  uint16_t Print(COCaptureFormat, uint16_t maxFrames);
+	  static uint8_t FormatHeader(COCaptureFormat, char *Line, uint8_t maxLen);
+	  static uint8_t FormatFrame(COCaptureFormat, uint64_t AtUs, const COCaptureFrame *, char *Line, uint8_t maxLen);
+
+	  uint16_t GetFramesPending();
+	  uint32_t GetNumCaptured() { return NumCaptured; }
+	  uint32_t GetNumDropped() { return NumDropped; }
+	  void Clear();
+
+	private:
+	  COCaptureFrame Ring[CO_CAPTURE_FRAMES];
+	  uint16_t NextWrite = 0;
+	  uint16_t NextRead = 0;
+	  uint32_t NumCaptured = 0;
+	  uint32_t NumDropped = 0;
+
+	  //micros() wraps after 71 minutes - the time of the lines doesn't
+	  uint32_t LastAt = 0;
+	  uint64_t LastAtUs = 0;
+	  bool hasLastAt = false;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+ 
+/*-------------------------------------------------------------------
+ * COFrameTiming.cpp
+ * exact length of a CAN frame on the bus
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW estimate cheap enough for the interrupt
+ *
+ *-------------------------------------------------------------------*/
+ 
+//--- includes ---
+ 
+#include <COFrameTiming.h>
+
+//--- implementation ---
+
+/*-------------------------------------------------------------------
+ * uint8_t COFrameBits(uint32_t Id, bool isRTR, uint8_t len, const uint8_t *data)
+ * 
+ * build the bit stream from SOF up to the CRC, calculate the CRC-15
+ * and count the stuff bits inserted after 5 equal bits.
+ * A remote frame has the DLC of len but no data.
+ * 
+ * 2026-10-16 AW 
+ *-------------------------------------------------------------------*/
+
+uint8_t COFrameBits(uint32_t Id, bool isRTR, uint8_t len, const uint8_t *data)
+{
+	uint8_t dataLen = isRTR ? 0 : (len > 8 ? 8 : len);
+	uint8_t numBits = 0;
+	uint8_t stuffBits = 0;
+	uint16_t crc = 0;
+	uint8_t lastBit = 0;
+	uint8_t runLength = 0;
+
+	//the stuffed part: SOF, 11 bit Id, RTR, IDE, r0, 4 bit DLC, data - MSB first
+	//followed by the 15 bits of the CRC which is calculated over all bits before
+	const uint8_t headerBits = 1 + 11 + 1 + 1 + 1 + 4;
+	uint32_t headerWord = ((Id & 0x7FF) << 7)          //SOF dominant in front
+											| ((uint32_t)(isRTR ? 1 : 0) << 6)
+											| (len & 0x0F);                //IDE and r0 dominant
+
+	for(uint8_t phase = 0; phase < 3; phase++)
+	{
+		uint8_t bitsInPhase = (phase == 0) ? headerBits : ((phase == 1) ? (uint8_t)(dataLen * 8) : 15);
+
+		for(uint8_t iter = 0; iter < bitsInPhase; iter++)
+		{
+			uint8_t bit;
+
+			if(phase == 0)
+				bit = (headerWord >> (headerBits - 1 - iter)) & 0x01;
+			else if(phase == 1)
+				bit = (data[iter >> 3] >> (7 - (iter & 0x07))) & 0x01;
+			else
+				bit = (crc >> (14 - iter)) & 0x01;
+
+			if(phase < 2)
+			{
+				//CRC-15 polynomial 0x4599
+				uint8_t crcNext = bit ^ ((crc >> 14) & 0x01);
+				crc = (crc << 1) & 0x7FFF;
+				if(crcNext)
+					crc ^= 0x4599;
+			}
+
+			//stuffing: after 5 equal bits a complementary bit is inserted
+			//which counts as the first bit of the next run
+			if((numBits > 0) && (bit == lastBit))
+				runLength++;
+			else
+				runLength = 1;
+			lastBit = bit;
+			numBits++;
+
+			if(runLength == 5)
+			{
+				stuffBits++;
+				lastBit = bit ^ 0x01;
+				runLength = 1;
+			}
+		}
+	}
+	return numBits + stuffBits + COFrameFixedBits;
+}
+
+/*-------------------------------------------------------------------
+ * uint8_t COFrameBitsEstimate(bool isRTR, uint8_t len, const uint8_t *data)
+ * 
+ * the unstuffed length plus an estimate of the stuff bits: 2 for
+ * Id, DLC and CRC and 2 per data byte of 0x00 or 0xFF - these long
+ * runs cause most of the stuff bits of real traffic. Off by up to
+ * 9 bits for a single frame, close to COFrameBits() in the mean.
+ * 
+ * 2026-10-16 AW 
+ *-------------------------------------------------------------------*/
+
+uint8_t COFrameBitsEstimate(bool isRTR, uint8_t len, const uint8_t *data)
+{
+	uint8_t dataLen = isRTR ? 0 : (len > 8 ? 8 : len);
+	uint8_t stuffBits = 2;
+
+	for(uint8_t iter = 0; iter < dataLen; iter++)
+	{
+		if((data[iter] == 0x00) || (data[iter] == 0xFF))
+			stuffBits += 2;
+	}
+	//SOF, Id, RTR, IDE, r0, DLC and CRC
+	return 1 + 11 + 1 + 1 + 1 + 4 + 15 + dataLen * 8 + stuffBits + COFrameFixedBits;
+}
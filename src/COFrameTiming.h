@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_FRAME_TIMING_H
+#define CO_FRAME_TIMING_H
+
+/*--------------------------------------------------------------------
+ * COFrameTiming
+ * length of a classic CAN frame with standard Id on the bus
+ * including the stuff bits and the interframe space.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW estimate cheap enough for the interrupt
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <stdint.h>
+
+//bits of a standard frame not subject to bit stuffing:
+//CRC delimiter, ACK slot, ACK delimiter, EOF and the interframe space
+const uint8_t COFrameFixedBits = 1 + 1 + 1 + 7 + 3;
+
+//number of bits a standard data or remote frame occupies the bus
+uint8_t COFrameBits(uint32_t Id, bool isRTR, uint8_t len, const uint8_t *data);
+
+//the same estimated without building the bit stream - for the bus statistics
+uint8_t COFrameBitsEstimate(bool isRTR, uint8_t len, const uint8_t *data);
+
+#endif
@@ -23,12 +23,21 @@
  * used for sending Msgs and distribution of received messages
  *
  * 2024-11-16 AW Frame
+ * 2026-10-16 AW synchronous window of the SYNC
+ * 2026-10-16 AW received frames time stamped in the Rx interrupt
+ * 2026-10-16 AW bus load and traffic statistics
+ * 2026-10-16 AW latency probes
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW capture of the frames
  *
  *-------------------------------------------------------------------*/
  
 //--- includes ---
  
 #include <COMsgHandler.h>
+#include <COFrameTiming.h>
+#include <COProbe.h>
+#include <COTrace.h>
 
 #define DEBUG_ONRX		0x0001
 #define DEBUG_REGNODE	0x0002
@@ -47,26 +56,102 @@
  * COMsgHandler()
  * constuctor. Register the callback at my instance of
  * the Uart
+ * On the host there are no pins - the default transport
+ * of the host build is used
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-16 AW use the UNOR4CAN via the COTransport
  * 
  * ----------------------------------------------------*/
  
 COMsgHandler::COMsgHandler(int const can_tx_pin, int const can_rx_pin,CanBitRate BR):
-	 can(can_tx_pin, can_rx_pin),
    can_bitrate(BR)
+	 #if !defined(CO_HOST_BUILD)
+	 ,r4can(can_tx_pin, can_rx_pin)
+	 #endif
+{
+	#if defined(CO_HOST_BUILD)
+	can = COHostDefaultTransport();
+	#else
+	can = &r4can;
+	#endif
+	
+	InitTables();
+}
+
+/*------------------------------------------------------
+ * COMsgHandler(COTransport *transport, CanBitRate BR)
+ * constuctor for any other CAN interface
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+ 
+COMsgHandler::COMsgHandler(COTransport *transport,CanBitRate BR):
+   can_bitrate(BR),
+	 can(transport)
+{
+	InitTables();
+}
+
+/*------------------------------------------------------
+ * void InitTables()
+ * set the defaults for the nodes, the Rx buffer and the
+ * Tx queue
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+ 
+void COMsgHandler::InitTables()
 {
 	//now set default values for no node registered
 	for(uint8_t iter = 0; iter < MsgHandler_MaxNodes; iter++)
 	{
 		nodeId[iter] = invalidNodeId;
+		SDORequest[iter] = NULL;
+		Scheduler.InitItem(&NodeDue[iter], NULL);
+		NodeSyncDue[iter] = false;
+		for(uint8_t cb = 0; cb < eCORxNumCb; cb++)
+		{
+			OnRxCb[iter][cb].callback = NULL;
+			OnRxCb[iter][cb].op = NULL;
+		}
 	}
 	
+	for(uint8_t iter = 0; iter < NumNodeIds; iter++)
+		RxDispatch[iter] = NULL;
+	NumRxPDOsRegistered = 0;
+	
 	for(uint8_t iter = 0; iter < NumRxBuffers; iter++)
   {
 		//invalidate all buffers
     CORxVector[iter].serviceType = eCANNone;
 	}
+	
+	//chain all Tx entries into the free list
+	for(uint8_t iter = 0; iter < NumTxBuffers; iter++)
+		COTxPool[iter].Next = iter + 1;
+	COTxPool[NumTxBuffers - 1].Next = InvalidSlot;
+	
+	for(uint8_t iter = 0; iter < eCOTxNumClasses; iter++)
+	{
+		TxClassHead[iter] = InvalidSlot;
+		TxClassCount[iter] = 0;
+		NumTxDropped[iter] = 0;
+	}
+	
+	//a newer SYNC makes a waiting one obsolete, a newer RPDO a waiting one with the same COB-Id
+	//all others are refused and re-sent by their service
+	//RPDOs and guarding requests scale with the nodes, see NumTxBuffers
+	SetTxClassPolicy(eCOTxClassNMT, 4, eCOTxRejectNew);
+	SetTxClassPolicy(eCOTxClassSync, 1, eCOTxDropOldest);
+	SetTxClassPolicy(eCOTxClassEmcy, 2, eCOTxRejectNew);
+	SetTxClassPolicy(eCOTxClassRPDO, TxRPDODepth, eCOTxReplaceSameId);
+	SetTxClassPolicy(eCOTxClassSDO, 8, eCOTxRejectNew);
+	SetTxClassPolicy(eCOTxClassGuarding, TxGuardingDepth, eCOTxRejectNew);
+	
+	ResetBusStats();
 }
 
 /*------------------------------------------------------
@@ -80,7 +165,7 @@ COMsgHandler::COMsgHandler(int const can_tx_pin, int const can_rx_pin,CanBitRate
 void COMsgHandler::set_can_bitrate(CanBitRate bitrate)
 {
   can_bitrate = bitrate;	
-	can.set_can_bitrate(can_bitrate);
+	can->set_can_bitrate(can_bitrate);
 }
 
 /*------------------------------------------------------
@@ -88,6 +173,7 @@ void COMsgHandler::set_can_bitrate(CanBitRate bitrate)
  * Open the serial interface at the set rate
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-16 AW start the latency probes
  * 
  * ----------------------------------------------------*/
  
@@ -98,10 +184,10 @@ void COMsgHandler::COMsgHandler::Open()
 	Cb.callback = (pfunction_pointer_t)COMsgHandler::OnMsgRxCb;
 	Cb.op = (void *)this;
 	
-  can.set_callback(&Cb);            						// register our handler for CAN bus events
+  can->set_callback(&Cb);            						// register our handler for CAN bus events
 
-	can.set_can_bitrate(can_bitrate);           	// limited to BR_125k, BR_250k, BR_500k, BR_1000k
-  bool ok = can.begin();                        // start the CAN bus peripheral
+	can->set_can_bitrate(can_bitrate);           	// limited to BR_125k, BR_250k, BR_500k, BR_1000k
+  bool ok = can->begin();                        // start the CAN bus peripheral
 
   Serial.print("MSG: > CAN begin returns ");
   Serial.println(ok);
@@ -110,92 +196,209 @@ void COMsgHandler::COMsgHandler::Open()
   Serial.println();
 	
 	TxStatus = eCOTxIdle;
+	
+	#if CO_PROBES
+	COProbeInit();
+	#endif
 }
 
 /*------------------------------------------------------
- * Update()
- * needed to call the Update of the underlying Uart as there
- * is no real interrupt driven Rx or Tx here
- * If the Msghandler has been locked for a too long time
- * it will e unlocked here to give the system a chance to recover
+ * uint8_t Update()
+ * dispatch the messages received in the interrupt context
+ * to the registered upper layers.
+ * The callback is found by the node-id and the service of the
+ * COB-Id without any search, a registered PDO by it's COB-Id.
+ * Up to RxFrameBudget frames are processed per call so a burst
+ * on the bus is handled within one loop instead of one frame per loop.
+ * Returns the number of frames still left in the Rx buffer.
+ * The time since the Rx interrupt (RxAt) of each frame is taken
+ * for the latency in the CORxStats.
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-16 AW drain the Rx buffer up to the frame budget
+ * 2026-10-16 AW table based dispatch
+ * 2026-10-16 AW PDOs by the COB-Id table
+ * 2026-10-16 AW latency since the Rx interrupt
+ * 2026-10-16 AW close the period of the bus load
+ * 2026-10-16 AW latency probe of the calls which dispatched frames
+ * 2026-10-16 AW run the nodes which are due
+ * 
+ * Then the scheduler runs the nodes which are due: a node with an
+ * OnDueCb (Register_OnDueCb()) is due when a frame was dispatched
+ * to it, when a SYNC was sent and it has synchronous work
+ * (SetNodeSyncDue()) and when the deadline it set by ScheduleNode()
+ * has passed. A SYNC sent while the nodes run makes the sync due
+ * ones due within the same call.
  * 
  * ----------------------------------------------------*/
  
-void COMsgHandler::COMsgHandler::Update(uint32_t timeNow)
+uint8_t COMsgHandler::COMsgHandler::Update(uint32_t timeNow)
 {
+	uint8_t framesDone = 0;
+	CO_PROBE_BEGIN(eCOProbeMsgUpdate);
+	
 	actTime = timeNow;
+	UpdateBusLoad(timeNow);
 
-	if(CORxNextWrite != CORxNextRead)
-	//while(CORxNextWrite != CORxNextRead)
+	//acquire: the frame is complete once we see the interrupt's write index
+	while((__atomic_load_n(&CORxNextWrite, __ATOMIC_ACQUIRE) != CORxNextRead) && (framesDone < RxFrameBudget))
 	{
-	  CANMsg *RxMsg = &(CORxVector[CORxNextRead]);
-		uint8_t thisNodeId = RxMsg->Id & 0x7F;
-    uint8_t NodeHandle = FindNode(thisNodeId);
+	  CANMsg *RxMsg = &(CORxVector[CORxNextRead & RxBufferMask]);
+		//the row of callbacks of this node-id, then the column of this service
+    pfunction_holder *NodeCb = RxDispatch[RxMsg->Id & 0x7F];
+		CORxCbType CbType = (CORxCbType)COBIdToRxCb[(RxMsg->Id >> 7) & 0x0F];
+		uint32_t PDOIdx = RxMsg->Id - FirstPDOCOBId;
+		uint16_t PDOEntry = InvalidPDOEntry;
+		uint32_t latency = micros() - RxMsg->RxAt;
+		
+		if(latency > RxMaxLatencyUs)
+			RxMaxLatencyUs = latency;
+		RxSumLatencyUs += latency;
+		
+		//a registered PDO goes to the node it is registered for
+		if((PDOIdx < NumPDOCOBIds) && (NumRxPDOsRegistered > 0))
+			PDOEntry = FindRxPDO((uint16_t)RxMsg->Id);
+		if(PDOEntry != InvalidPDOEntry)
+		{
+			NodeCb = OnRxCb[PDOEntry & 0x7F];
+			CbType = eCORxCbPDO;
+		}
 				
-	  if(NodeHandle != InvalidSlot)
+	  if(NodeCb != NULL)
 	  {
-		  switch(RxMsg->serviceType)
-	    {
-			  case eCANNone:
-	      case eCANNMT:
-	      case eCANSdoReq:
-			  case eCANRPDO1:
-			  case eCANRPDO2:
-			  case eCANRPDO3:
-			  case eCANRPDO4:
-				  break;
-			  case eCANSyncEmcy:
-				  #if(DEBUG_COMSGHandler & DEBUG_ONRX)
-				  Serial.print("MSG: Rx EMCY: ");
-				  Serial.println(RxMsg->Id, HEX);
-				  #endif
-				  if(OnRxEMCYCb[NodeHandle].callback != NULL)
-					  OnRxEMCYCb[NodeHandle].callback(OnRxEMCYCb[NodeHandle].op,(void *)RxMsg);
-				  break;
-			  case eCANSdoResp:
-				  #if(DEBUG_COMSGHandler & DEBUG_ONRX)
-				  Serial.print("MSG: Rx SDO Response: ");
-				  Serial.println(RxMsg->Id, HEX);
-				  #endif
-				  if(OnRxSDOCb[NodeHandle].callback != NULL)
-					  OnRxSDOCb[NodeHandle].callback(OnRxSDOCb[NodeHandle].op,(void *)RxMsg);
-				  break;
-			  case eCANTPDO1:
-			  case eCANTPDO2:
-			  case eCANTPDO3:
-			  case eCANTPDO4:
-				  #if(DEBUG_COMSGHandler & DEBUG_ONRX)
-			    Serial.print("MSG: Rx PDO: ");
-			    Serial.println(RxMsg->Id, HEX);
-				  #endif
-				  if(OnRxPDOCb[NodeHandle].callback != NULL)
-					  OnRxPDOCb[NodeHandle].callback(OnRxPDOCb[NodeHandle].op,(void *)RxMsg);
-					else
-						Serial.println("Msg: no PDO handler present");
-			    break;
-        case eCANGuarding:
-				  #if(DEBUG_COMSGHandler & DEBUG_ONRX & 0)
-			    Serial.print("MSG: Rx Guarding: ");
-			    Serial.println(RxMsg->Id, HEX);
-				  #endif
-				  if(OnRxNmtCb[NodeHandle].callback != NULL)
-					  OnRxNmtCb[NodeHandle].callback(OnRxNmtCb[NodeHandle].op,(void *)RxMsg);
-					else
-						Serial.println("Msg: no Nmt handler present");
-					
-				  break;
-			  default:
-				  break;
-		  }	// end of switch case
+			pfunction_holder *Cb = &(NodeCb[CbType]);
+			
+			#if(DEBUG_COMSGHandler & DEBUG_ONRX)
+			Serial.print("MSG: Rx: ");
+			Serial.println(RxMsg->Id, HEX);
+			#endif
+			
+			if(Cb->callback != NULL)
+				Cb->callback(Cb->op,(void *)RxMsg);
+			PostNode((NodeCb - &(OnRxCb[0][0])) / eCORxNumCb);
 	  } // end of processing for Node is registered
-		CORxNextRead++;
-    if(CORxNextRead == NumRxBuffers)
-			CORxNextRead = 0;
+		//release: the slot may be reused by the interrupt only after we are done with it
+		__atomic_store_n(&CORxNextRead, (uint16_t)(CORxNextRead + 1), __ATOMIC_RELEASE);
 
 		NumProcessedMessages++;
+		framesDone++;
   } //end of processing when NextRead != NextWrite
+	
+	PostSyncDueNodes();
+	Scheduler.Expire(micros());
+	while(Scheduler.RunNext())
+		PostSyncDueNodes();
+	
+	#if CO_PROBES
+	if(framesDone > 0)
+		CO_PROBE_END(eCOProbeMsgUpdate);
+	#endif
+	
+	return GetRxFramesPending();
+}
+
+/*------------------------------------------------------
+ * void SetRxFrameBudget(uint8_t)
+ * set the max number of frames dispatched per call of Update()
+ * a budget of 0 is corrected to 1
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::SetRxFrameBudget(uint8_t budget)
+{
+	if(budget == 0)
+		budget = 1;
+	RxFrameBudget = budget;
+}
+
+/*------------------------------------------------------
+ * void SetSDORxInInterrupt(bool)
+ * dispatch SDO responses right in the Rx interrupt instead of
+ * queueing them for Update(). A batch of the SDOHandler then runs
+ * at the pace of the bus and not of the loop.
+ * The SDOHandlers are called in interrupt context then - their
+ * debug output should be disabled.
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::SetSDORxInInterrupt(bool isEnabled)
+{
+	isSDORxInInterrupt = isEnabled;
+}
+
+/*------------------------------------------------------
+ * void SetCapture(COCapture *)
+ * record all frames received and sent into the capture,
+ * NULL to stop it. The received ones with the time of the
+ * Rx interrupt, the sent ones with the time they are handed
+ * to the CAN controller.
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::SetCapture(COCapture *thisCapture)
+{
+	CO_ENTER_CRITICAL();
+	Capture = thisCapture;
+	CO_EXIT_CRITICAL();
+}
+
+/*------------------------------------------------------
+ * uint8_t GetRxFramesPending()
+ * number of received frames not yet dispatched
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+uint8_t COMsgHandler::GetRxFramesPending()
+{
+	return (uint16_t)(__atomic_load_n(&CORxNextWrite, __ATOMIC_ACQUIRE) - CORxNextRead);
+}
+
+/*------------------------------------------------------
+ * void GetRxStats(CORxStats *)
+ * copy the counters of the Rx ring
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::GetRxStats(CORxStats *Stats)
+{
+	Stats->NumRxMessages = __atomic_load_n(&NumRxMessages, __ATOMIC_RELAXED);
+	Stats->NumProcessedMessages = NumProcessedMessages;
+	Stats->NumDroppedMessages = __atomic_load_n(&NumDroppedMessages, __ATOMIC_RELAXED);
+	Stats->HighWaterMark = __atomic_load_n(&RxHighWaterMark, __ATOMIC_RELAXED);
+	Stats->MaxLatencyUs = RxMaxLatencyUs;
+	Stats->MeanLatencyUs = (NumProcessedMessages > 0) ? (uint32_t)(RxSumLatencyUs / NumProcessedMessages) : 0;
+}
+
+/*------------------------------------------------------
+ * void ResetRxStats()
+ * clear the counters of the Rx ring
+ * the counters written by the interrupt are cleared with
+ * interrupts disabled
+ * 
+ * 2026-10-16 AW
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::ResetRxStats()
+{
+	noInterrupts();
+	NumRxMessages = 0;
+	NumDroppedMessages = 0;
+	RxHighWaterMark = 0;
+	interrupts();
+	NumProcessedMessages = 0;
+	RxMaxLatencyUs = 0;
+	RxSumLatencyUs = 0;
 }
 
 /*------------------------------------------------------
@@ -223,55 +426,114 @@ void COMsgHandler::COMsgHandler::Reset()
  * this is interrupt context and we should not use Serial.print out of this
  * >> will enter the contents of any received message in the prepared CORxVector
  *    no special flag used - Update will reacte when (CORxNextWrite != CORxNextRead)
+ *    if the ring is full the frame is dropped and counted
  * >> will flag a Tx being done when receiving the indication
+ * >> SDO responses are dispatched directly if SetSDORxInInterrupt() is set
+ * >> a received frame is time stamped with micros() right here, the
+ *    UNOR4CAN doesn't pass the time stamp of the controller
+ * >> frames sent and received and the error events are counted for
+ *    the bus statistics
+ * >> received frames are recorded by the capture if there is one
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-16 AW overflow check, drop counter and high water mark
+ * 2026-10-16 AW SDO responses in the interrupt
+ * 2026-10-16 AW time stamp
+ * 2026-10-16 AW bus statistics
+ * 2026-10-16 AW latency probe
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW capture
  * 
  * ----------------------------------------------------*/
 
 void COMsgHandler::OnRxHandler(can_callback_args_t *p_args)
 {
+	CO_PROBE_BEGIN(eCOProbeRxInterrupt);
+	
   switch (p_args->event) 
 	{
     case CAN_EVENT_TX_COMPLETE:
-			//SendMsg left the TxStatus @ TxStatus = eCOTxBusy
-		  //and would send only when TxStatus == eCOTxIdle
-		  //only now we can take new commands
-      TxStatus = eCOTxIdle;
+			//the mailbox is free again - refill it from the queue
+			OnTxDone(p_args->mailbox, true);
+      break;
+
+    case CAN_EVENT_TX_ABORTED:           /* Transmit abort event. */
+			OnTxDone(p_args->mailbox, false);
       break;
 
     case CAN_EVENT_RX_COMPLETE:
-			CORxVector[CORxNextWrite].Id = p_args->frame.id;
-		  CORxVector[CORxNextWrite].len = p_args->frame.data_length_code;
-		  if(p_args->frame.type == CAN_FRAME_TYPE_REMOTE)
-			  CORxVector[CORxNextWrite].isRTR = true;
-      else
+		{
+			uint32_t rxAt = micros();
+			uint16_t nextWrite = CORxNextWrite;
+			//acquire: Update() must be done with a slot before we overwrite it
+			uint16_t fillLevel = nextWrite - __atomic_load_n(&CORxNextRead, __ATOMIC_ACQUIRE);
+			
+      NumRxMessages++;
+			CountFrame(eCOTrafficRx, p_args->frame.id,
+			           COFrameBitsEstimate(p_args->frame.type == CAN_FRAME_TYPE_REMOTE, p_args->frame.data_length_code, p_args->frame.data));
+			CO_TRACE_EVENT(eCOTraceRx, p_args->frame.id & 0x7F, p_args->frame.id, COTracePayload(p_args->frame.data));
+			if(Capture != NULL)
+				Capture->Record(false, rxAt, p_args->frame.id, p_args->frame.type == CAN_FRAME_TYPE_REMOTE,
+				                p_args->frame.data_length_code, p_args->frame.data);
+			
+			if(isSDORxInInterrupt && ((p_args->frame.id & 0x780) == eCANSdoResp))
+			{
+				pfunction_holder *NodeCb = RxDispatch[p_args->frame.id & 0x7F];
+				
+				if((NodeCb != NULL) && (NodeCb[eCORxCbSDO].callback != NULL))
+				{
+					//the SDOHandler sends it's next request right from here
+					CANMsg SDOMsg;
+					
+					FrameToMsg(&(p_args->frame), &SDOMsg, rxAt);
+					NodeCb[eCORxCbSDO].callback(NodeCb[eCORxCbSDO].op, (void *)&SDOMsg);
+					PostNode((NodeCb - &(OnRxCb[0][0])) / eCORxNumCb);
+					break;
+				}
+			}
+			
+			if(fillLevel >= NumRxBuffers)
 			{
-        CORxVector[CORxNextWrite].isRTR = false;
-				memcpy((void *)CORxVector[CORxNextWrite].payload, p_args->frame.data, p_args->frame.data_length_code);
+				//ring is full - drop the new frame and keep the unread ones
+				NumDroppedMessages++;
+				CO_TRACE_EVENT(eCOTraceRxDropped, p_args->frame.id & 0x7F, p_args->frame.id, 0);
+				break;
 			}
-     	//now determine the service type
-			CORxVector[CORxNextWrite].serviceType = (COService)(p_args->frame.id & 0xFF80);
+			
+			CANMsg *RxMsg = &(CORxVector[nextWrite & RxBufferMask]);
+			
+			FrameToMsg(&(p_args->frame), RxMsg, rxAt);
       
 			#if(DEBUG_COMSGHandler & DEBUG_ONINT)
-			sprintf(IntBuff, "Int: rx: [%lX] [%d]: s: %X @ %d ", p_args->frame.id, p_args->frame.data_length_code,CORxVector[CORxNextWrite].serviceType,CORxNextWrite);
+			sprintf(IntBuff, "Int: rx: [%lX] [%d]: s: %X @ %d ", p_args->frame.id, p_args->frame.data_length_code,RxMsg->serviceType,nextWrite & RxBufferMask);
 			#endif
 			
-      NumRxMessages++;
-			CORxNextWrite++;
-      if(CORxNextWrite == NumRxBuffers)
-				CORxNextWrite = 0;
+			if((fillLevel + 1) > RxHighWaterMark)
+				RxHighWaterMark = fillLevel + 1;
+			
+			//release: publish the frame only after it is completely written
+			__atomic_store_n(&CORxNextWrite, (uint16_t)(nextWrite + 1), __ATOMIC_RELEASE);
       break;
+		}
 
-    case CAN_EVENT_ERR_WARNING:          /* error warning event */
-    case CAN_EVENT_ERR_PASSIVE:          /* error passive event */
     case CAN_EVENT_ERR_BUS_OFF:          /* error bus off event */
-    case CAN_EVENT_BUS_RECOVERY:         /* Bus recovery error event */
+			NumBusOff++;
+			NumCANErrors++;
+			CO_TRACE_EVENT(eCOTraceCANError, 0, p_args->event, 0);
+			break;
     case CAN_EVENT_MAILBOX_MESSAGE_LOST: /* overwrite/overrun error event */
+			NumRxOverruns++;
+			CO_TRACE_EVENT(eCOTraceCANError, 0, p_args->event, 0);
+			break;
+    case CAN_EVENT_ERR_WARNING:          /* error warning event */
+    case CAN_EVENT_ERR_PASSIVE:          /* error passive event */
     case CAN_EVENT_ERR_BUS_LOCK:         /* Bus lock detected (32 consecutive dominant bits). */
     case CAN_EVENT_ERR_CHANNEL:          /* Channel error has occurred. */
-    case CAN_EVENT_TX_ABORTED:           /* Transmit abort event. */
     case CAN_EVENT_ERR_GLOBAL:           /* Global error has occurred. */
+			NumCANErrors++;
+			CO_TRACE_EVENT(eCOTraceCANError, 0, p_args->event, 0);
+			break;
+    case CAN_EVENT_BUS_RECOVERY:         /* Bus recovery error event */
     case CAN_EVENT_TX_FIFO_EMPTY:        /* Transmit FIFO is empty. */
       #if 0
       Serial.print("> handler: error = ");
@@ -280,30 +542,55 @@ void COMsgHandler::OnRxHandler(can_callback_args_t *p_args)
       break;
 		default:
 		  #if(DEBUG_COMSGHandler & DEBUG_ONINT)
-			sprintf(IntBuff, "Int: rx: [%lX] [%d]: s: %X @ %d, ? ", p_args->frame.id, p_args->frame.data_length_code,CORxVector[CORxNextWrite].serviceType,CORxNextWrite);
+			sprintf(IntBuff, "Int: rx: [%lX] [%d]: s: %X @ %d, ? ", p_args->frame.id, p_args->frame.data_length_code,CORxVector[CORxNextWrite & RxBufferMask].serviceType,CORxNextWrite & RxBufferMask);
 			#endif
 			;
 		  break;
   }
+	
+	CO_PROBE_END(eCOProbeRxInterrupt);
+}
+
+/*------------------------------------------------------
+ * void FrameToMsg(can_frame_t *, CANMsg *, uint32_t rxAt)
+ * copy a received frame into a CANMsg
+ * 
+ * 2026-10-16 AW extracted from OnRxHandler
+ * 2026-10-16 AW time stamp
+ * 
+ * ----------------------------------------------------*/
+
+void COMsgHandler::FrameToMsg(can_frame_t *frame, CANMsg *Msg, uint32_t rxAt)
+{
+	Msg->Id = frame->id;
+	Msg->RxAt = rxAt;
+	Msg->len = frame->data_length_code;
+	if(frame->type == CAN_FRAME_TYPE_REMOTE)
+		Msg->isRTR = true;
+  else
+	{
+    Msg->isRTR = false;
+		memcpy((void *)Msg->payload, frame->data, frame->data_length_code);
+	}
+  //now determine the service type
+	Msg->serviceType = (COService)(frame->id & 0xFF80);
 }
 
 /*----------------------------------------------------------
  * char FindNode(char)
- * find the NodeHandle in the vector of adresses
+ * find the NodeHandle of a registered node-id
  * 
  * 2020-05-16 AW Header
+ * 2026-10-16 AW use the dispatch table
  * 
  * --------------------------------------------------------*/
 uint8_t COMsgHandler::FindNode(uint8_t NodeId)
 {
-	uint8_t i = 0;
 	uint8_t slot = InvalidSlot;
-	while(i < MsgHandler_MaxNodes)
-	{
-		if((uint8_t)nodeId[i] == NodeId)
-			slot = i;
-		i++;
-	}
+	
+	if((NodeId < NumNodeIds) && (RxDispatch[NodeId] != NULL))
+		slot = (RxDispatch[NodeId] - &(OnRxCb[0][0])) / eCORxNumCb;
+	
 	return slot;	
 }
 
@@ -311,8 +598,10 @@ uint8_t COMsgHandler::FindNode(uint8_t NodeId)
  * uint8_t RegisterNode(char)
  * try to register a node with it's node ID.
  * the handerl shall be used as a regference for furhter calls
+ * a node-id already registered returns it's existing handle
  * 
  * 2020-05-16 AW Header
+ * 2026-10-16 AW enter the node into the dispatch table
  * 
  * --------------------------------------------------------*/
 
@@ -320,6 +609,14 @@ uint8_t COMsgHandler::RegisterNode(uint8_t thisNodeId)
 {
 	uint8_t i = 0;
 	uint8_t slot = InvalidSlot;
+	
+	if((thisNodeId == 0) || (thisNodeId >= NumNodeIds))
+		return InvalidSlot;
+	
+	slot = FindNode(thisNodeId);
+	if(slot != InvalidSlot)
+		return slot;
+	
 	while(i < MsgHandler_MaxNodes)
 	{
 		if(nodeId[i] == invalidNodeId)
@@ -330,7 +627,10 @@ uint8_t COMsgHandler::RegisterNode(uint8_t thisNodeId)
 		i++;
 	}
 	if(slot != InvalidSlot)
+	{
 		nodeId[slot]=(int16_t)thisNodeId;
+		RxDispatch[thisNodeId] = OnRxCb[slot];
+	}
 	
 	#if(DEBUG_COMSGHandler & DEBUG_REGNODE)
 	Serial.print("MSG: Reg ");
@@ -366,73 +666,199 @@ int8_t thisNodeId = -1;
  * remove the entry for a given node
  * 
  * 2020-05-16 AW Header
+ * 2026-10-16 AW remove it from the dispatch table
+ * 2026-10-16 AW and it's PDOs from the COB-Id table
+ * 2026-10-16 AW and from the scheduler
  * 
  * --------------------------------------------------------*/
 
 void COMsgHandler::UnRegisterNode(uint8_t NodeHandle)
 {
-	if(NodeHandle < MsgHandler_MaxNodes)
+	if((NodeHandle < MsgHandler_MaxNodes) && (nodeId[NodeHandle] != invalidNodeId))
 	{
+		RxDispatch[nodeId[NodeHandle]] = NULL;
 		nodeId[NodeHandle] = invalidNodeId;
-		OnRxSDOCb[NodeHandle].callback = NULL;
-		OnRxSDOCb[NodeHandle].op = NULL;
-		OnRxNmtCb[NodeHandle].callback = NULL;
-		OnRxNmtCb[NodeHandle].op = NULL;
-		OnRxEMCYCb[NodeHandle].callback = NULL;
-		OnRxEMCYCb[NodeHandle].op = NULL;
-		OnRxPDOCb[NodeHandle].callback = NULL;
-		OnRxPDOCb[NodeHandle].op = NULL;
+		CancelSDORequest(NodeHandle);
+		Register_OnDueCb(NodeHandle, NULL);
+		
+		//remove the PDOs of the node, keeping the table sorted
+		uint16_t kept = 0;
+		for(uint16_t iter = 0; iter < NumRxPDOsRegistered; iter++)
+		{
+			if((RxPDODispatch[iter].Entry & 0x7F) != NodeHandle)
+				RxPDODispatch[kept++] = RxPDODispatch[iter];
+		}
+		NumRxPDOsRegistered = kept;
 		
+		for(uint8_t cb = 0; cb < eCORxNumCb; cb++)
+		{
+			OnRxCb[NodeHandle][cb].callback = NULL;
+			OnRxCb[NodeHandle][cb].op = NULL;
+		}
 	}
 }
 		
 /*----------------------------------------------------------
- * SendMsg(MCMsg *TxMsg)
+ * bool SendMsg(CANMsg *msg, uint32_t *ticket, volatile uint32_t *LateCount, COTxStamp *Stamp)
  *
- * if possible send the Msg directly
- * takes a pointer to a CAN msg and copies the contents in a 
- * CAN frame used by the low level
- * this local instance is used for send - a syncronous call
+ * copy the Msg into the Tx queue and start sending it if one
+ * of the Tx mailboxes is free. Never waits for the bus.
+ * The frame is queued in it's priority class sorted by COB-Id.
+ * If the class is at it's depth the class policy decides.
+ * Returns false if the frame was refused or the handler is
+ * not yet open.
+ * If ticket is given it receives a number to check the completion
+ * of this very frame with IsTxDone(). A frame replacing a queued one
+ * of the same COB-Id (eCOTxReplaceSameId) takes over the ticket of
+ * the queued one: both callers get the same ticket and IsTxDone()
+ * of it turns true when the new content has left the queue.
+ * If LateCount is given, the frame is a synchronous one: it has to be
+ * sent within the synchronous window of the last SYNC. Dropped from
+ * the queue or sent after the window it is counted in *LateCount.
+ * A remote frame keeps it's len as the DLC, e.g. the length of the
+ * PDO requested.
+ * If Stamp is given it receives the micros() the frame is handed to the
+ * CAN controller - the time a response is due from, not the time spent
+ * in the queue.
  *
  * 2025-01-01 AW
+ * 2026-10-16 AW queue the frame instead of single frame busy gating
+ * 2026-10-16 AW priority classes
+ * 2026-10-16 AW synchronous frames
+ * 2026-10-16 AW DLC of remote frames
+ * 2026-10-16 AW time stamp of the hand-off
+ * 2026-10-16 AW a refused frame traced
+ * 2026-10-16 AW a replaced frame keeps it's ticket
  * 
  * --------------------------------------------------------*/
 
-bool COMsgHandler::SendMsg(CANMsg *msg)
+bool COMsgHandler::SendMsg(CANMsg *msg, uint32_t *ticket, volatile uint32_t *LateCount, COTxStamp *Stamp)
 {
 	bool returnValue = false;
 	
-	if(TxStatus == eCOTxIdle)
+	if(TxStatus != eCOTxOffline)
   {
-    can_frame_t TxMsg;
-    
-    TxMsg.id = msg->Id;
-		TxMsg.id_mode = CAN_ID_MODE_STANDARD;
-		if(msg->isRTR)
+		COTxClass thisClass = GetTxClass(msg->Id);
+		uint8_t entry = InvalidSlot;
+		uint8_t prev = InvalidSlot;
+		bool isReplaced = false;
+		
+		CO_ENTER_CRITICAL();
+		
+		if(TxClassPolicy[thisClass] == eCOTxReplaceSameId)
 		{
-			TxMsg.type = CAN_FRAME_TYPE_REMOTE;
-			TxMsg.data_length_code = 0;
+			//a queued frame with the same COB-Id is superseded by the new one
+			for(entry = TxClassHead[thisClass]; entry != InvalidSlot; entry = COTxPool[entry].Next)
+			{
+				if(COTxPool[entry].Msg.Id == msg->Id)
+					break;
+			}
+			if(entry != InvalidSlot)
+			{
+				NumTxDropped[thisClass]++;
+				isReplaced = true;
+			}
 		}
-		else
+		
+		if((entry == InvalidSlot) && (TxClassCount[thisClass] >= TxClassDepth[thisClass]))
+		{
+			if(TxClassPolicy[thisClass] == eCOTxDropOldest)
+			{
+				//find the lowest ticket of the class and remove it
+				uint8_t oldest = TxClassHead[thisClass];
+				uint8_t oldestPrev = InvalidSlot;
+				
+				for(uint8_t iter = TxClassHead[thisClass]; iter != InvalidSlot; iter = COTxPool[iter].Next)
+				{
+					if((int32_t)(COTxPool[iter].Ticket - COTxPool[oldest].Ticket) < 0)
+					{
+						oldest = iter;
+						oldestPrev = prev;
+					}
+					prev = iter;
+				}
+				if(oldest != InvalidSlot)
+				{
+					TxUnlink(thisClass, oldest, oldestPrev);
+					NumTxDropped[thisClass]++;
+				}
+			}
+		}
+		
+		if(entry == InvalidSlot)
+		{
+			if((TxClassCount[thisClass] < TxClassDepth[thisClass]) && (TxFreeHead != InvalidSlot))
+			{
+				//take an entry out of the free list and insert it behind
+				//all frames of the class with a lower or equal COB-Id
+				entry = TxFreeHead;
+				TxFreeHead = COTxPool[entry].Next;
+				
+				prev = InvalidSlot;
+				uint8_t next = TxClassHead[thisClass];
+				while((next != InvalidSlot) && (COTxPool[next].Msg.Id <= msg->Id))
+				{
+					prev = next;
+					next = COTxPool[next].Next;
+				}
+				COTxPool[entry].Next = next;
+				if(prev == InvalidSlot)
+					TxClassHead[thisClass] = entry;
+				else
+					COTxPool[prev].Next = entry;
+				
+				TxClassCount[thisClass]++;
+				TxFramesQueued++;
+				if(TxFramesQueued > TxHighWaterMark)
+					TxHighWaterMark = TxFramesQueued;
+			}
+			else
+			{
+				NumTxRejected++;
+				CO_TRACE_EVENT(eCOTraceTxRejected, msg->Id & 0x7F, msg->Id, 0);
+			}
+		}
+		
+		if(entry != InvalidSlot)
 		{
-		  TxMsg.type = CAN_FRAME_TYPE_DATA;
-		  TxMsg.data_length_code = msg->len;
-      memcpy(TxMsg.data, msg->payload, 8);
+			CANMsg *TxMsg = &(COTxPool[entry].Msg);
+			
+			TxMsg->Id = msg->Id;
+			TxMsg->isRTR = msg->isRTR;
+			TxMsg->serviceType = msg->serviceType;
+			TxMsg->len = (msg->len > 8) ? 8 : msg->len;
+			if(!msg->isRTR)
+				memcpy(TxMsg->payload, msg->payload, 8);
+			
+			//a replaced frame keeps it's ticket, the holder of it
+			//waits for the frame superseding it
+			if(!isReplaced)
+			{
+				COTxPool[entry].Ticket = TxNextTicket;
+				TxNextTicket++;
+			}
+			COTxPool[entry].LateCount = LateCount;
+			COTxPool[entry].SyncNr = SyncNr;
+			COTxPool[entry].QueuedAt = micros();
+			COTxPool[entry].Stamp = Stamp;
+			if(ticket != NULL)
+				*ticket = COTxPool[entry].Ticket;
+			
+			TxStartNext();
+			returnValue = true;
 		}
-		//indicate busy before sending
-		TxStatus = eCOTxBusy;
-		returnValue = can.send(&TxMsg);
+		
+		CO_EXIT_CRITICAL();
    
 		#if ((DEBUG_COMSGHandler & DEBUG_TXMSG) > 0)
-    Serial.print("Msg> CAN write of frame returns: ");
-    Serial.println((returnValue ? "ok" : "fail"));
+    Serial.print("Msg> CAN queueing of frame returns: ");
+    Serial.println((returnValue ? "ok" : "full"));
     #endif
-	
 	}
 	else
 	{
 		#if ((DEBUG_COMSGHandler & DEBUG_TXMSG) > 0)
-    Serial.println("Msg> CAN write still busy");
+    Serial.println("Msg> CAN not open");
     #else
 		;
 		#endif
@@ -442,106 +868,1142 @@ bool COMsgHandler::SendMsg(CANMsg *msg)
 }
 
 /*----------------------------------------------------------
- * COTxStatus GetTxStatus()
- * return the status of the Tx channel
- * 
- * 2024-11-20 AW 
+ * bool SendSDORequest(uint8_t NodeHandle, CANMsg *msg)
+ *
+ * the SDO client scheduler: hand over the one outstanding SDO
+ * request of a node. The Msg is not copied, it has to stay valid
+ * and unchanged until sent - a SDO handler sends it's request Msg
+ * and does not touch it before the response. A request of the node
+ * still waiting is replaced, so a re-sent request is not sent twice.
+ * The requests of all nodes are sent round-robin within the SDO
+ * class, a node never waits for the complete transfers of the others
+ * and is never refused for a full queue.
+ * Returns false if the handler is not yet open or the node handle
+ * is not registered.
+ *
+ * 2026-10-16 AW
  * 
  * --------------------------------------------------------*/
 
-COTxStatus COMsgHandler::GetTxStatus()
+bool COMsgHandler::SendSDORequest(uint8_t NodeHandle, CANMsg *msg)
 {
-	return TxStatus;
+	if((TxStatus == eCOTxOffline) || (NodeHandle >= MsgHandler_MaxNodes) || (nodeId[NodeHandle] == invalidNodeId))
+		return false;
+	
+	CO_ENTER_CRITICAL();
+	
+	if(SDORequest[NodeHandle] == NULL)
+	{
+		NumSDORequests++;
+		if(NumSDORequests > SDOHighWaterMark)
+			SDOHighWaterMark = NumSDORequests;
+	}
+	SDORequest[NodeHandle] = msg;
+	TxStartNext();
+	
+	CO_EXIT_CRITICAL();
+	
+	return true;
 }
 
 /*----------------------------------------------------------
- * Register_onRxCb(function_holder *cb)
- * store the function and object pointer for the callback
- * called in case of a successful Rx
- * 
- * 2020-05-10 AW Header
+ * void CancelSDORequest(uint8_t NodeHandle)
+ *
+ * drop the SDO request of the node if it is still waiting
+ * for the bus
+ *
+ * 2026-10-16 AW
  * 
  * --------------------------------------------------------*/
 
-void COMsgHandler::Register_OnRxSDOCb(uint8_t NodeHandle, pfunction_holder *Cb)
+void COMsgHandler::CancelSDORequest(uint8_t NodeHandle)
 {
 	if(NodeHandle < MsgHandler_MaxNodes)
 	{
-		OnRxSDOCb[NodeHandle].callback = Cb->callback;
-		OnRxSDOCb[NodeHandle].op = Cb->op;
-		
-		#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
-		Serial.print("registered SDO Handler @ ");
-		Serial.println(NodeHandle);
-		#endif
+		CO_ENTER_CRITICAL();
+		if(SDORequest[NodeHandle] != NULL)
+		{
+			SDORequest[NodeHandle] = NULL;
+			NumSDORequests--;
+		}
+		CO_EXIT_CRITICAL();
 	}
 }
 
 /*----------------------------------------------------------
- * Register_onRxNmtCb(function_holder *cb)
- * store the function and object pointer for the callback
- * called in case of a successful Rx
- * 
- * 2020-05-10 AW Header
+ * bool IsSDORequestWaiting(uint8_t NodeHandle)
+ *
+ * the SDO request of the node is still waiting for the bus -
+ * it's response time-out hasn't started yet
+ *
+ * 2026-10-16 AW
  * 
  * --------------------------------------------------------*/
 
-void COMsgHandler::Register_OnRxNmtCb(uint8_t NodeHandle, pfunction_holder *Cb)
+bool COMsgHandler::IsSDORequestWaiting(uint8_t NodeHandle)
 {
-	if(NodeHandle < MsgHandler_MaxNodes)
-	{
-		OnRxNmtCb[NodeHandle].callback = Cb->callback;
-		OnRxNmtCb[NodeHandle].op = Cb->op;
-		
-		#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
-		Serial.print("registered Nmt Handler @ ");
-		Serial.println(NodeHandle);
-		#endif
-	}
+	return (NodeHandle < MsgHandler_MaxNodes) && (SDORequest[NodeHandle] != NULL);
 }
 
 /*----------------------------------------------------------
- * Register_onRxEMCYCb(function_holder *cb)
- * store the function and object pointer for the callback
- * called in case of a successful Rx
- * 
- * 2020-05-10 AW Header
+ * void TxUnlink(COTxClass, uint8_t entry, uint8_t prev)
+ *
+ * remove an entry from the list of it's class and
+ * return it to the free list
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
  * 
  * --------------------------------------------------------*/
 
-void COMsgHandler::Register_OnRxEMCYCb(uint8_t NodeHandle, pfunction_holder *Cb)
+void COMsgHandler::TxUnlink(COTxClass thisClass, uint8_t entry, uint8_t prev)
 {
-	if(NodeHandle < MsgHandler_MaxNodes)
-	{
-		OnRxEMCYCb[NodeHandle].callback = Cb->callback;
-		OnRxEMCYCb[NodeHandle].op = Cb->op;
-		
-		#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
-		Serial.print("registered EMCY Handler @ ");
-		Serial.println(NodeHandle);
-		#endif
-	}
+	if(prev == InvalidSlot)
+		TxClassHead[thisClass] = COTxPool[entry].Next;
+	else
+		COTxPool[prev].Next = COTxPool[entry].Next;
+	
+	COTxPool[entry].Next = TxFreeHead;
+	TxFreeHead = entry;
+	
+	TxClassCount[thisClass]--;
+	TxFramesQueued--;
 }
 
 /*----------------------------------------------------------
- * Register_onRxPDOCb(function_holder *cb)
- * store the function and object pointer for the callback
- * called in case of a successful Rx
- * 
- * 2020-05-10 AW Header
+ * void TxStartNext()
+ *
+ * move queued frames into free Tx mailboxes.
+ * The head of the highest class goes first.
+ * Remote frames use the remote mailbox, data frames any of the
+ * data mailboxes - so a waiting remote frame does not block data
+ * frames of lower classes and vice versa.
+ * The CAN controller sends pending mailboxes in order of their CAN-Id,
+ * with the same CAN-Id the lower mailbox first. So a frame waits while
+ * one with the same CAN-Id is pending - e.g. the segments of a SDO block
+ * download have to be sent in order.
+ * Within the SDO class the queued frames go first, then the requests
+ * of the SDO client scheduler.
+ * A synchronous frame at the head of it's class which can't make it's
+ * synchronous window any more - it would end after the window - is
+ * dropped and counted late.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW pick by priority class
+ * 2026-10-16 AW keep the order of frames with the same CAN-Id
+ * 2026-10-16 AW SDO client scheduler
+ * 2026-10-16 AW drop late synchronous frames
+ * 2026-10-16 AW the end of the frame has to be within the window
  * 
  * --------------------------------------------------------*/
 
-void COMsgHandler::Register_OnRxPDOCb(uint8_t NodeHandle, pfunction_holder *Cb)
+void COMsgHandler::TxStartNext()
 {
-	if(NodeHandle < MsgHandler_MaxNodes)
+	bool frameStarted = true;
+	
+	while(frameStarted && ((TxFramesQueued > 0) || (NumSDORequests > 0)))
 	{
-		OnRxPDOCb[NodeHandle].callback = Cb->callback;
-		OnRxPDOCb[NodeHandle].op = Cb->op;
-
-		#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
-		Serial.print("registered PDO Handler @ ");
-		Serial.println(NodeHandle);
-		#endif
+		frameStarted = false;
+		
+		for(uint8_t thisClass = 0; thisClass < eCOTxNumClasses; thisClass++)
+		{
+			uint8_t entry = TxClassHead[thisClass];
+			uint8_t slot = InvalidSlot;
+			
+			if((entry != InvalidSlot) && IsSyncFrameLate(COTxPool[entry].LateCount, COTxPool[entry].SyncNr, &(COTxPool[entry].Msg)))
+			{
+				//would be discarded by the node anyway
+				(*COTxPool[entry].LateCount)++;
+				NumTxSyncDropped++;
+				TxUnlink((COTxClass)thisClass, entry, InvalidSlot);
+				frameStarted = true;
+				break;
+			}
+			
+			if(entry != InvalidSlot)
+				slot = TxFindMailbox(&(COTxPool[entry].Msg));
+			
+			if(slot != InvalidSlot)
+			{
+				TxStartFrame(slot, &(COTxPool[entry].Msg), COTxPool[entry].Ticket, COTxPool[entry].QueuedAt, COTxPool[entry].Stamp);
+				TxMailboxLateCount[slot] = COTxPool[entry].LateCount;
+				TxMailboxSyncNr[slot] = COTxPool[entry].SyncNr;
+				TxUnlink((COTxClass)thisClass, entry, InvalidSlot);
+				frameStarted = true;
+			}
+			else if(thisClass == eCOTxClassSDO)
+				frameStarted = TxStartSDORequest();
+			
+			//start over with the highest class
+			//otherwise the head of this class has to wait for it's mailbox
+			if(frameStarted)
+				break;
+		}
+	}
+}
+
+/*----------------------------------------------------------
+ * uint8_t TxFindMailbox(CANMsg *msg)
+ *
+ * the mailbox slot the frame can be sent with or InvalidSlot
+ * if none is free or a data frame with the same CAN-Id is
+ * still pending.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+uint8_t COMsgHandler::TxFindMailbox(CANMsg *msg)
+{
+	uint8_t slot = InvalidSlot;
+	
+	if(msg->isRTR)
+	{
+		if((TxMailboxBusy & (0x01 << TxRemoteMailboxSlot)) == 0)
+			slot = TxRemoteMailboxSlot;
+	}
+	else
+	{
+		for(uint8_t iter = 0; iter < NumTxMailboxes; iter++)
+		{
+			if((TxDataMailboxesMask & TxMailboxBusy) & (0x01 << iter))
+			{
+				if(TxMailboxId[iter] == msg->Id)
+				{
+					slot = InvalidSlot;
+					break;
+				}
+			}
+			else if((slot == InvalidSlot) && (TxDataMailboxesMask & (0x01 << iter)))
+				slot = iter;
+		}
+	}
+	return slot;
+}
+
+/*----------------------------------------------------------
+ * void TxStartFrame(uint8_t slot, CANMsg *msg, uint32_t ticket, uint32_t queuedAt, COTxStamp *stamp)
+ *
+ * hand the frame to the CAN controller using the mailbox of
+ * the slot, which has to be free. queuedAt (us) and the bits of the
+ * frame are kept for the bus statistics. A stamp given is set once
+ * the controller took the frame.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW bus statistics
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW capture
+ * 2026-10-16 AW DLC of remote frames
+ * 2026-10-16 AW time stamp of the hand-off
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::TxStartFrame(uint8_t slot, CANMsg *msg, uint32_t ticket, uint32_t queuedAt, COTxStamp *stamp)
+{
+	can_frame_t TxMsg;
+	
+	TxMsg.id = msg->Id;
+	TxMsg.id_mode = CAN_ID_MODE_STANDARD;
+	if(msg->isRTR)
+	{
+		TxMsg.type = CAN_FRAME_TYPE_REMOTE;
+		TxMsg.data_length_code = msg->len;
+	}
+	else
+	{
+		TxMsg.type = CAN_FRAME_TYPE_DATA;
+		TxMsg.data_length_code = msg->len;
+		memcpy(TxMsg.data, msg->payload, 8);
+	}
+	
+	TxMailboxTicket[slot] = ticket;
+	TxMailboxId[slot] = msg->Id;
+	TxMailboxLateCount[slot] = NULL;
+	TxMailboxQueuedAt[slot] = queuedAt;
+	TxMailboxBits[slot] = COFrameBitsEstimate(msg->isRTR, msg->len, msg->payload);
+	TxMailboxBusy |= (0x01 << slot);
+	
+	if(can->send(&TxMsg, TxMailboxIds[slot]) <= 0)
+	{
+		//refused by the controller - the frame is lost
+		TxMailboxBusy &= ~(0x01 << slot);
+		NumTxFailed++;
+	}
+	else
+	{
+		CO_TRACE_EVENT(eCOTraceTx, msg->Id & 0x7F, msg->Id, COTracePayload(msg->payload));
+		if(stamp != NULL)
+		{
+			stamp->StartedAt = micros();
+			stamp->isStarted = true;
+		}
+		if(Capture != NULL)
+			Capture->Record(true, micros(), msg->Id, msg->isRTR, msg->len, msg->payload);
+	}
+}
+
+/*----------------------------------------------------------
+ * bool TxStartSDORequest()
+ *
+ * start the waiting SDO request of the next node in turn.
+ * The nodes are served round-robin starting behind the one
+ * served last, skipping nodes whose CAN-Id is still pending
+ * in a mailbox or queued in the SDO class - a frame sent by
+ * SendMsg() before, e.g. the end of a block upload, goes first.
+ * Returns true if a request was started, it's RxAt
+ * is the time it was handed to the CAN controller.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW time stamp for the SDO response time-out
+ * 2026-10-16 AW keep the order behind queued frames of the node
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::TxStartSDORequest()
+{
+	uint8_t handle = SDONextNode;
+	
+	if((NumSDORequests == 0) || ((TxMailboxBusy & TxDataMailboxesMask) == TxDataMailboxesMask))
+		return false;
+	
+	for(uint8_t iter = 0; iter < MsgHandler_MaxNodes; iter++)
+	{
+		if((SDORequest[handle] != NULL) && !TxIsQueued(eCOTxClassSDO, SDORequest[handle]->Id))
+		{
+			uint8_t slot = TxFindMailbox(SDORequest[handle]);
+			
+			if(slot != InvalidSlot)
+			{
+				uint32_t now = micros();
+				
+				TxStartFrame(slot, SDORequest[handle], TxNextTicket, now, NULL);
+				SDORequest[handle]->RxAt = now;
+				TxNextTicket++;
+				SDORequest[handle] = NULL;
+				NumSDORequests--;
+				
+				SDONextNode = handle + 1;
+				if(SDONextNode == MsgHandler_MaxNodes)
+					SDONextNode = 0;
+				return true;
+			}
+		}
+		handle++;
+		if(handle == MsgHandler_MaxNodes)
+			handle = 0;
+	}
+	return false;
+}
+
+/*----------------------------------------------------------
+ * bool TxIsQueued(COTxClass thisClass, uint32_t Id)
+ *
+ * a frame with the CAN-Id is waiting in the queue of the class
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::TxIsQueued(COTxClass thisClass, uint32_t Id)
+{
+	for(uint8_t entry = TxClassHead[thisClass]; entry != InvalidSlot; entry = COTxPool[entry].Next)
+	{
+		if(COTxPool[entry].Msg.Id == Id)
+			return true;
+	}
+	return false;
+}
+
+/*----------------------------------------------------------
+ * void OnTxDone(uint32_t mailbox, bool success)
+ *
+ * a Tx mailbox reported completion or abort.
+ * Free it and start the next queued frame.
+ * A synchronous frame completed after it's window is counted late.
+ * A frame sent is counted for the bus statistics.
+ * Interrupt context.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW late synchronous frames
+ * 2026-10-16 AW bus statistics
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::OnTxDone(uint32_t mailbox, bool success)
+{
+	for(uint8_t iter = 0; iter < NumTxMailboxes; iter++)
+	{
+		if(TxMailboxIds[iter] == mailbox)
+		{
+			TxMailboxBusy &= ~(0x01 << iter);
+			if(success)
+			{
+				uint32_t latency = micros() - TxMailboxQueuedAt[iter];
+				
+				NumTxCompleted++;
+				CountFrame(eCOTrafficTx, TxMailboxId[iter], TxMailboxBits[iter]);
+				if(latency > TxMaxLatencyUs)
+					TxMaxLatencyUs = latency;
+				TxSumLatencyUs += latency;
+				TxNumLatencies++;
+				
+				if(IsSyncFrameLate(TxMailboxLateCount[iter], TxMailboxSyncNr[iter], NULL))
+					(*TxMailboxLateCount[iter])++;
+			}
+			else
+				NumTxFailed++;
+			TxMailboxLateCount[iter] = NULL;
+			break;
+		}
+	}
+	TxStartNext();
+}
+
+/*----------------------------------------------------------
+ * void OnSyncSent(uint32_t atUs)
+ *
+ * a SYNC was handed over at atUs (micros()) and starts the
+ * synchronous window. Synchronous frames queued before are
+ * late from now on.
+ * Called by the COSyncHandler, maybe from the timer interrupt.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::OnSyncSent(uint32_t atUs)
+{
+	CO_ENTER_CRITICAL();
+	SyncSentAt = atUs;
+	SyncNr++;
+	CO_EXIT_CRITICAL();
+}
+
+/*----------------------------------------------------------
+ * void Register_OnDueCb(uint8_t NodeHandle, pfunction_holder *Cb)
+ *
+ * the node is run by the scheduler of Update(): Cb->callback is
+ * called with Cb->op whenever the node is due. It is due right away
+ * and then when posted or scheduled again. NULL removes it from the
+ * scheduler.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::Register_OnDueCb(uint8_t NodeHandle, pfunction_holder *Cb)
+{
+	if(NodeHandle >= MsgHandler_MaxNodes)
+		return;
+	
+	Scheduler.Cancel(&NodeDue[NodeHandle]);
+	Scheduler.InitItem(&NodeDue[NodeHandle], Cb);
+	NodeSyncDue[NodeHandle] = false;
+	PostNode(NodeHandle);
+}
+
+/*----------------------------------------------------------
+ * void ScheduleNode(uint8_t NodeHandle, uint32_t DueInUs)
+ *
+ * the node is due in DueInUs at the latest, a deadline set before
+ * which is earlier is kept. SchedNotDue: nothing to do until the
+ * node is posted.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::ScheduleNode(uint8_t NodeHandle, uint32_t DueInUs)
+{
+	if((NodeHandle < MsgHandler_MaxNodes) && (NodeDue[NodeHandle].Cb.callback != NULL))
+		Scheduler.ArmIn(&NodeDue[NodeHandle], DueInUs);
+}
+
+/*----------------------------------------------------------
+ * void PostNode(uint8_t NodeHandle)
+ *
+ * the node is due right away. May be called from the interrupt.
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::PostNode(uint8_t NodeHandle)
+{
+	if((NodeHandle < MsgHandler_MaxNodes) && (NodeDue[NodeHandle].Cb.callback != NULL))
+		Scheduler.Post(&NodeDue[NodeHandle]);
+}
+
+/*----------------------------------------------------------
+ * void SetNodeSyncDue(uint8_t NodeHandle, bool isDue)
+ *
+ * the node has work with each SYNC sent (synchronous RxPDOs) and
+ * is posted by the Update() after it
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::SetNodeSyncDue(uint8_t NodeHandle, bool isDue)
+{
+	if(NodeHandle < MsgHandler_MaxNodes)
+		NodeSyncDue[NodeHandle] = isDue;
+}
+
+/*----------------------------------------------------------
+ * void SetSyncWindowUs(uint32_t windowUs)
+ *
+ * the length of the synchronous window in us (0x1007),
+ * 0: no window, synchronous frames are never late
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::SetSyncWindowUs(uint32_t windowUs)
+{
+	SyncWindowUs = windowUs;
+}
+
+/*----------------------------------------------------------
+ * bool IsInSyncWindow()
+ *
+ * true if the window of the last SYNC is still open
+ * or there is no window
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::IsInSyncWindow()
+{
+	if(SyncWindowUs == 0)
+		return true;
+	
+	return (micros() - SyncSentAt) < SyncWindowUs;
+}
+
+/*----------------------------------------------------------
+ * void PostSyncDueNodes()
+ *
+ * post the sync due nodes once for each SYNC sent since the
+ * last call
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::PostSyncDueNodes()
+{
+	uint32_t syncNr = SyncNr;
+	
+	if(syncNr == DueSyncNr)
+		return;
+	DueSyncNr = syncNr;
+	
+	for(uint8_t iter = 0; iter < MsgHandler_MaxNodes; iter++)
+	{
+		if(NodeSyncDue[iter])
+			PostNode(iter);
+	}
+}
+
+/*----------------------------------------------------------
+ * bool IsSyncFrameLate(volatile uint32_t *LateCount, uint32_t FrameSyncNr, CANMsg *msg)
+ *
+ * a synchronous frame (LateCount given) is late once the window
+ * of the SYNC it was queued after is closed - or another SYNC
+ * was sent since. A frame still to be sent (msg given) is late
+ * already if it would end after the window: it's duration on
+ * the bus at the bit rate is added.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW duration of the frame
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::IsSyncFrameLate(volatile uint32_t *LateCount, uint32_t FrameSyncNr, CANMsg *msg)
+{
+	uint32_t frameUs = 0;
+	
+	if((LateCount == NULL) || (SyncWindowUs == 0))
+		return false;
+	
+	if(msg != NULL)
+		frameUs = (uint32_t)COFrameBitsEstimate(msg->isRTR, msg->len, msg->payload) * 1000000UL / (uint32_t)can_bitrate;
+	
+	return (FrameSyncNr != SyncNr) || ((micros() - SyncSentAt + frameUs) > SyncWindowUs);
+}
+
+/*----------------------------------------------------------
+ * void CountFrame(COTrafficDir Dir, uint32_t Id, uint8_t bits)
+ * count a frame received or sent for the bus statistics: the bits
+ * of the period, the service and the top talkers. A COB-Id not in
+ * the table of the top talkers replaces the one with the least bits.
+ * Must be called with interrupts disabled or from the CAN interrupt.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::CountFrame(COTrafficDir Dir, uint32_t Id, uint8_t bits)
+{
+	COTrafficCount *Service = &ServiceCount[Dir][(Id >> 7) & 0x0F];
+	uint8_t least = 0;
+	uint8_t entry;
+	
+	BusPeriodBits += bits;
+	Service->NumFrames++;
+	Service->NumBits += bits;
+	
+	for(entry = 0; entry < NumTopTalkers; entry++)
+	{
+		if((TopTalkers[entry].COBId == Id) && (TopTalkers[entry].Dir == Dir))
+			break;
+		if(TopTalkers[entry].Count.NumBits < TopTalkers[least].Count.NumBits)
+			least = entry;
+	}
+	if(entry == NumTopTalkers)
+	{
+		//takes over the counts of the one replaced
+		entry = least;
+		TopTalkers[entry].COBId = Id;
+		TopTalkers[entry].Dir = Dir;
+	}
+	TopTalkers[entry].Count.NumFrames++;
+	TopTalkers[entry].Count.NumBits += bits;
+}
+
+/*----------------------------------------------------------
+ * void UpdateBusLoad(uint32_t timeNow)
+ * close the period of the bus load when it's over. If Update()
+ * was not called for more than a period the next one starts now.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::UpdateBusLoad(uint32_t timeNow)
+{
+	if((timeNow - BusPeriodStartedAt) < BusLoadPeriodMs)
+		return;
+	
+	CO_ENTER_CRITICAL();
+	BusLoadBits[BusLoadNextPeriod] = BusPeriodBits;
+	BusPeriodBits = 0;
+	CO_EXIT_CRITICAL();
+	
+	BusLoadNextPeriod = (BusLoadNextPeriod + 1) % NumBusLoadPeriods;
+	if(BusLoadNumPeriods < NumBusLoadPeriods)
+		BusLoadNumPeriods++;
+	
+	BusPeriodStartedAt += BusLoadPeriodMs;
+	if((timeNow - BusPeriodStartedAt) >= BusLoadPeriodMs)
+		BusPeriodStartedAt = timeNow;
+}
+
+/*----------------------------------------------------------
+ * bool IsTxDone(uint32_t ticket)
+ *
+ * check whether the frame queued with this ticket has left
+ * the Tx queue and the CAN controller - either sent, failed or
+ * dropped by the class policy
+ *
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::IsTxDone(uint32_t ticket)
+{
+	bool returnValue = true;
+	
+	CO_ENTER_CRITICAL();
+	
+	for(uint8_t iter = 0; iter < NumTxMailboxes; iter++)
+	{
+		if((TxMailboxBusy & (0x01 << iter)) && (TxMailboxTicket[iter] == ticket))
+			returnValue = false;
+	}
+	
+	for(uint8_t thisClass = 0; (thisClass < eCOTxNumClasses) && returnValue; thisClass++)
+	{
+		for(uint8_t entry = TxClassHead[thisClass]; entry != InvalidSlot; entry = COTxPool[entry].Next)
+		{
+			if(COTxPool[entry].Ticket == ticket)
+			{
+				returnValue = false;
+				break;
+			}
+		}
+	}
+	
+	CO_EXIT_CRITICAL();
+	
+	return returnValue;
+}
+
+/*----------------------------------------------------------
+ * COTxStatus GetTxStatus()
+ * return the status of the Tx channel
+ * eCOTxIdle: SendMsg() will accept a frame
+ * eCOTxBusy: the Tx queue is full
+ * 
+ * 2024-11-20 AW 
+ * 2026-10-16 AW report the state of the Tx queue
+ * 
+ * --------------------------------------------------------*/
+
+COTxStatus COMsgHandler::GetTxStatus()
+{
+	if(TxStatus == eCOTxOffline)
+		return eCOTxOffline;
+	else if(GetTxFramesPending() >= NumTxBuffers)
+		return eCOTxBusy;
+	else
+		return eCOTxIdle;
+}
+
+/*----------------------------------------------------------
+ * uint8_t GetTxFramesPending()
+ * number of frames queued but not yet handed to a mailbox
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+uint8_t COMsgHandler::GetTxFramesPending()
+{
+	return __atomic_load_n(&TxFramesQueued, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------
+ * void GetTxStats(COTxStats *)
+ * copy the counters of the Tx queue
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::GetTxStats(COTxStats *Stats)
+{
+	CO_ENTER_CRITICAL();
+	Stats->NumTxQueued = TxNextTicket;
+	Stats->NumTxCompleted = NumTxCompleted;
+	Stats->NumTxRejected = NumTxRejected;
+	Stats->NumTxFailed = NumTxFailed;
+	Stats->NumTxSyncDropped = NumTxSyncDropped;
+	for(uint8_t iter = 0; iter < eCOTxNumClasses; iter++)
+		Stats->NumTxDropped[iter] = NumTxDropped[iter];
+	Stats->HighWaterMark = TxHighWaterMark;
+	Stats->SDOHighWaterMark = SDOHighWaterMark;
+	CO_EXIT_CRITICAL();
+}
+
+/*----------------------------------------------------------
+ * void SetTxClassPolicy(COTxClass, uint8_t depth, COTxDropPolicy)
+ * set the max number of queued frames of a priority class
+ * and what to do with a new frame if reached.
+ * All classes share the NumTxBuffers entries of the queue.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::SetTxClassPolicy(COTxClass thisClass, uint8_t depth, COTxDropPolicy policy)
+{
+	if(thisClass < eCOTxNumClasses)
+	{
+		if(depth == 0)
+			depth = 1;
+		if(depth > NumTxBuffers)
+			depth = NumTxBuffers;
+		
+		CO_ENTER_CRITICAL();
+		TxClassDepth[thisClass] = depth;
+		TxClassPolicy[thisClass] = policy;
+		CO_EXIT_CRITICAL();
+	}
+}
+
+/*----------------------------------------------------------
+ * void SetBusLoadPeriod(uint16_t periodMs)
+ * the length of a period of the bus load in ms, the sliding
+ * window is NumBusLoadPeriods of them. Update() has to be called
+ * more often than that. Restarts the statistics.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::SetBusLoadPeriod(uint16_t periodMs)
+{
+	if(periodMs == 0)
+		periodMs = 1;
+	BusLoadPeriodMs = periodMs;
+	ResetBusStats();
+}
+
+/*----------------------------------------------------------
+ * void GetBusStats(COBusStats *Stats)
+ * a snapshot of the bus statistics: the load of the last period
+ * and of the sliding window, the frames and bits per service and
+ * direction, the Tx latency and the error events.
+ * The load is that of the frames sent or received by this device
+ * at the bit rate set - all there is on the bus, as the CAN
+ * controller receives all frames.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::GetBusStats(COBusStats *Stats)
+{
+	uint32_t periodBits = (uint32_t)((uint64_t)(uint32_t)can_bitrate * BusLoadPeriodMs / 1000);
+	uint32_t sumBits = 0;
+	uint32_t maxBits = 0;
+	uint32_t lastBits = 0;
+	uint64_t sumLatency;
+	uint32_t numLatencies;
+	
+	CO_ENTER_CRITICAL();
+	memcpy(Stats->Service, ServiceCount, sizeof(ServiceCount));
+	Stats->MaxTxLatencyUs = TxMaxLatencyUs;
+	sumLatency = TxSumLatencyUs;
+	numLatencies = TxNumLatencies;
+	Stats->NumErrors = NumCANErrors;
+	Stats->NumBusOff = NumBusOff;
+	Stats->NumRxOverruns = NumRxOverruns;
+	CO_EXIT_CRITICAL();
+	
+	for(uint8_t iter = 0; iter < BusLoadNumPeriods; iter++)
+	{
+		sumBits += BusLoadBits[iter];
+		if(BusLoadBits[iter] > maxBits)
+			maxBits = BusLoadBits[iter];
+	}
+	if(BusLoadNumPeriods > 0)
+		lastBits = BusLoadBits[(BusLoadNextPeriod + NumBusLoadPeriods - 1) % NumBusLoadPeriods];
+	
+	Stats->PeriodMs = BusLoadPeriodMs;
+	Stats->NumPeriods = BusLoadNumPeriods;
+	Stats->LoadPercent = 100.0f * lastBits / periodBits;
+	Stats->PeakLoadPercent = 100.0f * maxBits / periodBits;
+	Stats->MeanLoadPercent = (BusLoadNumPeriods > 0) ? 100.0f * sumBits / ((float)periodBits * BusLoadNumPeriods) : 0;
+	Stats->MeanTxLatencyUs = (numLatencies > 0) ? (uint32_t)(sumLatency / numLatencies) : 0;
+}
+
+/*----------------------------------------------------------
+ * uint8_t GetTopTalkers(COTopTalker *Result, uint8_t MaxEntries)
+ * copy up to MaxEntries of the COB-Ids with the most bits on the
+ * bus since the reset, the most first. Returns the number copied.
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+uint8_t COMsgHandler::GetTopTalkers(COTopTalker *Result, uint8_t MaxEntries)
+{
+	COTopTalker Table[NumTopTalkers];
+	uint8_t numEntries = 0;
+	
+	CO_ENTER_CRITICAL();
+	memcpy(Table, TopTalkers, sizeof(TopTalkers));
+	CO_EXIT_CRITICAL();
+	
+	//insertion sort by the bits, entries not used yet are left out
+	for(uint8_t iter = 0; iter < NumTopTalkers; iter++)
+	{
+		if(Table[iter].Count.NumFrames == 0)
+			continue;
+		
+		uint8_t pos = numEntries;
+		while((pos > 0) && (Result[pos - 1].Count.NumBits < Table[iter].Count.NumBits))
+		{
+			if(pos < MaxEntries)
+				Result[pos] = Result[pos - 1];
+			pos--;
+		}
+		if(pos < MaxEntries)
+		{
+			Result[pos] = Table[iter];
+			if(numEntries < MaxEntries)
+				numEntries++;
+		}
+	}
+	return numEntries;
+}
+
+/*----------------------------------------------------------
+ * void ResetBusStats()
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::ResetBusStats()
+{
+	CO_ENTER_CRITICAL();
+	BusPeriodStartedAt = actTime;
+	BusPeriodBits = 0;
+	BusLoadNextPeriod = 0;
+	BusLoadNumPeriods = 0;
+	memset(ServiceCount, 0, sizeof(ServiceCount));
+	memset(TopTalkers, 0, sizeof(TopTalkers));
+	TxMaxLatencyUs = 0;
+	TxSumLatencyUs = 0;
+	TxNumLatencies = 0;
+	NumCANErrors = 0;
+	NumBusOff = 0;
+	NumRxOverruns = 0;
+	CO_EXIT_CRITICAL();
+}
+
+/*----------------------------------------------------------
+ * COTxClass GetTxClass(uint32_t Id)
+ * map a COB-Id onto it's priority class
+ * TIME is handled like SYNC, LSS like guarding
+ * 
+ * 2026-10-16 AW 
+ * 
+ * --------------------------------------------------------*/
+
+COTxClass COMsgHandler::GetTxClass(uint32_t Id)
+{
+	if(Id == eCANNMT)
+		return eCOTxClassNMT;
+	else if(Id == eCANSyncEmcy)
+		return eCOTxClassSync;
+	else if(Id < 0x100)
+		return eCOTxClassEmcy;
+	else if(Id < eCANTPDO1)
+		return eCOTxClassSync;
+	else if(Id < eCANSdoResp)
+		return eCOTxClassRPDO;
+	else if(Id < eCANGuarding)
+		return eCOTxClassSDO;
+	else
+		return eCOTxClassGuarding;
+}
+
+/*----------------------------------------------------------
+ * Register_onRxCb(function_holder *cb)
+ * store the function and object pointer for the callback
+ * called in case of a successful Rx
+ * 
+ * 2020-05-10 AW Header
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::Register_OnRxSDOCb(uint8_t NodeHandle, pfunction_holder *Cb)
+{
+	RegisterCb(NodeHandle, eCORxCbSDO, Cb);
+		
+	#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+	Serial.print("registered SDO Handler @ ");
+	Serial.println(NodeHandle);
+	#endif
+}
+
+/*----------------------------------------------------------
+ * Register_onRxNmtCb(function_holder *cb)
+ * store the function and object pointer for the callback
+ * called in case of a successful Rx
+ * 
+ * 2020-05-10 AW Header
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::Register_OnRxNmtCb(uint8_t NodeHandle, pfunction_holder *Cb)
+{
+	RegisterCb(NodeHandle, eCORxCbNmt, Cb);
+		
+	#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+	Serial.print("registered Nmt Handler @ ");
+	Serial.println(NodeHandle);
+	#endif
+}
+
+/*----------------------------------------------------------
+ * Register_onRxEMCYCb(function_holder *cb)
+ * store the function and object pointer for the callback
+ * called in case of a successful Rx
+ * 
+ * 2020-05-10 AW Header
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::Register_OnRxEMCYCb(uint8_t NodeHandle, pfunction_holder *Cb)
+{
+	RegisterCb(NodeHandle, eCORxCbEMCY, Cb);
+		
+	#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+	Serial.print("registered EMCY Handler @ ");
+	Serial.println(NodeHandle);
+	#endif
+}
+
+/*----------------------------------------------------------
+ * Register_onRxPDOCb(function_holder *cb)
+ * store the function and object pointer for the callback
+ * called in case of a successful Rx
+ * 
+ * 2020-05-10 AW Header
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::Register_OnRxPDOCb(uint8_t NodeHandle, pfunction_holder *Cb)
+{
+	RegisterCb(NodeHandle, eCORxCbPDO, Cb);
+		
+	#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+	Serial.print("registered PDO Handler @ ");
+	Serial.println(NodeHandle);
+	#endif
+}
+
+/*----------------------------------------------------------
+ * bool RegisterRxPDO(uint8_t NodeHandle, uint16_t COBId, uint16_t PdoNr)
+ * dispatch the PDO received with this COB-Id to the PDO callback
+ * of the node, GetRxPDONr() returns the PDO# for it.
+ * The COB-Id has to be in the range 0x180..0x57F, a COB-Id already
+ * registered is taken over. Fails if the table is full too.
+ * 
+ * 2026-10-16 AW
+ * 2026-10-16 AW table sorted by COB-Id instead of one entry per COB-Id
+ * 
+ * --------------------------------------------------------*/
+
+bool COMsgHandler::RegisterRxPDO(uint8_t NodeHandle, uint16_t COBId, uint16_t PdoNr)
+{
+	uint16_t PDOIdx = COBId - FirstPDOCOBId;
+	uint16_t pos = 0;
+	
+	if((NodeHandle >= MsgHandler_MaxNodes) || (PdoNr > MaxPDONr) || (PDOIdx >= NumPDOCOBIds))
+		return false;
+	
+	while((pos < NumRxPDOsRegistered) && (RxPDODispatch[pos].COBId < COBId))
+		pos++;
+	
+	if((pos == NumRxPDOsRegistered) || (RxPDODispatch[pos].COBId != COBId))
+	{
+		if(NumRxPDOsRegistered >= NumRxPDOEntries)
+		{
+			#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+			Serial.println("MSG: PDO table full");
+			#endif
+			return false;
+		}
+		//make room for the new COB-Id
+		for(uint16_t iter = NumRxPDOsRegistered; iter > pos; iter--)
+			RxPDODispatch[iter] = RxPDODispatch[iter - 1];
+		RxPDODispatch[pos].COBId = COBId;
+		NumRxPDOsRegistered++;
+	}
+	RxPDODispatch[pos].Entry = (uint16_t)((PdoNr << 7) | NodeHandle);
+	
+	#if(DEBUG_COMSGHandler & DEBUG_REGHandler)
+	Serial.print("registered PDO ");
+	Serial.print(COBId, HEX);
+	Serial.print(" @ ");
+	Serial.println(NodeHandle);
+	#endif
+	
+	return true;
+}
+
+/*----------------------------------------------------------
+ * void UnRegisterRxPDO(uint16_t COBId)
+ * a PDO received with this COB-Id is dispatched by it's node-id
+ * again
+ * 
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::UnRegisterRxPDO(uint16_t COBId)
+{
+	for(uint16_t iter = 0; iter < NumRxPDOsRegistered; iter++)
+	{
+		if(RxPDODispatch[iter].COBId == COBId)
+		{
+			NumRxPDOsRegistered--;
+			for(; iter < NumRxPDOsRegistered; iter++)
+				RxPDODispatch[iter] = RxPDODispatch[iter + 1];
+			break;
+		}
+	}
+}
+
+/*----------------------------------------------------------
+ * uint16_t GetRxPDONr(uint32_t COBId)
+ * the PDO# registered for this COB-Id or InvalidPDOEntry
+ * 
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+uint16_t COMsgHandler::GetRxPDONr(uint32_t COBId)
+{
+	uint32_t PDOIdx = COBId - FirstPDOCOBId;
+	uint16_t PDOEntry = InvalidPDOEntry;
+	
+	if(PDOIdx < NumPDOCOBIds)
+		PDOEntry = FindRxPDO((uint16_t)COBId);
+	if(PDOEntry != InvalidPDOEntry)
+		return PDOEntry >> 7;
+	
+	return InvalidPDOEntry;
+}
+
+/*----------------------------------------------------------
+ * uint16_t FindRxPDO(uint16_t COBId)
+ * binary search of the COB-Id in the table of registered PDOs
+ * returns it's entry or InvalidPDOEntry
+ * 
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+uint16_t COMsgHandler::FindRxPDO(uint16_t COBId)
+{
+	uint16_t low = 0;
+	uint16_t high = NumRxPDOsRegistered;
+	
+	while(low < high)
+	{
+		uint16_t mid = (low + high) >> 1;
+		
+		if(RxPDODispatch[mid].COBId < COBId)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if((low < NumRxPDOsRegistered) && (RxPDODispatch[low].COBId == COBId))
+		return RxPDODispatch[low].Entry;
+	
+	return InvalidPDOEntry;
+}
+
+/*----------------------------------------------------------
+ * void RegisterCb(uint8_t NodeHandle, CORxCbType, function_holder *cb)
+ * store the function and object pointer for the callback
+ * in the row of the node
+ * 
+ * 2026-10-16 AW
+ * 
+ * --------------------------------------------------------*/
+
+void COMsgHandler::RegisterCb(uint8_t NodeHandle, CORxCbType type, pfunction_holder *Cb)
+{
+	if((NodeHandle < MsgHandler_MaxNodes) && (type != eCORxCbNone) && (type < eCORxNumCb))
+	{
+		OnRxCb[NodeHandle][type].callback = Cb->callback;
+		OnRxCb[NodeHandle][type].op = Cb->op;
 	}
 }
@@ -26,23 +26,95 @@
  * Depending on their serive they will be distributed
  *
  * 2024-11-16 AW Frame
+ * 2026-10-16 AW Update() drains the Rx buffer up to a frame budget
+ * 2026-10-16 AW Rx buffer as an overflow safe single producer/single consumer ring
+ * 2026-10-16 AW Tx queue feeding all standard Tx mailboxes
+ * 2026-10-16 AW Tx queue ordered by priority classes and COB-Id
+ * 2026-10-16 AW dispatch of received frames via node-id and service tables
+ * 2026-10-16 AW number of nodes set at build time
+ * 2026-10-16 AW CAN access via the COTransport interface
+ * 2026-10-16 AW SDO client scheduler: one outstanding request per node
+ * 2026-10-16 AW received PDOs dispatched by a COB-Id table
+ * 2026-10-16 AW synchronous window of the SYNC
+ * 2026-10-16 AW received frames time stamped in the Rx interrupt
+ * 2026-10-16 AW bus load and traffic statistics
+ * 2026-10-16 AW capture of the frames received and sent
+ * 2026-10-16 AW deadline scheduler running the nodes when due
+ * 2026-10-16 AW SDO requests time stamped when handed to the CAN controller
+ * 2026-10-16 AW PDO COB-Id table sized by the nodes, sorted and searched binary
  *
  *-------------------------------------------------------------------*/
  
 //--- includes ---
 
+#if defined(CO_HOST_BUILD)
+#include <COTransport.h>
+#else
 #include <UNOR4CAN.h>
+#endif
 #include <MC_Helpers.h>
+#include <COCapture.h>
+#include <COScheduler.h>
 
 #include <stdint.h>
 
-const uint8_t MsgHandler_MaxNodes = 10;
+//max number of nodes to be registered - can be set at build time using
+//-DCO_MAX_NODES=n, up to the 127 nodes of a full CANopen network
+//RAM per node in the COMsgHandler is COMsgHandlerBytesPerNode
+//(91 bytes on the UNO R4) plus a fixed 512 bytes for the node-id table
+#ifndef CO_MAX_NODES
+#define CO_MAX_NODES 10
+#endif
+
+const uint8_t MsgHandler_MaxNodes = CO_MAX_NODES;
+const uint8_t NumNodeIds = 128;
+static_assert((MsgHandler_MaxNodes > 0) && (MsgHandler_MaxNodes < NumNodeIds), "CO_MAX_NODES must be 1..127");
 const int16_t invalidNodeId = -1;
 const uint8_t InvalidSlot = 0xff;
 
-const uint8_t NumRxBuffers = 20;
+//size of the Rx ring between the CAN interrupt and Update()
+//must be a power of two; check GetRxStats() for the high water mark
+const uint8_t NumRxBuffers = 32;
+const uint16_t RxBufferMask = NumRxBuffers - 1;
+static_assert((NumRxBuffers & (NumRxBuffers - 1)) == 0, "NumRxBuffers must be a power of two");
 const uint8_t IntRxBufferLen = 40;
 
+//max number of received frames dispatched by a single call of Update()
+//a budget of 1 is the former one-frame-per-loop behavior
+const uint8_t DefaultRxFrameBudget = NumRxBuffers;
+
+//depth of the Tx classes which scale with the number of nodes:
+//two RxPDOs per node may wait at once, a guarding request per node
+//the others are fixed - NMT, SYNC, EMCY and SDO (the SDO requests
+//wait in the SDO client scheduler, the queue holds only the rest)
+#ifndef CO_TX_RPDO_DEPTH
+#define CO_TX_RPDO_DEPTH ((2 * CO_MAX_NODES < 8) ? 8 : ((2 * CO_MAX_NODES > 128) ? 128 : 2 * CO_MAX_NODES))
+#endif
+#ifndef CO_TX_GUARDING_DEPTH
+#define CO_TX_GUARDING_DEPTH ((CO_MAX_NODES < 8) ? 8 : ((CO_MAX_NODES > 32) ? 32 : CO_MAX_NODES))
+#endif
+
+const uint8_t TxRPDODepth = CO_TX_RPDO_DEPTH;
+const uint8_t TxGuardingDepth = CO_TX_GUARDING_DEPTH;
+const uint8_t TxFixedDepth = 4 + 1 + 2 + 8;
+
+//number of frames the Tx queue in front of the CAN mailboxes can hold
+//shared by all priority classes, each limited by it's own depth
+//31 entries for 4 nodes, 43 for 10, 175 for 127
+const uint8_t NumTxBuffers = TxFixedDepth + TxRPDODepth + TxGuardingDepth;
+static_assert((TxFixedDepth + CO_TX_RPDO_DEPTH + CO_TX_GUARDING_DEPTH) < InvalidSlot, "Tx queue exceeds 254 entries");
+
+//the Tx mailboxes of the UNOR4CAN used by the queue
+//0..3 are configured for standard data frames, 8 for standard remote frames
+const uint8_t NumTxMailboxes = 5;
+const uint8_t TxMailboxIds[NumTxMailboxes] = {0, 1, 2, 3, 8};
+const uint8_t TxRemoteMailboxSlot = 4;
+const uint8_t TxDataMailboxesMask = 0x0F;
+
+//critical section usable from both loop and interrupt context
+#define CO_ENTER_CRITICAL() uint32_t co_primask = __get_PRIMASK(); __disable_irq()
+#define CO_EXIT_CRITICAL() __set_PRIMASK(co_primask)
+
 const int R4WiFiTx = 10;
 const int R4WiFiRx = 13;
 const int R4MinimaTx = 4;
@@ -69,6 +141,84 @@ typedef enum COServices {
 	eCANGuarding	=   0x700
   } COService;
 
+//priority classes of the Tx queue - highest first
+//matches the COB-Id order of the services so the bus arbitration agrees
+typedef enum COTxClass {
+	eCOTxClassNMT,
+	eCOTxClassSync,
+	eCOTxClassEmcy,
+	eCOTxClassRPDO,
+	eCOTxClassSDO,
+	eCOTxClassGuarding,
+	eCOTxNumClasses
+  } COTxClass;
+
+//what to do with a new frame if it's class is at it's depth
+typedef enum COTxDropPolicy {
+	eCOTxRejectNew,        //refuse the new frame - the caller will retry
+	eCOTxDropOldest,       //drop the frame of the class queued first
+	eCOTxReplaceSameId     //overwrite a queued frame with the same COB-Id, even if not full
+  } COTxDropPolicy;
+
+//callbacks an upper layer can register per node
+//eCORxCbNone is never set and catches all services not handled
+typedef enum CORxCbType {
+	eCORxCbNone,
+	eCORxCbEMCY,
+	eCORxCbPDO,
+	eCORxCbSDO,
+	eCORxCbNmt,
+	eCORxNumCb
+  } CORxCbType;
+
+//callback to be used for a received frame indexed by (COB-Id >> 7)
+const uint8_t COBIdToRxCb[16] = {
+	eCORxCbNone,    //0x000 NMT
+	eCORxCbEMCY,    //0x080 EMCY
+	eCORxCbNone,    //0x100 TIME
+	eCORxCbPDO,     //0x180 TPDO1
+	eCORxCbNone,    //0x200 RPDO1
+	eCORxCbPDO,     //0x280 TPDO2
+	eCORxCbNone,    //0x300 RPDO2
+	eCORxCbPDO,     //0x380 TPDO3
+	eCORxCbNone,    //0x400 RPDO3
+	eCORxCbPDO,     //0x480 TPDO4
+	eCORxCbNone,    //0x500 RPDO4
+	eCORxCbSDO,     //0x580 SDO response
+	eCORxCbNone,    //0x600 SDO request
+	eCORxCbNone,    //0x680
+	eCORxCbNmt,     //0x700 guarding/heartbeat
+	eCORxCbNone     //0x780
+  };
+
+//received PDOs are dispatched by their COB-Id in the range 0x180..0x57F
+//to the node handle and PDO# registered for it (RegisterRxPDO()), so PDOs
+//beyond the 4 predefined ones may use any COB-Id of the range.
+//A COB-Id not registered is dispatched by it's node-id as any other service.
+//The registered COB-Ids are kept in a table sorted by COB-Id, searched binary.
+//It holds CO_RX_PDOS_PER_NODE entries per node, can be set at build time.
+//An entry is (PDO# << 7) | node handle
+#ifndef CO_RX_PDOS_PER_NODE
+#define CO_RX_PDOS_PER_NODE 4
+#endif
+
+const uint16_t FirstPDOCOBId = eCANTPDO1;
+const uint16_t NumPDOCOBIds = eCANSdoResp - eCANTPDO1;
+const uint16_t MaxPDONr = 511;
+const uint16_t InvalidPDOEntry = 0xFFFF;
+const uint16_t NumRxPDOEntries = MsgHandler_MaxNodes * CO_RX_PDOS_PER_NODE;
+
+typedef struct CORxPDOEntry {
+	uint16_t COBId;
+	uint16_t Entry;
+} CORxPDOEntry;
+
+//RAM used per registered node: the node-id, the row of callbacks, the SDO request slot,
+//the item of the scheduler and the entries of the PDO COB-Id table
+const size_t COMsgHandlerBytesPerNode = sizeof(int16_t) + eCORxNumCb * sizeof(pfunction_holder) + sizeof(void *)
+                                        + sizeof(COSchedItem) + sizeof(bool)
+                                        + CO_RX_PDOS_PER_NODE * sizeof(CORxPDOEntry);
+
 typedef enum COTxStatus {
 	eCOTxOffline,
 	eCOTxIdle,
@@ -76,6 +226,71 @@ typedef enum COTxStatus {
 	eCOTxTimeOut
   } COTxStatus;
 	
+//--- counters of the Rx ring
+typedef struct CORxStats {
+	uint32_t NumRxMessages;         //frames received in the interrupt
+	uint32_t NumProcessedMessages;  //frames dispatched by Update()
+	uint32_t NumDroppedMessages;    //frames lost because the ring was full
+	uint16_t HighWaterMark;         //max number of frames waiting in the ring
+	uint32_t MaxLatencyUs;          //max time from the Rx interrupt to the dispatch
+	uint32_t MeanLatencyUs;
+  } CORxStats;
+
+//--- counters of the Tx queue
+typedef struct COTxStats {
+	uint32_t NumTxQueued;           //frames accepted by SendMsg()
+	uint32_t NumTxCompleted;        //frames reported sent by the CAN controller
+	uint32_t NumTxRejected;         //frames refused because the queue or their class was full
+	uint32_t NumTxFailed;           //frames aborted or refused by the CAN controller
+	uint32_t NumTxDropped[eCOTxNumClasses]; //queued frames dropped or replaced by the class policy
+	uint32_t NumTxSyncDropped;      //synchronous frames dropped as they would miss their window
+	uint16_t HighWaterMark;         //max number of frames waiting in the queue
+	uint16_t SDOHighWaterMark;      //max number of nodes with a SDO request waiting at once
+  } COTxStats;
+
+//--- bus load and traffic statistics
+//the load is measured in periods of SetBusLoadPeriod() ms, the last
+//NumBusLoadPeriods of them are the sliding window
+const uint8_t NumBusLoadPeriods = 8;
+const uint16_t DefaultBusLoadPeriodMs = 100;
+//the COB-Ids with the most bits on the bus, tracked by a table of
+//NumTopTalkers entries: a new COB-Id replaces the one with the least
+//bits and takes over it's counts, so a count may be too high by these
+const uint8_t NumTopTalkers = 16;
+//the services by their function code (COB-Id >> 7)
+const uint8_t NumCOServices = 16;
+
+typedef enum COTrafficDir {
+	eCOTrafficRx,
+	eCOTrafficTx,
+	eCOTrafficNumDirs
+  } COTrafficDir;
+
+typedef struct COTrafficCount {
+	uint32_t NumFrames;
+	uint32_t NumBits;               //stuff bits estimated (COFrameBitsEstimate())
+  } COTrafficCount;
+
+typedef struct COTopTalker {
+	uint16_t COBId;
+	COTrafficDir Dir;
+	COTrafficCount Count;
+  } COTopTalker;
+
+typedef struct COBusStats {
+	uint16_t PeriodMs;
+	uint8_t NumPeriods;             //periods in the sliding window so far
+	float LoadPercent;              //of the last period
+	float MeanLoadPercent;          //of the sliding window
+	float PeakLoadPercent;          //the max period of the sliding window
+	COTrafficCount Service[eCOTrafficNumDirs][NumCOServices];  //since the reset, by (COB-Id >> 7)
+	uint32_t MaxTxLatencyUs;        //SendMsg() to Tx complete, SDO requests from the mailbox only
+	uint32_t MeanTxLatencyUs;
+	uint32_t NumErrors;             //error events of the CAN controller
+	uint32_t NumBusOff;
+	uint32_t NumRxOverruns;         //frames lost in the controller's mailboxes
+  } COBusStats;
+
 //--- the CAN message structure
 typedef struct CANMsg {
    uint32_t Id;
@@ -83,28 +298,73 @@ typedef struct CANMsg {
 	 bool isRTR;
 	 COService serviceType;
 	 uint8_t payload[8];
+	 uint32_t RxAt;          //received frames: micros() of the Rx interrupt
+	                         //SDO requests: micros() handed to the CAN controller
    } CANMsg;
+
+//--- filled in by the COMsgHandler when a queued frame is handed to the CAN controller
+typedef struct COTxStamp {
+	volatile bool isStarted;       //cleared by the sender before SendMsg()
+	volatile uint32_t StartedAt;   //micros()
+  } COTxStamp;
 	 
 class COMsgHandler {
 	public:
 		COMsgHandler(int const can_tx_pin = R4WiFiTx, int const can_rx_pin = R4WiFiRx,CanBitRate bitrate = CanBitRate::BR_250k);
+		COMsgHandler(COTransport *,CanBitRate bitrate = CanBitRate::BR_250k);
 	  void set_can_bitrate(CanBitRate bitrate);
   
 	  void Open();
-		void Update(uint32_t);
+		uint8_t Update(uint32_t);
+		void SetRxFrameBudget(uint8_t);
+		void SetSDORxInInterrupt(bool);
+		void SetCapture(COCapture *);
+		uint8_t GetRxFramesPending();
+		void GetRxStats(CORxStats *);
+		void ResetRxStats();
 	  void Reset();
 	
 		uint8_t RegisterNode(uint8_t);
 		void UnRegisterNode(uint8_t);
 		int8_t GetNodeId(uint8_t);
 		
-	  bool SendMsg(CANMsg *);
+	  bool SendMsg(CANMsg *, uint32_t *ticket = NULL, volatile uint32_t *LateCount = NULL, COTxStamp *Stamp = NULL);
+	  bool IsTxDone(uint32_t);
 	  COTxStatus GetTxStatus();
+		uint8_t GetTxFramesPending();
+		void GetTxStats(COTxStats *);
+		void SetTxClassPolicy(COTxClass, uint8_t, COTxDropPolicy);
+		void SetBusLoadPeriod(uint16_t);
+		void GetBusStats(COBusStats *);
+		uint8_t GetTopTalkers(COTopTalker *, uint8_t);
+		void ResetBusStats();
+		static COTxClass GetTxClass(uint32_t);
+		bool SendSDORequest(uint8_t, CANMsg *);
+		void CancelSDORequest(uint8_t);
+		bool IsSDORequestWaiting(uint8_t);
 	
 		void Register_OnRxSDOCb(uint8_t,pfunction_holder *);
 		void Register_OnRxNmtCb(uint8_t,pfunction_holder *);
 		void Register_OnRxEMCYCb(uint8_t,pfunction_holder *);
 		void Register_OnRxPDOCb(uint8_t,pfunction_holder *);
+		bool RegisterRxPDO(uint8_t, uint16_t, uint16_t);
+		void UnRegisterRxPDO(uint16_t);
+		uint16_t GetRxPDONr(uint32_t);
+	
+		//the synchronous window (0x1007) started by each SYNC sent
+		void OnSyncSent(uint32_t);
+		void SetSyncWindowUs(uint32_t);
+		uint32_t GetSyncWindowUs() { return SyncWindowUs; }
+		bool IsInSyncWindow();
+		uint32_t GetSyncNr() { return SyncNr; }
+	
+		//the nodes run by the scheduler when they are due instead of
+		//being polled - see Update()
+		void Register_OnDueCb(uint8_t, pfunction_holder *);
+		void ScheduleNode(uint8_t, uint32_t);
+		void PostNode(uint8_t);
+		void SetNodeSyncDue(uint8_t, bool);
+		COScheduler *GetScheduler() { return &Scheduler; }
 	
 	  char IntBuff[IntRxBufferLen];
 	
@@ -116,28 +376,135 @@ class COMsgHandler {
 	private:
 	  //todo: den Datenzeiger auf CAN Msg anpassen
 	  void OnRxHandler(can_callback_args_t *);
+		void FrameToMsg(can_frame_t *, CANMsg *, uint32_t);
 		uint8_t FindNode(uint8_t);
+		void InitTables();
+		void TxStartNext();
+		uint8_t TxFindMailbox(CANMsg *);
+		void TxStartFrame(uint8_t, CANMsg *, uint32_t, uint32_t, COTxStamp *);
+		bool TxStartSDORequest();
+		bool TxIsQueued(COTxClass, uint32_t);
+		void TxUnlink(COTxClass, uint8_t, uint8_t);
+		void OnTxDone(uint32_t, bool);
+		bool IsSyncFrameLate(volatile uint32_t *, uint32_t, CANMsg *);
+		void CountFrame(COTrafficDir, uint32_t, uint8_t);
+		void UpdateBusLoad(uint32_t);
+		void PostSyncDueNodes();
 	
 	  //a local copy of the bitrate
 	  CanBitRate can_bitrate;
 				
-	  UNOR4CAN can;   // CAN bus object
+	  #if !defined(CO_HOST_BUILD)
+	  UNOR4CAN r4can;     // the CAN controller of the R4
+	  #endif
+	  COTransport *can;   // CAN bus object used
 	  //a vector of buffers to be used for any received Msg to be copied out of the interrupt context
+	  //CORxNextWrite is written by the interrupt only, CORxNextRead by Update() only
+	  //both are free running and masked by RxBufferMask when accessing the vector
     CANMsg CORxVector[NumRxBuffers];
-	  uint8_t CORxNextRead = 0;
-	  uint8_t CORxNextWrite = 0;
-	  uint16_t NumRxMessages = 0;
-	  uint16_t NumProcessedMessages = 0;
+	  uint16_t CORxNextRead = 0;
+	  uint16_t CORxNextWrite = 0;
+	  uint32_t NumRxMessages = 0;
+	  uint32_t NumProcessedMessages = 0;
+	  uint32_t NumDroppedMessages = 0;
+	  uint16_t RxHighWaterMark = 0;
+	  uint32_t RxMaxLatencyUs = 0;
+	  uint64_t RxSumLatencyUs = 0;
+	  uint8_t RxFrameBudget = DefaultRxFrameBudget;
+	  //SDO responses are dispatched right in the interrupt, not by Update()
+	  bool isSDORxInInterrupt = false;
+	  COCapture *Capture = NULL;
 	
 	  COTxStatus TxStatus = eCOTxOffline;
+	  
+	  //the Tx queue - filled by SendMsg(), emptied into free mailboxes
+	  //by TxStartNext() either from SendMsg() or the Tx complete interrupt
+	  //a pool of entries linked into one list per class, sorted by COB-Id
+	  typedef struct COTxEntry {
+			CANMsg Msg;
+			uint32_t Ticket;
+			volatile uint32_t *LateCount;  //a synchronous frame: the counter of the sender
+			uint32_t SyncNr;               //the SYNC it was queued after
+			uint32_t QueuedAt;             //us
+			COTxStamp *Stamp;              //of the sender, set at the hand-off
+			uint8_t Next;
+		} COTxEntry;
+		
+	  COTxEntry COTxPool[NumTxBuffers];
+	  uint8_t TxFreeHead = 0;
+	  uint8_t TxClassHead[eCOTxNumClasses];
+	  uint8_t TxClassCount[eCOTxNumClasses];
+	  uint8_t TxClassDepth[eCOTxNumClasses];
+	  COTxDropPolicy TxClassPolicy[eCOTxNumClasses];
+	  uint32_t NumTxDropped[eCOTxNumClasses];
+	  uint8_t TxFramesQueued = 0;
+	  uint32_t TxNextTicket = 0;
+	  
+	  uint8_t TxMailboxBusy = 0;
+	  uint32_t TxMailboxTicket[NumTxMailboxes];
+	  uint32_t TxMailboxId[NumTxMailboxes];
+	  volatile uint32_t *TxMailboxLateCount[NumTxMailboxes] = {};
+	  uint32_t TxMailboxSyncNr[NumTxMailboxes];
+	  uint32_t TxMailboxQueuedAt[NumTxMailboxes];
+	  uint8_t TxMailboxBits[NumTxMailboxes];
+	  uint32_t NumTxCompleted = 0;
+	  uint32_t NumTxRejected = 0;
+	  uint32_t NumTxFailed = 0;
+	  uint32_t NumTxSyncDropped = 0;
+	  uint16_t TxHighWaterMark = 0;
+	  
+	  //the SDO client scheduler - the one outstanding request of each node
+	  //by node handle, not copied but sent from the SDO handler's own Msg
+	  //served round-robin within the SDO class, so no node waits for the others
+	  CANMsg *SDORequest[MsgHandler_MaxNodes];
+	  uint8_t SDONextNode = 0;
+	  uint8_t NumSDORequests = 0;
+	  uint8_t SDOHighWaterMark = 0;
+	
+	  //the synchronous window - a synchronous frame not sent completely
+	  //within the window of the SYNC it was queued after is late
+	  uint32_t SyncWindowUs = 0;
+	  volatile uint32_t SyncSentAt = 0;
+	  volatile uint32_t SyncNr = 0;
+	
+	  //the bus statistics - counted in the interrupt, the periods are
+	  //closed by Update()
+	  uint16_t BusLoadPeriodMs = DefaultBusLoadPeriodMs;
+	  uint32_t BusPeriodStartedAt = 0;
+	  uint32_t BusPeriodBits = 0;
+	  uint32_t BusLoadBits[NumBusLoadPeriods];
+	  uint8_t BusLoadNextPeriod = 0;
+	  uint8_t BusLoadNumPeriods = 0;
+	  COTrafficCount ServiceCount[eCOTrafficNumDirs][NumCOServices];
+	  COTopTalker TopTalkers[NumTopTalkers];
+	  uint32_t TxMaxLatencyUs = 0;
+	  uint64_t TxSumLatencyUs = 0;
+	  uint32_t TxNumLatencies = 0;
+	  uint32_t NumCANErrors = 0;
+	  uint32_t NumBusOff = 0;
+	  uint32_t NumRxOverruns = 0;
 	
 	  int16_t nodeId[MsgHandler_MaxNodes];
-		pfunction_holder OnRxSDOCb[MsgHandler_MaxNodes];
-		pfunction_holder OnRxNmtCb[MsgHandler_MaxNodes];	
-		pfunction_holder OnRxEMCYCb[MsgHandler_MaxNodes];	
-		pfunction_holder OnRxPDOCb[MsgHandler_MaxNodes];	
+		//the callbacks of all registered nodes - a row per node handle
+		pfunction_holder OnRxCb[MsgHandler_MaxNodes][eCORxNumCb];
+		//the row of callbacks for every node-id or NULL if not registered
+		pfunction_holder *RxDispatch[NumNodeIds];
+		//node handle and PDO# of every registered PDO COB-Id, sorted by COB-Id
+		CORxPDOEntry RxPDODispatch[NumRxPDOEntries];
+		uint16_t NumRxPDOsRegistered = 0;
+		
+		uint16_t FindRxPDO(uint16_t);
+		
+		void RegisterCb(uint8_t, CORxCbType, pfunction_holder *);
+		
+		//the scheduler and the item of every node handle, posted by each
+		//frame dispatched to the node and - if sync due - by each SYNC
+		COScheduler Scheduler;
+		COSchedItem NodeDue[MsgHandler_MaxNodes];
+		bool NodeSyncDue[MsgHandler_MaxNodes];
+		uint32_t DueSyncNr = 0;
 		
-		uint32_t actTime;
+		uint32_t actTime = 0;
 };
 
 
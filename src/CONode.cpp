@@ -22,6 +22,10 @@
  * implements the class to handle NMT and Guarding 
  *
  * 2025-01-11 AW Frame
+ * 2026-10-16 AW guarding and heartbeat timed by the Rx time stamp
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW guarding timed from the hand-off of the request
+ * 2026-10-16 AW errors, time-outs and EMCYs traced, not printed by default
  *
  *--------------------------------------------------------------*/
  
@@ -46,9 +50,9 @@
 #define DEBUG_NMT_EMCY    0x0400
 #define DEBUG_NMT_BOOTING 0x0800
 
-#define DEBUG_NODE (DEBUG_NMT_TO | DEBUG_NMT_ERROR | DEBUG_NMT_EMCY | DEBUG_NMT_BOOTING | DEBUG_NMT_Init) 
+#define DEBUG_NODE (DEBUG_NMT_BOOTING | DEBUG_NMT_Init) 
 
-#define NODE_PrintEMCY 1
+#define NODE_PrintEMCY 0
 
 //--- local definitions ---------
 
@@ -128,7 +132,6 @@ void CONode::init(COMsgHandler *MsgHandler, int8_t ThisNode, int8_t MsgHandle)
 	  Handler->Register_OnRxNmtCb(MsgHandle,&Cb);
 	  ConfigState = eCO_NodeIdle;
 		RequestState = eCO_NodeIdle;
-		ConfigStep = 0;
 		
 		//create the dunctor for the EmcyHandler and register it
 		Cb.callback = (pfunction_pointer_t)CONode::OnEmcyMsgRxCb;
@@ -214,7 +217,6 @@ void CONode::ResetComState()
 	
 	TORetryCounter = 0;
 	BusyRetryCounter = 0;
-	ConfigStep = 0;
 	ResetSDOState();
 	
 }
@@ -303,6 +305,7 @@ void CONode::Register_OnNodeStateChangeCb(pfunction_holder *Cb)
  * INitRemoteNode is finished when eNMTStatePreOp is reached
  *
  * 2025-07-26 AW extracted from update
+ * 2026-10-16 AW state changes traced
  *-----------------------------------------------------------------*/
 
 NMTNodeState CONode::InitRemoteNode(uint32_t Time)
@@ -413,6 +416,7 @@ NMTNodeState CONode::InitRemoteNode(uint32_t Time)
 		default:
 			break;
 	}
+	TraceNodeState();
 	return NodeState;
 }
 
@@ -424,6 +428,9 @@ NMTNodeState CONode::InitRemoteNode(uint32_t Time)
  *
  * 2025-01-12 AW frame
  * 225-07-26 AW handle pre-op and op only - InitRemoteNode to be executed first
+ * 2026-10-16 AW guarding and heartbeat supervised in us (micros())
+ * 2026-10-16 AW state changes traced
+ * 2026-10-16 AW guarding time-out from the hand-off of the request
  *-----------------------------------------------------------------*/
 
 NMTNodeState CONode::Update(uint32_t Time)
@@ -552,12 +559,12 @@ NMTNodeState CONode::Update(uint32_t Time)
         {
           case eCO_GuardingExpected:
 					  //send request and
-				    //denote the time
-					  if(Handler->SendMsg(&GuardingRequest))
+				    //denote the time - the one it's sent at is stamped by the MsgHandler
+					  GuardRequestStamp.isStarted = false;
+					  isGuardRequestSent = false;
+					  GuardRequestQueuedAt = micros();
+					  if(Handler->SendMsg(&GuardingRequest, NULL, NULL, &GuardRequestStamp))
 						{
-							//denote this as successful only if true
-					    GuardRequestSentAt = actTime;
-
 					    //and switch to waiting
 					    GuardingState = eCO_GuardingWaiting;
 						}
@@ -565,7 +572,10 @@ NMTNodeState CONode::Update(uint32_t Time)
 					case eCO_GuardingWaiting:
 						//we do only leave the Waiting state when OnRx has received the correct response
 					  //we might swtich to TimeOut
-					  if((actTime - GuardRequestSentAt) > GuardTime)
+					  //the guard time starts when the request is handed to the CAN controller,
+					  //one lost in the queue is missed after the life time
+					  if(IsGuardRequestSent() ? ((micros() - GuardRequestSentAt) > GuardTimeUs())
+					                          : ((micros() - GuardRequestQueuedAt) > (GuardTimeUs() * LiveTimeFactor)))
 						{
 							//request was sent and didn't get an answer - this is TO
 						  GuardingState = eCO_GuardingTimeOut;
@@ -573,7 +583,7 @@ NMTNodeState CONode::Update(uint32_t Time)
 						}
 						break;
 					case eCO_GuardingReceivedIntime:
-					  if((actTime - GuardRequestSentAt) > GuardTime)
+					  if((micros() - GuardRequestSentAt) > GuardTimeUs())
 						{
 							//request was sent and didn't get an answer - this is TO
 						  GuardingState = eCO_GuardingExpected;
@@ -592,7 +602,10 @@ NMTNodeState CONode::Update(uint32_t Time)
 						//return to looking for this node
 						{
 							GuardingState = eCO_GuardingError;
+							CO_TRACE_EVENT(eCOTraceGuardingError, NodeId, NumGuardRequestsOpen, 0);
+							#if(DEBUG_NODE & DEBUG_NMT_TO)
 							Serial.println("Node: Guarding Error");
+							#endif
               NodeState = eNMTStateOffline;													
 						}						
 						break;
@@ -607,13 +620,16 @@ NMTNodeState CONode::Update(uint32_t Time)
 				//return to looking for this node
 
 				//if((HeatbeatReceivedAt - actTime) > HeartbeatProducerTime)
-				if((actTime - HeatbeatReceivedAt) > RemoteHBMissedTime)
+				if((micros() - HeatbeatReceivedAt) > (RemoteHBMissedTime * 1000))
 				{
 		      GuardingState = eCO_GuardingError;
+					CO_TRACE_EVENT(eCOTraceHBTimeout, NodeId, 0, micros() - HeatbeatReceivedAt);
+					#if(DEBUG_NODE & DEBUG_NMT_TO)
 					Serial.print("Node: HB failed @");
 					Serial.println(actTime);
 					Serial.print("Node: threshold was :");
 					Serial.println(RemoteHBMissedTime);
+					#endif
           NodeState = eNMTStateOffline;
 			  }
 			}	
@@ -621,9 +637,112 @@ NMTNodeState CONode::Update(uint32_t Time)
 		default:
 			break;
 	} // end switch NodeState
+	TraceNodeState();
 	return NodeState;
 }
 
+/*------------------------------------------------------------------
+ * uint32_t GetDueInUs()
+ * the time in us until Update() has something to do: the next
+ * probe of an offline node, the next guarding request or it's
+ * time-out, the time-out of the heartbeat and the one of the SDO.
+ * SchedNotDue while waiting for a frame of the node only - every
+ * frame dispatched to the node posts it.
+ *
+ * 2026-10-16 AW
+ *-----------------------------------------------------------------*/
+
+uint32_t CONode::GetDueInUs()
+{
+	uint32_t SDODue = RWSDO.GetDueInUs();
+	uint32_t DueInUs = SchedNotDue;
+	
+	switch(NodeState)
+	{
+		case eNMTStateOffline:
+			//Update() probes once the request time has passed by 1ms
+			if(SDODue != SchedNotDue)
+				return SDODue;
+			return COSchedLeft(RequestTime + SDORequestTimeout + 1, millis()) * 1000;
+		case eNMTWaitForBoot:
+		case eNMTBootMsgReceived:
+			return isLive ? 0 : SchedNotDue;
+		case eNMTBooting:
+			return 0;
+		case eNMTStateReset:
+			return (SDODue != SchedNotDue) ? SDODue : 0;
+		case eNMTStatePreOp:
+		case eNMTStateOperational:
+			if(isGuardingActive)
+			{
+				switch(GuardingState)
+				{
+					case eCO_GuardingExpected:
+					case eCO_GuardingTimeOut:
+						return 0;
+					case eCO_GuardingWaiting:
+						//still queued: the time-out can't be due before the guard time from now
+						if(IsGuardRequestSent())
+							DueInUs = COSchedLeft(GuardRequestSentAt + GuardTimeUs() + 1, micros());
+						else
+							DueInUs = GuardTimeUs() + 1;
+						break;
+					case eCO_GuardingReceivedIntime:
+						DueInUs = COSchedLeft(GuardRequestSentAt + GuardTimeUs() + 1, micros());
+						break;
+					default:
+						break;
+				}
+			}
+			if(isHeartbeatActive)
+				DueInUs = COSchedMin(DueInUs, COSchedLeft(HeatbeatReceivedAt + RemoteHBMissedTime * 1000 + 1, micros()));
+			return COSchedMin(DueInUs, SDODue);
+		default:
+			return SDODue;
+	}
+}
+
+/*------------------------------------------------------------------
+ * bool IsGuardRequestSent()
+ * true once the COMsgHandler handed the guarding request to the
+ * CAN controller. Takes the time it was sent at from the stamp and
+ * the time it waited in the Tx queue.
+ *
+ * 2026-10-16 AW
+ *-----------------------------------------------------------------*/
+
+bool CONode::IsGuardRequestSent()
+{
+	if(!isGuardRequestSent && GuardRequestStamp.isStarted)
+	{
+		GuardRequestSentAt = GuardRequestStamp.StartedAt;
+		GuardQueueWaitUs = GuardRequestSentAt - GuardRequestQueuedAt;
+		if(GuardQueueWaitUs > MaxGuardQueueWaitUs)
+			MaxGuardQueueWaitUs = GuardQueueWaitUs;
+		isGuardRequestSent = true;
+	}
+	return isGuardRequestSent;
+}
+
+/*------------------------------------------------------------------
+ * void TraceNodeState()
+ * trace the NMT state if it changed since the last call - the state
+ * is changed in many places, so it's compared once per Update().
+ *
+ * 2026-10-16 AW
+ *-----------------------------------------------------------------*/
+
+void CONode::TraceNodeState()
+{
+	#if CO_TRACE
+	if(NodeState != TracedState)
+	{
+		CO_TRACE_EVENT(eCOTraceNMTState, NodeId, (uint8_t)NodeState, (uint8_t)TracedState);
+		TracedState = NodeState;
+	}
+	#endif
+}
+
 /*------------------------------------------------------------------
  * CONodeCommStates ConfigureGuarding(uint16_t Time, uint8_t Factor)
  *
@@ -902,7 +1021,7 @@ CONodeCommStates sendResult = eCO_NodeBusy;
 				//force the two of them to be equal until we get an update
 				ReportedState = eNMTStateOperational;
 				//reset the HB rx time als it will be checked in Pre-Op or Op only
-				HeatbeatReceivedAt = actTime;
+				HeatbeatReceivedAt = micros();
   
 		    #if(DEBUG_NODE & DEBUG_NMT_StateChange)
 			  Serial.print("Node: switch remote state --> start @ ");
@@ -998,7 +1117,7 @@ CONodeCommStates sendResult = eCO_NodeBusy;
 				//force the two of them to be equal until we get an update
 				ReportedState = eNMTStatePreOp;
 				//reset the HB rx time als it will be checked in Pre-Op or Op only
-				HeatbeatReceivedAt = actTime;
+				HeatbeatReceivedAt = micros();
   
 		    #if(DEBUG_NODE & DEBUG_NMT_StateChange)
 			  Serial.print("Node: switch remote state --> pre-op @");
@@ -1099,6 +1218,7 @@ CONodeCommStates CONode::SendRequest(CANMsg *Msg)
  * get the parts of the Emcy Msg and assing them to the loval variables
  * 
  * 2025-08-21 AW Done
+ * 2026-10-16 AW traced, printed with NODE_PrintEMCY only
  * ----------------------------------------------------------------*/
 
 void CONode::EmcyHandler(CANMsg *Msg)
@@ -1106,6 +1226,7 @@ void CONode::EmcyHandler(CANMsg *Msg)
   EmcyCode = (((uint16_t)(Msg->payload[1])) << 8) | ((uint16_t)(Msg->payload[0]));
 	FAULHABERErrorWord = Msg->payload[2];
 	CiA301ErrorWord = (((uint16_t)(Msg->payload[4])) << 8) | ((uint16_t)(Msg->payload[3]));
+	CO_TRACE_EVENT(eCOTraceEMCY, NodeId, EmcyCode, FAULHABERErrorWord | ((uint32_t)CiA301ErrorWord << 8));
 	
 	#if(NODE_PrintEMCY)
 	PrintEMCY();
@@ -1149,8 +1270,12 @@ void CONode::PrintEMCY()
  *   - Boot Msg
  *   - Guardnig Response
  *   - HB Indication
+ * The guarding response is in time and the HB received by their
+ * time stamp of the Rx interrupt (RxAt).
  * 
  * 2025-03-01 AW Done
+ * 2026-10-16 AW time stamp of the frame
+ * 2026-10-16 AW round trip from the hand-off of the request
  * ----------------------------------------------------------------*/
 
 void CONode::OnRxHandler(CANMsg *Msg)
@@ -1166,7 +1291,8 @@ void CONode::OnRxHandler(CANMsg *Msg)
 			//here Guarding and HB would need to be configured
 			isGuardingActive = false;
 			isHeartbeatActive = false;
-			ConfigStep = 0;
+			//a config written before the boot is lost
+			RWSDO.ResetComState();
 			
 			#if(DEBUG_NODE & DEBUG_NMT_RXMSG)
 			Serial.println("Node: Rx Boot");
@@ -1187,7 +1313,17 @@ void CONode::OnRxHandler(CANMsg *Msg)
 				  Serial.println("Node: Rx Guarding");
 				  #endif
           
- 					GuardingState = eCO_GuardingReceivedIntime;
+					//in time by the time stamp, not by the time it's dispatched
+					//and from the time the request was sent, not the one it was queued
+					if(IsGuardRequestSent())
+					{
+						GuardRoundTripUs = Msg->RxAt - GuardRequestSentAt;
+						if(GuardRoundTripUs > MaxGuardRoundTripUs)
+							MaxGuardRoundTripUs = GuardRoundTripUs;
+					
+						if(GuardRoundTripUs <= GuardTimeUs())
+ 						  GuardingState = eCO_GuardingReceivedIntime;
+					}
 					//toggle then expected toggle bit
 					if(expectedToggleBit == 0x80)
 						expectedToggleBit = 0;
@@ -1206,7 +1342,7 @@ void CONode::OnRxHandler(CANMsg *Msg)
 			else if(isHeartbeatActive)
 			{
 				NodeState = (NMTNodeState)(Msg->payload[0] & 0x7F);
-				HeatbeatReceivedAt = actTime;
+				HeatbeatReceivedAt = Msg->RxAt;
 				
 				#if(DEBUG_NODE & DEBUG_NMT_RXMSG)
         Serial.println("Node: Rx HB");
@@ -1220,116 +1356,43 @@ void CONode::OnRxHandler(CANMsg *Msg)
  * CONodeCommStates ActivateGuarding()
  * Activate the configured Guarding if time > 0 and factor > 0
  * otherwise deactivate it
+ * Heartbeat is disabled first, all 4 objects are written in one
+ * batch of the SDOHandler.
  * 
  * 2025-01-25 AW Frame
+ * 2026-10-16 AW written as a batch
  * ----------------------------------------------------------------*/
 
 CONodeCommStates CONode::ActivateGuarding()
 {
-  COSDOCommStates requestComState;	
+  COSDOCommStates requestComState = RWSDO.WriteObjects(GuardingConfigObjects, NumNodeConfigObjects);	
 
-	switch(ConfigStep)
+	ConfigState = eCO_NodeBusy;
+	isHeartbeatActive = false;
+
+	switch(requestComState)
 	{
-		case 0:
-			//disable Heartbeat first
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODProducerHeartbeatTime);
-		
-			ConfigState = eCO_NodeBusy;
-			isHeartbeatActive = false;
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 1;
+		case eCO_SDODone:
+			isGuardingActive = true;
+			NumGuardRequestsOpen = 0;
+			expectedToggleBit = 0;
+				
+			GuardingState = eCO_GuardingConfigured;
 
-  				#if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Reset Producer HB to 0");
-					#endif
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			}  //end of step 0
-			break;
-		case 1:
-			//disable Heartbeat first
-  		requestComState = RWSDO.WriteSDO((ODEntry *)&ODConsumerHeartbeatTime);
-		
-			ConfigState = eCO_NodeBusy;
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 2;
+			#if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
+			Serial.println("Node: Guarding configured");
+			#endif
 
-  				#if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Reset Consumer HB to 0");
-					#endif
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			}  //end of step 0
+			//done here
+			ConfigState = eCO_NodeDone;
 			break;
-		case 2:
-			//now configure for Guarding
-		  requestComState = RWSDO.WriteSDO((ODEntry *)&ODGuardTime);
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 3;
-
-				  #if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Configure GuardTime");
-					#endif
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			} //end of step 1
+		case eCO_SDOError:		
+		case eCO_SDOTimeout:
+			ConfigState = eCO_NodeError;
 			break;
-		case 3:
-			//plus live time factor
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODLiveTimeFactor);
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					isGuardingActive = true;
-				  NumGuardRequestsOpen = 0;
-				  expectedToggleBit = 0;
-				
-				  GuardingState = eCO_GuardingConfigured;
-
-				  #if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Configure Livetime factor");
-					#endif
-
-					//done here
-					ConfigState = eCO_NodeDone;
-					ConfigStep = 0;
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			} //end of step 2		
-      break;		
-		default:			
+		default:
 			break;
-	}  //end of step sequence	
+	}
 	return ConfigState;
 }
 
@@ -1337,113 +1400,41 @@ CONodeCommStates CONode::ActivateGuarding()
  * CONodeCommStates ActivateHeartbeat()
  * Activate the configured Heartbeat if time > 0
  * otherwise deactivate it
+ * Guarding is disabled first, all 4 objects are written in one
+ * batch of the SDOHandler.
  * 
  * 2025-01-25 AW Frame
+ * 2026-10-16 AW written as a batch
  * ----------------------------------------------------------------*/
 CONodeCommStates CONode::ActivateHeartbeat()
 {
-	COSDOCommStates requestComState;
+	COSDOCommStates requestComState = RWSDO.WriteObjects(HeartbeatConfigObjects, NumNodeConfigObjects);
+
+	ConfigState = eCO_NodeBusy;
+	isGuardingActive = false;
 	
-	switch(ConfigStep)
+	switch(requestComState)
 	{
-		case 0:
-			//disable Gurading first
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODGuardTime);
-
-		  ConfigState = eCO_NodeBusy;
-			isGuardingActive = false;
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 1;
+		case eCO_SDODone:
+			isHeartbeatActive = true;
+			GuardingState = eCO_GuardingConfigured;
+			//we reset the time for BH to now for the first round
+			HeatbeatReceivedAt = micros();
+
+			#if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
+			Serial.println("Node: Heartbeat configured");
+			#endif
 
-				  #if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Reset Guard Time to 0");
-					#endif
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			}  //end of step 0
+			//done here
+			ConfigState = eCO_NodeDone;
 			break;
-		case 1:
-			//reset LiceTime Factor
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODLiveTimeFactor);
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 2;
-
-				  #if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Reset LiveTimeFactor");
-					#endif
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			} //end of step 1
+		case eCO_SDOError:		
+		case eCO_SDOTimeout:
+			ConfigState = eCO_NodeError;
 			break;
-		case 2:
-			//set HeartBeatTime
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODProducerHeartbeatTime);
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					ConfigStep = 3;
-				
-					#if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Configure HB producer");
-					#endif
-
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			} //end of step 2	
-      break;
-		case 3:
-			//set Consumer HeartBeatTime
-			requestComState = RWSDO.WriteSDO((ODEntry *)&ODConsumerHeartbeatTime);
-		
-			switch(requestComState)
-			{
-				case eCO_SDODone:
-					isHeartbeatActive = true;
-				  GuardingState = eCO_GuardingConfigured;
-					//we reset the time for BH to now for the first round
-				  HeatbeatReceivedAt = actTime;
-
-				  #if(DEBUG_NODE & DEBUG_NMT_ConfigGuard)
-				  Serial.println("Node: Configure HB consumer");
-					#endif
-
-					//done here
-					ConfigState = eCO_NodeDone;
-					ConfigStep = 0;
-					break;
-				case eCO_SDOError:		
-				case eCO_SDOTimeout:
-					ConfigState = eCO_NodeError;
-					break;
-				default:
-					break;
-			} //end of step 2	
-      break;
 		default:
-      break;					
-	}  //end of step sequence	
+			break;
+	}
 	return ConfigState;
 }
 
@@ -25,6 +25,10 @@
  * implements the node specific NMT services of a CANopen device
  *
  * 2025-01-11 AW Frame
+ * 2026-10-16 AW guarding and heartbeat timed by the Rx time stamp
+ * 2026-10-16 AW event trace of the state
+ * 2026-10-16 AW GetDueInUs() for the scheduler
+ * 2026-10-16 AW guarding timed from the hand-off of the request
  *
  *-------------------------------------------------------------*/
  
@@ -33,6 +37,7 @@
 #include <COMsgHandler.h>
 #include <COSDOHandler.h>
 #include <COObjects.h>
+#include <COTrace.h>
 #include <stdint.h>
 
 // the node needs the typical states too
@@ -72,6 +77,7 @@ typedef enum COGuardingState {
 
 const uint8_t NMTCommandFrameLength = 2;
 const uint8_t NMTGuardingFrameLength = 1;
+const uint8_t NumNodeConfigObjects = 4;
 
 typedef struct NMTMsg {
    uint32_t Id;
@@ -93,6 +99,8 @@ class CONode {
 	
     NMTNodeState InitRemoteNode(uint32_t);  //confire the remote node via SDO	
 	  NMTNodeState Update(uint32_t);          //set the time and trigger Guarding / node identification
+		uint32_t GetDueInUs();                  //the time until Update() has something to do
+		NMTNodeState GetNodeState() { return NodeState; }
 		
 		void ResetComState(); 
 	  void RestartNode();
@@ -123,6 +131,15 @@ class CONode {
 		COSDOCommStates GetSDOState();
 
 		bool IsLive();
+		
+		//request to response of the node guarding, from the hand-off of the request
+		//to the CAN controller to the time stamp of the response
+		uint32_t GetGuardRoundTripUs() { return GuardRoundTripUs; }
+		uint32_t GetMaxGuardRoundTripUs() { return MaxGuardRoundTripUs; }
+		//the time the request waited in the Tx queue before
+		uint32_t GetGuardQueueWaitUs() { return GuardQueueWaitUs; }
+		uint32_t GetMaxGuardQueueWaitUs() { return MaxGuardQueueWaitUs; }
+		void ResetGuardStats() { MaxGuardRoundTripUs = 0; MaxGuardQueueWaitUs = 0; }
 
 		static void OnSysMsgRxCb(void *op,void *p) {
 			((CONode *)op)->OnRxHandler((CANMsg *)p);
@@ -141,14 +158,15 @@ class CONode {
 	  void EmcyHandler(CANMsg *);
 	
     void OnTimeOut();
+	  void TraceNodeState();
 	  CONodeCommStates SendRequest(CANMsg *);
 	
 	  CONodeCommStates ActivateGuarding();
 	  CONodeCommStates ActivateHeartbeat();
 	
 	  void PrintEMCY();
-		
-		uint8_t ConfigStep = 0;
+	  uint32_t GuardTimeUs() { return (uint32_t)GuardTime * 1000; }
+	  bool IsGuardRequestSent();
 		
 		uint8_t Channel = InvalidSlot;
 		int16_t NodeId = invalidNodeId;
@@ -163,6 +181,16 @@ class CONode {
     ODEntry08 ODLiveTimeFactor = {0x100D, 0x00, NULL, 1};
     ODEntry16 ODProducerHeartbeatTime = {0x1017, 0x00, NULL, 2};
     ODEntry32 ODConsumerHeartbeatTime = {0x1016, 0x01, NULL, 4};
+
+    //written as a batch by ActivateGuarding() / ActivateHeartbeat()
+    ODEntry *GuardingConfigObjects[NumNodeConfigObjects] = {(ODEntry *)&ODProducerHeartbeatTime,
+		                                                        (ODEntry *)&ODConsumerHeartbeatTime,
+		                                                        (ODEntry *)&ODGuardTime,
+		                                                        (ODEntry *)&ODLiveTimeFactor};
+    ODEntry *HeartbeatConfigObjects[NumNodeConfigObjects] = {(ODEntry *)&ODGuardTime,
+		                                                         (ODEntry *)&ODLiveTimeFactor,
+		                                                         (ODEntry *)&ODProducerHeartbeatTime,
+		                                                         (ODEntry *)&ODConsumerHeartbeatTime};
 	
 	  uint16_t GuardTime = 0;
 	  uint8_t LiveTimeFactor = 0;
@@ -172,12 +200,19 @@ class CONode {
 		uint32_t RemoteHBMissedTime = 0;
 		
     bool isGuardingActive = false;
-		uint32_t GuardRequestSentAt;
+		COTxStamp GuardRequestStamp = {false, 0};  //set by the COMsgHandler at the hand-off
+		bool isGuardRequestSent = false;
+		uint32_t GuardRequestQueuedAt;  //us
+		uint32_t GuardRequestSentAt;    //us, handed to the CAN controller
+		uint32_t GuardRoundTripUs = 0;
+		uint32_t MaxGuardRoundTripUs = 0;
+		uint32_t GuardQueueWaitUs = 0;
+		uint32_t MaxGuardQueueWaitUs = 0;
 		uint8_t NumGuardRequestsOpen = 0;
 		uint8_t expectedToggleBit = 0;
 		
 	  bool isHeartbeatActive = false;
-		uint32_t HeatbeatReceivedAt;
+		uint32_t HeatbeatReceivedAt;    //us, the time stamp of the HB
 		
 	  COGuardingState GuardingState = eCO_GuardingOff;
 		
@@ -199,6 +234,9 @@ class CONode {
 
 	  NMTNodeState NodeState = eNMTStateOffline;
 		NMTNodeState ReportedState = eNMTStateReset;
+		#if CO_TRACE
+		NMTNodeState TracedState = eNMTStateOffline;
+		#endif
 		bool isLive = false;
 		
 		uint32_t RequestTime = 0;
@@ -22,6 +22,16 @@
  * implements the class to produce handle and configure the PDOs
  *
  * 2025-03-09 AW Frame
+ * 2026-10-16 AW PDOs packed and unpacked using copy plans
+ * 2026-10-16 AW mappings defined by a COPDOMap
+ * 2026-10-16 AW number of PDOs set per node, received PDOs by COB-Id
+ * 2026-10-16 AW all transmission types, inhibit time, event timer, TxPDO timeout
+ * 2026-10-16 AW mapped objects refer to their PDO
+ * 2026-10-16 AW synchronous RxPDOs sent right after the SYNC, late ones counted
+ * 2026-10-16 AW TxPDOs supervised by the Rx time stamp
+ * 2026-10-16 AW latency probes
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW only configuration errors printed by default
  *
  *--------------------------------------------------------------*/
  
@@ -29,6 +39,8 @@
 
 #include <stdint.h>
 #include <COPDOHandler.h>
+#include <COProbe.h>
+#include <COTrace.h>
 
 //--- local defines ---
 
@@ -41,8 +53,9 @@
 #define DEBUG_PDO_Config  0x0020
 #define DEBUG_PDO_Init    0x0040
 #define DEBUG_PDO_BUSY    0x0080
+#define DEBUG_PDO_TIMEOUT 0x0100
 
-#define DEBUG_PDO (DEBUG_PDO_ERROR | DEBUG_PDO_BUSY) 
+#define DEBUG_PDO (DEBUG_PDO_ERROR) 
 
 //--- local definitions ---------
 
@@ -59,36 +72,176 @@ const uint8_t PDOComSettingsSubIdxEvtTimer = 05;
 
 const uint32_t PDOInvalidFlag = 0x80000000;
 
+//the inhibit time is given in 100us, the time base of the Update() is 1ms
+static inline uint32_t InhibitTimeMs(uint16_t InhibitTime) { return ((uint32_t)InhibitTime + 9) / 10; }
+//a TxPDO not received within 1.5 event timers is timed out
+//a single one lost is detected, the jitter of the node is tolerated
+static inline uint32_t TxPDODeadline(uint16_t EventTimer) { return (uint32_t)EventTimer + (EventTimer / 2); }
+
+//the predefined connection set: COB-Ids of PDO# 0..3 without the node-id
+const uint16_t PredefRxPDOCOBIds[NrPDOs] = {eCANRPDO1, eCANRPDO2, eCANRPDO3, eCANRPDO4};
+const uint16_t PredefTxPDOCOBIds[NrPDOs] = {eCANTPDO1, eCANTPDO2, eCANTPDO3, eCANTPDO4};
+
+//the steps writing the mapping of a PDO: step 0 clears the mapping,
+//steps 1..MaxPDOMappingEntries write the entries, then the rest
+const uint8_t PDOMapStepCount = MaxPDOMappingEntries + 1;
+const uint8_t PDOMapStepTType = MaxPDOMappingEntries + 2;
+const uint8_t PDOMapStepRxDone = MaxPDOMappingEntries + 3;
+const uint8_t PDOMapStepInhTime = MaxPDOMappingEntries + 3;
+const uint8_t PDOMapStepEvtTimer = MaxPDOMappingEntries + 4;
+const uint8_t PDOMapStepTxDone = MaxPDOMappingEntries + 5;
+
+//the mapping word of an entry written to 0x1600ff / 0x1A00ff
+//false if the entry is not in use
+static bool GetMappingWord(PDOMapping *Mapping, PDOCopyPlan *Plan, uint8_t Entry, uint32_t *Word)
+{
+	if((Entry >= Mapping->NrEntries) || (Mapping->Entries[Entry] == NULL))
+		return false;
+	
+	if(Plan->MappingWords != NULL)
+		*Word = Plan->MappingWords[Entry];
+	else
+		*Word = ((uint32_t)Mapping->Entries[Entry]->Idx << 16) | 
+						((uint32_t)Mapping->Entries[Entry]->SubIdx << 8) |
+						(Mapping->Entries[Entry]->len * 8);
+	return true;
+}
+
+//the copy plans write the values as they are in memory
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "PDO copy plans need a little endian target");
+
+//copy a run of up to 8 bytes - a single jump per run, the fixed size
+//copies compile into plain loads and stores while a memcpy() of a
+//variable size would call the library
+static inline void CopyRun(uint8_t *Dest, const uint8_t *Src, uint8_t Width)
+{
+	switch(Width)
+	{
+		case 1:
+			*Dest = *Src;
+			break;
+		case 2:
+			memcpy(Dest, Src, 2);
+			break;
+		case 3:
+			memcpy(Dest, Src, 3);
+			break;
+		case 4:
+			memcpy(Dest, Src, 4);
+			break;
+		case 5:
+			memcpy(Dest, Src, 5);
+			break;
+		case 6:
+			memcpy(Dest, Src, 6);
+			break;
+		case 7:
+			memcpy(Dest, Src, 7);
+			break;
+		default:
+			memcpy(Dest, Src, 8);
+			break;
+	}
+}
+
 //--- public functions ---
 
 /*---------------------------------------------------------------------
  * COPDOHandler::COPDOHandler()
- * as of now there is noting to intialized when created
+ * use the default storage for the 4 predefined Rx- and TxPDOs
  * 
  * 2025-03-11 AW Done
+ * 2026-10-16 AW default storage
+ * 2026-10-16 AW empty reverse index
  * ------------------------------------------------------------------*/
 
 COPDOHandler::COPDOHandler()
 {
-	for(uint8_t iter = 0; iter < NrPDOs; iter++)
+	memset(PDORefs, 0, sizeof(PDORefs));
+	
+	NrRxPDOs = NrPDOs;
+	RxPDOSettings = DefaultRxPDOSettings;
+	RxPDOMapping = DefaultRxPDOMapping;
+	RxPDOPlan = DefaultRxPDOPlan;
+	InitPDOs(NrRxPDOs, RxPDOSettings, RxPDOMapping, RxPDOPlan);
+	
+	NrTxPDOs = NrPDOs;
+	TxPDOSettings = DefaultTxPDOSettings;
+	TxPDOMapping = DefaultTxPDOMapping;
+	TxPDOPlan = DefaultTxPDOPlan;
+	InitPDOs(NrTxPDOs, TxPDOSettings, TxPDOMapping, TxPDOPlan);
+}
+
+/*---------------------------------------------------------------------
+ * void COPDOHandler::SetRxPDOStorage(uint16_t Nr, PDOTransmType *Settings,
+ *                                    PDOMapping *Mappings, PDOCopyPlan *Plans)
+ * use Nr RxPDOs in the storage of the user instead of the 4 default ones,
+ * e.g. using a COPDOStorage<N>. Each of the vectors has Nr elements and
+ * has to live as long as this handler.
+ * To be called before the PDOs are preset - they start unmapped and
+ * invalid. PDO# 4 and above have no predefined COB-Id, it's set using
+ * PresetRxPDOCOBId().
+ * 
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COPDOHandler::SetRxPDOStorage(uint16_t Nr, PDOTransmType *Settings, PDOMapping *Mappings, PDOCopyPlan *Plans)
+{
+	if((Nr == 0) || (Nr > MaxNrPDOs) || (Settings == NULL) || (Mappings == NULL) || (Plans == NULL))
 	{
-	  RxPDOMapping[iter].NrEntries = 0;
-	  TxPDOMapping[iter].NrEntries = 0;
-		
-		RxPDOSettings[iter].isValid = false;
-		RxPDOSettings[iter].pending = 0;
-		RxPDOSettings[iter].sentAt = 0;
-		
-		TxPDOSettings[iter].isValid = false;
-		TxPDOSettings[iter].pending = 0;
-		TxPDOSettings[iter].sentAt = 0;
-		TxPDOSettings[iter].hasInhibitTime = false;
-		TxPDOSettings[iter].hasEventTimer = false;
-		
-		
-		RxPDOLength[iter] = 0;
-		TxPDOLength[iter] = 0;
+		#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+		Serial.println("PDO: Rx storage invalid");
+		#endif
+		return;
+	}
+	for(uint16_t iter = 0; iter < NrRxPDOs; iter++)
+		SetPDORefs(eCO_PDORx, iter, false);
+	
+	NrRxPDOs = Nr;
+	RxPDOSettings = Settings;
+	RxPDOMapping = Mappings;
+	RxPDOPlan = Plans;
+	InitPDOs(NrRxPDOs, RxPDOSettings, RxPDOMapping, RxPDOPlan);
+	SetPredefCOBIds();
+	
+	nextTx = 0;
+	PDOsConfigured = 0;
+}
+
+/*---------------------------------------------------------------------
+ * void COPDOHandler::SetTxPDOStorage(uint16_t Nr, PDOTransmType *Settings,
+ *                                    PDOMapping *Mappings, PDOCopyPlan *Plans)
+ * use Nr TxPDOs in the storage of the user instead of the 4 default ones
+ * the COB-Ids already registered at the COMsgHandler are released
+ * PDO# 4 and above get their COB-Id using PresetTxPDOCOBId().
+ * 
+ * 2026-10-16 AW
+ * ------------------------------------------------------------------*/
+
+void COPDOHandler::SetTxPDOStorage(uint16_t Nr, PDOTransmType *Settings, PDOMapping *Mappings, PDOCopyPlan *Plans)
+{
+	if((Nr == 0) || (Nr > MaxNrPDOs) || (Settings == NULL) || (Mappings == NULL) || (Plans == NULL))
+	{
+		#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+		Serial.println("PDO: Tx storage invalid");
+		#endif
+		return;
+	}
+	for(uint16_t iter = 0; iter < NrTxPDOs; iter++)
+	{
+		SetTxCOBId(iter, 0);
+		SetPDORefs(eCO_PDOTx, iter, false);
 	}
+	
+	NrTxPDOs = Nr;
+	TxPDOSettings = Settings;
+	TxPDOMapping = Mappings;
+	TxPDOPlan = Plans;
+	InitPDOs(NrTxPDOs, TxPDOSettings, TxPDOMapping, TxPDOPlan);
+	SetPredefCOBIds();
+	
+	nextSupervised = 0;
+	PDOsConfigured = 0;
 }
 
 
@@ -98,9 +251,11 @@ COPDOHandler::COPDOHandler()
  * store the pointer to the MsgHandler
  * and the local Nodeid + Handler at the MsgHandler
  * register the CB at exact this handle
+ * and the COB-Ids of the TxPDOs, PDO# 0..3 of the predefined
+ * connection set if not preset
  *
  * 25-03-11 AW 
- *+6
+ * 2026-10-16 AW COB-Ids of the TxPDOs
  *-------------------------------------------------------------------*/
 
 void COPDOHandler::init(COMsgHandler *MsgHandler, CONode *MyNode, int8_t ThisNode, int8_t MsgHandle)
@@ -122,6 +277,14 @@ void COPDOHandler::init(COMsgHandler *MsgHandler, CONode *MyNode, int8_t ThisNod
 		Cb.op = (void *)this;
 
 	  Handler->Register_OnRxPDOCb(MsgHandle,&Cb);
+		
+		Channel = (uint8_t)MsgHandle;
+		SetPredefCOBIds();
+		for(uint16_t iter = 0; iter < NrTxPDOs; iter++)
+		{
+			if(TxPDOSettings[iter].COBId != 0)
+				Handler->RegisterRxPDO(Channel, TxPDOSettings[iter].COBId, iter);
+		}
 	  //PDORxTxState = eCO_PDOIdle;
 		RequestState = eCO_PDOIdle;
     SDORxTxState = eCO_SDOUnknown;		
@@ -218,13 +381,27 @@ void COPDOHandler::SetPDOConfigTimeout(uint32_t value)
  * void COPDOHandler::FlagPDOsInvalid()
  * to be called when a bbot msg was received to flag all
  * the pods to be unconfigured
+ * A config sequence interrupted by the re-boot has to start over
+ * and must not stay in the state of it's last SDO.
  * 
  * 2025-07-27 AW inital
+ * 2026-10-16 AW restart the config sequence too
+ * 2026-10-16 AW stop the timeout check of the TxPDOs
  * ---------------------------------------------*/
 
 void COPDOHandler::FlagPDOsInvalid()
 {
 	PDOsConfigured = 0;
+	
+	for(uint16_t iter = 0; iter < NrTxPDOs; iter++)
+	{
+		TxPDOSettings[iter].isReceived = false;
+		TxPDOSettings[iter].isSupervised = false;
+	}
+	
+	PDOConfigSequenceAccessStep = 0;
+	PDOConfigSingleStepAccessStep = 0;
+	SDORxTxState = eCO_SDOUnknown;
 }
 
 /*--------------------------------------------------------------
@@ -258,18 +435,33 @@ void COPDOHandler::SetBusyRetryMax(uint8_t value)
 }
 	
 /*--------------------------------------------------------------
- * void PresetRxPDOTransmission(uint8_t PDONr, uint8_t TransmType)
+ * void PresetRxPDOTransmission(uint16_t PDONr, uint8_t TransmType, uint16_t InhibitTime, uint16_t EvtTimer)
  *
  * store the tranmission type in the requested PDO settings
  * will not be transferred now
- * paramters are the PDO# and the transmission type
+ * paramters are the PDO#, the transmission type, the inhibit time and the EventTimer
+ *
+ * inhibit time (in 100us) and event timer (in ms) are applied by this
+ * central device when sending an event driven (254/255) RxPDO - they
+ * are not written to the node
+ * PDO# 0..3 get their predefined COB-Id
  * 
  * 2025-03-14 AW frame
+ * 2026-10-16 AW PDO# checked
+ * 2026-10-16 AW inhibit time and EvtTimer
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetRxPDOTransmission(uint8_t PDONr, uint8_t TransmType)
+void COPDOHandler::PresetRxPDOTransmission(uint16_t PDONr, uint8_t TransmType, uint16_t InhibitTime, uint16_t EvtTimer)
 {	
+	if(!CheckPDONr(eCO_PDORx, PDONr))
+		return;
+	
 	RxPDOSettings[PDONr].TransmType = TransmType;
+	RxPDOSettings[PDONr].inhibitTime = InhibitTime;
+	RxPDOSettings[PDONr].eventTimer = EvtTimer;
+	RxPDOSettings[PDONr].hasInhibitTime = (InhibitTime > 0);
+	RxPDOSettings[PDONr].hasEventTimer = (EvtTimer > 0);
+	RxPDOSettings[PDONr].syncCount = 0;
 	switch(PDONr)
 	{
 		case 0:
@@ -296,7 +488,7 @@ void COPDOHandler::PresetRxPDOTransmission(uint8_t PDONr, uint8_t TransmType)
 }
 
 /*--------------------------------------------------------------
- * void PresetTxPDOTransmission(uint8_t PDONr, uint8_t TransmType, uint16_t inhibitTime, uint16_t EvtTimer)
+ * void PresetTxPDOTransmission(uint16_t PDONr, uint8_t TransmType, uint16_t inhibitTime, uint16_t EvtTimer)
  *
  * store the tranmission type in the requested PDO settings
  * will not be transferred now
@@ -304,12 +496,18 @@ void COPDOHandler::PresetRxPDOTransmission(uint8_t PDONr, uint8_t TransmType)
  *
  * inihibit time nor supported than uesed so far
  * 
+ * PDO# 0..3 get their predefined COB-Id, registered at the COMsgHandler
+ * 
  * 2025-03-14 AW frame
  * 2025-10-03 AW add handling of EvtTimer and inhibit time
+ * 2026-10-16 AW PDO# checked, COB-Id registered
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetTxPDOTransmission(uint8_t PDONr, uint8_t TransmType, uint16_t InhibitTime, uint16_t EvtTimer)
+void COPDOHandler::PresetTxPDOTransmission(uint16_t PDONr, uint8_t TransmType, uint16_t InhibitTime, uint16_t EvtTimer)
 {
+	if(!CheckPDONr(eCO_PDOTx, PDONr))
+		return;
+	
 	TxPDOSettings[PDONr].TransmType = TransmType;
 	TxPDOSettings[PDONr].inhibitTime = InhibitTime;
 	TxPDOSettings[PDONr].eventTimer = EvtTimer;	
@@ -322,16 +520,16 @@ void COPDOHandler::PresetTxPDOTransmission(uint8_t PDONr, uint8_t TransmType, ui
 	switch(PDONr)
 	{
 		case 0:
-	    TxPDOSettings[PDONr].COBId = (uint16_t)eCANTPDO1 | nodeId;
+	    SetTxCOBId(PDONr, (uint16_t)eCANTPDO1 | nodeId);
 		  break;
 		case 1:
-	    TxPDOSettings[PDONr].COBId = (uint16_t)eCANTPDO2  | nodeId;
+	    SetTxCOBId(PDONr, (uint16_t)eCANTPDO2  | nodeId);
 		  break;
     case 2:
-	    TxPDOSettings[PDONr].COBId = (uint16_t)eCANTPDO3 | nodeId;
+	    SetTxCOBId(PDONr, (uint16_t)eCANTPDO3 | nodeId);
 		  break;
     case 3:
-	    TxPDOSettings[PDONr].COBId = (uint16_t)eCANTPDO4 | nodeId;
+	    SetTxCOBId(PDONr, (uint16_t)eCANTPDO4 | nodeId);
 		  break;
 	}			
   #if (DEBUG_PDO & DEBUG_PDO_Config) 
@@ -345,22 +543,72 @@ void COPDOHandler::PresetTxPDOTransmission(uint8_t PDONr, uint8_t TransmType, ui
 }
 	
 /*--------------------------------------------------------------
- * void PresetRxPDOMapping(uint8_t PDONr, unit8_t NrEntries, ODEntry **Entries)
+ * void PresetRxPDOCOBId(uint16_t PDONr, uint16_t COBId)
+ *
+ * the COB-Id of a RxPDO, e.g. of PDO# 4 and above
+ * will not be transferred now
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+void COPDOHandler::PresetRxPDOCOBId(uint16_t PDONr, uint16_t COBId)
+{
+	if(CheckPDONr(eCO_PDORx, PDONr))
+		RxPDOSettings[PDONr].COBId = COBId;
+}
+
+/*--------------------------------------------------------------
+ * void PresetTxPDOCOBId(uint16_t PDONr, uint16_t COBId)
+ *
+ * the COB-Id of a TxPDO, e.g. of PDO# 4 and above
+ * will not be transferred now, but is registered at the COMsgHandler
+ * so the PDO is dispatched to this handler. It has to be in the
+ * range 0x180..0x57F.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+void COPDOHandler::PresetTxPDOCOBId(uint16_t PDONr, uint16_t COBId)
+{
+	if(CheckPDONr(eCO_PDOTx, PDONr))
+		SetTxCOBId(PDONr, COBId);
+}
+
+/*--------------------------------------------------------------
+ * void PresetRxPDOMapping(uint16_t PDONr, unit8_t NrEntries, ODEntry **Entries)
  *
  * store the the mapping entires of a single PDO
  * will not be transferred now
  * paramters are the PDO#, number of active entries and a vector of ODEntries
+ * The mapping is compiled into the copy plan used for the frames.
+ * The mapped objects refer to this PDO.
  * 
  * 2025-03-14 AW frame
+ * 2026-10-16 AW compile the copy plan
+ * 2026-10-16 AW PDO# and # of entries checked
+ * 2026-10-16 AW set the reference of the mapped objects
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetRxPDOMapping(uint8_t PDONr, uint8_t NrEntries, ODEntry **Entries)
+void COPDOHandler::PresetRxPDOMapping(uint16_t PDONr, uint8_t NrEntries, ODEntry **Entries)
 {
+	if(!CheckPDONr(eCO_PDORx, PDONr))
+		return;
+	if(NrEntries > MaxPDOMappingEntries)
+		NrEntries = MaxPDOMappingEntries;
+	
+	SetPDORefs(eCO_PDORx, PDONr, false);
 	RxPDOMapping[PDONr].NrEntries = NrEntries;
 	for(uint8_t iter = 0; iter < NrEntries; iter++)
-	{
 	  RxPDOMapping[PDONr].Entries[iter] = Entries[iter];
-		RxPDOLength[PDONr] += (Entries[iter])->len;
+	SetPDORefs(eCO_PDORx, PDONr, true);
+	
+	if(!CompileCopyPlan(&RxPDOMapping[PDONr], &RxPDOPlan[PDONr]))
+	{
+		#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+		Serial.print("PDO: Rx #");
+		Serial.print(PDONr);
+		Serial.println(" mapping odd or longer than 8 bytes");
+		#endif
 	}
 
   #if (DEBUG_PDO & DEBUG_PDO_Config) 
@@ -369,28 +617,46 @@ void COPDOHandler::PresetRxPDOMapping(uint8_t PDONr, uint8_t NrEntries, ODEntry
 	Serial.print(" with # ");
 	Serial.print(RxPDOMapping[PDONr].NrEntries);
 	Serial.print(" entries #");
-	Serial.print(RxPDOLength[PDONr]);
+	Serial.print(RxPDOPlan[PDONr].Length);
 	Serial.println(" bytes");
   #endif
 }
 
 /*--------------------------------------------------------------
- * void PresetTxPDOMapping(uint8_t PDONr, unit8_t NrEntries, ODEntry **Entries)
+ * void PresetTxPDOMapping(uint16_t PDONr, unit8_t NrEntries, ODEntry **Entries)
  *
  * store the the mapping entires of a single PDO
  * will not be transferred now
  * paramters are the PDO#, number of active entries and a vector of ODEntries
+ * The mapping is compiled into the copy plan used for the frames.
+ * The mapped objects refer to this PDO.
  * 
  * 2025-03-14 AW frame
+ * 2026-10-16 AW compile the copy plan
+ * 2026-10-16 AW PDO# and # of entries checked
+ * 2026-10-16 AW set the reference of the mapped objects
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetTxPDOMapping(uint8_t PDONr, uint8_t NrEntries, ODEntry **Entries)
+void COPDOHandler::PresetTxPDOMapping(uint16_t PDONr, uint8_t NrEntries, ODEntry **Entries)
 {
+	if(!CheckPDONr(eCO_PDOTx, PDONr))
+		return;
+	if(NrEntries > MaxPDOMappingEntries)
+		NrEntries = MaxPDOMappingEntries;
+	
+	SetPDORefs(eCO_PDOTx, PDONr, false);
 	TxPDOMapping[PDONr].NrEntries = NrEntries;
 	for(uint8_t iter = 0; iter < NrEntries; iter++)
-	{
 	  TxPDOMapping[PDONr].Entries[iter] = Entries[iter];
-		TxPDOLength[PDONr] += (Entries[iter])->len;
+	SetPDORefs(eCO_PDOTx, PDONr, true);
+	
+	if(!CompileCopyPlan(&TxPDOMapping[PDONr], &TxPDOPlan[PDONr]))
+	{
+		#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+		Serial.print("PDO: Tx #");
+		Serial.print(PDONr);
+		Serial.println(" mapping odd or longer than 8 bytes");
+		#endif
 	}
 
   #if (DEBUG_PDO & DEBUG_PDO_Config) 
@@ -399,7 +665,7 @@ void COPDOHandler::PresetTxPDOMapping(uint8_t PDONr, uint8_t NrEntries, ODEntry
 	Serial.print(" with # ");
 	Serial.print(TxPDOMapping[PDONr].NrEntries);
 	Serial.print(" entries #");
-	Serial.print(RxPDOLength[PDONr]);
+	Serial.print(TxPDOPlan[PDONr].Length);
 	Serial.println(" bytes");
   #endif
 }
@@ -412,9 +678,10 @@ void COPDOHandler::PresetTxPDOMapping(uint8_t PDONr, uint8_t NrEntries, ODEntry
  * 2025-07-08 AW implemented
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetRxPDOisValid(uint8_t PdoNr,bool isValid)
+void COPDOHandler::PresetRxPDOisValid(uint16_t PdoNr,bool isValid)
 {
-	RxPDOSettings[PdoNr].isValid = isValid;
+	if(CheckPDONr(eCO_PDORx, PdoNr))
+		RxPDOSettings[PdoNr].isValid = isValid;
 }
 
 /*--------------------------------------------------------------
@@ -425,9 +692,10 @@ void COPDOHandler::PresetRxPDOisValid(uint8_t PdoNr,bool isValid)
  * 2025-07-08 AW implemented
  * --------------------------------------------------------------*/
 
-void COPDOHandler::PresetTxPDOisValid(uint8_t PdoNr,bool isValid)
+void COPDOHandler::PresetTxPDOisValid(uint16_t PdoNr,bool isValid)
 {
-	TxPDOSettings[PdoNr].isValid = isValid;
+	if(CheckPDONr(eCO_PDOTx, PdoNr))
+		TxPDOSettings[PdoNr].isValid = isValid;
 }
 
 /*--------------------------------------------------------------
@@ -444,18 +712,18 @@ COPDOCommStates COPDOHandler::ConfigurePresetPDOs(uint32_t timestamp)
 	COPDOCommStates returnValue = eCO_PDOBusy;	
 	
 	//first configure the Rx
-	if(PDOsConfigured < NrPDOs)
+	if(PDOsConfigured < NrRxPDOs)
 	{
 	  if((PDOAccessState = ConfigureRxTxPDO(PDOsConfigured, eCO_PDORx, timestamp)) == eCO_PDODone)
 		  PDOsConfigured++;
   }
-	else if(PDOsConfigured == (2 * NrPDOs))
+	else if(PDOsConfigured == (NrRxPDOs + NrTxPDOs))
 	{
 	  returnValue = eCO_PDODone;			
 	}
 	else
 	{
-	  if((PDOAccessState = ConfigureRxTxPDO(PDOsConfigured - NrPDOs, eCO_PDOTx, timestamp)) == eCO_PDODone)
+	  if((PDOAccessState = ConfigureRxTxPDO(PDOsConfigured - NrRxPDOs, eCO_PDOTx, timestamp)) == eCO_PDODone)
 		  PDOsConfigured++;
 	}
 	
@@ -467,8 +735,26 @@ COPDOCommStates COPDOHandler::ConfigurePresetPDOs(uint32_t timestamp)
  *
  * update the timestamp and return the current state
  * to be called after the Pre-Op
+ *
+ * RxPDOs are flagged for sending by their transmission type:
+ * - 0: at the SYNC after a mapped value changed (TxPDOsAsync())
+ * - 1..240: at every n-th SYNC
+ * - 254/255: when a mapped value changed or the event timer elapsed,
+ *   but not before the inhibit time passed since the last one
+ * The synchronous ones are all queued in the call reporting the SYNC,
+ * right behind it, so they are sent within the synchronous window.
+ * They use their own frame, so an asynchronous one waiting for it's
+ * retry is not touched. The ones refused by a full Tx queue are all
+ * retried by the following calls until the window is closed and
+ * counted late then - as is one still pending at the next SYNC.
+ * Otherwise one asynchronous RxPDO is checked (and sent) per call,
+ * as is one TxPDO for a timeout.
  * 
  * 2025-04-26 AW implementation
+ * 2026-10-16 AW SYNC every n, acyclic sync, inhibit time and event timer
+ * 2026-10-16 AW synchronous ones sent right after the SYNC
+ * 2026-10-16 AW late ones traced
+ * 2026-10-16 AW synchronous ones by their own frame, all retried at once
  * --------------------------------------------------------------*/
 
 COPDOCommStates COPDOHandler::Update(uint32_t time, COSyncState synchState)
@@ -478,33 +764,103 @@ COPDOCommStates COPDOHandler::Update(uint32_t time, COSyncState synchState)
 	//check for sync ones
 	if(synchState == eSyncSyncSent)
 	{
-	  for(uint8_t iterPDO = 0; iterPDO < NrPDOs; iterPDO++)
+	  for(uint16_t iterPDO = 0; iterPDO < NrRxPDOs; iterPDO++)
+	  {
+			PDOTransmType *Settings = &RxPDOSettings[iterPDO];
+			
+			if((Settings->TransmType <= TPDOTTypeSyncMax) && (Settings->pending > 0))
+			{
+				//still not sent for the last SYNC
+				Settings->pending = 0;
+				LateRxPDOs++;
+				CO_TRACE_EVENT(eCOTraceRxPDOLate, nodeId, Settings->COBId, 0);
+			}
+			
+			if(Settings->TransmType == TPDOTTypeSyncAcyclic)
+			{
+				//only if changed
+				if(Settings->isChanged)
+				{
+					Settings->isChanged = false;
+					Settings->pending = 1;
+				}
+			}
+			else if(Settings->TransmType <= TPDOTTypeSyncMax)
+			{
+				//every n-th SYNC
+				Settings->syncCount++;
+				if(Settings->syncCount >= Settings->TransmType)
+				{
+					Settings->syncCount = 0;
+					Settings->pending = 1;
+				}
+			}
+		}
+		hasSyncPending = true;
+	}
+	
+	//all synchronous ones at once - the ones refused are retried by the following calls
+	if(hasSyncPending)
+	{
+		bool isInWindow = Handler->IsInSyncWindow();
+		
+		hasSyncPending = false;
+	  for(uint16_t iterPDO = 0; iterPDO < NrRxPDOs; iterPDO++)
 	  {
-			//handling for Sync but non 1 is missing
-	    if((RxPDOSettings[iterPDO].TransmType == 1))
+			PDOTransmType *Settings = &RxPDOSettings[iterPDO];
+			
+			if((Settings->TransmType > TPDOTTypeSyncMax) || (Settings->pending == 0))
+				continue;
+			
+			if(!isInWindow)
+			{
+				//missed the window, would be discarded by the node
+				Settings->pending = 0;
+				LateRxPDOs++;
+				CO_TRACE_EVENT(eCOTraceRxPDOLate, nodeId, Settings->COBId, 0);
+			}
+			else if(TransmitSyncPdo(iterPDO))
 			{
-				//add this one to the list for sending
-			  RxPDOSettings[iterPDO].pending = true;
+				Settings->sentAt = actTime;
+				Settings->pending = 0;
 			}
+			else
+				hasSyncPending = true;
 		}
 	}
-	//now check the PDO one in focus in this turn for being pendig
-	if(RxPDOSettings[nextTx].pending > 0)
+	
+	//now check the asynchronous one in focus in this turn for being pendig
+	PDOTransmType *Settings = &RxPDOSettings[nextTx];
+	bool isInhibited = false;
+	
+	if(Settings->TransmType >= TPDOTTypeAsyncMS)
+	{
+		uint32_t sinceSent = actTime - Settings->sentAt;
+		
+		if(Settings->hasEventTimer && (sinceSent >= Settings->eventTimer))
+			Settings->pending = 1;
+		if(Settings->hasInhibitTime && (sinceSent < InhibitTimeMs(Settings->inhibitTime)))
+			isInhibited = true;
+	}
+	else if(Settings->TransmType <= TPDOTTypeSyncMax)
+	{
+		//sent above
+		isInhibited = true;
+	}
+	
+	if((Settings->pending > 0) && !isInhibited)
 	{
 		//if it is pending we try to send
 		//will only proceed with the next in list, when Tx did work
 		
 		if(TransmitPdo(nextTx))
 		{
-		  RxPDOSettings[nextTx].sentAt = actTime;
-      //several source can falg this one for Tx
-		  if(RxPDOSettings[nextTx].pending > 0)
-			{
-			  RxPDOSettings[nextTx].pending--;
-			}
+		  Settings->sentAt = actTime;
+      //several changes are covered by a single PDO
+		  Settings->pending = 0;
 	
 			nextTx++;			
-			if(nextTx == NrPDOs)
+			if(nextTx >= NrRxPDOs)
 			{
 				nextTx = 0;
 			}
@@ -512,16 +868,119 @@ COPDOCommStates COPDOHandler::Update(uint32_t time, COSyncState synchState)
 	}
 	else
 	{
-		//not pendig, check the next
+		//not pendig or inhibited, check the next
 		nextTx++;			
-		if(nextTx == NrPDOs)
+		if(nextTx >= NrRxPDOs)
 		{
 			nextTx = 0;
 		}
 	}
+	
+	//the TxPDOs received
+	OnTimeOut();
+	
 	return RequestState;
 }
 
+/*--------------------------------------------------------------
+ * uint32_t GetDueInUs()
+ *
+ * the time in us until Update() has something to do: an RxPDO to
+ * be sent - when it's inhibit time is over - or it's event timer,
+ * a TxPDO received or the deadline of it's supervision.
+ * The SYNC isn't covered - see HasSyncRxPDOs().
+ * As Update() checks one PDO per call, a PDO due is due for the
+ * calls until it's turn.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+uint32_t COPDOHandler::GetDueInUs()
+{
+	uint32_t DueInUs = SchedNotDue;
+	uint32_t nowMs = millis();
+	uint32_t nowUs = micros();
+	
+	for(uint16_t iterPDO = 0; iterPDO < NrRxPDOs; iterPDO++)
+	{
+		PDOTransmType *Settings = &RxPDOSettings[iterPDO];
+		
+		if(Settings->TransmType >= TPDOTTypeAsyncMS)
+		{
+			bool isPending = (Settings->pending > 0) || (Settings->hasEventTimer && ((nowMs - Settings->sentAt) >= Settings->eventTimer));
+			
+			if(isPending)
+				DueInUs = Settings->hasInhibitTime ? COSchedMin(DueInUs, COSchedLeft(Settings->sentAt + InhibitTimeMs(Settings->inhibitTime), nowMs) * 1000) : 0;
+			else if(Settings->hasEventTimer)
+				DueInUs = COSchedMin(DueInUs, COSchedLeft(Settings->sentAt + Settings->eventTimer, nowMs) * 1000);
+		}
+		else if((Settings->TransmType <= TPDOTTypeSyncMax) && (Settings->pending > 0))
+			DueInUs = 0;
+		
+		if(DueInUs == 0)
+			return 0;
+	}
+	
+	for(uint16_t iterPDO = 0; iterPDO < NrTxPDOs; iterPDO++)
+	{
+		PDOTransmType *Settings = &TxPDOSettings[iterPDO];
+		
+		if(!Settings->hasEventTimer)
+			continue;
+		if(Settings->isReceived)
+			return 0;
+		if(Settings->isSupervised && !Settings->isTimedOut)
+			DueInUs = COSchedMin(DueInUs, COSchedLeft(Settings->sentAt + TxPDODeadline(Settings->eventTimer) * 1000 + 1, nowUs));
+	}
+	
+	return DueInUs;
+}
+
+/*--------------------------------------------------------------
+ * uint32_t GetConfigDueInUs()
+ *
+ * the time in us until ConfigurePresetPDOs() has something to do:
+ * right away unless waiting for the response of the node, then
+ * by the time-out of the SDO or the one of the configuration
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+uint32_t COPDOHandler::GetConfigDueInUs()
+{
+	uint32_t DueInUs = Node->RWSDO.GetDueInUs();
+	
+	if(DueInUs == SchedNotDue)
+		return 0;
+	return COSchedMin(DueInUs, COSchedLeft(RequestSentAt + PDOConfigTimeout + 1, millis()) * 1000);
+}
+
+/*--------------------------------------------------------------
+ * bool HasSyncRxPDOs()
+ *
+ * an RxPDO sent every n-th SYNC or a changed acyclic one, for
+ * which Update() has to see the SYNC
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+bool COPDOHandler::HasSyncRxPDOs()
+{
+	for(uint16_t iterPDO = 0; iterPDO < NrRxPDOs; iterPDO++)
+	{
+		PDOTransmType *Settings = &RxPDOSettings[iterPDO];
+		
+		if(Settings->TransmType == TPDOTTypeSyncAcyclic)
+		{
+			if(Settings->isChanged)
+				return true;
+		}
+		else if(Settings->TransmType <= TPDOTTypeSyncMax)
+			return true;
+	}
+	return false;
+}
+
 /*--------------------------------------------------------------
  * COPDOCommStates ModifyRxPDOTransmission(uint8_t PDONr, uint8_t TransmType)
  *
@@ -599,20 +1058,25 @@ COPDOCommStates COPDOHandler::ModifyTxPDOMapping(uint8_t PDONr, uint8_t NrEntrie
 }	
 			
 /*--------------------------------------------------------------
- * COPDOCommStates COPDOHandler::ConfigureRxTxPDO(uint8_t PdoNr, PDODir Dir, uint32_t time)
+ * COPDOCommStates COPDOHandler::ConfigureRxTxPDO(uint16_t PdoNr, PDODir Dir, uint32_t time)
  *
  * configure a single preset PDO at the remote node
+ * a PDO without a COB-Id (PDO# 4 and above not preset) is skipped
  * 
  * 2025-04-26 AW implementation
+ * 2026-10-16 AW skip PDOs without a COB-Id
  * --------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::ConfigureRxTxPDO(uint8_t PdoNr, PDODir Dir, uint32_t time)
+COPDOCommStates COPDOHandler::ConfigureRxTxPDO(uint16_t PdoNr, PDODir Dir, uint32_t time)
 {
   COPDOCommStates StepState;
 	COPDOCommStates returnValue = eCO_PDOBusy;
 	
   actTime = time;
 	
+	if(((Dir == eCO_PDORx) ? RxPDOSettings[PdoNr].COBId : TxPDOSettings[PdoNr].COBId) == 0)
+		return eCO_PDODone;
+	
 	switch(PDOConfigSequenceAccessStep)
 	{
 		case 0:
@@ -686,44 +1150,41 @@ COPDOCommStates COPDOHandler::ConfigureRxTxPDO(uint8_t PdoNr, PDODir Dir, uint32
  *
  * check whether entry is mapped into a RxPDO and triger its transmission if async
  * to have it transmitted it gets entered into a list of PDOs to be sent for this node
+ * an acyclic sync one (type 0) is flagged to be sent with the next SYNC
+ *
+ * the RxPDO is the one the entry refers to, only an entry mapped into
+ * several RxPDOs needs the search through all mappings
  * 
  * 2025-07-12 AW frame
+ * 2026-10-16 AW acyclic sync, changes before a Tx are covered by a single one
+ * 2026-10-16 AW RxPDO by the reference of the entry
  * --------------------------------------------------------------*/
 
 bool COPDOHandler::TxPDOsAsync(ODEntry *entry)
 {
 	bool returnValue = false;
+	uint16_t Ref = GetPDORef(eCO_PDORx, entry);
+	
+	if(Ref == PDORefNone)
+		return false;
+	
+	if((Ref != PDORefMulti) && (Ref <= NrRxPDOs))
+	{
+		FlagRxPDO(Ref - 1);
+		return true;
+	}
 	
-  for(uint8_t iterPDO = 0; iterPDO < NrPDOs; iterPDO++)
+  for(uint16_t iterPDO = 0; iterPDO < NrRxPDOs; iterPDO++)
 	{
 		#if (DEBUG_PDO & DEBUG_PDO_TXAsync)
 		Serial.print("PDO: Check RxPDO");
 		Serial.println(iterPDO+1);
 		#endif
 		
-		//now check every mapped entry
-		for(uint8_t iterEntry = 0; iterEntry < RxPDOMapping[iterPDO].NrEntries; iterEntry++)
+		if(IsMapped(&RxPDOMapping[iterPDO], entry))
 		{
-			#if (DEBUG_PDO & DEBUG_PDO_TXAsync)
-			Serial.print("PDO: Check Entry ");
-			Serial.print(iterEntry);
-			Serial.print(":");
-			Serial.println((RxPDOMapping[iterPDO].Entries[iterEntry])->Idx, HEX);
-			#endif
-			if(RxPDOMapping[iterPDO].Entries[iterEntry] == entry)
-			{
-				//add this one to the list for sending
-				//only PDOs configured to be asyc get flagged
-		    if(RxPDOSettings[iterPDO].TransmType == TPDOTTypeAsync)
-				  RxPDOSettings[iterPDO].pending++;
-				
-				returnValue = true;
-				
-				#if (DEBUG_PDO & DEBUG_PDO_TXAsync)
-				Serial.print("PDO: will Tx RxPDO");
-				Serial.println(iterPDO+1);  
-				#endif
-			}
+			FlagRxPDO(iterPDO);
+			returnValue = true;
 		}
 	}
 	return returnValue;
@@ -733,59 +1194,121 @@ bool COPDOHandler::TxPDOsAsync(ODEntry *entry)
  * bool COPDOHandler::RxPDOIsSync(ODEntry *entry)
  *
  * check whether entry is mapped into a sync TxPDO 
+ * by the reference of the entry, searching all mappings only
+ * if it's mapped into several TxPDOs
  * 
  * 2025-11-16 AW frame
+ * 2026-10-16 AW TxPDO by the reference of the entry
  * --------------------------------------------------------------*/
 
 bool COPDOHandler::RxPDOIsSync(ODEntry *entry)
 {
-	bool returnValue = false;
+	uint16_t Ref = GetPDORef(eCO_PDOTx, entry);
 	
-  for(uint8_t iterPDO = 0; iterPDO < NrPDOs; iterPDO++)
+	if(Ref == PDORefNone)
+		return false;
+	
+	if((Ref != PDORefMulti) && (Ref <= NrTxPDOs))
+		return true;
+	
+  for(uint16_t iterPDO = 0; iterPDO < NrTxPDOs; iterPDO++)
 	{
 		#if (DEBUG_PDO & DEBUG_PDO_RXSync)
 		Serial.print("PDO: Check TxPDO");
 		Serial.println(iterPDO+1);
 		#endif
 		
-		//now check every mapped entry
-		for(uint8_t iterEntry = 0; iterEntry < TxPDOMapping[iterPDO].NrEntries; iterEntry++)
-		{
+		if(IsMapped(&TxPDOMapping[iterPDO], entry))
+		{				
 			#if (DEBUG_PDO & DEBUG_PDO_RXSync)
-			Serial.print("PDO: Check Entry ");
-			Serial.print(iterEntry);
-			Serial.print(":");
-			Serial.println((TxPDOMapping[iterPDO].Entries[iterEntry])->Idx, HEX);
+			Serial.print("PDO: will be Rx sync");
+			Serial.println(iterPDO+1);  
 			#endif
-			if(TxPDOMapping[iterPDO].Entries[iterEntry] == entry)
-			{				
-				returnValue = true;
-				
-				#if (DEBUG_PDO & DEBUG_PDO_RXSync)
-				Serial.print("PDO: will be Rx sync");
-				Serial.println(iterPDO+1);  
-				#endif
-			}
+			
+			return true;
 		}
 	}
-	return returnValue;
+	return false;
+}
+
+/*--------------------------------------------------------------
+ * bool COPDOHandler::RequestTxPDO(uint16_t PdoNr)
+ *
+ * request a TxPDO by a RTR - the way to get one of the transmission
+ * type 252 or 253
+ * returns false if it could not be queued
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+bool COPDOHandler::RequestTxPDO(uint16_t PdoNr)
+{
+	CANMsg Request;
+	
+	if(!CheckPDONr(eCO_PDOTx, PdoNr) || (TxPDOSettings[PdoNr].COBId == 0))
+		return false;
+	
+	Request.Id = TxPDOSettings[PdoNr].COBId;
+	Request.len = TxPDOPlan[PdoNr].Length;
+	Request.isRTR = true;
+	Request.serviceType = (COService)(Request.Id & 0xFF80);
+	
+	return Handler->SendMsg(&Request);
+}
+
+/*--------------------------------------------------------------
+ * bool COPDOHandler::IsTxPDOTimedOut(uint16_t PdoNr)
+ *
+ * true if a TxPDO with an event timer was not received in time
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+bool COPDOHandler::IsTxPDOTimedOut(uint16_t PdoNr)
+{
+	if(PdoNr >= NrTxPDOs)
+		return false;
+	
+	return TxPDOSettings[PdoNr].isTimedOut;
+}
+
+/*--------------------------------------------------------------
+ * uint32_t COPDOHandler::GetTxPDOAgeUs(uint16_t PdoNr)
+ *
+ * the time in us since the TxPDO was received - by the time stamp
+ * of the Rx interrupt, so independent of the loop.
+ * 0xFFFFFFFF if it was not received yet.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+uint32_t COPDOHandler::GetTxPDOAgeUs(uint16_t PdoNr)
+{
+	if((PdoNr >= NrTxPDOs) || !(TxPDOSettings[PdoNr].isReceived || TxPDOSettings[PdoNr].isSupervised))
+		return 0xFFFFFFFF;
+	
+	return micros() - TxPDOSettings[PdoNr].sentAt;
 }
 	
 // - private functions ---
 	
 /*-------------------------------------------------------------------
- * bool COPDOHandler::SendRequest(CANMsg *)
+ * bool COPDOHandler::SendRequest(CANMsg *, volatile uint32_t *LateCount)
  * 
  * proess and send a CANMsg
  * enter a retry when momentarily blocked
+ * a synchronous RxPDO comes with the LateCount, the COMsgHandler
+ * counts it there if it misses the synchronous window
  * 
  * 25-03-09 AW 
+ * 2026-10-16 AW synchronous frames
+ * 2026-10-16 AW a failed request printed with DEBUG_PDO_BUSY
  *
  *-------------------------------------------------------------------*/
 		
-bool COPDOHandler::SendRequest(CANMsg *Msg)
+bool COPDOHandler::SendRequest(CANMsg *Msg, volatile uint32_t *LateCount)
 {
-	bool result = Handler->SendMsg(Msg);	
+	bool result = Handler->SendMsg(Msg, NULL, LateCount);	
 	
 	if(result)
 	{
@@ -807,7 +1330,7 @@ bool COPDOHandler::SendRequest(CANMsg *Msg)
 		{
 			RequestState = eCO_PDOError;
 
-		  #if(DEBUG_PDO & DEBUG_PDO_ERROR)
+		  #if(DEBUG_PDO & DEBUG_PDO_BUSY)
 		  Serial.print("PDO: TX ");
 			Serial.print(Msg->Id,HEX);
 			Serial.println(" TxReq failed");
@@ -829,7 +1352,7 @@ bool COPDOHandler::SendRequest(CANMsg *Msg)
 
 
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint16_t PdoNr)
  * 
  * set this RxPDO to invalid
  * uses the CobId stored in the master
@@ -839,7 +1362,7 @@ bool COPDOHandler::SendRequest(CANMsg *Msg)
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint16_t PdoNr)
 {
 	uint32_t ObjValue = RxPDOSettings[PdoNr].COBId | PDOInvalidFlag;
 	uint32_t ObjLen = 4;
@@ -848,7 +1371,7 @@ COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint8_t PdoNr)
 }
 
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint16_t PdoNr)
  * 
  * set this TxPDO to invalid
  * uses the CobId stored in the master
@@ -859,7 +1382,7 @@ COPDOCommStates COPDOHandler::SetRxPDOInvalid(uint8_t PdoNr)
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint16_t PdoNr)
 {
 	uint32_t ObjValue = TxPDOSettings[PdoNr].COBId | PDOInvalidFlag;
 	uint32_t ObjLen = 4;
@@ -868,7 +1391,7 @@ COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint8_t PdoNr)
 }
 
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::SetRxPDOValid(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::SetRxPDOValid(uint16_t PdoNr)
  * 
  * set this RxPDO to valid state
  * does not check the mapping stored in the node
@@ -879,7 +1402,7 @@ COPDOCommStates COPDOHandler::SetTxPDOInvalid(uint8_t PdoNr)
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::SetRxPDOValid(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::SetRxPDOValid(uint16_t PdoNr)
 {
 	uint32_t ObjValue = RxPDOSettings[PdoNr].COBId;
 	uint32_t ObjLen = 4;
@@ -892,7 +1415,7 @@ COPDOCommStates COPDOHandler::SetRxPDOValid(uint8_t PdoNr)
 }
 
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::SetTxPDOValid(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::SetTxPDOValid(uint16_t PdoNr)
  * 
  * set this TxPDO to valid state
  * does not check the mapping stored in the node
@@ -903,7 +1426,7 @@ COPDOCommStates COPDOHandler::SetRxPDOValid(uint8_t PdoNr)
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::SetTxPDOValid(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::SetTxPDOValid(uint16_t PdoNr)
 {
 	uint32_t ObjValue = TxPDOSettings[PdoNr].COBId;
 	uint32_t ObjLen = 4;
@@ -916,7 +1439,7 @@ COPDOCommStates COPDOHandler::SetTxPDOValid(uint8_t PdoNr)
 }
 	
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint16_t PdoNr)
  * 
  * write the locally stored mappings to the referred PDO
  * has to reset the number of mapped entires to 0 first
@@ -925,10 +1448,11 @@ COPDOCommStates COPDOHandler::SetTxPDOValid(uint8_t PdoNr)
  * is intended to be called cyclically until the final SDO access reports eCO_SDODone
  * 
  * 25-04-27 AW 
+ * 2026-10-16 AW all MaxPDOMappingEntries entries, not only the first 4
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint16_t PdoNr)
 {
   //the return value of this method
 	COPDOCommStates returnValue = eCO_PDOBusy;
@@ -948,42 +1472,21 @@ COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
 		  ObjIdx = RxPDOMappingTypeBaseIndex + PdoNr;
 		  ObjSubIdx = 0;
 			break;
-		case 1:
-		case 2:
-		case 3:
-		case 4:
-		{
-			uint8_t entry = PDOConfigSingleStepAccessStep - 1;
-			if(RxPDOMapping[PdoNr].Entries[entry] != NULL)
-			{
-			  ObjValue = (RxPDOMapping[PdoNr].Entries[entry]->Idx << 16) | 
-									 (RxPDOMapping[PdoNr].Entries[entry]->SubIdx << 8) |
-									 (RxPDOMapping[PdoNr].Entries[entry]->len * 8);
-				ObjLen = 4;
-			}
-			else
-				//skip this access
-				doTransmit = false;		
-			
-		  ObjIdx = RxPDOMappingTypeBaseIndex + PdoNr;
-		  ObjSubIdx = PDOConfigSingleStepAccessStep;
-			break;
-		}
-		case 5:
+		case PDOMapStepCount:
 			//set the number of mepped objects to the actual one
 			ObjValue = RxPDOMapping[PdoNr].NrEntries;
 			ObjLen = 1;
 		  ObjIdx = RxPDOMappingTypeBaseIndex + PdoNr;
 		  ObjSubIdx = 0;
 			break;
-		case 6:
+		case PDOMapStepTType:
 			//set the trasnmission type
 			ObjValue = RxPDOSettings[PdoNr].TransmType;
 			ObjLen = 1;
 		  ObjIdx = RxPDOTransmTypeBaseIndex + PdoNr;
 		  ObjSubIdx = PDOComSettingsSubIdxTType;
 			break;
-		case 7:
+		case PDOMapStepRxDone:
 			//we are done with this one
 			PDOConfigSingleStepAccessStep = 0;
 			returnValue = eCO_PDODone;	
@@ -997,6 +1500,17 @@ COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
 		
       break;
 		default:
+			//the mapping entries
+			if((PDOConfigSingleStepAccessStep >= 1) && (PDOConfigSingleStepAccessStep <= MaxPDOMappingEntries))
+			{
+				uint8_t entry = PDOConfigSingleStepAccessStep - 1;
+				
+				//entries not used are skipped
+				doTransmit = GetMappingWord(&RxPDOMapping[PdoNr], &RxPDOPlan[PdoNr], entry, &ObjValue);
+				ObjLen = 4;
+				ObjIdx = RxPDOMappingTypeBaseIndex + PdoNr;
+				ObjSubIdx = PDOConfigSingleStepAccessStep;
+			}
 			break;
 	}
   if(doTransmit)
@@ -1035,7 +1549,7 @@ COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
 }
 
 /*-------------------------------------------------------------------
- * COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
+ * COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint16_t PdoNr)
  * 
  * write the locally stored mappings to the referred PDO
  * has to reset the number of mapped entires to 0 first
@@ -1044,10 +1558,11 @@ COPDOCommStates COPDOHandler::WriteRxPDOMapping(uint8_t PdoNr)
  * is intended to be called cyclically until the final SDO access reports eCO_SDODone
  * 
  * 25-04-27 AW 
+ * 2026-10-16 AW all MaxPDOMappingEntries entries, not only the first 4
  *
  *-------------------------------------------------------------------*/
 
-COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
+COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint16_t PdoNr)
 {
   //the return value of this method
 	COPDOCommStates returnValue = eCO_PDOBusy;
@@ -1067,42 +1582,21 @@ COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
 		  ObjIdx = TxPDOMappingTypeBaseIndex + PdoNr;
 		  ObjSubIdx = 0;
 			break;
-		case 1:
-		case 2:
-		case 3:
-		case 4:
-		{
-			uint8_t entry = PDOConfigSingleStepAccessStep - 1;
-			if(TxPDOMapping[PdoNr].Entries[entry] != NULL)
-			{
-			  ObjValue = (TxPDOMapping[PdoNr].Entries[entry]->Idx << 16) | 
-									 (TxPDOMapping[PdoNr].Entries[entry]->SubIdx << 8) |
-									 (TxPDOMapping[PdoNr].Entries[entry]->len * 8);
-				ObjLen = 4;
-			}
-			else
-				//skip this access
-				doTransmit = false;		
-			
-		  ObjIdx = TxPDOMappingTypeBaseIndex + PdoNr;
-		  ObjSubIdx = PDOConfigSingleStepAccessStep;
-			break;
-		}
-		case 5:
+		case PDOMapStepCount:
 			//set the number of mepped objects to 0
 			ObjValue = TxPDOMapping[PdoNr].NrEntries;
 			ObjLen = 1;
 		  ObjIdx = TxPDOMappingTypeBaseIndex + PdoNr;
 		  ObjSubIdx = 0;
 			break;
-		case 6:
+		case PDOMapStepTType:
 			//set the trasnmission type
 			ObjValue = TxPDOSettings[PdoNr].TransmType;
 			ObjLen = 1;
 		  ObjIdx = TxPDOTransmTypeBaseIndex + PdoNr;
 		  ObjSubIdx = PDOComSettingsSubIdxTType;
 			break;
-		case 7:
+		case PDOMapStepInhTime:
 			//inhibit time - only if supported
 			ObjValue = TxPDOSettings[PdoNr].inhibitTime;
 			ObjLen = 2;
@@ -1113,7 +1607,7 @@ COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
 				  doTransmit = false;
 			
 			break;
-		case 8:
+		case PDOMapStepEvtTimer:
 			//event timer - only if supported
 			ObjValue = TxPDOSettings[PdoNr].eventTimer;
 			ObjLen = 2;
@@ -1124,7 +1618,7 @@ COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
 				  doTransmit = false;
 			
 			break;
-		case 9:
+		case PDOMapStepTxDone:
 			//we are done with this one
 			PDOConfigSingleStepAccessStep = 0;
 			returnValue = eCO_PDODone;	
@@ -1136,7 +1630,18 @@ COPDOCommStates COPDOHandler::WriteTxPDOMapping(uint8_t PdoNr)
 			Serial.println(" complete --> valid");
 		  #endif
 		
-    default:
+		default:
+			//the mapping entries
+			if((PDOConfigSingleStepAccessStep >= 1) && (PDOConfigSingleStepAccessStep <= MaxPDOMappingEntries))
+			{
+				uint8_t entry = PDOConfigSingleStepAccessStep - 1;
+				
+				//entries not used are skipped
+				doTransmit = GetMappingWord(&TxPDOMapping[PdoNr], &TxPDOPlan[PdoNr], entry, &ObjValue);
+				ObjLen = 4;
+				ObjIdx = TxPDOMappingTypeBaseIndex + PdoNr;
+				ObjSubIdx = PDOConfigSingleStepAccessStep;
+			}
 			break;
 	}
   if(doTransmit)
@@ -1235,146 +1740,144 @@ COPDOCommStates COPDOHandler::WriteObject(uint16_t Idx, uint8_t SubIdx, uint32_t
 }
 
 /*-------------------------------------------------------------------
- * bool COPDOHandler::TransmitPdo(uint8_t PdoNr);
+ * bool COPDOHandler::TransmitPdo(uint16_t PdoNr);
  *
  * transmit a single RxPDO identified by its index
  * needs to have a step sequence to have the chance to send until it's done 
+ * The payload is filled using the copy plan of the mapping or the
+ * pack of it's COPDOMap.
  *
  * 25-07-06 AW frame added 
+ * 2026-10-16 AW copy plan instead of a switch per entry
+ * 2026-10-16 AW pack of a COPDOMap
+ * 2026-10-16 AW latency probe
+ * 2026-10-16 AW asynchronous ones only, packed by PackRxPDO()
  *
  *-------------------------------------------------------------------*/
 
-bool COPDOHandler::TransmitPdo(uint8_t PdoNr)
+bool COPDOHandler::TransmitPdo(uint16_t PdoNr)
 {
 	bool returnValue = false;
+	CO_PROBE_BEGIN(eCOProbeTransmitPdo);
 	
 	//write to the TxPDO structure only when PDORxTxState == eCO_PDOIdle
 	//indicating the last SendRequest being closed
 	//otherwise simply re-trigger the last one
 	if(RequestState == eCO_PDOIdle)
+		PackRxPDO(PdoNr, &TxPDO);
+	
+	if(SendRequest(&TxPDO))
 	{
-	  uint8_t writeIdx = 0;
+	  returnValue = true;
+	}
+	
+	CO_PROBE_END(eCOProbeTransmitPdo);
+	return returnValue;
+}
+
+/*-------------------------------------------------------------------
+ * bool COPDOHandler::TransmitSyncPdo(uint16_t PdoNr)
+ *
+ * transmit a synchronous RxPDO using a frame of it's own - the one
+ * of TransmitPdo() may wait for the retry of an asynchronous one.
+ * Packed again on every attempt, never enters the retry state.
+ * It has to make the synchronous window, the COMsgHandler counts
+ * it late otherwise.
+ *
+ * 2026-10-16 AW
+ *
+ *-------------------------------------------------------------------*/
+
+bool COPDOHandler::TransmitSyncPdo(uint16_t PdoNr)
+{
+	CANMsg SyncPDO;
+	bool returnValue;
+	CO_PROBE_BEGIN(eCOProbeTransmitPdo);
+	
+	PackRxPDO(PdoNr, &SyncPDO);
+	returnValue = Handler->SendMsg(&SyncPDO, NULL, &LateRxPDOs);
+	
+	#if(DEBUG_PDO & DEBUG_PDO_BUSY)
+	if(!returnValue)
+	{
+		Serial.print("PDO: TX ");
+		Serial.print(SyncPDO.Id, HEX);
+		Serial.println(" sync TxReq busy, retry");
+	}
+	#endif
+	
+	CO_PROBE_END(eCOProbeTransmitPdo);
+	return returnValue;
+}
 
-		//add Id and service type and rtr
+/*-------------------------------------------------------------------
+ * void COPDOHandler::PackRxPDO(uint16_t PdoNr, CANMsg *Msg)
+ *
+ * fill the frame of a RxPDO: the payload using the copy plan of
+ * the mapping or the pack of it's COPDOMap, the length and the COB-Id
+ *
+ * 2026-10-16 AW extracted from TransmitPdo()
+ *
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::PackRxPDO(uint16_t PdoNr, CANMsg *Msg)
+{
+	//fill in the data	
+	if((RxPDOSettings[PdoNr].isValid) &&(RxPDOPlan[PdoNr].NrRuns > 0))
+	{
+		if(RxPDOPlan[PdoNr].Pack != NULL)
+			RxPDOPlan[PdoNr].Pack(RxPDOMapping[PdoNr].Entries, Msg->payload);
+		else
+			PackPayload(&RxPDOPlan[PdoNr], Msg->payload);
+		//add the length
+		Msg->len = RxPDOPlan[PdoNr].Length;
+		
 		#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
 		Serial.print("PDO: Tx RxPDO");
 		Serial.print(PdoNr+1);
 		Serial.print(": ");
-    #endif
-		
-		//fill in the data	
-		if((RxPDOSettings[PdoNr].isValid) &&(RxPDOMapping[PdoNr].NrEntries > 0))
+		for(uint8_t iter = 0; iter < Msg->len; iter++)
 		{
-			//check the mapping 
-			for(uint8_t iter = 0; iter < RxPDOMapping[PdoNr].NrEntries; iter++)
-			{
-				#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
-    		Serial.print(iter);
-				Serial.print(": ");
-				#endif
-				//copy data according to length into a temp buffer
-				switch((RxPDOMapping[PdoNr].Entries[iter])->len)
-				{
-					case 1:
-					{
-						uint8_t tempValue = *(((ODEntry08 *)(RxPDOMapping[PdoNr].Entries[iter]))->Value);
-
-						#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
-						Serial.print(tempValue);
-						Serial.print(" 1b | ");
-						#endif
-
-						//copy the value into the payload
-						TxPDO.payload[writeIdx++] = tempValue;
-						
-						break;
-					}
-					case 2:
-					{
-						//1st copy the value
-						uint16_t tempValue = *(((ODEntry16 *)(RxPDOMapping[PdoNr].Entries[iter]))->Value);
-
-						#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
-						Serial.print(tempValue);
-						Serial.print(" 2b | ");
-						#endif
-
-						//lsb is transferred first
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-						//msb is next
-						tempValue = tempValue >> 8;
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-
-						break;
-					}
-					case 4:
-					{
-						//1st copy the value
-						uint32_t tempValue = *(((ODEntry32 *)(RxPDOMapping[PdoNr].Entries[iter]))->Value);
-
-						#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
-						Serial.print(tempValue);
-						Serial.print(" 4b | ");
-						#endif
-
-						//lsb is transferred first
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-						tempValue = tempValue >> 8;
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-						tempValue = tempValue >> 8;
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-						//msb is last
-						tempValue = tempValue >> 8;
-						TxPDO.payload[writeIdx++] = (uint8_t)tempValue;
-
-						break;
-					}
-					default:
-						#if(DEBUG_PDO & DEBUG_PDO_ERROR)
-						Serial.print("Mapping entry # ");
-						Serial.print(iter);
-						Serial.println(" odd");
-					  #endif
-						break;
-				}
-			}
-			#if(DEBUG_PDO & DEBUG_PDO_TXMsg)
-			Serial.println(".");
-			#endif
+			Serial.print(Msg->payload[iter], HEX);
+			Serial.print(" ");
 		}
-		else
-		{
-			Serial.print("PDO: PDO is not valid");
-		}	
-		//add the length
-		TxPDO.len = writeIdx;
-		//add the COB-Id
-		TxPDO.Id = RxPDOSettings[PdoNr].COBId;
-		
+		Serial.println(".");
+		#endif
 	}
-	//send it
-	if(SendRequest(&TxPDO))
+	else
 	{
-	  returnValue = true;
-	}
-	
-	return returnValue;
+		Msg->len = 0;
+		Serial.print("PDO: PDO is not valid");
+	}	
+	//add the COB-Id
+	Msg->Id = RxPDOSettings[PdoNr].COBId;
+	Msg->isRTR = false;
+	Msg->serviceType = (COService)(Msg->Id & 0xFF80);
 }
 
 /*-------------------------------------------------------------------
  * void COPDOHandler::OnRxHandler(CANMsg *)
  * 
  * COMsgHander received a PDO - is handled here bases on the locally stored mappings
+ * The values are copied using the copy plan of the mapping or the unpack
+ * of it's COPDOMap. A frame shorter than the mapping is ignored.
  * 
  * 25-04-27 AW frame added
  * 25-07-05 AW implemented
+ * 2026-10-16 AW copy plan instead of a switch per entry
+ * 2026-10-16 AW unpack of a COPDOMap
+ * 2026-10-16 AW PDO# by the COB-Id table of the COMsgHandler
+ * 2026-10-16 AW flagged received for the timeout check
+ * 2026-10-16 AW time stamp of the frame
+ * 2026-10-16 AW latency probe
+ * 2026-10-16 AW a too short PDO traced, printed with DEBUG_PDO_RX only
  *
  *-------------------------------------------------------------------*/
 
 void COPDOHandler::OnRxHandler(CANMsg *RxMsg)
 {
 	uint16_t PdoNr;
-	uint8_t readIdx = 0;
+	CO_PROBE_BEGIN(eCOProbeRxPdo);
 	
 	#if(DEBUG_PDO & DEBUG_PDO_RX)
 	Serial.print("PDO: Rx PDO @ ");
@@ -1385,85 +1888,428 @@ void COPDOHandler::OnRxHandler(CANMsg *RxMsg)
 	#endif
 	
 	//1st: determine the PDO Idx
-	//but be safe here CoMsghandelr should only call with Ids 0x18x, 0x28x, 0x38x and 0x48x	
-	PdoNr = (RxMsg->Id>>8)-1;
+	//the COMsgHandler knows it by the COB-Id registered for it
+	PdoNr = Handler->GetRxPDONr(RxMsg->Id);
 	
-	if((TxPDOSettings[PdoNr].isValid) &&(TxPDOMapping[PdoNr].NrEntries > 0))
+	if((PdoNr < NrTxPDOs) && (TxPDOSettings[PdoNr].COBId == RxMsg->Id)
+		 && (TxPDOSettings[PdoNr].isValid) &&(TxPDOPlan[PdoNr].NrRuns > 0))
 	{
-		//check the mapping 
-		for(uint8_t iter = 0; iter < TxPDOMapping[PdoNr].NrEntries; iter++)
+		if(RxMsg->len < TxPDOPlan[PdoNr].Length)
 		{
-		  //copy data according to length into a temp buffer
-			switch((TxPDOMapping[PdoNr].Entries[iter])->len)
-			{
-				case 1:
-				{
-					//1st copy the value
-					uint8_t tempValue = RxMsg->payload[readIdx++];
-
-					#if(DEBUG_PDO & DEBUG_PDO_RX)
-					Serial.print("PDO: entry ");
-					Serial.print(iter);
-					Serial.print(" = ");
-					Serial.println(tempValue,HEX);
-					#endif
-
-				  //then write it to the object
-				  *(((ODEntry08 *)(TxPDOMapping[PdoNr].Entries[iter]))->Value) = tempValue;
-					break;
-				}
-				case 2:
-				{
-					//1st copy the value
-				  //lsb is transferred first
-					uint16_t tempValue = (uint16_t)RxMsg->payload[readIdx++];
-				  //msb is next
-				  tempValue |= (uint16_t)((RxMsg->payload[readIdx++]) * 256);
-
-					#if(DEBUG_PDO & DEBUG_PDO_RX)
-					Serial.print("PDO: entry ");
-					Serial.print(iter);
-					Serial.print(" = ");
-					Serial.println(tempValue,HEX);
-					#endif
-
-				  //then write it to the object
-				  *(((ODEntry16 *)(TxPDOMapping[PdoNr].Entries[iter]))->Value) = tempValue;
-					break;
-				}
-				case 4:
-				{
-					//1st copy the value
-				  //lsb is transferred first
-					uint32_t tempValue = (uint32_t)RxMsg->payload[readIdx++];
-				  tempValue |= (uint32_t)((RxMsg->payload[readIdx++]) * 256);
-				  tempValue |= (uint32_t)((RxMsg->payload[readIdx++]) * 256 *256);
-				  //msb is last
-				  tempValue |= (uint32_t)((RxMsg->payload[readIdx++]) * 256 * 256 * 256);
-
-					#if(DEBUG_PDO & DEBUG_PDO_RX)
-					Serial.print("PDO: entry ");
-					Serial.print(iter);
-					Serial.print(" = ");
-					Serial.println(tempValue,HEX);
-					#endif
-
-				  //then write it to the object
-				  *(((ODEntry32 *)(TxPDOMapping[PdoNr].Entries[iter]))->Value) = tempValue;
-					break;
-				}
-				default:
-					Serial.print("Mapping entry # ");
-				  Serial.print(iter);
-				  Serial.println(" odd");
-					break;
-			}
+			CO_TRACE_EVENT(eCOTraceRxPDOShort, nodeId, RxMsg->Id, RxMsg->len);
+			#if(DEBUG_PDO & DEBUG_PDO_RX)
+			Serial.print("PDO: Rx PDO too short @ ");
+			Serial.println(RxMsg->Id, HEX);
+			#endif
+		}
+		else
+		{
+			if(TxPDOPlan[PdoNr].Unpack != NULL)
+				TxPDOPlan[PdoNr].Unpack(TxPDOMapping[PdoNr].Entries, RxMsg->payload);
+			else
+				UnpackPayload(&TxPDOPlan[PdoNr], RxMsg->payload);
+			
+			TxPDOSettings[PdoNr].sentAt = RxMsg->RxAt;
+			TxPDOSettings[PdoNr].isReceived = true;
 		}
 	}
 	else
 	{
 		Serial.println("PDO: PDO is not valid");
 	}
+	
+	CO_PROBE_END(eCOProbeRxPdo);
+}
+
+/*-------------------------------------------------------------------
+ * bool CompileCopyPlan(PDOMapping *Mapping, PDOCopyPlan *Plan)
+ *
+ * compile the mapping into a copy plan: one run per object, objects
+ * following each other in memory are merged into a single run.
+ * Objects with a length other than 1, 2 or 4 bytes and those which
+ * don't fit into the 8 bytes of a frame are skipped and false is
+ * returned.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COPDOHandler::CompileCopyPlan(PDOMapping *Mapping, PDOCopyPlan *Plan)
+{
+	bool isValid = true;
+	PDOCopyRun *Run = NULL;
+	
+	Plan->NrRuns = 0;
+	Plan->Length = 0;
+	Plan->Pack = NULL;
+	Plan->Unpack = NULL;
+	Plan->MappingWords = NULL;
+	
+	for(uint8_t iter = 0; iter < Mapping->NrEntries; iter++)
+	{
+		ODEntry *Entry = Mapping->Entries[iter];
+		
+		if((Entry == NULL) || ((Entry->len != 1) && (Entry->len != 2) && (Entry->len != 4))
+			 || ((Plan->Length + Entry->len) > 8))
+		{
+			isValid = false;
+			continue;
+		}
+		
+		uint8_t *Value = (uint8_t *)(Entry->Value);
+		
+		if((Run != NULL) && ((Run->Value + Run->Width) == Value))
+			Run->Width += Entry->len;
+		else
+		{
+			Run = &(Plan->Runs[Plan->NrRuns]);
+			Plan->NrRuns++;
+			Run->Offset = Plan->Length;
+			Run->Width = Entry->len;
+			Run->Value = Value;
+		}
+		Plan->Length += Entry->len;
+	}
+	return isValid;
+}
+
+/*-------------------------------------------------------------------
+ * void PackPayload(const PDOCopyPlan *Plan, uint8_t *Payload)
+ *
+ * copy the values of the mapped objects into the payload
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::PackPayload(const PDOCopyPlan *Plan, uint8_t *Payload)
+{
+	for(uint8_t iter = 0; iter < Plan->NrRuns; iter++)
+	{
+		const PDOCopyRun *Run = &(Plan->Runs[iter]);
+		CopyRun(&Payload[Run->Offset], Run->Value, Run->Width);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void UnpackPayload(const PDOCopyPlan *Plan, const uint8_t *Payload)
+ *
+ * copy the payload into the values of the mapped objects
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::UnpackPayload(const PDOCopyPlan *Plan, const uint8_t *Payload)
+{
+	for(uint8_t iter = 0; iter < Plan->NrRuns; iter++)
+	{
+		const PDOCopyRun *Run = &(Plan->Runs[iter]);
+		CopyRun(Run->Value, &Payload[Run->Offset], Run->Width);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * bool UseMap(PDOMapping *Mapping, PDOCopyPlan *Plan, uint8_t NrEntries,
+ *             const uint32_t *MappingWords, PDOPackFunction Pack, PDOUnpackFunction Unpack)
+ *
+ * use the pack / unpack and the mapping words of a COPDOMap for a preset
+ * mapping. Only if the entries match the ones of the COPDOMap in
+ * index, sub-index and length - otherwise the plan is kept and false
+ * is returned.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COPDOHandler::UseMap(PDOMapping *Mapping, PDOCopyPlan *Plan, uint8_t NrEntries,
+                          const uint32_t *MappingWords, PDOPackFunction Pack, PDOUnpackFunction Unpack)
+{
+	if(Mapping->NrEntries != NrEntries)
+		return false;
+	
+	for(uint8_t iter = 0; iter < NrEntries; iter++)
+	{
+		ODEntry *Entry = Mapping->Entries[iter];
+		
+		if((Entry == NULL) || ((((uint32_t)Entry->Idx << 16) | ((uint32_t)Entry->SubIdx << 8) | (Entry->len * 8)) != MappingWords[iter]))
+			return false;
+	}
+	Plan->Pack = Pack;
+	Plan->Unpack = Unpack;
+	Plan->MappingWords = MappingWords;
+	
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::InitPDOs(uint16_t Nr, PDOTransmType *Settings,
+ *                             PDOMapping *Mappings, PDOCopyPlan *Plans)
+ *
+ * Nr PDOs unmapped, invalid and without a COB-Id
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::InitPDOs(uint16_t Nr, PDOTransmType *Settings, PDOMapping *Mappings, PDOCopyPlan *Plans)
+{
+	for(uint16_t iter = 0; iter < Nr; iter++)
+	{
+		Settings[iter].COBId = 0;
+		Settings[iter].isValid = false;
+		Settings[iter].pending = 0;
+		Settings[iter].sentAt = 0;
+		Settings[iter].TransmType = TPDOTTypeAsync;
+		Settings[iter].hasInhibitTime = false;
+		Settings[iter].inhibitTime = 0;
+		Settings[iter].hasEventTimer = false;
+		Settings[iter].eventTimer = 0;
+		Settings[iter].syncCount = 0;
+		Settings[iter].isChanged = false;
+		Settings[iter].isReceived = false;
+		Settings[iter].isSupervised = false;
+		Settings[iter].isTimedOut = false;
+		
+		Mappings[iter].NrEntries = 0;
+		for(uint8_t entry = 0; entry < MaxPDOMappingEntries; entry++)
+			Mappings[iter].Entries[entry] = NULL;
+		CompileCopyPlan(&Mappings[iter], &Plans[iter]);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::SetPredefCOBIds()
+ *
+ * PDO# 0..3 without a COB-Id get the one of the predefined connection
+ * set - so the PDOs not used are set invalid at the node too.
+ * Needs the node-id, so does nothing before init().
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::SetPredefCOBIds()
+{
+	if(Channel == InvalidSlot)
+		return;
+	
+	for(uint16_t iter = 0; (iter < NrPDOs) && (iter < NrRxPDOs); iter++)
+	{
+		if(RxPDOSettings[iter].COBId == 0)
+			RxPDOSettings[iter].COBId = PredefRxPDOCOBIds[iter] | nodeId;
+	}
+	for(uint16_t iter = 0; (iter < NrPDOs) && (iter < NrTxPDOs); iter++)
+	{
+		if(TxPDOSettings[iter].COBId == 0)
+			SetTxCOBId(iter, PredefTxPDOCOBIds[iter] | nodeId);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::SetPDORefs(PDODir Dir, uint16_t PdoNr, bool isMapped)
+ *
+ * the objects mapped into this PDO refer to it (isMapped) or no longer
+ * An object mapped into several PDOs refers to PDORefMulti and keeps
+ * this - the search through all mappings is slower, but still right.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW references in the reverse index of the handler
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::SetPDORefs(PDODir Dir, uint16_t PdoNr, bool isMapped)
+{
+	PDOMapping *Mapping = (Dir == eCO_PDORx) ? &RxPDOMapping[PdoNr] : &TxPDOMapping[PdoNr];
+	uint16_t ThisRef = PdoNr + 1;
+	
+	for(uint8_t iter = 0; iter < Mapping->NrEntries; iter++)
+	{
+		ODEntry *Entry = Mapping->Entries[iter];
+		
+		if(Entry == NULL)
+			continue;
+		
+		PDORef *EntryRef = FindPDORef(Entry, isMapped);
+		
+		if(EntryRef == NULL)
+			continue;
+		
+		uint16_t *Ref = (Dir == eCO_PDORx) ? &(EntryRef->RxRef) : &(EntryRef->TxRef);
+		
+		if(isMapped)
+		{
+			if(*Ref == PDORefNone)
+				*Ref = ThisRef;
+			else if(*Ref != ThisRef)
+				*Ref = PDORefMulti;
+		}
+		else if(*Ref == ThisRef)
+			*Ref = PDORefNone;
+	}
+}
+
+/*-------------------------------------------------------------------
+ * PDORef *COPDOHandler::FindPDORef(ODEntry *Entry, bool create)
+ *
+ * the slot of the entry in the reverse index, probed linearly from
+ * the hash of it's address. A new entry gets a free slot if create,
+ * slots are not freed again. NULL if not found - or if create but
+ * the index is full, then isPDORefsFull is set.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+PDORef *COPDOHandler::FindPDORef(ODEntry *Entry, bool create)
+{
+	uint8_t slot = (uint8_t)(((uintptr_t)Entry >> 2) & (NumPDORefs - 1));
+	
+	for(uint8_t iter = 0; iter < NumPDORefs; iter++)
+	{
+		if(PDORefs[slot].Entry == Entry)
+			return &PDORefs[slot];
+		if(PDORefs[slot].Entry == NULL)
+		{
+			if(!create)
+				return NULL;
+			PDORefs[slot].Entry = Entry;
+			PDORefs[slot].RxRef = PDORefNone;
+			PDORefs[slot].TxRef = PDORefNone;
+			return &PDORefs[slot];
+		}
+		slot = (slot + 1) & (NumPDORefs - 1);
+	}
+	if(create)
+		isPDORefsFull = true;
+	
+	return NULL;
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t COPDOHandler::GetPDORef(PDODir Dir, ODEntry *Entry)
+ *
+ * the reference of the entry: PDO# + 1, PDORefNone or PDORefMulti.
+ * Once the index ran full an entry not in it may be mapped anyway,
+ * PDORefMulti makes the caller search all mappings.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COPDOHandler::GetPDORef(PDODir Dir, ODEntry *Entry)
+{
+	PDORef *EntryRef = FindPDORef(Entry, false);
+	
+	if(EntryRef == NULL)
+		return isPDORefsFull ? PDORefMulti : PDORefNone;
+	
+	return (Dir == eCO_PDORx) ? EntryRef->RxRef : EntryRef->TxRef;
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::FlagRxPDO(uint16_t PdoNr)
+ *
+ * a mapped value changed: flag the RxPDO to be sent if async,
+ * with the next SYNC if acyclic sync. A node run by the scheduler
+ * is posted to send it.
+ *
+ * 2026-10-16 AW extracted from TxPDOsAsync()
+ * 2026-10-16 AW post the node
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::FlagRxPDO(uint16_t PdoNr)
+{
+	//only PDOs configured to be asyc get flagged
+	if(RxPDOSettings[PdoNr].TransmType >= TPDOTTypeAsyncMS)
+		RxPDOSettings[PdoNr].pending = 1;
+	else if(RxPDOSettings[PdoNr].TransmType == TPDOTTypeSyncAcyclic)
+		RxPDOSettings[PdoNr].isChanged = true;
+	if(Channel != InvalidSlot)
+		Handler->PostNode(Channel);
+	
+	#if (DEBUG_PDO & DEBUG_PDO_TXAsync)
+	Serial.print("PDO: will Tx RxPDO");
+	Serial.println(PdoNr+1);  
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * bool COPDOHandler::IsMapped(PDOMapping *Mapping, ODEntry *Entry)
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COPDOHandler::IsMapped(PDOMapping *Mapping, ODEntry *Entry)
+{
+	for(uint8_t iter = 0; iter < Mapping->NrEntries; iter++)
+	{
+		if(Mapping->Entries[iter] == Entry)
+			return true;
+	}
+	return false;
+}
+
+/*-------------------------------------------------------------------
+ * bool COPDOHandler::CheckPDONr(PDODir Dir, uint16_t PdoNr)
+ *
+ * false if there is no such PDO
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COPDOHandler::CheckPDONr(PDODir Dir, uint16_t PdoNr)
+{
+	if(PdoNr < ((Dir == eCO_PDORx) ? NrRxPDOs : NrTxPDOs))
+		return true;
+	
+	#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+	Serial.print((Dir == eCO_PDORx) ? "PDO: no Rx #" : "PDO: no Tx #");
+	Serial.println(PdoNr);
+	#endif
+	return false;
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::SetTxCOBId(uint16_t PdoNr, uint16_t COBId)
+ *
+ * the COB-Id of a TxPDO - registered at the COMsgHandler, which
+ * dispatches the PDOs received with it to this handler
+ * a COB-Id of 0 releases it
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::SetTxCOBId(uint16_t PdoNr, uint16_t COBId)
+{
+	uint16_t OldCOBId = TxPDOSettings[PdoNr].COBId;
+	
+	TxPDOSettings[PdoNr].COBId = COBId;
+	if(Channel == InvalidSlot)
+		return;
+	
+	if((OldCOBId != 0) && (Handler->GetRxPDONr(OldCOBId) == PdoNr))
+		Handler->UnRegisterRxPDO(OldCOBId);
+	if((COBId != 0) && !(Handler->RegisterRxPDO(Channel, COBId, PdoNr)))
+	{
+		#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+		Serial.print("PDO: Tx COB-Id ");
+		Serial.print(COBId, HEX);
+		Serial.println(" out of range or PDO table full");
+		#endif
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void COPDOHandler::MapMismatch(PDODir Dir, uint16_t PdoNr)
+ *
+ * the entries handed to a PresetRx/TxPDOMapping<Map>() don't match
+ * the Map - the mapping is used as it is
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COPDOHandler::MapMismatch(PDODir Dir, uint16_t PdoNr)
+{
+	#if (DEBUG_PDO & DEBUG_PDO_ERROR)
+	Serial.print((Dir == eCO_PDORx) ? "PDO: Rx #" : "PDO: Tx #");
+	Serial.print(PdoNr);
+	Serial.println(" entries don't match the COPDOMap");
+	#else
+	(void)Dir;
+	(void)PdoNr;
+	#endif
 }
 
 /*-------------------------------------------------------------------
@@ -1471,13 +2317,46 @@ void COPDOHandler::OnRxHandler(CANMsg *RxMsg)
  * 
  * actions when an expected response timed out
  * these can either be a SDO timed out or a sync PDO was not recieved
+ *
+ * checks one TxPDO per call: a TxPDO with an event timer is timed out
+ * when not received within 1.5 event timers. The check starts with the
+ * first one received and the flag is reset by the next one.
+ * The time received is the time stamp of the frame, the check is late
+ * by up to NrTxPDOs calls of the Update().
  * 
  * 25-04-27 AW frame added
+ * 2026-10-16 AW timeout of TxPDOs by their event timer
+ * 2026-10-16 AW time stamp of the frame
+ * 2026-10-16 AW event trace
  *
  *-------------------------------------------------------------------*/
 
 void COPDOHandler::OnTimeOut()
 {
-	;
+	PDOTransmType *Settings = &TxPDOSettings[nextSupervised];
+	
+	if(Settings->isReceived)
+	{
+		Settings->isReceived = false;
+		Settings->isSupervised = true;
+		Settings->isTimedOut = false;
+	}
+	else if(Settings->isSupervised && Settings->hasEventTimer && !Settings->isTimedOut
+	        && ((micros() - Settings->sentAt) > TxPDODeadline(Settings->eventTimer) * 1000))
+	{
+		Settings->isTimedOut = true;
+		TxPDOTimeouts++;
+		CO_TRACE_EVENT(eCOTraceTxPDOTimeout, nodeId, Settings->COBId, 0);
+		
+		#if(DEBUG_PDO & DEBUG_PDO_TIMEOUT)
+		Serial.print("PDO: TxPDO ");
+		Serial.print(Settings->COBId, HEX);
+		Serial.println(" timed out");
+		#endif
+	}
+	
+	nextSupervised++;
+	if(nextSupervised >= NrTxPDOs)
+		nextSupervised = 0;
 }
 		
@@ -25,6 +25,15 @@
  * implements the CiA 301 PDO services
  *
  * 2025-03-19 AW Frame
+ * 2026-10-16 AW mappings compiled into copy plans
+ * 2026-10-16 AW mappings defined at compile time (COPDOMap)
+ * 2026-10-16 AW number of PDOs set per node, storage by the user
+ * 2026-10-16 AW all transmission types, inhibit time, event timer, TxPDO timeout
+ * 2026-10-16 AW mapped objects refer to their PDO
+ * 2026-10-16 AW the reference kept in the handler instead of the ODEntry
+ * 2026-10-16 AW synchronous RxPDOs sent right after the SYNC, late ones counted
+ * 2026-10-16 AW TxPDOs supervised by the Rx time stamp
+ * 2026-10-16 AW due times for the scheduler
  *
  *-------------------------------------------------------------*/
  
@@ -34,6 +43,7 @@
 #include <COMsgHandler.h>
 #include <CONode.h>
 #include <COSyncHandler.h>
+#include <COPDOMap.h>
 
 #include <stdint.h>
 
@@ -41,8 +51,26 @@
 
 //define node states which should relate to the
 
+//objects of 1, 2 or 4 bytes: up to 8 fit into the payload of a PDO
 const uint8_t MaxPDOMappingEntries = 8;
+//the PDOs of a node if no storage is set - the predefined connection set
 const uint8_t NrPDOs = 4;
+//the max # of Rx- and of TxPDOs of a node in CiA 301
+const uint16_t MaxNrPDOs = 512;
+//the reverse index of a handler: the PDO each mapped object is in, hashed
+//by the address of it's ODEntry. Objects which don't fit into it any more
+//are searched in all mappings, as the ones mapped into several PDOs are.
+const uint8_t NumPDORefs = 16;
+static_assert((NumPDORefs & (NumPDORefs - 1)) == 0, "NumPDORefs must be a power of two");
+//RxRef / TxRef: PDO# + 1, or not mapped or mapped into several PDOs
+const uint16_t PDORefNone = 0;
+const uint16_t PDORefMulti = 0xFFFF;
+
+typedef struct PDORef {
+	ODEntry *Entry;
+	uint16_t RxRef;
+	uint16_t TxRef;
+} PDORef;
 
 typedef enum COPDOCommStates {
 	eCO_PDOIdle,
@@ -58,16 +86,47 @@ typedef struct PDOMapping {
 	ODEntry *Entries[MaxPDOMappingEntries];
 } PDOMapping;
 
+//a mapping compiled into a flat copy plan when it's preset:
+//each run copies Width bytes between the payload at Offset and
+//the value(s) of the mapped objects. Objects adjacent both in the
+//payload and in memory share a single run.
+//Relies on the little endian byte order of the UNO R4 (and the host)
+//being the one of CANopen.
+typedef struct PDOCopyRun {
+	uint8_t Offset;
+	uint8_t Width;
+	uint8_t *Value;
+} PDOCopyRun;
+
+//the pack / unpack of a mapping defined by a COPDOMap
+typedef void (*PDOPackFunction)(ODEntry * const *, uint8_t *);
+typedef void (*PDOUnpackFunction)(ODEntry * const *, const uint8_t *);
+
+typedef struct PDOCopyPlan {
+	uint8_t NrRuns;
+	uint8_t Length;        //length of the payload
+	PDOCopyRun Runs[MaxPDOMappingEntries];
+	//set if preset from a COPDOMap: used instead of the runs
+	PDOPackFunction Pack;
+	PDOUnpackFunction Unpack;
+	const uint32_t *MappingWords;
+} PDOCopyPlan;
+
 typedef struct PDOTransmType {
 	uint16_t COBId;        //subIdx 01
 	bool isValid;
-	uint8_t pending;       //to be incremented, if this PDO shall be sent (Rx only) // decremented if sent
-	uint32_t sentAt;
+	uint8_t pending;       //set, if this PDO shall be sent (Rx only) // reset if sent
+	uint32_t sentAt;       //RxPDO: sent at (ms), TxPDO: received at (us, the Rx time stamp)
 	uint8_t TransmType;    //subIdx 02
 	bool hasInhibitTime;
-	uint16_t inhibitTime;  //subIdx 03
+	uint16_t inhibitTime;  //subIdx 03, in 100us
 	bool hasEventTimer;
-	uint16_t eventTimer;   //subIdx 05
+	uint16_t eventTimer;   //subIdx 05, in ms
+	uint8_t syncCount;     //RxPDO: SYNCs since the last one sent
+	bool isChanged;        //RxPDO: a mapped value changed since the last SYNC
+	bool isReceived;       //TxPDO: received since the last check
+	bool isSupervised;     //TxPDO: timeout checked, starts with the first one received
+	bool isTimedOut;       //TxPDO: not received within 1.5 event timers
 } PDOTransmType;
 
 typedef enum PDODir {
@@ -75,7 +134,22 @@ typedef enum PDODir {
 	eCO_PDOTx
 } PDODir;
 
-const uint8_t TPDOTTypeAsync = 255;
+//transmission types of CiA 301
+const uint8_t TPDOTTypeSyncAcyclic = 0;    //at the SYNC after a change
+const uint8_t TPDOTTypeSyncMax = 240;      //1..240: every n-th SYNC
+const uint8_t TPDOTTypeRTRSync = 252;      //TxPDO only: sampled at SYNC, sent on RTR
+const uint8_t TPDOTTypeRTRAsync = 253;     //TxPDO only: sent on RTR
+const uint8_t TPDOTTypeAsyncMS = 254;      //event driven, manufacturer specific
+const uint8_t TPDOTTypeAsync = 255;        //event driven, device profile
+
+//storage for N Rx- or TxPDOs of a node, to be handed to
+//SetRxPDOStorage() / SetTxPDOStorage() before the PDOs are preset
+template<uint16_t N> struct COPDOStorage {
+	static_assert((N > 0) && (N <= MaxNrPDOs), "a node has 1..512 Rx- and TxPDOs");
+	PDOTransmType Settings[N];
+	PDOMapping Mappings[N];
+	PDOCopyPlan Plans[N];
+};
 
 	
 class COPDOHandler {
@@ -85,20 +159,50 @@ class COPDOHandler {
 
   	void RegisterSDOHandler(COSDOHandler *);
 
-	  void PresetRxPDOTransmission(uint8_t, uint8_t);  //paramters are the PDO# and the transmission type
-	  void PresetTxPDOTransmission(uint8_t, uint8_t, uint16_t = 0, uint16_t = 0);  //paramters are the PDO#, the transmission type, the inhibit time and the EvtTimer
+	  //more PDOs than the 4 predefined ones - the storage is the user's
+	  void SetRxPDOStorage(uint16_t, PDOTransmType *, PDOMapping *, PDOCopyPlan *);
+	  void SetTxPDOStorage(uint16_t, PDOTransmType *, PDOMapping *, PDOCopyPlan *);
+	  template<uint16_t N> void SetRxPDOStorage(COPDOStorage<N> *Storage) {
+		  SetRxPDOStorage(N, Storage->Settings, Storage->Mappings, Storage->Plans);
+	  }
+	  template<uint16_t N> void SetTxPDOStorage(COPDOStorage<N> *Storage) {
+		  SetTxPDOStorage(N, Storage->Settings, Storage->Mappings, Storage->Plans);
+	  }
+	  uint16_t GetNrRxPDOs() { return NrRxPDOs; }
+	  uint16_t GetNrTxPDOs() { return NrTxPDOs; }
+
+	  void PresetRxPDOTransmission(uint16_t, uint8_t, uint16_t = 0, uint16_t = 0);  //paramters are the PDO#, the transmission type, the inhibit time and the EvtTimer
+	  void PresetTxPDOTransmission(uint16_t, uint8_t, uint16_t = 0, uint16_t = 0);  //paramters are the PDO#, the transmission type, the inhibit time and the EvtTimer
+	  //the COB-Id of PDO# 4 and above, which have no predefined one
+	  void PresetRxPDOCOBId(uint16_t, uint16_t);
+	  void PresetTxPDOCOBId(uint16_t, uint16_t);
 	
-	  void PresetRxPDOMapping(uint8_t, uint8_t, ODEntry **);
-	  void PresetTxPDOMapping(uint8_t, uint8_t, ODEntry **);
+	  void PresetRxPDOMapping(uint16_t, uint8_t, ODEntry **);
+	  void PresetTxPDOMapping(uint16_t, uint8_t, ODEntry **);
+
+	  //preset a mapping defined by a COPDOMap, Entries in the order of the Map
+	  template<typename Map> void PresetRxPDOMapping(uint16_t PDONr, ODEntry **Entries) {
+		  PresetRxPDOMapping(PDONr, Map::NrEntries, Entries);
+		  if((PDONr < NrRxPDOs) && !UseMap(&RxPDOMapping[PDONr], &RxPDOPlan[PDONr], Map::NrEntries, Map::MappingWords, &Map::Pack, NULL))
+			  MapMismatch(eCO_PDORx, PDONr);
+	  }
+	  template<typename Map> void PresetTxPDOMapping(uint16_t PDONr, ODEntry **Entries) {
+		  PresetTxPDOMapping(PDONr, Map::NrEntries, Entries);
+		  if((PDONr < NrTxPDOs) && !UseMap(&TxPDOMapping[PDONr], &TxPDOPlan[PDONr], Map::NrEntries, Map::MappingWords, NULL, &Map::Unpack))
+			  MapMismatch(eCO_PDOTx, PDONr);
+	  }
 	
-	  void PresetRxPDOisValid(uint8_t,bool);
-	  void PresetTxPDOisValid(uint8_t,bool);
+	  void PresetRxPDOisValid(uint16_t,bool);
+	  void PresetTxPDOisValid(uint16_t,bool);
 	
 	  COPDOCommStates ConfigurePresetPDOs(uint32_t);
 	  void FlagPDOsInvalid();
     
-    COPDOCommStates ConfigureRxTxPDO(uint8_t, PDODir, uint32_t);
+    COPDOCommStates ConfigureRxTxPDO(uint16_t, PDODir, uint32_t);
     COPDOCommStates Update(uint32_t, COSyncState);
+		uint32_t GetDueInUs();        //the time until Update() has something to do
+		uint32_t GetConfigDueInUs();  //the same for ConfigurePresetPDOs()
+		bool HasSyncRxPDOs();         //Update() has to be called with each SYNC
 	
 	  //todo?
 	  COPDOCommStates ModifyRxPDOTransmission(uint8_t, uint8_t);  //paramters are the PDO# and the transmission type
@@ -110,6 +214,13 @@ class COPDOHandler {
 	
 	  bool TxPDOsAsync(ODEntry *);
 		bool RxPDOIsSync(ODEntry *);
+		
+		bool RequestTxPDO(uint16_t);  //RTR for a TxPDO
+		bool IsTxPDOTimedOut(uint16_t);
+		uint32_t GetTxPDOAgeUs(uint16_t);
+		uint32_t GetTxPDOTimeouts() { return TxPDOTimeouts; }
+		//synchronous RxPDOs not sent within the synchronous window
+		uint32_t GetLateRxPDOs() { return LateRxPDOs; }
 	
 		void ResetComState(); 
 		void ResetSDOState();
@@ -120,6 +231,11 @@ class COPDOHandler {
 		void SetTORetryMax(uint8_t);
 		void SetBusyRetryMax(uint8_t);
 
+		static bool CompileCopyPlan(PDOMapping *, PDOCopyPlan *);
+		static void PackPayload(const PDOCopyPlan *, uint8_t *);
+		static void UnpackPayload(const PDOCopyPlan *, const uint8_t *);
+		static bool UseMap(PDOMapping *, PDOCopyPlan *, uint8_t, const uint32_t *, PDOPackFunction, PDOUnpackFunction);
+
 		static void OnPdoMsgRxCb(void *op,void *p) {
 			((COPDOHandler *)op)->OnRxHandler((CANMsg *)p);
 		};
@@ -128,8 +244,20 @@ class COPDOHandler {
 		void OnRxHandler(CANMsg *);
     void OnTimeOut();
 		
-	  bool TransmitPdo(uint8_t);
-   	bool SendRequest(CANMsg *);
+	  bool TransmitPdo(uint16_t);
+	  bool TransmitSyncPdo(uint16_t);
+	  void PackRxPDO(uint16_t, CANMsg *);
+	  void MapMismatch(PDODir, uint16_t);
+	  bool CheckPDONr(PDODir, uint16_t);
+	  void SetPredefCOBIds();
+	  void SetTxCOBId(uint16_t, uint16_t);
+	  void SetPDORefs(PDODir, uint16_t, bool);
+	  PDORef *FindPDORef(ODEntry *, bool);
+	  uint16_t GetPDORef(PDODir, ODEntry *);
+	  void FlagRxPDO(uint16_t);
+	  static bool IsMapped(PDOMapping *, ODEntry *);
+	  static void InitPDOs(uint16_t, PDOTransmType *, PDOMapping *, PDOCopyPlan *);
+   	bool SendRequest(CANMsg *, volatile uint32_t *LateCount = NULL);
 	
 		uint32_t RequestSentAt;
 		uint32_t actTime;
@@ -141,35 +269,54 @@ class COPDOHandler {
 		uint8_t BusyRetryCounter = 0;
 		uint8_t BusyRetryMax = 1;
 	  uint32_t PDOConfigTimeout = 20;
-	  uint8_t nextTx = 0;
+	  uint16_t nextTx = 0;
+	  uint16_t nextSupervised = 0;
+	  uint32_t TxPDOTimeouts = 0;
+	  volatile uint32_t LateRxPDOs = 0;
+	  bool hasSyncPending = false;    //synchronous RxPDOs refused by the Tx queue
 	
 	  COPDOCommStates ConfigureRxTxPDO(uint16_t, PDOTransmType *, PDOMapping *, uint32_t);
 
-	  COPDOCommStates SetRxPDOInvalid(uint8_t);
-	  COPDOCommStates SetTxPDOInvalid(uint8_t);
+	  COPDOCommStates SetRxPDOInvalid(uint16_t);
+	  COPDOCommStates SetTxPDOInvalid(uint16_t);
 
-  	COPDOCommStates SetRxPDOValid(uint8_t);
-	  COPDOCommStates SetTxPDOValid(uint8_t);
+  	COPDOCommStates SetRxPDOValid(uint16_t);
+	  COPDOCommStates SetTxPDOValid(uint16_t);
 	
-	  COPDOCommStates WriteRxPDOMapping(uint8_t);
-	  COPDOCommStates WriteTxPDOMapping(uint8_t);
+	  COPDOCommStates WriteRxPDOMapping(uint16_t);
+	  COPDOCommStates WriteTxPDOMapping(uint16_t);
 		
 		COPDOCommStates WriteObject(uint16_t, uint8_t, uint32_t *, uint32_t);
 			
 		uint8_t PDOConfigSequenceAccessStep = 0;
 		uint8_t PDOConfigSingleStepAccessStep = 0;
-		uint8_t PDOsConfigured = 0;
+		uint16_t PDOsConfigured = 0;
 		
 		uint8_t Channel = InvalidSlot;
 		int8_t nodeId = invalidNodeId;
 	
-	  PDOTransmType RxPDOSettings[NrPDOs];
-    PDOMapping RxPDOMapping[NrPDOs];
-		uint8_t RxPDOLength[NrPDOs];
+	  //the PDOs in use - either the default ones below or the user's storage
+	  uint16_t NrRxPDOs = NrPDOs;
+	  PDOTransmType *RxPDOSettings;
+    PDOMapping *RxPDOMapping;
+		PDOCopyPlan *RxPDOPlan;
+		
+	  uint16_t NrTxPDOs = NrPDOs;
+	  PDOTransmType *TxPDOSettings;
+	  PDOMapping *TxPDOMapping;
+		PDOCopyPlan *TxPDOPlan;
+		
+	  //the reverse index of the mapped objects
+	  PDORef PDORefs[NumPDORefs];
+	  bool isPDORefsFull = false;
+	
+	  PDOTransmType DefaultRxPDOSettings[NrPDOs];
+    PDOMapping DefaultRxPDOMapping[NrPDOs];
+		PDOCopyPlan DefaultRxPDOPlan[NrPDOs];
 		
-	  PDOTransmType TxPDOSettings[NrPDOs];
-	  PDOMapping TxPDOMapping[NrPDOs];
-		uint8_t TxPDOLength[NrPDOs];
+	  PDOTransmType DefaultTxPDOSettings[NrPDOs];
+	  PDOMapping DefaultTxPDOMapping[NrPDOs];
+		PDOCopyPlan DefaultTxPDOPlan[NrPDOs];
 	
 		COMsgHandler *Handler;
 		CONode *Node;
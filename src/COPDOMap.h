@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef COPDOMap_H
+#define COPDOMap_H
+
+/*--------------------------------------------------------------
+ * COPDOObject / COPDOMap
+ * compile time description of a PDO mapping
+ *
+ * A COPDOObject is a mapped object given by it's index, sub-index
+ * and the type of it's value. A COPDOMap lists the objects of a PDO
+ * in the order of the payload and provides as constants:
+ * - the number of entries and the length of the payload
+ * - the byte offset of each entry
+ * - the mapping words written to 0x1600ff / 0x1A00ff
+ * and a pack / unpack function specialized for this very mapping,
+ * a fixed size copy per entry without a loop or a branch.
+ * The 8 byte limit of a PDO is checked by the compiler.
+ *
+ *   typedef COPDOObject<0x6041, 0x00, uint16_t> StatusWord;
+ *   typedef COPDOMap<ActualPos, StatusWord> TxPDO1Map;
+ *   PDOHandler.PresetTxPDOMapping<TxPDO1Map>(0, Entries);
+ *
+ * 2026-10-16 AW
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <COObjects.h>
+
+#include <stdint.h>
+#include <string.h>
+
+//--- a single mapped object ---
+
+template<uint16_t ThisIdx, uint8_t ThisSubIdx, typename T>
+struct COPDOObject {
+	static_assert((sizeof(T) == 1) || (sizeof(T) == 2) || (sizeof(T) == 4), "objects of 1, 2 or 4 bytes can be mapped");
+
+	typedef T Type;
+	static constexpr uint16_t Idx = ThisIdx;
+	static constexpr uint8_t SubIdx = ThisSubIdx;
+	static constexpr uint8_t Len = sizeof(T);
+	//the mapping entry: index, sub-index and length in bits
+	static constexpr uint32_t MappingWord = ((uint32_t)ThisIdx << 16) | ((uint32_t)ThisSubIdx << 8) | (sizeof(T) * 8);
+};
+
+//--- the layout of the payload, one entry after the other ---
+
+template<uint8_t Offset, uint8_t Entry, typename... Objects>
+struct COPDOMapLayout {
+	static constexpr uint8_t Length = Offset;
+
+	static constexpr uint8_t OffsetOf(uint8_t) { return Offset; }
+	static inline void Pack(ODEntry * const *, uint8_t *) {}
+	static inline void Unpack(ODEntry * const *, const uint8_t *) {}
+};
+
+template<uint8_t Offset, uint8_t Entry, typename First, typename... Rest>
+struct COPDOMapLayout<Offset, Entry, First, Rest...> {
+	typedef COPDOMapLayout<Offset + First::Len, Entry + 1, Rest...> Next;
+	static constexpr uint8_t Length = Next::Length;
+
+	static constexpr uint8_t OffsetOf(uint8_t thisEntry) {
+		return (thisEntry == Entry) ? Offset : Next::OffsetOf(thisEntry);
+	}
+
+	//the value of the entry is stored as is - the byte order of the UNO R4
+	//is the little endian one of CANopen
+	static inline void Pack(ODEntry * const *Entries, uint8_t *Payload) {
+		memcpy(&Payload[Offset], Entries[Entry]->Value, First::Len);
+		Next::Pack(Entries, Payload);
+	}
+	static inline void Unpack(ODEntry * const *Entries, const uint8_t *Payload) {
+		memcpy(Entries[Entry]->Value, &Payload[Offset], First::Len);
+		Next::Unpack(Entries, Payload);
+	}
+};
+
+//--- the mapping of a PDO ---
+
+template<typename... Objects>
+struct COPDOMap {
+	typedef COPDOMapLayout<0, 0, Objects...> Layout;
+
+	static constexpr uint8_t NrEntries = sizeof...(Objects);
+	static constexpr uint8_t Length = Layout::Length;
+	static constexpr uint32_t MappingWords[sizeof...(Objects)] = {Objects::MappingWord...};
+
+	static_assert(sizeof...(Objects) > 0, "a PDO maps at least one object");
+	static_assert(sizeof...(Objects) <= 8, "a PDO maps up to 8 objects");
+	static_assert(Layout::Length <= 8, "the mapped objects exceed the 8 bytes of a PDO");
+
+	static constexpr uint8_t Offset(uint8_t Entry) { return Layout::OffsetOf(Entry); }
+
+	//the Entries have to be the ones of the mapping, in the same order
+	static void Pack(ODEntry * const *Entries, uint8_t *Payload) {
+		Layout::Pack(Entries, Payload);
+	}
+	static void Unpack(ODEntry * const *Entries, const uint8_t *Payload) {
+		Layout::Unpack(Entries, Payload);
+	}
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COProbe.cpp
+ * the histograms of the latency probes
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COProbe.h>
+#include <string.h>
+
+//--- local definitions ---
+
+#if CO_PROBES
+static const char *ProbeNames[eCONumProbes] = {
+	"Rx interrupt",
+	"MsgHandler Update",
+	"TransmitPdo",
+	"Rx PDO",
+	"SDO round trip"
+};
+
+static COProbeHistogram Probes[eCONumProbes];
+#endif
+
+//--- implementation ---
+
+/*-------------------------------------------------------------------
+ * void COProbeInit()
+ *
+ * start the cycle counter and clear the histograms
+ * called by COMsgHandler::Open()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COProbeInit()
+{
+	#if CO_PROBES
+	#if !defined(CO_HOST_BUILD)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	#endif
+	COProbeReset();
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COProbeReset()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COProbeReset()
+{
+	#if CO_PROBES
+	noInterrupts();
+	memset(Probes, 0, sizeof(Probes));
+	interrupts();
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COProbeRecord(COProbeId Id, uint32_t ticks)
+ *
+ * sort a pass into the log2 bucket of it's ticks
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COProbeRecord(COProbeId Id, uint32_t ticks)
+{
+	#if CO_PROBES
+	COProbeHistogram *Probe = &Probes[Id];
+	uint8_t bucket = (ticks == 0) ? 0 : 32 - __builtin_clz(ticks);
+
+	Probe->Count++;
+	Probe->SumTicks += ticks;
+	if(ticks > Probe->MaxTicks)
+		Probe->MaxTicks = ticks;
+	Probe->Buckets[bucket]++;
+	#else
+	(void)Id;
+	(void)ticks;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COProbeGet(COProbeId Id, COProbeHistogram *Result)
+ *
+ * a copy of the histogram of a probe
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COProbeGet(COProbeId Id, COProbeHistogram *Result)
+{
+	#if CO_PROBES
+	noInterrupts();
+	*Result = Probes[Id];
+	interrupts();
+	#else
+	(void)Id;
+	memset(Result, 0, sizeof(COProbeHistogram));
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t COProbeTicksPerUs()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint32_t COProbeTicksPerUs()
+{
+	#if defined(CO_HOST_BUILD)
+	return 1000;
+	#else
+	return SystemCoreClock / 1000000;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COProbeDump()
+ *
+ * print count, mean and max of all probes which were passed and
+ * their buckets in us - on demand, not while timing matters.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COProbeDump()
+{
+	#if CO_PROBES
+	float usPerTick = 1.0f / COProbeTicksPerUs();
+
+	for(uint8_t iter = 0; iter < eCONumProbes; iter++)
+	{
+		COProbeHistogram Probe;
+
+		COProbeGet((COProbeId)iter, &Probe);
+		if(Probe.Count == 0)
+			continue;
+
+		Serial.print("Probe ");
+		Serial.print(ProbeNames[iter]);
+		Serial.print(": ");
+		Serial.print(Probe.Count);
+		Serial.print(" x, mean ");
+		Serial.print((float)Probe.SumTicks / Probe.Count * usPerTick, 2);
+		Serial.print(" us, max ");
+		Serial.print(Probe.MaxTicks * usPerTick, 2);
+		Serial.println(" us");
+
+		for(uint8_t bucket = 0; bucket < NumProbeBuckets; bucket++)
+		{
+			if(Probe.Buckets[bucket] == 0)
+				continue;
+
+			Serial.print("  < ");
+			Serial.print((float)((uint64_t)1 << bucket) * usPerTick, 3);
+			Serial.print(" us: ");
+			Serial.println(Probe.Buckets[bucket]);
+		}
+	}
+	#else
+	Serial.println("Probe: build with -DCO_PROBES=1");
+	#endif
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_PROBE_H
+#define CO_PROBE_H
+
+/*--------------------------------------------------------------------
+ * COProbe
+ * latency probes on the hot paths of the library: the time of each
+ * pass is sorted into a histogram of log2 buckets per probe.
+ * Time is taken from the cycle counter of the Cortex-M4 (DWT), on the
+ * host from the steady clock in ns.
+ *
+ * The probes are compiled in with -DCO_PROBES=1 only, otherwise the
+ * macros are empty statements ((void)0) and nothing is left of them.
+ * A probe is written from a single context - the Rx interrupt or the
+ * loop - so there is no lock.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW disabled probes as empty statements
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#ifndef CO_PROBES
+#define CO_PROBES 0
+#endif
+
+//--- the probes ---
+
+typedef enum COProbeId {
+	eCOProbeRxInterrupt,    //COMsgHandler::OnRxHandler(), the CAN interrupt
+	eCOProbeMsgUpdate,      //COMsgHandler::Update(), dispatch of the received frames
+	eCOProbeTransmitPdo,    //COPDOHandler::TransmitPdo(), pack and queue a RxPDO
+	eCOProbeRxPdo,          //COPDOHandler::OnRxHandler(), unpack a TxPDO
+	eCOProbeSDORoundTrip,   //COSDOHandler: request handed over to the response dispatched
+	eCONumProbes
+} COProbeId;
+
+//bucket n counts the passes of 2^(n-1) up to 2^n - 1 ticks, bucket 0 those of 0 ticks
+const uint8_t NumProbeBuckets = 33;
+
+typedef struct COProbeHistogram {
+	uint32_t Count;
+	uint32_t MaxTicks;
+	uint64_t SumTicks;
+	uint32_t Buckets[NumProbeBuckets];
+} COProbeHistogram;
+
+#if CO_PROBES
+
+#if defined(CO_HOST_BUILD)
+#define CO_PROBE_TICKS() COHostProbeTicks()
+#else
+#define CO_PROBE_TICKS() (DWT->CYCCNT)
+#endif
+
+//start and end of a probe within one block
+#define CO_PROBE_BEGIN(Id) uint32_t co_probe_##Id = CO_PROBE_TICKS()
+#define CO_PROBE_END(Id) COProbeRecord(Id, CO_PROBE_TICKS() - co_probe_##Id)
+
+#else
+
+#define CO_PROBE_TICKS() 0
+#define CO_PROBE_BEGIN(Id) ((void)0)
+#define CO_PROBE_END(Id) ((void)0)
+
+#endif
+
+//--- the functions, to be called only if CO_PROBES is set ---
+
+void COProbeInit();
+void COProbeReset();
+void COProbeRecord(COProbeId, uint32_t);
+void COProbeGet(COProbeId, COProbeHistogram *);
+uint32_t COProbeTicksPerUs();
+void COProbeDump();
+
+#endif
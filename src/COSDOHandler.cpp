@@ -23,6 +23,11 @@
  * does itself no interpreation
  *
  * 2024-11-28 AW Frame derived from RS SDOHandler.cpp
+ * 2026-10-16 AW latency probe of the round trip
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW response time-out adapted to the round trip, backoff
+ * 2026-10-16 AW no Serial output from the Rx handler by default
+ * 2026-10-16 AW errors, retries and time-outs traced, not printed by default
  *
  *--------------------------------------------------------------*/
  
@@ -36,17 +41,16 @@
 #define DEBUG_ERROR		0x0008
 #define DEBUG_TO		  0x0010
 #define DEBUG_INIT    0x0020
+#define DEBUG_RXERROR 0x0040  //errors and retries of the Rx handler - it runs in the
+                             //CAN Rx interrupt with SetSDORxInInterrupt(), so never
+                             //on by default, the trace records them instead
 #define DEBUG_BUSY    0x8000
 
-#define DEBUG_SDO (DEBUG_INIT | DEBUG_TO | DEBUG_ERROR | DEBUG_BUSY)
+#define DEBUG_SDO (DEBUG_INIT)
 //#define DEBUG_SDO (DEBUG_TO | DEBUG_ERROR | DEBUG_BUSY)
 
 //--- implementation ---
 
-//this is an ultimate measure
-//might be delayed due to the Serial commands 
-const uint32_t SDORespTimeOut = 50;
-
 //--- public calls ---
 
 /*---------------------------------------------------
@@ -71,12 +75,14 @@ COSDOHandler::COSDOHandler()
  * SDO messages
  * 
  * 2020-11-18 AW Done
+ * 2026-10-16 AW keep the handle for the SDO client scheduler
  * ---------------------------------------------------------------*/
 
 void COSDOHandler::init(COMsgHandler *MsgHandler, int8_t ThisNode, int8_t MsgHandle)
 {
 	nodeId = ThisNode;
 	Handler = MsgHandler;
+	NodeHandle = (uint8_t)MsgHandle;
 		
 	if(MsgHandle != InvalidSlot)
 	{
@@ -127,6 +133,38 @@ COSDOCommStates COSDOHandler::GetComState()
 	return SDORxTxState;
 }
 
+/*---------------------------------------------------------------
+ * uint32_t GetDueInUs()
+ * the time until the owner has to call again: the time-out of a
+ * request waiting for it's response (at least TimeOutUs while it
+ * still waits for the bus), 0 if the request has to be
+ * sent again or the block is still sent.
+ * SchedNotDue if the handler only waits for a response or for the
+ * owner to pick up the result - the response posts the owner.
+ * 
+ * 2026-10-16 AW
+ * -------------------------------------------------------------*/
+
+uint32_t COSDOHandler::GetDueInUs()
+{
+	switch(SDORxTxState)
+	{
+		case eCO_SDOWaiting:
+			//SetActTime() times out once the time-out has passed by 1us,
+			//it starts when the request leaves the client scheduler
+			if(isTimerActive && Handler->IsSDORequestWaiting(NodeHandle))
+				return TimeOutUs;
+			if(isTimerActive)
+				return COSchedLeft(SDORequestMsg.RxAt + TimeOutUs + 1, micros());
+			return 0;
+		case eCO_SDOBusy:
+		case eCO_SDORetry:
+			return 0;
+		default:
+			return SchedNotDue;
+	}
+}
+
 /*--------------------------------------------------------------
  * void SetTORetryMax(uint8_t)
  * An attempted transfer can run into a timeout either while trying to send
@@ -157,21 +195,108 @@ void COSDOHandler::SetBusyRetryMax(uint8_t value)
 	BusyRetryMax = value;
 }
 
+/*--------------------------------------------------------------
+ * void SetRespTimeOut(uint32_t MinUs, uint32_t MaxUs)
+ * the range of the response time-out adapted to the round trip.
+ * A slow server (e.g. a gateway) needs a larger MinUs if some of it's
+ * objects take much longer than the others - MinUs = MaxUs gives a
+ * fixed time-out.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+void COSDOHandler::SetRespTimeOut(uint32_t MinUs, uint32_t MaxUs)
+{
+	if((MinUs > 0) && (MinUs <= MaxUs))
+	{
+		MinTimeOutUs = MinUs;
+		MaxTimeOutUs = MaxUs;
+	}
+}
+
+/*--------------------------------------------------------------
+ * uint32_t GetRespTimeOutUs()
+ * the time-out of the next request: the smoothed round trip plus
+ * 4 times it's mean deviation, at least a quarter of the round trip -
+ * a server answering in the same time gets a margin for the load of
+ * the bus (SDOInitRespTimeOutUs until the first round trip was
+ * measured), doubled by each time-out since the last response
+ * received in time, within MinTimeOutUs ... MaxTimeOutUs
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+uint32_t COSDOHandler::GetRespTimeOutUs()
+{
+	uint32_t value = SDOInitRespTimeOutUs;
+
+	if(SmoothedRTT8 != 0)
+		value = (SmoothedRTT8 >> 3) + ((RTTVar4 > (SmoothedRTT8 >> 5)) ? RTTVar4 : (SmoothedRTT8 >> 5));
+
+	if(value < MinTimeOutUs)
+		value = MinTimeOutUs;
+	for(uint8_t iter = 0; (iter < TimeOutBackoff) && (value < MaxTimeOutUs); iter++)
+		value <<= 1;
+	if(value > MaxTimeOutUs)
+		value = MaxTimeOutUs;
+
+	return value;
+}
+
+/*--------------------------------------------------------------
+ * void SetBlockTransfer(bool)
+ * enable the block transfer for objects of more than 3 segments.
+ * If the server rejects the first block transfer, this and all the
+ * following transfers fall back to the segmented transfer.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+void COSDOHandler::SetBlockTransfer(bool isEnabled)
+{
+	isBlockEnabled = isEnabled;
+	isBlockSupported = true;
+}
+
+/*--------------------------------------------------------------
+ * void SetBlockSize(uint8_t)
+ * number of segments of a block the server may send during an upload
+ * 1 ... 127. Without the SDO responses being handled in the Rx interrupt
+ * a block has to fit into the Rx buffers of the COMsgHandler along with
+ * any other frame received per loop.
+ * 
+ * 2026-10-16 AW
+ * --------------------------------------------------------------*/
+
+void COSDOHandler::SetBlockSize(uint8_t value)
+{
+	if((value > 0) && (value <= SDOMaxBlockSize))
+		BlockSize = value;
+}
+
 /*----------------------------------------------
  * void SDOHandler::ResetComState()
  * to be called after each interaction to 
  * move the SDORxTxState from eDone to eIdle
+ * ends a running batch as well and drops a request
+ * still waiting for the bus
  * 
  * 2020-10-16 AW inital
+ * 2026-10-16 AW end the batch
+ * 2026-10-16 AW drop the waiting request
  * ---------------------------------------------*/
 
 void COSDOHandler::ResetComState()
 {
 	SDORxTxState = eCO_SDOIdle;
 	requestedService = eSDONoRequest;
+	isBatchActive = false;
+	RWObjectsAccessStep = 0;
 
 	TORetryCounter = 0;
 	BusyRetryCounter = 0;
+	if(Handler != NULL)
+		Handler->CancelSDORequest(NodeHandle);
 	//Handler should not be reset, as it could be used by different
 	//instances of the Drive
 }
@@ -201,36 +326,20 @@ COSDOCommStates COSDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx, void *datapt
 	{
 		case eCO_SDOIdle:
 			//fill the SDO read request message
-      SDOReqData->MsgExp.Idx = Idx;
-      SDOReqData->MsgExp.SubIdx = SubIdx;
-		  SDOReqData->MsgExp.Data.u32 = 0;
-		  SDOReqData->MsgExp.control.cs = SDOInitUploadReq; //upload request
-      SDOReqData->MsgExp.control.x = 0;
-		  SDOReqData->MsgExp.control.n = 0;
-		  //with the init upload it's not yet known, whether expedited or segmented
-		  SDOReqData->MsgExp.control.e = 0;
-		  //no size given
-		  SDOReqData->MsgExp.control.s = 0;
-				  			
-		  //now store the requested object
-		  requestedIdx = Idx;
-		  requestedSub = SubIdx;
-		  MaxRxLen = *length;
-		  ActRxTxLen = 0;
-
-		  nextToggle = 0;
-		  //save the pointer to the data
-		  ClientDataPtr = (uint8_t *)dataptr;
-      requestedService = eSDOReadRequestInit;
+		  ComposeReadRequest(Idx, SubIdx, dataptr, *length);
 		  //no break here;
 		
 		case eCO_SDORetry:
 		{
+			//the response may be handled in the Rx interrupt - so wait
+			//for it before the request is sent
+			SDORxTxState = eCO_SDOWaiting;
+			//register a timeout handler
+			StartTimer();
+
 			//try to send the data
 			if(SendRequest(&SDORequestMsg))
 			{
-				SDORxTxState = eCO_SDOWaiting;
-
 				BusyRetryCounter = 0;
 				
 				#if(DEBUG_SDO & DEBUG_RREQ)
@@ -240,18 +349,16 @@ COSDOCommStates COSDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx, void *datapt
 				Serial.print(Idx, HEX);
 				Serial.println(" --> eSDOWaiting");
 				#endif
-				
-				//register a timeout handler
-				RequestSentAt = actTime;
-				isTimerActive = true;
 			}
 			else
 			{
 				//was busy
+				isTimerActive = false;
 				BusyRetryCounter++;
 				if(BusyRetryCounter > BusyRetryMax)
 				{
 					SDORxTxState = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					#if(DEBUG_SDO & DEBUG_ERROR)
 					Serial.print("SDO: N ");
 					Serial.print(nodeId, DEC);
@@ -261,6 +368,7 @@ COSDOCommStates COSDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx, void *datapt
 				else
 				{
 					SDORxTxState = eCO_SDORetry;
+					CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					#if(DEBUG_SDO & (DEBUG_RREQ | DEBUG_BUSY))
 					Serial.print("SDO: N ");
 					Serial.print(nodeId,DEC);
@@ -338,63 +446,19 @@ COSDOCommStates COSDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,void *Data,
 	switch(SDORxTxState)
 	{
 		case eCO_SDOIdle:
-			//fill the SDO read request message
-      SDOReqData->MsgExp.Idx = Idx;
-      SDOReqData->MsgExp.SubIdx = SubIdx;
-			
-		  //now register the expected lenght
-		  ExpectedRxTxLen = len;
-		  ActRxTxLen = 0;
-		
-		  //upload request
-		  //same for epedited and standard
-		  SDOReqData->MsgExp.control.cs = SDOInitDownloadReq; 
-
-		  if(len <= 4)
-			{
-		    SDOReqData->MsgExp.control.e = 1;
-		    SDOReqData->MsgExp.control.n = 4-len;
-				SDOReqData->MsgExp.control.s = 1;
-        SDOReqData->MsgExp.control.x = 0;
-				
-		    //clear the contents first	  
-        SDOReqData->MsgExp.Data.u32 = 0;
-
-				//have to copy the data into the message
-				if(len == 1)
-			    SDOReqData->MsgExp.Data.u8[0] = *((uint8_t *)Data);
-			  else if(len == 2)
-			    SDOReqData->MsgExp.Data.u16[0] = *((uint16_t *)Data);				
-			  else if(len == 4)
-          SDOReqData->MsgExp.Data.u32 = *((uint32_t *)Data);
-
-			}
-			else
-			{
-				//this is segmented, but the request has the same contents as an expedited one
-		    SDOReqData->MsgExp.control.e = 0;
-		    SDOReqData->MsgExp.control.n = 0;
-		    SDOReqData->MsgExp.control.s = 1;
-				
-				//in the expedited case it's the number of bytes to be donwloaded
-				SDOReqData->MsgExp.Data.u32 = len;
-        ClientDataPtr = (uint8_t *)Data;
-			  
-				nextToggle = 0;				
-			}
-			//the init request is the same for both
-			requestedService = eSDOWriteRequestExp;
-
-      //now store the requested object
-		  requestedIdx = Idx;
-		  requestedSub = SubIdx;
+			//fill the SDO write request message
+		  ComposeWriteRequest(Idx, SubIdx, Data, len);
 			
 		  //no break here
 		case eCO_SDORetry:			
+			//the response may be handled in the Rx interrupt - so wait
+			//for it before the request is sent
+			SDORxTxState = eCO_SDOWaiting;
+			StartTimer();
+
 			//send the data
 			if(SendRequest(&SDORequestMsg))
 			{
-				SDORxTxState = eCO_SDOWaiting;
 				BusyRetryCounter = 0;
 				
 				#if(DEBUG_SDO & DEBUG_WREQ)
@@ -403,16 +467,15 @@ COSDOCommStates COSDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,void *Data,
 				Serial.print(" TxReq ok ");
 				Serial.println(Idx, HEX);
 				#endif
-
-				RequestSentAt = actTime;
-				isTimerActive = true;
 			}
 			else
 			{
+				isTimerActive = false;
 				BusyRetryCounter++;
 				if(BusyRetryCounter > BusyRetryMax)
 				{
 					SDORxTxState = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					#if(DEBUG_SDO & DEBUG_ERROR)
 					Serial.print("SDO: N ");
 					Serial.print(nodeId ,DEC);
@@ -422,6 +485,7 @@ COSDOCommStates COSDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,void *Data,
 				else
 				{
 					SDORxTxState = eCO_SDORetry;
+					CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					#if(DEBUG_SDO & (DEBUG_WREQ | DEBUG_BUSY))
 					Serial.print("SDO: N ");
 					Serial.print(nodeId,DEC);
@@ -446,6 +510,11 @@ COSDOCommStates COSDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,void *Data,
 		
 		  break;
 
+		case eCO_SDOBusy:
+			//a block download waits for the Tx queue
+			PumpBlockSegments();
+			break;
+
 		//no need to handle eCO_SDODone here
 	} //end of switch (SDORxTxState)
 	return SDORxTxState;
@@ -476,103 +545,570 @@ return returnValue;
  *
  * read a complete set of objects given oin an vector
  * return _SDODone when all have been read
- *
+ * The len of each entry is the max length to be read and is
+ * updated to the length actually received.
  *
  * 2025-09-11 AW
+ * 2026-10-16 AW batched - see TransferObjects()
  *-------------------------------------------------------------------*/
 
 COSDOCommStates COSDOHandler::ReadObjects(ODEntry **Objects, uint8_t nrEntries)
+{
+	return TransferObjects(Objects, nrEntries, false);
+}
+
+
+/*-------------------------------------------------------------------
+ * COSDOCommStates COSDOHandler::WriteObjects(ODEntry **, uint8_t nrEntries)
+ *
+ * write a complete set of objects given oin an vector
+ * return _SDODone when all have been written
+ *
+ * 2025-09-11 AW
+ * 2026-10-16 AW batched - see TransferObjects()
+ *-------------------------------------------------------------------*/
+
+COSDOCommStates COSDOHandler::WriteObjects(ODEntry **Objects, uint8_t nrEntries)
+{
+	return TransferObjects(Objects, nrEntries, true);
+}
+
+
+//-------------------------------------------------------------------
+//--- private calls ---
+
+/*-------------------------------------------------------------------
+ * bool SendRequest(CANMsg *)
+ *
+ * send the request - the onyl direct Tx interface to the COMsghandler
+ * The request Msg is handed to the SDO client scheduler of the
+ * COMsghandler, which sends the requests of all nodes interleaved.
+ * The end of a block upload is not confirmed by the server, so the
+ * transfer is done as soon as the request is queued. As the next
+ * transfer reuses the request Msg right away, this one is copied
+ * into the Tx queue by SendMsg() - the scheduler doesn't start the
+ * next request of the node before it.
+ *
+ * 2025-01-05 AW
+ * 2026-10-16 AW end of the block upload
+ * 2026-10-16 AW via the SDO client scheduler
+ * 2026-10-16 AW start of the round trip probe
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW end of the block upload copied
+ *-------------------------------------------------------------------*/
+
+bool COSDOHandler::SendRequest(CANMsg *Msg)
+{
+  bool isSent;
+	bool isScheduled = (Msg == &SDORequestMsg) && (requestedService != eSDOBlockReadEndResp);
+
+	if(isScheduled)
+		isSent = Handler->SendSDORequest(NodeHandle, Msg);
+	else
+		isSent = Handler->SendMsg(Msg);
+
+	if(isSent && isScheduled)
+		CO_TRACE_EVENT(eCOTraceSDORequest, SDORequestMsg.Id & 0x7F, requestedIdx, requestedSub | ((uint32_t)requestedService << 8));
+
+	#if CO_PROBES
+	if(isSent && isScheduled)
+	{
+		ProbeRequestAt = CO_PROBE_TICKS();
+		isProbeRunning = true;
+	}
+	#endif
+
+	if(isSent && (requestedService == eSDOBlockReadEndResp))
+		OnTransferDone();
+
+	return isSent;
+}
+
+/*-------------------------------------------------------------------
+ * COSDOCommStates TransferObjects(ODEntry **, uint8_t nrEntries, bool isWrite)
+ *
+ * the batch engine behind ReadObjects() / WriteObjects().
+ * The first call starts the request of the first object, all the
+ * following ones are requested by OnTransferDone() right from the
+ * Rx handler when the response of the preceeding one is dispatched.
+ * So the batch runs at the pace of the bus, not the pace of the
+ * calls - those are only needed to retry a request which was blocked
+ * or timed out and to collect the result.
+ * Returns eCO_SDOBusy while running, eCO_SDODone when all objects
+ * are done and the state of the handler in case of an error or
+ * time-out. Both end the batch, the next call starts it over.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+COSDOCommStates COSDOHandler::TransferObjects(ODEntry **Objects, uint8_t nrEntries, bool isWrite)
 {
 	COSDOCommStates returnValue = eCO_SDOBusy;
-	COSDOCommStates stepResult;
-	uint32_t actLength;
-	
-	stepResult = ReadSDO(Objects[RWObjectsAccessStep]->Idx,
-		                   Objects[RWObjectsAccessStep]->SubIdx,
-	                     Objects[RWObjectsAccessStep]->Value,
-	                     &actLength);
-	
-	//we can only increment the pointr when a preceeding one is done
-	if(stepResult == eCO_SDODone)
+
+	switch(SDORxTxState)
 	{
-		Objects[RWObjectsAccessStep]->len = actLength;
+		case eCO_SDOIdle:
+			if(nrEntries == 0)
+			{
+				returnValue = eCO_SDODone;
+				break;
+			}
+			BatchObjects = Objects;
+			BatchNrEntries = nrEntries;
+			isBatchWrite = isWrite;
+			isBatchActive = true;
+			RWObjectsAccessStep = 0;
+			ComposeBatchRequest();
+			//no break here
+		case eCO_SDORetry:
+			//the request of the actual object is still in SDORequestMsg
+			//wait before sending as the response may be handled in the Rx interrupt
+			SDORxTxState = eCO_SDOWaiting;
+			StartTimer();
+			
+			if(SendRequest(&SDORequestMsg))
+				BusyRetryCounter = 0;
+			else
+			{
+				isTimerActive = false;
+				BusyRetryCounter++;
+				if(BusyRetryCounter > BusyRetryMax)
+				{
+					SDORxTxState = eCO_SDOError;
+					isBatchActive = false;
+					returnValue = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+					#if(DEBUG_SDO & DEBUG_ERROR)
+					Serial.print("SDO: N ");
+					Serial.print(nodeId ,DEC);
+					Serial.println(" batch request failed --> eError");
+					#endif
+				}
+				else
+				{
+					SDORxTxState = eCO_SDORetry;
+					CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+					#if(DEBUG_SDO & DEBUG_BUSY)
+					Serial.print("SDO: N ");
+					Serial.print(nodeId,DEC);
+					Serial.println(" batch request busy --> eRetry");
+					#endif
+				}
+			}
+			break;
+		case eCO_SDODone:
+			//all the objects are done
+			isBatchActive = false;
+			RWObjectsAccessStep = 0;
+			ResetComState();
+			returnValue = eCO_SDODone;
+			break;
+		case eCO_SDOError:
+		case eCO_SDOTimeout:
+			isBatchActive = false;
+			RWObjectsAccessStep = 0;
+			returnValue = SDORxTxState;
+			break;
+		default:
+			//waiting for the responses
+			//or a block download waits for the Tx queue
+			PumpBlockSegments();
+			break;
+	}
+	return returnValue;
+}
+
+/*-------------------------------------------------------------------
+ * void ComposeBatchRequest()
+ *
+ * fill the request for the actual object of the batch
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::ComposeBatchRequest()
+{
+	ODEntry *Object = BatchObjects[RWObjectsAccessStep];
+
+	if(isBatchWrite)
+		ComposeWriteRequest(Object->Idx, Object->SubIdx, Object->Value, Object->len);
+	else
+		ComposeReadRequest(Object->Idx, Object->SubIdx, Object->Value, Object->len);
+}
+
+/*-------------------------------------------------------------------
+ * void OnTransferDone()
+ *
+ * called by the Rx handler when the transfer of an object is complete.
+ * Without a batch running the transfer is done. Within a batch the
+ * request for the next object is sent immediately. If that is blocked
+ * the next call of ReadObjects() / WriteObjects() will retry.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW event trace
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::OnTransferDone()
+{
+	isTimerActive = false;
+	CO_TRACE_EVENT(eCOTraceSDODone, SDORequestMsg.Id & 0x7F, requestedIdx, ActRxTxLen);
+
+	if(isBatchActive)
+	{
+		if(!isBatchWrite)
+			BatchObjects[RWObjectsAccessStep]->len = ActRxTxLen;
 
 		RWObjectsAccessStep++;
-		ResetComState();
-	
-		//was this the last one?
-		if(RWObjectsAccessStep == nrEntries)
+		TORetryCounter = 0;
+	}
+
+	if((!isBatchActive) || (RWObjectsAccessStep >= BatchNrEntries))
+		SDORxTxState = eCO_SDODone;
+	else
+	{
+		//pipeline the next object
+		ComposeBatchRequest();
+
+		if(SendRequest(&SDORequestMsg))
 		{
-			returnValue = eCO_SDODone;	
-			RWObjectsAccessStep = 0;
+			SDORxTxState = eCO_SDOWaiting;
+			BusyRetryCounter = 0;
+			StartTimer();
 		}
+		else
+			SDORxTxState = eCO_SDORetry;
 	}
-	//if Read results in an error
-	if(stepResult == eCO_SDOError)
-		returnValue = eCO_SDOError;		
-	
-	return returnValue;	
 }
 
+/*-------------------------------------------------------------------
+ * void ComposeReadRequest(uint16_t Idx, uint8_t SubIdx, void *, uint32_t MaxLen)
+ *
+ * fill the init upload request and store the requested object
+ *
+ * 2026-10-16 AW extracted from ReadSDO
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::ComposeReadRequest(uint16_t Idx, uint8_t SubIdx, void *dataptr, uint32_t MaxLen)
+{
+	//now store the requested object
+	requestedIdx = Idx;
+	requestedSub = SubIdx;
+	MaxRxLen = MaxLen;
+	ActRxTxLen = 0;
+
+	nextToggle = 0;
+	//save the pointer to the data
+	ClientDataPtr = (uint8_t *)dataptr;
+
+	if(isBlockEnabled && isBlockSupported && (MaxLen >= SDOBlockMinLen))
+		ComposeBlockReadRequest();
+	else
+		ComposeUploadRequest();
+}
 
 /*-------------------------------------------------------------------
- * COSDOCommStates COSDOHandler::WriteObjects(ODEntry **, uint8_t nrEntries)
+ * void ComposeUploadRequest()
  *
- * write a complete set of objects given oin an vector
- * return _SDODone when all have been written
+ * fill the init upload request for the requested object
+ *
+ * 2026-10-16 AW extracted from ComposeReadRequest
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::ComposeUploadRequest()
+{
+  SDOReqData->MsgExp.Idx = requestedIdx;
+  SDOReqData->MsgExp.SubIdx = requestedSub;
+	SDOReqData->MsgExp.Data.u32 = 0;
+	SDOReqData->MsgExp.control.cs = SDOInitUploadReq; //upload request
+  SDOReqData->MsgExp.control.x = 0;
+	SDOReqData->MsgExp.control.n = 0;
+	//with the init upload it's not yet known, whether expedited or segmented
+	SDOReqData->MsgExp.control.e = 0;
+	//no size given
+	SDOReqData->MsgExp.control.s = 0;
+
+  requestedService = eSDOReadRequestInit;
+}
+
+/*-------------------------------------------------------------------
+ * void ComposeWriteRequest(uint16_t Idx, uint8_t SubIdx, void *, uint32_t len)
  *
+ * store the requested object and fill the init download request -
+ * expedited for up to 4 bytes, segmented or block else
  *
- * 2025-09-11 AW
+ * 2026-10-16 AW extracted from WriteSDO
  *-------------------------------------------------------------------*/
 
-COSDOCommStates COSDOHandler::WriteObjects(ODEntry **Objects, uint8_t nrEntries)
+void COSDOHandler::ComposeWriteRequest(uint16_t Idx, uint8_t SubIdx, void *Data, uint32_t len)
 {
-	COSDOCommStates returnValue = eCO_SDOBusy;
-	COSDOCommStates stepResult;
+  //now store the requested object
+	requestedIdx = Idx;
+	requestedSub = SubIdx;
+		
+	//now register the expected lenght
+	ExpectedRxTxLen = len;
+	ActRxTxLen = 0;
+  ClientDataPtr = (uint8_t *)Data;
+	nextToggle = 0;
+
+	if(isBlockEnabled && isBlockSupported && (len >= SDOBlockMinLen))
+		ComposeBlockWriteRequest();
+	else
+		ComposeDownloadRequest();
+}
 
-  //for an object to write to the len is a given	
-	stepResult = 	WriteSDO(Objects[RWObjectsAccessStep]->Idx,
-		                     Objects[RWObjectsAccessStep]->SubIdx,
-	                       Objects[RWObjectsAccessStep]->Value,
-	                       Objects[RWObjectsAccessStep]->len);
+/*-------------------------------------------------------------------
+ * void ComposeDownloadRequest()
+ *
+ * fill the init download request for the requested object -
+ * expedited for up to 4 bytes, segmented else
+ *
+ * 2026-10-16 AW extracted from ComposeWriteRequest
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::ComposeDownloadRequest()
+{
+  uint32_t len = ExpectedRxTxLen;
+
+  SDOReqData->MsgExp.Idx = requestedIdx;
+  SDOReqData->MsgExp.SubIdx = requestedSub;
 	
-	//we can only increment the pointr when a preceeding one is done
-	if(stepResult == eCO_SDODone)
+	//download request
+	//same for epedited and standard
+	SDOReqData->MsgExp.control.cs = SDOInitDownloadReq; 
+  SDOReqData->MsgExp.control.x = 0;
+
+	if(len <= 4)
 	{
-		RWObjectsAccessStep++;
-		ResetComState();
-		
-		//was this the last one?
-	  if(RWObjectsAccessStep == nrEntries)
-	  {
-	    returnValue = eCO_SDODone;	
-		  RWObjectsAccessStep = 0;
-	  }
+	  SDOReqData->MsgExp.control.e = 1;
+	  SDOReqData->MsgExp.control.n = 4-len;
+		SDOReqData->MsgExp.control.s = 1;
+			
+	  //clear the contents first	  
+    SDOReqData->MsgExp.Data.u32 = 0;
+
+		//have to copy the data into the message
+		if(len == 1)
+		  SDOReqData->MsgExp.Data.u8[0] = *((uint8_t *)ClientDataPtr);
+		else if(len == 2)
+		  SDOReqData->MsgExp.Data.u16[0] = *((uint16_t *)ClientDataPtr);				
+		else if(len == 4)
+      SDOReqData->MsgExp.Data.u32 = *((uint32_t *)ClientDataPtr);
 	}
-	
-	//if Write results in an error
-	if(stepResult == eCO_SDOError)
-		returnValue = eCO_SDOError;		
+	else
+	{
+		//this is segmented, but the request has the same contents as an expedited one
+	  SDOReqData->MsgExp.control.e = 0;
+	  SDOReqData->MsgExp.control.n = 0;
+	  SDOReqData->MsgExp.control.s = 1;
+			
+		//in the segmented case it's the number of bytes to be donwloaded
+		SDOReqData->MsgExp.Data.u32 = len;
+	}
+	//the init request is the same for both
+	requestedService = eSDOWriteRequestExp;
+}
 
-	return returnValue;	
+/*-------------------------------------------------------------------
+ * void ComposeBlockReadRequest()
+ *
+ * fill the init block upload request for the requested object.
+ * Objects of up to 3 segments may be uploaded by the server using
+ * the segmented transfer then.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::ComposeBlockReadRequest()
+{
+	SDOReqData->words[0] = 0;
+	SDOReqData->words[1] = 0;
+
+	//the client supports the CRC
+	SDOReqData->bytes[0] = (SDOBlockUploadReq << 5) | 0x04 | SDOBlockInit;
+  SDOReqData->MsgExp.Idx = requestedIdx;
+  SDOReqData->MsgExp.SubIdx = requestedSub;
+	SDOReqData->bytes[4] = BlockSize;
+	//protocol switch threshold
+	SDOReqData->bytes[5] = SDOBlockMinLen - 1;
+
+	requestedService = eSDOBlockReadInit;
 }
 
+/*-------------------------------------------------------------------
+ * void ComposeBlockWriteRequest()
+ *
+ * fill the init block download request for the requested object
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
 
-//-------------------------------------------------------------------
-//--- private calls ---
+void COSDOHandler::ComposeBlockWriteRequest()
+{
+	SDOReqData->words[0] = 0;
+
+	//the client supports the CRC, the size is given
+	SDOReqData->bytes[0] = (SDOBlockDownloadReq << 5) | 0x04 | 0x02 | SDOBlockInit;
+  SDOReqData->MsgExp.Idx = requestedIdx;
+  SDOReqData->MsgExp.SubIdx = requestedSub;
+	SDOReqData->MsgExp.Data.u32 = ExpectedRxTxLen;
+
+	requestedService = eSDOBlockWriteInit;
+}
 
 /*-------------------------------------------------------------------
- * bool SendRequest(CANMsg *)
+ * void StartBlock()
  *
- * send the request - the onyl direct Tx interface to the COMsghandler
+ * start to send the next block of a download from the data confirmed
+ * so far
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::StartBlock()
+{
+	BlockSeqNr = 0;
+	BlockTxOffset = ActRxTxLen;
+	isBlockTxPending = false;
+	isTimerActive = false;
+	SDORxTxState = eCO_SDOBusy;
+
+	PumpBlockSegments();
+}
+
+/*-------------------------------------------------------------------
+ * void PumpBlockSegments()
  *
+ * queue the next segments of the block being downloaded - up to
+ * SDOBlockTxBurst at once and only if the ones queued before have
+ * been sent. Called when the block is started and by the calls of
+ * WriteSDO() / WriteObjects() while eCO_SDOBusy.
+ * With the last segment of the block the client waits for the
+ * confirmation of the server.
  *
- * 2025-01-05 AW
+ * 2026-10-16 AW
  *-------------------------------------------------------------------*/
 
-bool COSDOHandler::SendRequest(CANMsg *Msg)
+void COSDOHandler::PumpBlockSegments()
 {
-  return Handler->SendMsg(Msg);	
+	//might be started by the Rx interrupt as well
+	CO_ENTER_CRITICAL();
+	if((SDORxTxState == eCO_SDOBusy) && ((!isBlockTxPending) || Handler->IsTxDone(BlockTxTicket)))
+	{
+		for(uint8_t iter = 0; iter < SDOBlockTxBurst; iter++)
+		{
+			uint32_t length = ExpectedRxTxLen - BlockTxOffset;
+			uint8_t seqNr = BlockSeqNr + 1;
+
+			if(length > SegDataLen)
+				length = SegDataLen;
+			else
+				seqNr |= SDOBlockLastSeg;
+
+			SDOReqData->bytes[0] = seqNr;
+			for(uint8_t byteIdx = 0; byteIdx < SegDataLen; byteIdx++)
+			{
+				if(byteIdx < length)
+					SDOReqData->bytes[byteIdx + 1] = ClientDataPtr[BlockTxOffset + byteIdx];
+				else
+					SDOReqData->bytes[byteIdx + 1] = 0;
+			}
+
+			if(!Handler->SendMsg(&SDORequestMsg, &BlockTxTicket))
+				break;
+
+			isBlockTxPending = true;
+			BlockSeqNr++;
+			BlockTxOffset += length;
+
+			if((BlockSeqNr == ActBlockSize) || (BlockTxOffset >= ExpectedRxTxLen))
+			{
+				//wait for the confirmation of the block
+				SDORxTxState = eCO_SDOWaiting;
+				StartTimer();
+				break;
+			}
+		}
+	}
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * void SendNextRequest()
+ *
+ * send the request composed by the Rx handler during a block transfer.
+ * If the Tx queue is full, the next call of ReadSDO() / WriteSDO()
+ * retries.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW errors traced, printed with DEBUG_RXERROR only
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::SendNextRequest()
+{
+	SDORxTxState = eCO_SDOWaiting;
+	StartTimer();
+
+	if(SendRequest(&SDORequestMsg))
+		BusyRetryCounter = 0;
+	else
+	{
+		isTimerActive = false;
+		SDORxTxState = eCO_SDORetry;
+
+		#if(DEBUG_SDO & DEBUG_RXERROR)
+		Serial.println("SDO: block request blocked --> retry");
+		#endif
+		CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void SendAbort(uint32_t code)
+ *
+ * abort the transfer of the requested object - best effort,
+ * there is no response to it. A request not yet sent is dropped.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COSDOHandler::SendAbort(uint32_t code)
+{
+	CANMsg AbortMsg = SDORequestMsg;
+	COSDO *Abort = (COSDO *)&(AbortMsg.payload[0]);
+
+	Abort->words[0] = 0;
+	Abort->MsgExp.control.cs = SDOErrorReqResp;
+	Abort->MsgExp.Idx = requestedIdx;
+	Abort->MsgExp.SubIdx = requestedSub;
+	Abort->MsgExp.Data.u32 = code;
+
+	Handler->CancelSDORequest(NodeHandle);
+	Handler->SendMsg(&AbortMsg);
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t CalcCRC(uint8_t *Data, uint32_t len)
+ *
+ * the CRC of a block transfer: CRC-16-CCITT, x^16 + x^12 + x^5 + 1,
+ * starting with 0. Byte-wise without a table.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COSDOHandler::CalcCRC(uint8_t *Data, uint32_t len)
+{
+	uint16_t crc = 0;
+
+	for(uint32_t iter = 0; iter < len; iter++)
+	{
+		crc = (crc >> 8) | (crc << 8);
+		crc ^= Data[iter];
+		crc ^= (crc & 0xFF) >> 4;
+		crc ^= crc << 12;
+		crc ^= (crc & 0xFF) << 5;
+	}
+	return crc;
 }
 
 /*-------------------------------------------------------------------
@@ -588,6 +1124,11 @@ bool COSDOHandler::SendRequest(CANMsg *Msg)
  * Playload should be casted to a SDO
  * 
  * 2020-11-18 AW Done
+ * 2026-10-16 AW end of the round trip probe
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW measure the round trip
+ * 2026-10-16 AW errors traced, printed with DEBUG_RXERROR only
+ * 2026-10-16 AW segmented transfers bound by the client's buffer
  * -----------------------------------------------------------------*/
 
 void COSDOHandler::OnRxHandler(CANMsg *Msg)
@@ -595,11 +1136,38 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 	//fist check payload[0] for being a correct response type and if not an error
 	//payload [1...3] for having the expected object
 	COSDO *Response = (COSDO *)(Msg->payload);
+
+	//the response to a request sent again is ambiguous - only the
+	//round trip of the first one is measured
+	if(isRTTPending)
+	{
+		isRTTPending = false;
+		if((TORetryCounter == 0) && ((int32_t)(Msg->RxAt - SDORequestMsg.RxAt) >= 0))
+			OnRoundTrip(Msg->RxAt - SDORequestMsg.RxAt);
+	}
+
+	#if CO_PROBES
+	if(isProbeRunning)
+	{
+		COProbeRecord(eCOProbeSDORoundTrip, CO_PROBE_TICKS() - ProbeRequestAt);
+		isProbeRunning = false;
+	}
+	#endif
+
+	//the segments of a block don't have a command specifier
+	if(requestedService >= eSDOBlockReadInit)
+	{
+		OnBlockRxHandler(Msg);
+		return;
+	}
 	
   if(Response->MsgExp.control.cs == SDOErrorReqResp)
   {
 	  SDORxTxState = eCO_SDOError;
+		CO_TRACE_EVENT(eCOTraceSDOAbort, SDORequestMsg.Id & 0x7F, requestedIdx, Response->MsgExp.Data.u32);
+		#if(DEBUG_SDO & DEBUG_RXERROR)
 		Serial.println("SDO: Error: Server sent cancellation");	
+		#endif
     isTimerActive = false;
   }
   else
@@ -629,16 +1197,21 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 				  Serial.println(Response->MsgExp.Data.u32, HEX);				
 				  #endif
 
-          isTimerActive = false;
-					SDORxTxState = eCO_SDODone;
+					OnTransferDone();
+				}
+				else if((Response->MsgExp.control.e == 0) && (Response->MsgExp.control.s == 1)
+				        && (Response->MsgExp.Data.u32 > MaxRxLen))
+				{
+					//the object does not fit into the client's buffer
+					SendAbort(SDOAbortLength);
+					SDORxTxState = eCO_SDOError;
+					requestedService = eSDONoRequest;
+					isTimerActive = false;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, eSDOReadRequestInit);
 				}
 				else if((Response->MsgExp.control.e == 0) && (Response->MsgExp.control.s == 1))
 				{
 					ExpectedRxTxLen = Response->MsgExp.Data.u32;
-
-					//todo
-					//check against MaxRxLen
-					
 					ActRxTxLen = 0;
 					//compose the next request
 					SDOReqData->MsgSeg.control.cs = SDOUploadSegReq;
@@ -666,30 +1239,42 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 					  #if(DEBUG_SDO  & DEBUG_RXMSG)
 						Serial.println("next segment requested");
 						#endif
-						RequestSentAt = actTime;
+						StartTimer();
 						BusyRetryCounter = 0;
 					}
 					else
 					{
 						SDORxTxState = eCO_SDORetry;
             isTimerActive = false;
-					  #if(DEBUG_SDO  & DEBUG_ERROR)
+					  #if(DEBUG_SDO & DEBUG_RXERROR)
 						Serial.println("SDO Error: Seg Upload Request blocked! --> retry");		
             #endif						
+						CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					}					
 				}	//end of case start segement
 			}  // end of handling for correct Idx/Sub in response      
 			else			
 			{
 			  SDORxTxState = eCO_SDOError;
-			  #if(DEBUG_SDO  & DEBUG_ERROR)
+			  #if(DEBUG_SDO & DEBUG_RXERROR)
 				Serial.println("SDO: Error: wrong Idx/Sub in response!");	
         #endif				
+				CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 			}					
     }  // end of handling of UploadInit response
     else if((requestedService == eSDOReadRequestSeg) && (Response->MsgSeg.control.cs == SDOUploadSegResp))	
     {
-      if(Response->MsgSeg.control.t == nextToggle)
+      if((Response->MsgSeg.control.t == nextToggle)
+			   && ((ActRxTxLen + 7 - Response->MsgSeg.control.n) > MaxRxLen))
+			{
+				//the segment does not fit into the client's buffer
+				SendAbort(SDOAbortLength);
+				SDORxTxState = eCO_SDOError;
+				requestedService = eSDONoRequest;
+				isTimerActive = false;
+				CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, eSDOReadRequestSeg);
+			}
+      else if(Response->MsgSeg.control.t == nextToggle)
 			{
 				uint8_t length = 7 - Response->MsgSeg.control.n;
 
@@ -733,29 +1318,32 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 			    if(SendRequest(&SDORequestMsg))
 			    {
 				    SDORxTxState = eCO_SDOWaiting;
-						RequestSentAt = actTime;
+						StartTimer();
 				    BusyRetryCounter = 0;
           }
           else
 				  {
 					  SDORxTxState = eCO_SDORetry;
 						isTimerActive = false;
-				    Serial.println("SDO Error: Seg Upload Request blocked!");			
+				    #if(DEBUG_SDO & DEBUG_RXERROR)
+				    Serial.println("SDO Error: Seg Upload Request blocked!");
+				    #endif
+				    CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 				  }
 				} //end of repeated segmented request
 				else
 				{
 				  // no more data to be received
-          isTimerActive = false;
-          SDORxTxState = eCO_SDODone;
+          OnTransferDone();
 				}					
 			}//and of action when correct toggle received
       else
 			{
 			  SDORxTxState = eCO_SDOError;
-				#if(DEBUG_SDO  & DEBUG_ERROR)
+				#if(DEBUG_SDO & DEBUG_RXERROR)
 				Serial.println("SDO Error: wrong toggle bit in response!");			
 				#endif
+				CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 			}
     }
     else if((requestedService == eSDOWriteRequestExp) && (Response->MsgExp.control.cs == SDOInitDownloadResp))	
@@ -764,8 +1352,6 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 			{
 				if(ExpectedRxTxLen <= 4)
         {
-			    SDORxTxState = eCO_SDODone;
-					isTimerActive = false;
 					ActRxTxLen = ExpectedRxTxLen;
 					
 					#if(DEBUG_SDO  & DEBUG_TXMSG)
@@ -775,6 +1361,8 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 				  Serial.println("confirmed");				
 				  #endif
 
+					OnTransferDone();
+
 				}  // end of handling a response to a expedited download
         else
 				{
@@ -823,7 +1411,7 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 			    if(SendRequest(&SDORequestMsg))
 					{
 						SDORxTxState = eCO_SDOWaiting;
-						RequestSentAt = actTime;
+						StartTimer();
 						BusyRetryCounter = 0;
 					}
 					else
@@ -831,18 +1419,20 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 						SDORxTxState = eCO_SDORetry;
 						isTimerActive = false;
 
-						#if(DEBUG_SDO  & DEBUG_ERROR)
+						#if(DEBUG_SDO & DEBUG_RXERROR)
 						Serial.println("SDO Error: Seg Download Request blocked! --> retry");			
 						#endif
+						CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 					}					
 				}	// end of handling a response to a init segmented download request
 			}  // end of handling for correct Idx/Sub in response      
 			else			
 			{
 			  SDORxTxState = eCO_SDOError;
-				#if(DEBUG_SDO  & DEBUG_ERROR)
+				#if(DEBUG_SDO & DEBUG_RXERROR)
 				Serial.println("SDO Error: wrong Idx/Sub in response!");	
         #endif				
+				CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 			}  				
     }
     else if((requestedService == eSDOWriteRequestSeg) && (Response->MsgSeg.control.cs == SDODownloadSegResp))	
@@ -873,7 +1463,7 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 				
 				//clear the contens
 				for(uint8_t iter = 0; iter < SegDataLen; iter++)
-					SDOReqData->MsgSeg.Data[iter] = ClientDataPtr[ActRxTxLen + iter];
+					SDOReqData->MsgSeg.Data[iter] = 0;
 
 				//copy the data into the vector
 				for(uint8_t iter = 0; iter < length; iter++)
@@ -887,26 +1477,272 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
 			  if(SendRequest(&SDORequestMsg))
 				{
 					SDORxTxState = eCO_SDOWaiting;
-					RequestSentAt = actTime;
+					StartTimer();
 					BusyRetryCounter = 0;
 				}
 				else
 				{
 					SDORxTxState = eCO_SDORetry;
 					isTimerActive = false;
-					Serial.println("SDO Error: Seg Request blocked!");			
+					#if(DEBUG_SDO & DEBUG_RXERROR)
+					Serial.println("SDO Error: Seg Request blocked!");
+					#endif
+					CO_TRACE_EVENT(eCOTraceSDORetry, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
 				}
 			}
 			else //no more data left
 			{
-			  SDORxTxState = eCO_SDODone;
-				isTimerActive = false;
-
+			  OnTransferDone();
 			}	//end of case start segement
     }
 	}
 }
 
+/*-------------------------------------------------------------------
+ * void OnBlockRxHandler(CANMsg *Msg)
+ * the part of the Rx handler for the block transfers.
+ * An abort of the init request falls back to the segmented transfer.
+ * If the server doesn't know the block transfer at all, this is
+ * kept for all the following transfers.
+ * All frames are ignored unless a response is expected.
+ *
+ * 2026-10-16 AW
+ * 2026-10-16 AW errors traced, printed with DEBUG_RXERROR only
+ * -----------------------------------------------------------------*/
+
+void COSDOHandler::OnBlockRxHandler(CANMsg *Msg)
+{
+	COSDO *Response = (COSDO *)(Msg->payload);
+	uint8_t control = Response->bytes[0];
+	uint8_t cs = control >> 5;
+
+	if((SDORxTxState != eCO_SDOWaiting) && (SDORxTxState != eCO_SDOBusy))
+		return;
+
+	//an abort - there is no segment 0
+	if(control == (SDOErrorReqResp << 5))
+	{
+		if((requestedService == eSDOBlockReadInit) || (requestedService == eSDOBlockWriteInit))
+		{
+			if(Response->MsgExp.Data.u32 == SDOAbortCommand)
+				isBlockSupported = false;
+
+			#if(DEBUG_SDO & DEBUG_RXERROR)
+			Serial.print("SDO: N ");
+			Serial.print(nodeId, DEC);
+			Serial.println(" block transfer rejected --> segmented");
+			#endif
+
+			if(requestedService == eSDOBlockReadInit)
+				ComposeUploadRequest();
+			else
+				ComposeDownloadRequest();
+			SendNextRequest();
+		}
+		else
+		{
+			SDORxTxState = eCO_SDOError;
+			CO_TRACE_EVENT(eCOTraceSDOAbort, SDORequestMsg.Id & 0x7F, requestedIdx, Response->MsgExp.Data.u32);
+			requestedService = eSDONoRequest;
+			isTimerActive = false;
+			#if(DEBUG_SDO & DEBUG_RXERROR)
+			Serial.println("SDO: Error: Server sent cancellation");	
+			#endif
+		}
+		return;
+	}
+
+	switch(requestedService)
+	{
+		case eSDOBlockReadInit:
+			if(cs == SDOInitUploadResponse)
+			{
+				//the server switched to the segmented transfer
+				requestedService = eSDOReadRequestInit;
+				OnRxHandler(Msg);
+			}
+			else if((cs == SDOBlockUploadResp) && ((control & 0x01) == SDOBlockInit))
+			{
+				if((Response->MsgExp.Idx != requestedIdx) || (Response->MsgExp.SubIdx != requestedSub))
+				{
+					SDORxTxState = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+					requestedService = eSDONoRequest;
+					isTimerActive = false;
+					#if(DEBUG_SDO & DEBUG_RXERROR)
+					Serial.println("SDO: Error: wrong Idx/Sub in response!");	
+					#endif
+					break;
+				}
+
+				isBlockCRC = (control & 0x04);
+				ExpectedRxTxLen = 0;
+				if(control & 0x02)
+					ExpectedRxTxLen = Response->MsgExp.Data.u32;
+
+				if(ExpectedRxTxLen > MaxRxLen)
+				{
+					SendAbort(SDOAbortLength);
+					SDORxTxState = eCO_SDOError;
+					requestedService = eSDONoRequest;
+					isTimerActive = false;
+					break;
+				}
+
+				//start the upload
+				SDOReqData->words[0] = 0;
+				SDOReqData->words[1] = 0;
+				SDOReqData->bytes[0] = (SDOBlockUploadReq << 5) | SDOBlockStart;
+
+				ActRxTxLen = 0;
+				BlockSeqNr = 0;
+				isBlockLastSeg = false;
+				requestedService = eSDOBlockReadSeg;
+				SendNextRequest();
+			}
+			break;
+
+		case eSDOBlockReadSeg:
+		{
+			uint8_t seqNr = control & ~SDOBlockLastSeg;
+
+			//a segment missed - all the following ones are ignored
+			//until the end of the block and sent again by the server
+			if(seqNr == (BlockSeqNr + 1))
+			{
+				//copy what fits, the length is checked at the end
+				for(uint8_t iter = 0; iter < SegDataLen; iter++)
+				{
+					if((ActRxTxLen + iter) < MaxRxLen)
+						ClientDataPtr[ActRxTxLen + iter] = Response->bytes[iter + 1];
+				}
+				ActRxTxLen += SegDataLen;
+				BlockSeqNr = seqNr;
+				isBlockLastSeg = (control & SDOBlockLastSeg);
+			}
+			//still receiving
+			StartTimer(false);
+
+			if((seqNr == BlockSize) || (control & SDOBlockLastSeg))
+			{
+				//confirm what was received in sequence
+				SDOReqData->bytes[0] = (SDOBlockUploadReq << 5) | SDOBlockAck;
+				SDOReqData->bytes[1] = BlockSeqNr;
+				SDOReqData->bytes[2] = BlockSize;
+
+				if(isBlockLastSeg)
+					requestedService = eSDOBlockReadEnd;
+				BlockSeqNr = 0;
+				SendNextRequest();
+			}
+			break;
+		}
+
+		case eSDOBlockReadEnd:
+			if((cs == SDOBlockUploadResp) && ((control & 0x01) == SDOBlockEnd))
+			{
+				//bytes of the last segment not holding any data
+				uint8_t unused = (control >> 2) & 0x07;
+				uint16_t crc = Response->bytes[1] | (Response->bytes[2] << 8);
+				uint32_t code = 0;
+
+				ActRxTxLen -= unused;
+
+				if((ActRxTxLen > MaxRxLen) || ((ExpectedRxTxLen > 0) && (ActRxTxLen != ExpectedRxTxLen)))
+					code = SDOAbortLength;
+				else if(isBlockCRC && (CalcCRC(ClientDataPtr, ActRxTxLen) != crc))
+					code = SDOAbortCRC;
+
+				if(code != 0)
+				{
+					SendAbort(code);
+					SDORxTxState = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+					requestedService = eSDONoRequest;
+					isTimerActive = false;
+					#if(DEBUG_SDO & DEBUG_RXERROR)
+					Serial.print("SDO: Error: block upload aborted ");
+					Serial.println(code, HEX);
+					#endif
+					break;
+				}
+
+				//confirm the end - the transfer is done when this is sent
+				SDOReqData->words[0] = 0;
+				SDOReqData->bytes[0] = (SDOBlockUploadReq << 5) | SDOBlockEnd;
+				SDOReqData->bytes[1] = 0;
+				SDOReqData->bytes[2] = 0;
+				requestedService = eSDOBlockReadEndResp;
+				SendNextRequest();
+			}
+			break;
+
+		case eSDOBlockWriteInit:
+			if((cs == SDOBlockDownloadResp) && ((control & 0x03) == SDOBlockInit))
+			{
+				if((Response->MsgExp.Idx != requestedIdx) || (Response->MsgExp.SubIdx != requestedSub) || 
+				   (Response->bytes[4] == 0) || (Response->bytes[4] > SDOMaxBlockSize))
+				{
+					SDORxTxState = eCO_SDOError;
+					CO_TRACE_EVENT(eCOTraceSDOError, SDORequestMsg.Id & 0x7F, requestedIdx, requestedService);
+					requestedService = eSDONoRequest;
+					isTimerActive = false;
+					#if(DEBUG_SDO & DEBUG_RXERROR)
+					Serial.println("SDO: Error: wrong block download response!");	
+					#endif
+					break;
+				}
+
+				isBlockCRC = (control & 0x04);
+				ActBlockSize = Response->bytes[4];
+				ActRxTxLen = 0;
+				requestedService = eSDOBlockWriteSeg;
+				StartBlock();
+			}
+			break;
+
+		case eSDOBlockWriteSeg:
+			if((cs == SDOBlockDownloadResp) && ((control & 0x03) == SDOBlockAck))
+			{
+				//the server confirms the segments received in sequence
+				ActRxTxLen += Response->bytes[1] * SegDataLen;
+				if(ActRxTxLen > ExpectedRxTxLen)
+					ActRxTxLen = ExpectedRxTxLen;
+				if((Response->bytes[2] > 0) && (Response->bytes[2] <= SDOMaxBlockSize))
+					ActBlockSize = Response->bytes[2];
+
+				if(ActRxTxLen < ExpectedRxTxLen)
+					StartBlock();
+				else
+				{
+					//all data confirmed - end it
+					uint8_t unused = (SegDataLen - (ExpectedRxTxLen % SegDataLen)) % SegDataLen;
+					uint16_t crc = 0;
+
+					if(isBlockCRC)
+						crc = CalcCRC(ClientDataPtr, ExpectedRxTxLen);
+
+					SDOReqData->words[0] = 0;
+					SDOReqData->words[1] = 0;
+					SDOReqData->bytes[0] = (SDOBlockDownloadReq << 5) | (unused << 2) | SDOBlockEnd;
+					SDOReqData->bytes[1] = (uint8_t)crc;
+					SDOReqData->bytes[2] = (uint8_t)(crc >> 8);
+					requestedService = eSDOBlockWriteEnd;
+					SendNextRequest();
+				}
+			}
+			break;
+
+		case eSDOBlockWriteEnd:
+			if((cs == SDOBlockDownloadResp) && ((control & 0x03) == SDOBlockEnd))
+				OnTransferDone();
+			break;
+
+		default:
+			break;
+	}
+}
+
 /*----------------------------------------------------
  * void SetActTime(uint32_t time)
  * Soft-Update of the internal time in case of no HW timer being used.
@@ -914,16 +1750,19 @@ void COSDOHandler::OnRxHandler(CANMsg *Msg)
  * is timed out and call the OnTimeOut() if so.
  * 
  * 2020-11-18 AW Done
+ * 2026-10-16 AW time-out in micros(), safe when the timer wraps,
+ *               from the request handed to the CAN controller
  * -----------------------------------------------------------*/
 
 void COSDOHandler::SetActTime(uint32_t time)
 {	
 	actTime = time;
 	
-	if((isTimerActive) && ((RequestSentAt + SDORespTimeOut) < actTime))	
+	if((isTimerActive) && (!Handler->IsSDORequestWaiting(NodeHandle)) &&
+	   ((int32_t)(micros() - SDORequestMsg.RxAt) > (int32_t)TimeOutUs))	
 	{	
-		OnTimeOut();
 		isTimerActive = false;
+		OnTimeOut();
 	}
 
 }
@@ -933,34 +1772,127 @@ void COSDOHandler::SetActTime(uint32_t time)
  * In case of a time-out either detected by the HW-tiemr or by the 
  * soft-timer swtich the communication either to a retry and increment
  * the retry counter or switch to final state eTimeout.
+ * Only a request still waiting for it's response can time out.
+ * 
+ * A timed out block transfer can't be continued - it's aborted and
+ * the retry starts it over.
  * 
  * 2020-11-18 AW Done
+ * 2026-10-16 AW responses may be handled in the Rx interrupt
+ * 2026-10-16 AW block transfers
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW back off the time-out
  * -------------------------------------------------------------*/
 
 void COSDOHandler::OnTimeOut()
 {
-	#if(DEBUG_SDO & DEBUG_TO)
-	Serial.print("SDO: Timeout ");
-	#endif
+	bool isTimedOut = false;
 	
-	if(TORetryCounter < TORetryMax)
+	//the response might have been handled by the Rx interrupt meanwhile
+	CO_ENTER_CRITICAL();
+	if(SDORxTxState == eCO_SDOWaiting)
 	{
-		SDORxTxState = eCO_SDORetry;
-		TORetryCounter++;
+		isTimedOut = true;
+		
+		if(TORetryCounter < TORetryMax)
+		{
+			SDORxTxState = eCO_SDORetry;
+			TORetryCounter++;
+		}
+		else
+		{	
+			SDORxTxState = eCO_SDOTimeout;
+			TORetryCounter = 0;
+		}
+	}
+	CO_EXIT_CRITICAL();
 
-		#if(DEBUG_SDO & DEBUG_TO)
-		Serial.println("retry");
-		#endif
+	if(isTimedOut)
+	{
+		//a late response must not be taken for the one of the next request
+		isRTTPending = false;
+		if(TimeOutBackoff < SDOMaxTimeOutBackoff)
+			TimeOutBackoff++;
+	}
+
+	if(isTimedOut)
+		CO_TRACE_EVENT(eCOTraceSDOTimeout, SDORequestMsg.Id & 0x7F, requestedIdx, SDORxTxState == eCO_SDOTimeout);
+
+	if(isTimedOut && (requestedService > eSDOBlockReadInit) && (requestedService != eSDOBlockWriteInit))
+	{
+		SendAbort(SDOAbortTimeOut);
+
+		if(SDORxTxState == eCO_SDORetry)
+		{
+			ActRxTxLen = 0;
+			if(requestedService < eSDOBlockWriteInit)
+				ComposeBlockReadRequest();
+			else
+				ComposeBlockWriteRequest();
+		}
+	}
+
+	#if(DEBUG_SDO & DEBUG_TO)
+	if(isTimedOut)
+	{
+		Serial.print("SDO: Timeout ");
+		if(SDORxTxState == eCO_SDORetry)
+			Serial.println("retry");
+		else
+			Serial.println("final");
+	}
+	#endif
+}
+
+/*----------------------------------------------------------
+ * void StartTimer(bool isRequest)
+ * start the time-out of the response - of a request sent
+ * (isRequest) the round trip is measured as well.
+ * The RxAt of the request is the start: the client scheduler of
+ * the COMsgHandler sets it again when the request is handed to
+ * the CAN controller, the time waiting for the bus doesn't count.
+ * May be called from the Rx interrupt.
+ * 
+ * 2026-10-16 AW
+ * -------------------------------------------------------------*/
+
+void COSDOHandler::StartTimer(bool isRequest)
+{
+	SDORequestMsg.RxAt = micros();
+	TimeOutUs = GetRespTimeOutUs();
+	isRTTPending = isRequest;
+	isTimerActive = true;
+}
+
+/*----------------------------------------------------------
+ * void OnRoundTrip(uint32_t RoundTripUs)
+ * update the smoothed round trip and it's mean deviation with a
+ * response received in time (Jacobson/Karels as of RFC 6298,
+ * gains 1/8 and 1/4) - the backoff ends.
+ * 
+ * 2026-10-16 AW
+ * -------------------------------------------------------------*/
+
+void COSDOHandler::OnRoundTrip(uint32_t RoundTripUs)
+{
+	if(RoundTripUs == 0)
+		RoundTripUs = 1;
+
+	if(SmoothedRTT8 == 0)
+	{
+		SmoothedRTT8 = RoundTripUs << 3;
+		RTTVar4 = RoundTripUs << 1;
 	}
 	else
-	{	
-		SDORxTxState = eCO_SDOTimeout;
-		TORetryCounter = 0;
+	{
+		int32_t delta = (int32_t)RoundTripUs - (int32_t)(SmoothedRTT8 >> 3);
 
-		#if(DEBUG_SDO & DEBUG_TO)
-		Serial.println("final");
-		#endif
+		SmoothedRTT8 += delta;
+		if(delta < 0)
+			delta = -delta;
+		RTTVar4 += delta - (int32_t)(RTTVar4 >> 2);
 	}
+	TimeOutBackoff = 0;
 }
 
 
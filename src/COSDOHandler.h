@@ -24,8 +24,20 @@
  * class CO_SDOHandler
  * handles R/W of parameters via SDO
  * uses an already existing instance of the MsgHandler
+ * ReadObjects() / WriteObjects() transfer a list of objects,
+ * the next request is sent as soon as a response was received
+ * objects of more than 3 segments can be transferred using the
+ * block transfer if enabled - falls back to segmented if the
+ * server doesn't support it
  *
  * 2024-11-28 AW derived from RS Msghandler
+ * 2026-10-16 AW batched ReadObjects() / WriteObjects()
+ * 2026-10-16 AW block up- and download
+ * 2026-10-16 AW requests via the SDO client scheduler of the COMsgHandler
+ * 2026-10-16 AW latency probe of the round trip
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW GetDueInUs() for the scheduler
+ * 2026-10-16 AW response time-out adapted to the round trip, backoff
  *
  *-------------------------------------------------------------*/
  
@@ -33,6 +45,9 @@
  
 #include <COMsgHandler.h>
 #include <COObjects.h>
+#include <COProbe.h>
+#include <COTrace.h>
+#include <COScheduler.h>
 
 #include <stdint.h>
 
@@ -50,9 +65,48 @@ const uint8_t SDODownloadSegResp = 1;
 
 const uint8_t SDOErrorReqResp = 4;
 
+//block transfer - the sub-command is in bit 0..1
+const uint8_t SDOBlockUploadReq = 5;
+const uint8_t SDOBlockUploadResp = 6;
+const uint8_t SDOBlockDownloadReq = 6;
+const uint8_t SDOBlockDownloadResp = 5;
+
+const uint8_t SDOBlockInit = 0;
+const uint8_t SDOBlockEnd = 1;
+const uint8_t SDOBlockAck = 2;
+const uint8_t SDOBlockStart = 3;
+
+//a segment of a block carries the sequence number and this flag
+const uint8_t SDOBlockLastSeg = 0x80;
+
 #define ExpDataLen 4
 #define SegDataLen 7
 
+//a block of the upload should fit into the Rx buffers of the COMsgHandler
+const uint8_t SDOMaxBlockSize = 127;
+const uint8_t SDODefaultBlockSize = NumRxBuffers / 2;
+//segments of a download queued at once - leaves room for other SDOs
+const uint8_t SDOBlockTxBurst = 4;
+//up to 3 segments the segmented transfer is as fast
+const uint32_t SDOBlockMinLen = 3 * SegDataLen + 1;
+
+//the response time-out: the smoothed round trip plus 4 times it's mean
+//deviation (at least a quarter of the round trip), within a range. The
+//initial one until the first round trip was measured. Each time-out
+//doubles it until a response is received in time.
+//The minimum covers the responses delayed by a bus under load - the round
+//trip has a long tail then, SetRespTimeOut() lowers it for a bus with a low load
+const uint32_t SDOInitRespTimeOutUs = 50000;
+const uint32_t SDOMinRespTimeOutUs = 50000;
+const uint32_t SDOMaxRespTimeOutUs = 1000000;
+const uint8_t SDOMaxTimeOutBackoff = 4;
+
+//abort codes sent by the client
+const uint32_t SDOAbortTimeOut = 0x05040000;
+const uint32_t SDOAbortCommand = 0x05040001;
+const uint32_t SDOAbortCRC = 0x05040004;
+const uint32_t SDOAbortLength = 0x06070010;
+
 //--- definitions arround the SDO messages
 
 //basic SDO request/response
@@ -117,7 +171,14 @@ typedef enum COSDORequestType {
 	eSDOReadRequestInit, //the first is allways segement, only the response will tell
 	eSDOReadRequestSeg, 
 	eSDOWriteRequestExp,
-	eSDOWriteRequestSeg  
+	eSDOWriteRequestSeg,
+	eSDOBlockReadInit,       //all the block services after this one
+	eSDOBlockReadSeg,
+	eSDOBlockReadEnd,
+	eSDOBlockReadEndResp,
+	eSDOBlockWriteInit,
+	eSDOBlockWriteSeg,
+	eSDOBlockWriteEnd
 } COSDORequestType;
 //define the class itself
 
@@ -136,9 +197,15 @@ class COSDOHandler {
 		COSDOCommStates WriteObjects(ODEntry **, uint8_t);
 
 		COSDOCommStates GetComState();
+		uint32_t GetDueInUs();
 		void ResetComState(); 
 		void SetTORetryMax(uint8_t);
 		void SetBusyRetryMax(uint8_t);
+		void SetRespTimeOut(uint32_t MinUs, uint32_t MaxUs);
+		uint32_t GetRespTimeOutUs();
+		uint32_t GetRoundTripUs() { return SmoothedRTT8 >> 3; };
+		void SetBlockTransfer(bool);
+		void SetBlockSize(uint8_t);
 		
 		//handler to be registered at the Msghandler instance
 		static void OnCOSDOMsgRxCb(void *op,void *p) {
@@ -148,7 +215,26 @@ class COSDOHandler {
 	private:
 		void OnRxHandler(CANMsg *);
     void OnTimeOut();
+		void StartTimer(bool isRequest = true);
+		void OnRoundTrip(uint32_t RoundTripUs);
 	  bool SendRequest(CANMsg *);
+		void ComposeReadRequest(uint16_t, uint8_t, void *, uint32_t);
+		void ComposeWriteRequest(uint16_t, uint8_t, void *, uint32_t);
+		void ComposeUploadRequest();
+		void ComposeDownloadRequest();
+		
+		COSDOCommStates TransferObjects(ODEntry **, uint8_t, bool);
+		void ComposeBatchRequest();
+		void OnTransferDone();
+
+		void OnBlockRxHandler(CANMsg *);
+		void ComposeBlockReadRequest();
+		void ComposeBlockWriteRequest();
+		void StartBlock();
+		void PumpBlockSegments();
+		void SendNextRequest();
+		void SendAbort(uint32_t);
+		uint16_t CalcCRC(uint8_t *, uint32_t);
     
 		int8_t nodeId = invalidNodeId;
 
@@ -159,7 +245,24 @@ class COSDOHandler {
 
 		COSDOCommStates SDORxTxState = eCO_SDOIdle;
 	
+	  //the batch of ReadObjects() / WriteObjects()
+	  ODEntry **BatchObjects = NULL;
+	  uint8_t BatchNrEntries = 0;
 	  uint8_t RWObjectsAccessStep = 0;
+	  bool isBatchWrite = false;
+	  bool isBatchActive = false;
+
+	  //block transfer
+	  bool isBlockEnabled = false;
+	  bool isBlockSupported = true;    //cleared when the server rejected it
+	  bool isBlockCRC = false;
+	  bool isBlockLastSeg = false;
+	  bool isBlockTxPending = false;
+	  uint8_t BlockSize = SDODefaultBlockSize;
+	  uint8_t ActBlockSize = 0;        //given by the server for a download
+	  uint8_t BlockSeqNr = 0;
+	  uint32_t BlockTxOffset = 0;
+	  uint32_t BlockTxTicket = 0;
 
 		uint32_t MaxRxLen = 0;
 	  uint32_t ExpectedRxTxLen = 0;
@@ -171,11 +274,27 @@ class COSDOHandler {
 		uint16_t requestedIdx;
 		uint8_t requestedSub;
 		
-		COMsgHandler *Handler;
+		COMsgHandler *Handler = NULL;
+		uint8_t NodeHandle = InvalidSlot;
 		
-		uint32_t RequestSentAt;
 		uint32_t actTime;
 	  bool isTimerActive = false;
+		uint32_t TimeOutUs = SDOInitRespTimeOutUs;
+
+		//the round trip of the requests smoothed (x8) and it's mean
+		//deviation (x4) - 0 until the first one was measured
+		uint32_t SmoothedRTT8 = 0;
+		uint32_t RTTVar4 = 0;
+		uint32_t MinTimeOutUs = SDOMinRespTimeOutUs;
+		uint32_t MaxTimeOutUs = SDOMaxRespTimeOutUs;
+		uint8_t TimeOutBackoff = 0;
+		bool isRTTPending = false;
+		
+		#if CO_PROBES
+		//the request handed over for the round trip probe
+		uint32_t ProbeRequestAt = 0;
+		bool isProbeRunning = false;
+		#endif
 				
 		uint8_t TORetryCounter = 0;
 		uint8_t TORetryMax = 1;
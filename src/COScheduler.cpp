@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COScheduler.cpp
+ * Implementation of the COScheduler Class
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COScheduler.h>
+#include <COMsgHandler.h>
+#include <string.h>
+
+//--- local definitions ---
+
+const uint16_t SchedSlotMask = CO_SCHED_SLOTS - 1;
+static_assert((CO_SCHED_SLOTS & SchedSlotMask) == 0, "CO_SCHED_SLOTS has to be a power of 2");
+static_assert(CO_SCHED_SLOTS < SchedListNone - 2, "CO_SCHED_SLOTS is too large");
+
+//--- public functions ---
+
+/*-------------------------------------------------------------------
+ * COScheduler()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+COScheduler::COScheduler()
+{
+	for(uint16_t iter = 0; iter < SchedNumLists; iter++)
+		Head[iter] = NULL;
+	memset(&Stats, 0, sizeof(Stats));
+}
+
+/*-------------------------------------------------------------------
+ * void InitItem(COSchedItem *Item, pfunction_holder *Cb)
+ *
+ * set up an item which is not armed, Cb->callback is called with
+ * Cb->op and the item when it's due
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::InitItem(COSchedItem *Item, pfunction_holder *Cb)
+{
+	Item->Next = NULL;
+	Item->Prev = NULL;
+	Item->DueAt = 0;
+	Item->RunNr = 0;
+	Item->List = SchedListNone;
+	Item->Cb.callback = (Cb != NULL) ? Cb->callback : NULL;
+	Item->Cb.op = (Cb != NULL) ? Cb->op : NULL;
+}
+
+/*-------------------------------------------------------------------
+ * void Arm(COSchedItem *Item, uint32_t DueAt)
+ *
+ * the item is due at DueAt (micros()). An item armed already keeps
+ * the earlier of both times - each deadline of a node arms the node's
+ * item and the first one wins.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Arm(COSchedItem *Item, uint32_t DueAt)
+{
+	CO_ENTER_CRITICAL();
+	if(Item->List != SchedListNone)
+	{
+		if((Item->List >= SchedListReady) || ((int32_t)(DueAt - Item->DueAt) >= 0))
+		{
+			CO_EXIT_CRITICAL();
+			return;
+		}
+		Unlink(Item);
+	}
+	Item->DueAt = DueAt;
+	Insert(Item);
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * void ArmIn(COSchedItem *Item, uint32_t DueInUs)
+ *
+ * the item is due in DueInUs from now, SchedNotDue leaves it as it is
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::ArmIn(COSchedItem *Item, uint32_t DueInUs)
+{
+	if(DueInUs != SchedNotDue)
+		Arm(Item, micros() + DueInUs);
+}
+
+/*-------------------------------------------------------------------
+ * void Post(COSchedItem *Item)
+ *
+ * the item is due right away - run by the current Run() if it
+ * wasn't run by it already, by the next one otherwise
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Post(COSchedItem *Item)
+{
+	CO_ENTER_CRITICAL();
+	if(Item->List < SchedListReady)
+		Unlink(Item);
+	if(Item->List == SchedListNone)
+		Link(SchedListReady, Item);
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * void Cancel(COSchedItem *Item)
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Cancel(COSchedItem *Item)
+{
+	CO_ENTER_CRITICAL();
+	if(Item->List != SchedListNone)
+		Unlink(Item);
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t Run(uint32_t nowUs)
+ *
+ * run all items due at nowUs (micros()), returns their number
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COScheduler::Run(uint32_t nowUs)
+{
+	Expire(nowUs);
+	while(RunNext())
+		;
+
+	return ItemsThisRun;
+}
+
+/*-------------------------------------------------------------------
+ * void Expire(uint32_t nowUs)
+ *
+ * start a Run(): move the items due at nowUs into the ready list.
+ * The slots of the ticks passed since the last call and the one of
+ * the current tick are visited - all of them once if a turn of the
+ * wheel or more passed. The items deferred by the last Run() are
+ * ready again.
+ * Split from Run() for the COMsgHandler, which checks for a SYNC
+ * sent between the items.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Expire(uint32_t nowUs)
+{
+	CO_ENTER_CRITICAL();
+	RunNr++;
+	ItemsThisRun = 0;
+	Stats.NumRuns++;
+
+	while(Head[SchedListDeferred] != NULL)
+	{
+		COSchedItem *Item = Head[SchedListDeferred];
+
+		Unlink(Item);
+		Link(SchedListReady, Item);
+	}
+
+	if(!isStarted)
+	{
+		TickStartUs = nowUs;
+		isStarted = true;
+	}
+
+	uint32_t ticks = ((int32_t)(nowUs - TickStartUs) > 0) ? (nowUs - TickStartUs) / SchedTickUs : 0;
+	uint32_t numSlots = (ticks >= CO_SCHED_SLOTS) ? CO_SCHED_SLOTS : ticks + 1;
+
+	for(uint32_t iter = 0; iter < numSlots; iter++)
+	{
+		COSchedItem *Item = Head[(NowTick + iter) & SchedSlotMask];
+
+		while(Item != NULL)
+		{
+			COSchedItem *Next = Item->Next;
+
+			if((int32_t)(Item->DueAt - nowUs) <= 0)
+			{
+				Unlink(Item);
+				Link(SchedListReady, Item);
+			}
+			Item = Next;
+		}
+	}
+	NowTick += ticks;
+	TickStartUs += ticks * SchedTickUs;
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * bool RunNext()
+ *
+ * run the next item of the ready list, false if there is none left.
+ * One run by this Run() already is deferred to the next one, so an
+ * item posting itself doesn't keep the loop here.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+bool COScheduler::RunNext()
+{
+	COSchedItem *Item;
+
+	while(true)
+	{
+		CO_ENTER_CRITICAL();
+		Item = Head[SchedListReady];
+		if(Item == NULL)
+		{
+			CO_EXIT_CRITICAL();
+			return false;
+		}
+		Unlink(Item);
+		if(Item->RunNr != RunNr)
+		{
+			Item->RunNr = RunNr;
+			CO_EXIT_CRITICAL();
+			break;
+		}
+		Link(SchedListDeferred, Item);
+		CO_EXIT_CRITICAL();
+	}
+
+	ItemsThisRun++;
+	Stats.NumItemsRun++;
+	if(ItemsThisRun > Stats.MaxItemsPerRun)
+		Stats.MaxItemsPerRun = ItemsThisRun;
+
+	if(Item->Cb.callback != NULL)
+		Item->Cb.callback(Item->Cb.op, (void *)Item);
+
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void GetStats(COSchedStats *)
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::GetStats(COSchedStats *thisStats)
+{
+	CO_ENTER_CRITICAL();
+	*thisStats = Stats;
+	CO_EXIT_CRITICAL();
+}
+
+/*-------------------------------------------------------------------
+ * void ResetStats()
+ *
+ * clear the counters, the number of items armed is kept
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::ResetStats()
+{
+	CO_ENTER_CRITICAL();
+	uint16_t numArmed = Stats.NumArmed;
+
+	memset(&Stats, 0, sizeof(Stats));
+	Stats.NumArmed = numArmed;
+	CO_EXIT_CRITICAL();
+}
+
+//--- private functions ---
+
+/*-------------------------------------------------------------------
+ * void Link(uint16_t List, COSchedItem *Item)
+ *
+ * the ready list is a FIFO, the others are pushed to the front.
+ * Must be called with interrupts disabled.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Link(uint16_t List, COSchedItem *Item)
+{
+	Item->List = List;
+
+	if(List == SchedListReady)
+	{
+		Item->Next = NULL;
+		Item->Prev = ReadyTail;
+		if(ReadyTail != NULL)
+			ReadyTail->Next = Item;
+		else
+			Head[SchedListReady] = Item;
+		ReadyTail = Item;
+	}
+	else
+	{
+		Item->Prev = NULL;
+		Item->Next = Head[List];
+		if(Head[List] != NULL)
+			Head[List]->Prev = Item;
+		Head[List] = Item;
+	}
+	Stats.NumArmed++;
+}
+
+/*-------------------------------------------------------------------
+ * void Unlink(COSchedItem *Item)
+ *
+ * Must be called with interrupts disabled.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Unlink(COSchedItem *Item)
+{
+	if(Item->Prev != NULL)
+		Item->Prev->Next = Item->Next;
+	else
+		Head[Item->List] = Item->Next;
+
+	if(Item->Next != NULL)
+		Item->Next->Prev = Item->Prev;
+	else if(Item->List == SchedListReady)
+		ReadyTail = Item->Prev;
+
+	Item->Next = NULL;
+	Item->Prev = NULL;
+	Item->List = SchedListNone;
+	Stats.NumArmed--;
+}
+
+/*-------------------------------------------------------------------
+ * void Insert(COSchedItem *Item)
+ *
+ * link an item into the slot of the tick of it's DueAt - into the
+ * ready list if that has passed already.
+ * Before the first Run() there is no time base, all items are ready.
+ * Must be called with interrupts disabled.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COScheduler::Insert(COSchedItem *Item)
+{
+	int32_t delta = (int32_t)(Item->DueAt - TickStartUs);
+
+	if(!isStarted || (delta < 0))
+		Link(SchedListReady, Item);
+	else
+		Link((NowTick + (uint32_t)delta / SchedTickUs) & SchedSlotMask, Item);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_SCHEDULER_H
+#define CO_SCHEDULER_H
+
+/*--------------------------------------------------------------------
+ * class COScheduler
+ * a deadline scheduler for the work of the nodes, run by the
+ * COMsgHandler::Update().
+ *
+ * A COSchedItem is a callback with the time it is due (micros()).
+ * Armed items are kept in a hashed timer wheel of CO_SCHED_SLOTS
+ * slots of SchedTickUs each: arming and cancelling are O(1), Run()
+ * only visits the slots of the ticks passed since the last call.
+ * Items due later than one turn of the wheel stay in their slot and
+ * are passed over until they are due. Posted items are due right away.
+ *
+ * An item is run once it's due, never before, and at most once per
+ * Run(): one armed again while it runs is due with the next Run().
+ * Arm(), Post() and Cancel() may be called from the Rx interrupt.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//the number of slots of the timer wheel, has to be a power of 2
+#ifndef CO_SCHED_SLOTS
+#define CO_SCHED_SLOTS 64
+#endif
+
+const uint32_t SchedTickUs = 1000;
+//a due time of "nothing to do" - GetDueInUs() of the node classes
+const uint32_t SchedNotDue = 0xFFFFFFFF;
+
+//the list an item is linked into
+const uint16_t SchedListNone = 0xFFFF;
+const uint16_t SchedListReady = CO_SCHED_SLOTS;
+const uint16_t SchedListDeferred = CO_SCHED_SLOTS + 1;
+const uint16_t SchedNumLists = CO_SCHED_SLOTS + 2;
+
+typedef struct COSchedItem {
+	COSchedItem *Next;
+	COSchedItem *Prev;
+	uint32_t DueAt;          //micros()
+	uint32_t RunNr;          //the Run() it was run by the last time
+	uint16_t List;
+	pfunction_holder Cb;     //called with the item as p
+} COSchedItem;
+
+typedef struct COSchedStats {
+	uint32_t NumRuns;        //calls of Run()
+	uint32_t NumItemsRun;
+	uint16_t MaxItemsPerRun;
+	uint16_t NumArmed;       //items armed or ready right now
+} COSchedStats;
+
+//the smaller one of two due times
+inline uint32_t COSchedMin(uint32_t DueInUs, uint32_t OtherUs) { return (OtherUs < DueInUs) ? OtherUs : DueInUs; }
+//the time left until DueAt, 0 if it has passed - both in the same unit
+inline uint32_t COSchedLeft(uint32_t DueAt, uint32_t now) { return ((int32_t)(DueAt - now) > 0) ? DueAt - now : 0; }
+
+class COScheduler {
+	public:
+	  COScheduler();
+
+	  void InitItem(COSchedItem *, pfunction_holder *);
+	  void Arm(COSchedItem *, uint32_t DueAt);
+	  void ArmIn(COSchedItem *, uint32_t DueInUs);
+	  void Post(COSchedItem *);
+	  void Cancel(COSchedItem *);
+	  bool IsArmed(COSchedItem *Item) { return Item->List != SchedListNone; }
+
+	  uint16_t Run(uint32_t nowUs);
+	  void Expire(uint32_t nowUs);
+	  bool RunNext();
+
+	  void GetStats(COSchedStats *);
+	  void ResetStats();
+
+	private:
+	  void Link(uint16_t, COSchedItem *);
+	  void Unlink(COSchedItem *);
+	  void Insert(COSchedItem *);
+
+	  //the heads of the wheel's slots, the ready and the deferred list
+	  COSchedItem *Head[SchedNumLists];
+	  COSchedItem *ReadyTail = NULL;
+
+	  //the current tick of the wheel and it's start in us
+	  uint32_t NowTick = 0;
+	  uint32_t TickStartUs = 0;
+	  bool isStarted = false;
+
+	  uint32_t RunNr = 0;
+	  uint16_t ItemsThisRun = 0;
+	  COSchedStats Stats;
+};
+
+#endif
@@ -22,14 +22,21 @@
  * implements the class to produce Sync and global HB
  *
  * 2025-03-09 AW Frame
+ * 2026-10-16 AW SYNC period in us, late policy, timer driven SYNC, jitter statistics
+ * 2026-10-16 AW SYNC counter and synchronous window
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW run by the scheduler of the COMsgHandler
+ * 2026-10-16 AW only the set-up printed by default
  *
  *--------------------------------------------------------------*/
  
 //--- includes ---
 
 #include <stdint.h>
+#include <math.h>
 #include <CONode.h>
 #include <COSyncHandler.h>
+#include <COTrace.h>
 
 //--- local defines ---
 
@@ -38,9 +45,10 @@
 #define DEBUG_SYNC_TXMsg	      0x0004
 #define DEBUG_SYNC_ConfigGuard	0x0008
 #define DEBUG_SYNC_Init         0x0010
+#define DEBUG_SYNC_Timer        0x0020
 #define DEBUG_SYNC_StateChange  0x0100
 
-#define DEBUG_SYNC (DEBUG_SYNC_TO | DEBUG_SYNC_ERROR | DEBUG_SYNC_ConfigGuard | DEBUG_SYNC_Init) 
+#define DEBUG_SYNC (DEBUG_SYNC_ConfigGuard | DEBUG_SYNC_Init) 
 
 //--- local definitions ---------
 
@@ -73,6 +81,8 @@ COSyncHandler::COSyncHandler(uint8_t thisId)
 	HBProducerId = thisId;
 	
 	SyncMasterState SyncState = eSyncStateOffline;
+	
+	ResetSyncStats();
 }
 
 
@@ -122,6 +132,94 @@ void COSyncHandler::init(COMsgHandler *ThisHandler)
 void COSyncHandler::SetState(SyncMasterState newState)
 {
 	SyncState = newState;
+	Wake();
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::Schedule()
+ * 
+ * run by the scheduler of the COMsgHandler instead of calling the
+ * Update() in the loop: it's called at the time of the next SYNC or
+ * HB. The nodes are told about the SYNC by the COMsgHandler.
+ * To be called after init().
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::Schedule()
+{
+	pfunction_holder Cb;
+	
+	Cb.callback = (pfunction_pointer_t)COSyncHandler::OnDueCb;
+	Cb.op = (void *)this;
+	Handler->GetScheduler()->InitItem(&SyncDue, &Cb);
+	isScheduled = true;
+	Wake();
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::Wake()
+ * 
+ * due right away when scheduled - to be called after SyncInterval
+ * or ProducerHBTime were changed
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::Wake()
+{
+	if(isScheduled)
+		Handler->GetScheduler()->Post(&SyncDue);
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t COSyncHandler::GetDueInUs()
+ * 
+ * the time in us until Update() has to send the next SYNC or HB.
+ * Right away for a SYNC not sent by the Update() or owed by the
+ * timer, SchedNotDue if there is neither.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+uint32_t COSyncHandler::GetDueInUs()
+{
+	uint32_t DueInUs = SchedNotDue;
+	
+	if((SyncState != eSyncStatePreOp) && (SyncState != eSyncStateOperational))
+		return SchedNotDue;
+	
+	if(ProducerHBTime > 0)
+		DueInUs = COSchedLeft(lastHB + ProducerHBTime, millis()) * 1000;
+	
+	if(SyncState == eSyncStateOperational)
+	{
+		if(isTimerRunning)
+		{
+			if((SyncsOwed > 0) || (TimerSyncs != ReportedSyncs))
+				DueInUs = 0;
+		}
+		else if(GetSyncPeriodUs() > 0)
+			DueInUs = isSyncScheduled ? COSchedMin(DueInUs, COSchedLeft(nextSyncAt, micros())) : 0;
+	}
+	
+	return DueInUs;
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::OnDue()
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::OnDue()
+{
+	Update(millis());
+	Handler->GetScheduler()->ArmIn(&SyncDue, GetDueInUs());
 }
 
 /*-------------------------------------------------------------------
@@ -131,8 +229,16 @@ void COSyncHandler::SetState(SyncMasterState newState)
  * or Sync and related messages are sent
  * these are trhow away messages - unconfirmed
  * for the HB the current node stante of this device is added
+ *
+ * The SYNC is scheduled in us on a fixed grid (micros()), so a late
+ * call doesn't shift the following ones. Being late by a period or
+ * more is handled by the LatePolicy.
+ * If the SYNC is sent by the timer, a SYNC sent there is reported
+ * here - one per call.
  * 
  * 25-03-09 AW 
+ * 2026-10-16 AW SYNC scheduled in us, timer driven SYNC
+ * 2026-10-16 AW SYNC only if operational
  *
  *-------------------------------------------------------------------*/
 
@@ -159,7 +265,7 @@ COSyncState COSyncHandler::Update(uint32_t actTime)
 		}
 	}
 	//in operational it's HB and Sync to be checked
-  else if(eSyncStateOperational)
+  else if(SyncState == eSyncStateOperational)
 	{
 		//simply send the HB message related to the given nodeId
 		//add the "node state" of this service
@@ -175,20 +281,274 @@ COSyncState COSyncHandler::Update(uint32_t actTime)
 				}
 			}
 		}
+		
+		uint32_t periodUs = GetSyncPeriodUs();
+		
+		if(isTimerRunning)
+		{
+			returnValue = ReportTimerSync();
+		}
     //send the sync message when timed out
-		if(SyncInterval > 0)
+		else if(periodUs > 0)
 		{
-			if((actTime - lastSync) >= SyncInterval)
-			  if(SendRequest(&SyncMessage))
+			uint32_t nowUs = micros();
+			
+			if(!isSyncScheduled)
+			{
+				nextSyncAt = nowUs;
+				isSyncScheduled = true;
+			}
+			
+			uint32_t lateUs = nowUs - nextSyncAt;
+			
+			if((int32_t)lateUs >= 0)
+			{
+			  if(SendSync(nowUs))
 				{
 					lastSync = actTime;
 					returnValue = eSyncSyncSent;
+					
+					if(lateUs >= periodUs)
+						Stats.NumLate++;
+					
+					//the next one on the grid - if that's passed already too
+					//it's sent with the next call or skipped
+					nextSyncAt += periodUs;
+					if((int32_t)(nowUs - nextSyncAt) >= 0)
+					{
+						uint32_t missed = (nowUs - nextSyncAt) / periodUs + 1;
+						uint32_t keep = (LatePolicy == eSyncCatchUp) ? SyncMaxCatchUp : 0;
+						
+						if(missed > keep)
+						{
+							nextSyncAt += (missed - keep) * periodUs;
+							Stats.NumSkipped += missed - keep;
+						}
+					}
 				}
+			}
 		}
 	}
   return returnValue;	
 }
 
+/*-------------------------------------------------------------------
+ * void COSyncHandler::SetSyncPeriodUs(uint32_t periodUs)
+ * 
+ * the SYNC period in us - for periods below 1ms or not being a
+ * multiple of it. 0 uses the SyncInterval in ms again.
+ * A running SYNC timer is restarted with the new period.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::SetSyncPeriodUs(uint32_t periodUs)
+{
+	SyncPeriodUs = periodUs;
+	isSyncScheduled = false;
+	hasLastSync = false;
+	
+	if(isTimerRunning)
+		StartSyncTimer();
+	Wake();
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::SetSyncLatePolicy(COSyncLatePolicy Policy)
+ * 
+ * SYNCs missed, as the Update() was called too late or the
+ * COMsgHandler refused the one of the timer, are either sent
+ * late (eSyncCatchUp, the default) or dropped (eSyncSkip)
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::SetSyncLatePolicy(COSyncLatePolicy Policy)
+{
+	LatePolicy = Policy;
+}
+
+/*-------------------------------------------------------------------
+ * bool COSyncHandler::SetSyncCounterOverflow(uint8_t Overflow)
+ * 
+ * the SYNC counter overflow value as in 0x1019 of a SYNC producer:
+ * 0 (SyncCounterOff) sends the SYNC without data, 2..240 adds a byte
+ * counting 1..Overflow, starting over with 1 after the Overflow.
+ * The counter restarts with the next SYNC. Other values are refused.
+ * The nodes' SYNC start value (0x1400/0x1800 sub 6) refers to it.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+bool COSyncHandler::SetSyncCounterOverflow(uint8_t Overflow)
+{
+	if((Overflow != SyncCounterOff) && ((Overflow < SyncCounterMin) || (Overflow > SyncCounterMax)))
+		return false;
+	
+	CO_ENTER_CRITICAL();
+	SyncCounterOverflow = Overflow;
+	SyncCounter = 0;
+	SyncMessage.len = (Overflow == SyncCounterOff) ? 0 : 1;
+	CO_EXIT_CRITICAL();
+	
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::SetSyncWindowUs(uint32_t windowUs)
+ * 
+ * the synchronous window length in us as in 0x1007: synchronous
+ * RxPDOs are sent only within this time after the SYNC, the ones
+ * which would finish later are dropped and counted per node
+ * (COPDOHandler::GetLateRxPDOs()). 0 is no window.
+ * Kept by the COMsgHandler, so it has to be initialized before.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::SetSyncWindowUs(uint32_t windowUs)
+{
+	Handler->SetSyncWindowUs(windowUs);
+}
+
+/*-------------------------------------------------------------------
+ * bool COSyncHandler::StartSyncTimer()
+ * 
+ * send the SYNC from the interrupt of a FspTimer of the UNO R4
+ * instead of the Update() - the period doesn't depend on the
+ * loop() then. The Update() still has to be called, it reports the
+ * SYNCs sent and sends the HB.
+ * Returns false if there is no timer available.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+bool COSyncHandler::StartSyncTimer()
+{
+	uint8_t TimerType;
+	uint32_t periodUs = GetSyncPeriodUs();
+	
+	if(periodUs == 0)
+		return false;
+	
+	if(isTimerRunning)
+		StopSyncTimer();
+	
+	int8_t Channel = FspTimer::get_available_timer(TimerType);
+	
+	if((Channel < 0)
+		 || !SyncTimer.begin(TIMER_MODE_PERIODIC, TimerType, Channel, 1000000.0f / (float)periodUs, 0.0f, OnSyncTimerCb, this)
+		 || !SyncTimer.setup_overflow_irq()
+		 || !SyncTimer.open()
+		 || !SyncTimer.start())
+	{
+		SyncTimer.end();
+		
+		#if(DEBUG_SYNC & DEBUG_SYNC_Timer)
+		Serial.println("Sync: no timer available");
+		#endif
+		
+		return false;
+	}
+	
+	ReportedSyncs = TimerSyncs;
+	SyncsOwed = 0;
+	hasLastSync = false;
+	isTimerRunning = true;
+	Wake();
+	
+	#if(DEBUG_SYNC & DEBUG_SYNC_Timer)
+	Serial.print("Sync: timer started, period ");
+	Serial.print(periodUs);
+	Serial.println("us");
+	#endif
+	
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::StopSyncTimer()
+ * 
+ * the SYNC is sent by the Update() again
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::StopSyncTimer()
+{
+	if(!isTimerRunning)
+		return;
+	
+	SyncTimer.stop();
+	SyncTimer.end();
+	isTimerRunning = false;
+	isSyncScheduled = false;
+	hasLastSync = false;
+	Wake();
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::GetSyncStats(COSyncStats *Result)
+ * 
+ * the statistics of the SYNCs sent so far: number and the min, max,
+ * mean and standard deviation of the intervals between them
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::GetSyncStats(COSyncStats *Result)
+{
+	int64_t Sum;
+	uint64_t SumSq;
+	
+	CO_ENTER_CRITICAL();
+	*Result = Stats;
+	Sum = SumDeviation;
+	SumSq = SumDeviationSq;
+	CO_EXIT_CRITICAL();
+	
+	if(Result->NumIntervals > 0)
+	{
+		float meanDeviation = (float)Sum / Result->NumIntervals;
+		float variance = (float)SumSq / Result->NumIntervals - meanDeviation * meanDeviation;
+		
+		Result->MeanIntervalUs = (float)GetSyncPeriodUs() + meanDeviation;
+		Result->StdDevUs = (variance > 0) ? sqrtf(variance) : 0;
+	}
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::ResetSyncStats()
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::ResetSyncStats()
+{
+	CO_ENTER_CRITICAL();
+	Stats.NumSyncs = 0;
+	Stats.NumIntervals = 0;
+	Stats.MinIntervalUs = 0;
+	Stats.MaxIntervalUs = 0;
+	Stats.MeanIntervalUs = 0;
+	Stats.StdDevUs = 0;
+	Stats.NumLate = 0;
+	Stats.NumSkipped = 0;
+	Stats.NumTxFailed = 0;
+	SumDeviation = 0;
+	SumDeviationSq = 0;
+	hasLastSync = false;
+	CO_EXIT_CRITICAL();
+}
+
 //--- global NMT commands --------------------------------------------
 
 /*-------------------------------------------------------------------
@@ -281,6 +641,148 @@ COSyncCommStates returnValue = eCO_SyncBusy;
 
 //--- private functions ---
 		
+/*-------------------------------------------------------------------
+ * bool COSyncHandler::SendSync(uint32_t nowUs)
+ * 
+ * hand the SYNC to the COMsgHandler and measure the interval
+ * to the last one. Called from the Update() or the timer interrupt,
+ * so neither uses the SendRequest() and it's retry states.
+ * The counter is only advanced if the SYNC was taken, the
+ * synchronous window starts now.
+ * 
+ * 2026-10-16 AW 
+ * 2026-10-16 AW SYNC counter, synchronous window
+ * 2026-10-16 AW event trace
+ * 2026-10-16 AW run by the scheduler of the COMsgHandler
+ *
+ *-------------------------------------------------------------------*/
+
+bool COSyncHandler::SendSync(uint32_t nowUs)
+{
+	uint8_t nextCounter = 0;
+	
+	if(SyncCounterOverflow != SyncCounterOff)
+	{
+		nextCounter = (SyncCounter >= SyncCounterOverflow) ? 1 : SyncCounter + 1;
+		SyncMessage.payload[0] = nextCounter;
+	}
+	
+	if(!Handler->SendMsg(&SyncMessage))
+	{
+		Stats.NumTxFailed++;
+		return false;
+	}
+	
+	SyncCounter = nextCounter;
+	Handler->OnSyncSent(nowUs);
+	CO_TRACE_EVENT(eCOTraceSync, 0, SyncCounter, hasLastSync ? nowUs - lastSyncUs : 0);
+	
+	if(hasLastSync)
+	{
+		uint32_t interval = nowUs - lastSyncUs;
+		int32_t deviation = (int32_t)(interval - GetSyncPeriodUs());
+		
+		if((Stats.NumIntervals == 0) || (interval < Stats.MinIntervalUs))
+			Stats.MinIntervalUs = interval;
+		if(interval > Stats.MaxIntervalUs)
+			Stats.MaxIntervalUs = interval;
+		
+		SumDeviation += deviation;
+		SumDeviationSq += (uint64_t)((int64_t)deviation * deviation);
+		Stats.NumIntervals++;
+	}
+	
+	Stats.NumSyncs++;
+	lastSyncUs = nowUs;
+	hasLastSync = true;
+	
+	#if(DEBUG_SYNC & DEBUG_SYNC_TXMsg)
+	Serial.println("Sync: TX SYNC");
+	#endif
+	
+	return true;
+}
+
+/*-------------------------------------------------------------------
+ * void COSyncHandler::OnSyncTimer()
+ * 
+ * the interrupt of the SYNC timer: send the SYNC if operational.
+ * One refused by the COMsgHandler is owed and sent by the Update()
+ * (eSyncCatchUp) or dropped (eSyncSkip).
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+void COSyncHandler::OnSyncTimer()
+{
+	if(SyncState != eSyncStateOperational)
+		return;
+	
+	if(SendSync(micros()))
+		TimerSyncs++;
+	else if((LatePolicy == eSyncCatchUp) && (SyncsOwed < SyncMaxCatchUp))
+	{
+		SyncsOwed++;
+		Wake();
+	}
+	else
+		Stats.NumSkipped++;
+}
+
+/*-------------------------------------------------------------------
+ * COSyncState COSyncHandler::ReportTimerSync()
+ * 
+ * send a SYNC owed by the timer and report the ones sent by it,
+ * one per call. If the loop() falls behind by more than SyncMaxCatchUp
+ * SYNCs, the older ones are not reported.
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+COSyncState COSyncHandler::ReportTimerSync()
+{
+	if(SyncsOwed > 0)
+	{
+		CO_ENTER_CRITICAL();
+		if(SendSync(micros()))
+		{
+			SyncsOwed--;
+			Stats.NumLate++;
+			TimerSyncs++;
+		}
+		CO_EXIT_CRITICAL();
+	}
+	
+	uint32_t sent = TimerSyncs;
+	
+	if(sent == ReportedSyncs)
+		return eSyncIdle;
+	
+	if((sent - ReportedSyncs) > SyncMaxCatchUp)
+		ReportedSyncs = sent - 1;
+	else
+		ReportedSyncs++;
+	
+	return eSyncSyncSent;
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t COSyncHandler::GetSyncPeriodUs()
+ * 
+ * 2026-10-16 AW 
+ *
+ *-------------------------------------------------------------------*/
+
+uint32_t COSyncHandler::GetSyncPeriodUs()
+{
+	if(SyncPeriodUs > 0)
+		return SyncPeriodUs;
+	
+	return (uint32_t)SyncInterval * 1000;
+}
+
 /*-------------------------------------------------------------------
  * bool COSyncHandler::SendRequest(CANMsg *Msg)
  * 
@@ -26,12 +26,16 @@
  * produce a global HB message if configured
  *
  * 2025-03-09 AW Frame
+ * 2026-10-16 AW SYNC period in us, late policy, timer driven SYNC, jitter statistics
+ * 2026-10-16 AW SYNC counter and synchronous window
+ * 2026-10-16 AW run by the scheduler of the COMsgHandler
  *
  *-------------------------------------------------------------------*/
  
 //--- includes ---
  
 #include <COMsgHandler.h>
+#include <FspTimer.h>
 #include <stdint.h>
 
 //--- local definitions ---
@@ -55,6 +59,34 @@ typedef enum COSyncState {
 	eSyncSyncSent
 } COSyncState;
 
+//a SYNC sent later than it's time by a period or more
+typedef enum COSyncLatePolicy {
+	eSyncCatchUp,   //the ones missed are sent one after the other (up to SyncMaxCatchUp)
+	eSyncSkip       //the ones missed are dropped, the next one is on time again
+} COSyncLatePolicy;
+
+const uint8_t SyncMaxCatchUp = 4;
+
+//the SYNC counter overflow value (0x1019): 0 is a SYNC without counter,
+//2..240 a counter of 1..overflow value in the single byte of the SYNC
+const uint8_t SyncCounterOff = 0;
+const uint8_t SyncCounterMin = 2;
+const uint8_t SyncCounterMax = 240;
+
+//the intervals between two SYNCs, measured when they are handed
+//to the COMsgHandler
+typedef struct COSyncStats {
+	uint32_t NumSyncs;        //SYNCs sent
+	uint32_t NumIntervals;    //intervals measured
+	uint32_t MinIntervalUs;
+	uint32_t MaxIntervalUs;
+	float MeanIntervalUs;
+	float StdDevUs;           //standard deviation of the interval
+	uint32_t NumLate;         //sent late by a period or more
+	uint32_t NumSkipped;      //not sent - skipped or more than SyncMaxCatchUp behind
+	uint32_t NumTxFailed;     //refused by the COMsgHandler
+} COSyncStats;
+
 
 class COSyncHandler {
 	public:
@@ -64,6 +96,27 @@ class COSyncHandler {
 
 	  COSyncState Update(uint32_t); //generate the HB and the Sync depending on time and state
 	
+	  //instead of calling Update() in the loop: run by the COMsgHandler
+	  //at the time of the next SYNC or HB
+	  void Schedule();
+	  void Wake();
+	  uint32_t GetDueInUs();
+	
+	  //the SYNC period in us, 0: SyncInterval in ms is used
+	  void SetSyncPeriodUs(uint32_t);
+	  void SetSyncLatePolicy(COSyncLatePolicy);
+	  //the SYNC counter overflow value (0x1019)
+	  bool SetSyncCounterOverflow(uint8_t);
+	  uint8_t GetSyncCounter() { return SyncCounter; }
+	  //the synchronous window in us (0x1007), 0: none
+	  void SetSyncWindowUs(uint32_t);
+	  //the SYNC sent by a hardware timer instead of the Update()
+	  bool StartSyncTimer();
+	  void StopSyncTimer();
+	
+	  void GetSyncStats(COSyncStats *);
+	  void ResetSyncStats();
+	
 	  void SetState(SyncMasterState); //force the com op-mode to init / Pre-op / op
 	
 	  COSyncCommStates SendResetNodes();
@@ -72,8 +125,21 @@ class COSyncHandler {
 	  uint16_t ProducerHBTime = 0;
 	  uint16_t SyncInterval = 100;
 		
+	  static void OnSyncTimerCb(timer_callback_args_t *args) {
+		  ((COSyncHandler *)args->p_context)->OnSyncTimer();
+	  };
+	
+	  static void OnDueCb(void *op,void *p) {
+		  ((COSyncHandler *)op)->OnDue();
+	  };
+	
 	private:
 	  bool SendRequest(CANMsg *);
+	  bool SendSync(uint32_t);
+	  void OnSyncTimer();
+	  uint32_t GetSyncPeriodUs();
+	  COSyncState ReportTimerSync();
+	  void OnDue();
     
 	  uint8_t HBProducerId = 127;  //used for HB message
 	
@@ -88,6 +154,33 @@ class COSyncHandler {
 	  uint32_t lastSync = 0;
 	  uint32_t lastHB = 0;
 	
+	  //the schedule of the SYNC in us
+	  uint32_t SyncPeriodUs = 0;
+	  COSyncLatePolicy LatePolicy = eSyncCatchUp;
+	  bool isSyncScheduled = false;
+	  uint32_t nextSyncAt = 0;
+	  uint32_t lastSyncUs = 0;
+	  bool hasLastSync = false;
+	
+	  //timer driven: counted in the interrupt, reported by the Update()
+	  FspTimer SyncTimer;
+	  bool isTimerRunning = false;
+	  volatile uint32_t TimerSyncs = 0;
+	  uint32_t ReportedSyncs = 0;
+	  volatile uint8_t SyncsOwed = 0;
+	
+	  //run by the scheduler
+	  COSchedItem SyncDue;
+	  bool isScheduled = false;
+	
+	  //the counter of the last SYNC sent, 0 if none
+	  uint8_t SyncCounterOverflow = SyncCounterOff;
+	  volatile uint8_t SyncCounter = 0;
+	
+	  COSyncStats Stats;
+	  int64_t SumDeviation = 0;     //intervals minus the period, us
+	  uint64_t SumDeviationSq = 0;
+	
 	  SyncMasterState SyncState = eSyncStateOffline;
 	
 		uint8_t BusyRetryCounter = 0;
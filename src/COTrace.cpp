@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+/*-------------------------------------------------------------------
+ * COTrace.cpp
+ * the ring of the event trace
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <COTrace.h>
+
+//--- local definitions ---
+
+#if CO_TRACE
+const uint32_t TraceMask = CO_TRACE_RECORDS - 1;
+static_assert((CO_TRACE_RECORDS & TraceMask) == 0, "CO_TRACE_RECORDS has to be a power of 2");
+
+static COTraceRecord TraceRing[CO_TRACE_RECORDS];
+//the number of records written since the last clear, the slot is NextRecord & TraceMask
+static uint32_t NextRecord = 0;
+static volatile bool isTraceEnabled = true;
+#endif
+
+//--- implementation ---
+
+/*-------------------------------------------------------------------
+ * void COTraceWrite(COTraceEvent Event, uint8_t Node, uint16_t Arg0, uint32_t Arg1)
+ *
+ * write a record into the ring - from the loop or an interrupt.
+ * The slot is taken by an atomic increment, so an interrupt
+ * writing a record meanwhile gets the next one.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COTraceWrite(COTraceEvent Event, uint8_t Node, uint16_t Arg0, uint32_t Arg1)
+{
+	#if CO_TRACE
+	if(!isTraceEnabled)
+		return;
+
+	uint32_t at = micros();
+	COTraceRecord *Record = &TraceRing[__atomic_fetch_add(&NextRecord, 1, __ATOMIC_RELAXED) & TraceMask];
+
+	Record->At = at;
+	Record->Event = (uint8_t)Event;
+	Record->Node = Node;
+	Record->Arg0 = Arg0;
+	Record->Arg1 = Arg1;
+	#else
+	(void)Event;
+	(void)Node;
+	(void)Arg0;
+	(void)Arg1;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COTraceSetEnabled(bool isEnabled)
+ *
+ * stop the trace to keep the records of interest, e.g. when an
+ * error is detected, and start it again.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COTraceSetEnabled(bool isEnabled)
+{
+	#if CO_TRACE
+	isTraceEnabled = isEnabled;
+	#else
+	(void)isEnabled;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COTraceClear()
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COTraceClear()
+{
+	#if CO_TRACE
+	noInterrupts();
+	NextRecord = 0;
+	interrupts();
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * uint16_t COTraceRead(COTraceRecord *Records, uint16_t maxRecords)
+ *
+ * copy the records in the ring, the oldest first, and return their
+ * number. If there are more than maxRecords the latest are copied.
+ * The interrupts are locked while copying, so no record is
+ * half written.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint16_t COTraceRead(COTraceRecord *Records, uint16_t maxRecords)
+{
+	#if CO_TRACE
+	uint32_t numRecords;
+
+	noInterrupts();
+	numRecords = (NextRecord < CO_TRACE_RECORDS) ? NextRecord : CO_TRACE_RECORDS;
+	if(numRecords > maxRecords)
+		numRecords = maxRecords;
+
+	for(uint32_t iter = 0; iter < numRecords; iter++)
+		Records[iter] = TraceRing[(NextRecord - numRecords + iter) & TraceMask];
+	interrupts();
+
+	return (uint16_t)numRecords;
+	#else
+	(void)Records;
+	(void)maxRecords;
+	return 0;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t COTraceGetNumLost()
+ *
+ * the number of records overwritten since the last clear
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+uint32_t COTraceGetNumLost()
+{
+	#if CO_TRACE
+	uint32_t numRecords = __atomic_load_n(&NextRecord, __ATOMIC_RELAXED);
+
+	return (numRecords > CO_TRACE_RECORDS) ? numRecords - CO_TRACE_RECORDS : 0;
+	#else
+	return 0;
+	#endif
+}
+
+/*-------------------------------------------------------------------
+ * void COTraceDump()
+ *
+ * send the records via Serial in binary: COTraceMagic, the size of
+ * a record and the number of records (uint16_t each), the number of
+ * records lost (uint32_t) and the records, the oldest first.
+ * All little endian as in the memory of the Cortex-M4.
+ * The trace is stopped while sending and started again if it was
+ * running. The decoder finds the dump by the magic within the other
+ * output of the sketch.
+ *
+ * 2026-10-16 AW
+ *-------------------------------------------------------------------*/
+
+void COTraceDump()
+{
+	#if CO_TRACE
+	bool wasEnabled = isTraceEnabled;
+	uint16_t recordSize = sizeof(COTraceRecord);
+	uint16_t numRecords;
+	uint32_t numLost;
+
+	isTraceEnabled = false;
+
+	noInterrupts();
+	numRecords = (NextRecord < CO_TRACE_RECORDS) ? NextRecord : CO_TRACE_RECORDS;
+	numLost = NextRecord - numRecords;
+	interrupts();
+
+	Serial.write(COTraceMagic, sizeof(COTraceMagic));
+	Serial.write((const uint8_t *)&recordSize, sizeof(recordSize));
+	Serial.write((const uint8_t *)&numRecords, sizeof(numRecords));
+	Serial.write((const uint8_t *)&numLost, sizeof(numLost));
+	for(uint16_t iter = 0; iter < numRecords; iter++)
+		Serial.write((const uint8_t *)&TraceRing[(NextRecord - numRecords + iter) & TraceMask], sizeof(COTraceRecord));
+	Serial.flush();
+
+	isTraceEnabled = wasEnabled;
+	#else
+	Serial.println("Trace: build with -DCO_TRACE=1");
+	#endif
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_TRACE_H
+#define CO_TRACE_H
+
+/*--------------------------------------------------------------------
+ * COTrace
+ * a binary event trace of the library: fixed size records of the
+ * time stamp (micros()), the event, the node and two arguments are
+ * written into a ring in RAM - from the loop and the interrupts.
+ * The ring keeps the last CO_TRACE_RECORDS records, older ones are
+ * overwritten.
+ *
+ * COTraceDump() sends the records in binary via Serial, the host
+ * tool extras/host/tools/COTraceDecode renders them to text or the
+ * Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * The trace is compiled in with -DCO_TRACE=1 only, otherwise
+ * CO_TRACE_EVENT() is an empty statement and nothing is left of it -
+ * ((void)0), so it can be the body of an if() or else.
+ * Unlike the Serial.print() of the DEBUG_xxx flags a record takes
+ * a few us, so the timing of the bus is kept while tracing.
+ *
+ * 2026-10-16 AW Frame
+ * 2026-10-16 AW disabled CO_TRACE_EVENT() as an empty statement
+ * 2026-10-16 AW SDO retries and errors
+ * 2026-10-16 AW rejected frames, short PDOs and EMCYs
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#ifndef CO_TRACE
+#define CO_TRACE 0
+#endif
+
+//the size of the ring, has to be a power of 2
+#ifndef CO_TRACE_RECORDS
+#define CO_TRACE_RECORDS 512
+#endif
+
+//--- the events ---
+//new events are appended only, the decoder knows them by their number
+
+typedef enum COTraceEvent {
+	eCOTraceNone,
+	eCOTraceRx,             //Arg0: COB-Id, Arg1: payload[0..3]
+	eCOTraceTx,             //Arg0: COB-Id, Arg1: payload[0..3]
+	eCOTraceRxDropped,      //Arg0: COB-Id, Rx buffer full
+	eCOTraceCANError,       //Arg0: the can_event_t
+	eCOTraceNMTState,       //Arg0: new NMTNodeState, Arg1: the one before
+	eCOTraceGuardingError,  //Arg0: requests open
+	eCOTraceHBTimeout,      //Arg1: us since the last heartbeat
+	eCOTraceSDORequest,     //Arg0: index, Arg1: sub-index | request type << 8
+	eCOTraceSDODone,        //Arg0: index, Arg1: length
+	eCOTraceSDOAbort,       //Arg0: index, Arg1: abort code of the server
+	eCOTraceSDOTimeout,     //Arg0: index, Arg1: 1 if final, 0 if retried
+	eCOTraceSync,           //Arg0: SYNC counter, Arg1: us since the last SYNC
+	eCOTraceRxPDOLate,      //Arg0: COB-Id, missed the synchronous window
+	eCOTraceTxPDOTimeout,   //Arg0: COB-Id
+	eCOTraceUser,           //free for the application
+	eCOTraceSDORetry,       //Arg0: index, Arg1: request type, blocked by a full Tx queue
+	eCOTraceSDOError,       //Arg0: index, Arg1: request type, invalid response
+	eCOTraceTxRejected,     //Arg0: COB-Id, Tx queue full
+	eCOTraceRxPDOShort,     //Arg0: COB-Id, Arg1: length received
+	eCOTraceEMCY,           //Arg0: EMCY code, Arg1: error register | CiA error word << 8
+	eCONumTraceEvents
+} COTraceEvent;
+
+typedef struct COTraceRecord {
+	uint32_t At;            //micros()
+	uint8_t Event;          //COTraceEvent
+	uint8_t Node;
+	uint16_t Arg0;
+	uint32_t Arg1;
+} COTraceRecord;
+
+//a dump starts with the magic, the size of a record and the number of records
+const uint8_t COTraceMagic[4] = {'C', 'O', 'T', 'R'};
+
+#if CO_TRACE
+#define CO_TRACE_EVENT(Event, Node, Arg0, Arg1) COTraceWrite(Event, Node, Arg0, Arg1)
+#else
+#define CO_TRACE_EVENT(Event, Node, Arg0, Arg1) ((void)0)
+#endif
+
+//--- the functions, to be called only if CO_TRACE is set ---
+
+void COTraceWrite(COTraceEvent, uint8_t Node, uint16_t Arg0, uint32_t Arg1);
+void COTraceSetEnabled(bool);
+void COTraceClear();
+uint16_t COTraceRead(COTraceRecord *, uint16_t maxRecords);
+uint32_t COTraceGetNumLost();
+void COTraceDump();
+
+//the first 4 bytes of a payload as Arg1
+inline uint32_t COTracePayload(const uint8_t *payload)
+{
+	return (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 by Andreas Wagener (AW)
+ * CANopen central device library for Arduino UNO R4.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CO_TRANSPORT_H
+#define CO_TRANSPORT_H
+
+/*--------------------------------------------------------------------
+ * interface class COTransport
+ * the CAN interface used by the COMsgHandler.
+ * Implemented by the UNOR4CAN on the board and by the COVirtualCAN
+ * of the host build (extras/host) which is an in-memory CAN bus.
+ *
+ * Frames and events are the ones of the Renesas FSP CAN driver.
+ * Received frames, Tx complete and error events are reported via the
+ * callback registered with set_callback() - interrupt context on
+ * the board.
+ *
+ * 2026-10-16 AW Frame
+ *
+ *-------------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include "r_can.h"
+#include "api/HardwareCAN.h"
+
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+class COTransport {
+	public:
+	  virtual bool begin(void) = 0;
+	  virtual void end(void) = 0;
+
+	  virtual void set_can_bitrate(CanBitRate bitrate) = 0;
+	  virtual void set_callback(pfunction_holder *) = 0;
+
+	  //returns > 0 if the frame was placed in the mailbox
+	  virtual int send(can_frame_t *msg, uint32_t const mailbox) = 0;
+};
+
+#if defined(CO_HOST_BUILD)
+//the transport used by a COMsgHandler created by it's pin constructor
+//provided by the host build
+COTransport *COHostDefaultTransport();
+#endif
+
+#endif
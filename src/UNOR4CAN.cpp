@@ -10,6 +10,9 @@
  * published by the Free Software Foundation.
  */
 
+// (AW) the host build uses the COVirtualCAN instead
+#if !defined(CO_HOST_BUILD)
+
 /**************************************************************************************
  * INCLUDE
  **************************************************************************************/
@@ -201,7 +204,14 @@ int UNOR4CAN::disableInternalLoopback() {
 
 int UNOR4CAN::send(can_frame_t *msg) {
 
-  if (fsp_err_t const rc = R_CAN_Write(&_can_ctrl, CAN_MAILBOX_ID_0, msg); rc != FSP_SUCCESS)
+  return send(msg, CAN_MAILBOX_ID_0);
+}
+
+// (AW) the mailbox has to be one of the Tx mailboxes configured
+// in the constructor and must match the frame's id_mode and type
+int UNOR4CAN::send(can_frame_t *msg, uint32_t const mailbox) {
+
+  if (fsp_err_t const rc = R_CAN_Write(&_can_ctrl, mailbox, msg); rc != FSP_SUCCESS)
     return -rc;
 
   return 1;
@@ -295,3 +305,4 @@ extern "C" void can_callback2(can_callback_args_t * p_args)
   this_ptr->onCanCallback2(p_args);
 }
 
+#endif
@@ -25,6 +25,9 @@
 //2024-11-16 AW
 //--- added include to allow complete Cb
 #include <MC_Helpers.h>
+//2026-10-16 AW
+//--- the interface used by the COMsgHandler
+#include <COTransport.h>
 
 #define CANopenLib
 
@@ -41,21 +44,23 @@ std::tuple<bool,     /* valid result found */
 
 ///
 
-class UNOR4CAN {
+class UNOR4CAN : public COTransport {
 public:
   UNOR4CAN(int const can_tx_pin = 4, int const can_rx_pin = 5);
   ~UNOR4CAN() { }
 
-  bool begin(void);
-  void end(void);
+  bool begin(void) override;
+  void end(void) override;
 
-  void set_can_bitrate(CanBitRate bitrate);
+  void set_can_bitrate(CanBitRate bitrate) override;
   void set_callback(void (*fptr)(can_callback_args_t *args));
 
   // (AW) add a method to register a Cb using the functor
-	void set_callback(pfunction_holder *);
+	void set_callback(pfunction_holder *) override;
 
   int send(can_frame_t *msg);
+  // (AW) send using one of the configured Tx mailboxes
+  int send(can_frame_t *msg, uint32_t const mailbox) override;
 
   int enableInternalLoopback();
   int disableInternalLoopback();